@@ -0,0 +1,190 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/btree.h"
+#include "../src/rbtree.h"
+
+#define NUM_NODES 100000
+
+typedef enum Container {
+    CONTAINER_RBTREE,
+    CONTAINER_BTREE,
+    CONTAINER_BTREE_PREFIX
+} Container;
+
+const char *container_names[] = { "rbtree", "btree", "btree+prefix" };
+
+typedef struct BenchStruct {
+    int key;
+    RBTreeNode rbtree_node;
+    BTreeNode btree_node;
+} BenchStruct;
+
+BenchStruct vars[NUM_NODES];
+size_t order[NUM_NODES];
+BTreePage page_array[BTREE_PAGES_NEEDED(NUM_NODES)];
+RBTree rbtree;
+BTree btree;
+
+static int rbtree_compare(const void *key, const RBTreeNode *node) {
+    int x = *(const int*) key, y = rbtree_entry(node, BenchStruct, rbtree_node)->key;
+
+    return (x > y) - (x < y);
+}
+
+static int btree_compare(const void *key, const BTreeNode *node) {
+    int x = *(const int*) key, y = btree_entry(node, BenchStruct, btree_node)->key;
+
+    return (x > y) - (x < y);
+}
+
+static unsigned long key_prefix(const void *key) {
+    return (unsigned long) *(const int*) key;
+}
+
+static void shuffle(size_t *array, size_t n) {
+    size_t i;
+
+    for (i = n - 1; i > 0; --i) {
+        size_t j = (size_t) rand() % (i + 1), tmp = array[i];
+        array[i] = array[j];
+        array[j] = tmp;
+    }
+}
+
+static void bench_insert(Container container, BenchStruct *var) {
+    if (container == CONTAINER_RBTREE) {
+        rbtree_insert(&rbtree, &var->key, &var->rbtree_node);
+    } else {
+        btree_insert(&btree, &var->key, &var->btree_node);
+    }
+}
+
+static size_t bench_lookup_key(Container container, const int *key) {
+    if (container == CONTAINER_RBTREE) {
+        return (size_t) rbtree_lookup_key(&rbtree, key);
+    } else {
+        return (size_t) btree_lookup_key(&btree, key);
+    }
+}
+
+static void bench_remove(Container container, BenchStruct *var) {
+    if (container == CONTAINER_RBTREE) {
+        rbtree_remove(&rbtree, &var->rbtree_node);
+    } else {
+        btree_remove(&btree, &var->btree_node);
+    }
+}
+
+/*
+ * Inserts, looks up and removes all nodes in random order. The keys are shuffled across the array, so that
+ * comparing with a node touches a cache line unrelated to those of its neighbours in key order.
+ */
+static void bench_container(Container container) {
+    Benchmark benchmark;
+    size_t i, j;
+    int missing_key;
+
+    for (i = 0; i < NUM_NODES; ++i) {
+        order[i] = i;
+    }
+
+    shuffle(order, NUM_NODES);
+
+    for (i = 0; i < NUM_NODES; ++i) {
+        vars[i].key = (int) (2 * order[i]);
+    }
+
+    shuffle(order, NUM_NODES);
+
+    rbtree_init(&rbtree, rbtree_compare, NULL, NULL);
+    btree_init(&btree, page_array, BTREE_PAGES_NEEDED(NUM_NODES), btree_compare, NULL, NULL);
+
+    if (container == CONTAINER_BTREE_PREFIX) {
+        btree_set_key_prefix(&btree, key_prefix);
+    }
+
+    benchmark_begin(&benchmark, "insert", container_names[container], NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            bench_insert(container, &vars[order[j]]);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    shuffle(order, NUM_NODES);
+
+    benchmark_begin(&benchmark, "lookup_key", container_names[container], NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            benchmark_sink += bench_lookup_key(container, &vars[order[j]].key);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "lookup_key_miss", container_names[container], NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            missing_key = vars[order[j]].key + 1;
+            benchmark_sink += bench_lookup_key(container, &missing_key);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    if (container != CONTAINER_RBTREE) {
+        benchmark_begin(&benchmark, "at", container_names[container], NUM_NODES);
+        for (i = 0; i < NUM_NODES; i = j) {
+            double start = benchmark_now();
+            for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+                benchmark_sink += (size_t) btree_at(&btree, order[j]);
+            }
+            benchmark_record(&benchmark, benchmark_now() - start, j - i);
+        }
+        benchmark_end(&benchmark);
+    }
+
+    shuffle(order, NUM_NODES);
+
+    benchmark_begin(&benchmark, "remove", container_names[container], NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            bench_remove(container, &vars[order[j]]);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    srand(1);
+
+    bench_container(CONTAINER_RBTREE);
+    bench_container(CONTAINER_BTREE);
+    bench_container(CONTAINER_BTREE_PREFIX);
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/hash_string.h"
+
+#define MAX_LENGTH 4096
+#define BYTES_PER_BENCHMARK (16UL * 1024 * 1024)
+
+/* Strings of every length start at a different offset, so that unaligned reads are measured as well. */
+char strings[MAX_LENGTH + 16];
+
+static void bench_length(const char *name, int function, size_t length) {
+    char variant[32];
+    Benchmark benchmark;
+    size_t num_hashes = BYTES_PER_BENCHMARK / length, i, j;
+    const char *string = strings + length % 8;
+
+    sprintf(variant, "length=%lu", (unsigned long) length);
+
+    memset(strings, 'x', sizeof(strings));
+    strings[length % 8 + length] = '\0';
+
+    benchmark_begin(&benchmark, name, variant, length);
+    for (i = 0; i < num_hashes; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, num_hashes); ++j) {
+            /* Feeding the previous hash back in keeps the calls from being overlapped or hoisted. */
+            strings[length % 8] = (char) ('a' + benchmark_sink % 16);
+
+            switch (function) {
+                case 0:
+                    benchmark_sink = hash_string(string);
+                    break;
+                case 1:
+                    benchmark_sink = hash_string_fast(string);
+                    break;
+                default:
+                    benchmark_sink = hash_bytes(string, length);
+                    break;
+            }
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    const size_t lengths[] = { 4, 8, 16, 32, 64, 256, 1024, MAX_LENGTH };
+    size_t i;
+
+    for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i) {
+        bench_length("hash_string", 0, lengths[i]);
+        bench_length("hash_string_fast", 1, lengths[i]);
+        bench_length("hash_bytes", 2, lengths[i]);
+    }
+
+    return 0;
+}
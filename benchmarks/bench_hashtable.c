@@ -0,0 +1,221 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/hash_string.h"
+#include "../src/hashtable.h"
+
+#define NUM_NODES 100000
+#define MAX_KEY_LENGTH 64
+#define NUM_SPARSE_NODES 1000
+#define NUM_SPARSE_ROUNDS 200
+
+typedef struct BenchStruct {
+    int key;
+    char string[MAX_KEY_LENGTH + 1];
+    HashTableNode node;
+} BenchStruct;
+
+BenchStruct vars[NUM_NODES];
+char missing_strings[NUM_NODES][MAX_KEY_LENGTH + 1];
+int missing_keys[NUM_NODES];
+size_t order[NUM_NODES];
+HashTableNode *bucket_array[4 * NUM_NODES];
+unsigned long occupancy[HASHTABLE_OCCUPANCY_WORDS(4 * NUM_NODES)];
+HashTable hashtable;
+
+static size_t hash_int(const void *key) {
+    return (size_t) *(const int*) key;
+}
+
+static int equal_int(const void *key, const HashTableNode *node) {
+    return *(const int*) key == hashtable_entry(node, BenchStruct, node)->key;
+}
+
+static int equal_string(const void *key, const HashTableNode *node) {
+    return strcmp((const char*) key, hashtable_entry(node, BenchStruct, node)->string) == 0;
+}
+
+static void shuffle(size_t *array, size_t n) {
+    size_t i;
+
+    for (i = n - 1; i > 0; --i) {
+        size_t j = (size_t) rand() % (i + 1), tmp = array[i];
+        array[i] = array[j];
+        array[j] = tmp;
+    }
+}
+
+static void random_string(char *string, size_t length) {
+    size_t i;
+
+    for (i = 0; i < length; ++i) {
+        string[i] = (char) ('a' + rand() % 26);
+    }
+
+    string[length] = '\0';
+}
+
+/*
+ * Returns the key of the node at @ref index of the current benchmark.
+ */
+static const void* key_of(size_t index, size_t key_length) {
+    return key_length == 0 ? (const void*) &vars[index].key : (const void*) vars[index].string;
+}
+
+static const void* missing_key_of(size_t index, size_t key_length) {
+    return key_length == 0 ? (const void*) &missing_keys[index] : (const void*) missing_strings[index];
+}
+
+/*
+ * Inserts, looks up and removes all nodes of keys of @ref key_length characters (or int keys if
+ * @ref key_length == 0) in a hash table with NUM_NODES / @ref load_factor buckets.
+ */
+static void bench_config(size_t key_length, double load_factor) {
+    char variant[64];
+    Benchmark benchmark;
+    size_t num_buckets = (size_t) (NUM_NODES / load_factor), i, j;
+
+    if (key_length == 0) {
+        sprintf(variant, "key=int load=%.2f", load_factor);
+    } else {
+        sprintf(variant, "key=%lu bytes load=%.2f", (unsigned long) key_length, load_factor);
+    }
+
+    for (i = 0; i < NUM_NODES; ++i) {
+        vars[i].key = rand();
+        missing_keys[i] = -1 - rand();
+        random_string(vars[i].string, key_length);
+        random_string(missing_strings[i], key_length);
+        order[i] = i;
+    }
+
+    shuffle(order, NUM_NODES);
+
+    hashtable_init(
+        &hashtable,
+        bucket_array,
+        num_buckets,
+        key_length == 0 ? hash_int : hash_string_fast,
+        key_length == 0 ? equal_int : equal_string,
+        NULL,
+        NULL
+    );
+
+    benchmark_begin(&benchmark, "hashtable_insert", variant, NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            hashtable_insert(&hashtable, key_of(j, key_length), &vars[j].node);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "hashtable_lookup_key", variant, NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            benchmark_sink += (size_t) hashtable_lookup_key(&hashtable, key_of(order[j], key_length));
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "hashtable_lookup_key_miss", variant, NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            benchmark_sink += (size_t) hashtable_lookup_key(&hashtable, missing_key_of(j, key_length));
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "hashtable_remove_key", variant, NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            hashtable_remove_key(&hashtable, key_of(order[j], key_length));
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+}
+
+/*
+ * Traverses and clears a hash table with 4 * NUM_NODES buckets but only NUM_SPARSE_NODES nodes, with an
+ * occupancy bitmap if @ref use_occupancy is non-zero.
+ */
+static void bench_sparse(int use_occupancy) {
+    const char *variant = use_occupancy ? "sparse occupancy" : "sparse";
+    Benchmark benchmark;
+    HashTableNode *n;
+    size_t i, j, bkt;
+    double start;
+
+    hashtable_init(&hashtable, bucket_array, 4 * NUM_NODES, hash_int, equal_int, NULL, NULL);
+    hashtable_set_occupancy(&hashtable, use_occupancy ? occupancy : NULL);
+
+    for (i = 0; i < NUM_SPARSE_NODES; ++i) {
+        vars[i].key = rand();
+        hashtable_insert(&hashtable, &vars[i].key, &vars[i].node);
+    }
+
+    benchmark_begin(&benchmark, "hashtable_for_each", variant, NUM_SPARSE_NODES);
+    for (i = 0; i < NUM_SPARSE_ROUNDS; ++i) {
+        start = benchmark_now();
+        hashtable_for_each(n, bkt, &hashtable) {
+            benchmark_sink += (size_t) n;
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, 1);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "hashtable_remove_all", variant, NUM_SPARSE_NODES);
+    for (i = 0; i < NUM_SPARSE_ROUNDS; ++i) {
+        for (j = 0; j < NUM_SPARSE_NODES; ++j) {
+            hashtable_insert(&hashtable, &vars[j].key, &vars[j].node);
+        }
+
+        start = benchmark_now();
+        hashtable_remove_all(&hashtable);
+        benchmark_record(&benchmark, benchmark_now() - start, 1);
+    }
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    const double load_factors[] = { 0.25, 0.5, 1.0, 2.0, 4.0 };
+    const size_t key_lengths[] = { 0, 8, MAX_KEY_LENGTH };
+    size_t i, j;
+
+    srand(1);
+
+    for (i = 0; i < sizeof(key_lengths) / sizeof(key_lengths[0]); ++i) {
+        for (j = 0; j < sizeof(load_factors) / sizeof(load_factors[0]); ++j) {
+            bench_config(key_lengths[i], load_factors[j]);
+        }
+    }
+
+    bench_sparse(0);
+    bench_sparse(1);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/list.h"
+
+#define NUM_NODES 100000
+#define NUM_RUNS 5
+
+typedef struct BenchStruct {
+    int val;
+    ListNode node;
+} BenchStruct;
+
+BenchStruct vars[NUM_NODES];
+ListNode *scratch[2 * NUM_NODES];
+List list;
+
+static int compare(const ListNode *a, const ListNode *b) {
+    int x = list_entry(a, BenchStruct, node)->val, y = list_entry(b, BenchStruct, node)->val;
+
+    return (x > y) - (x < y);
+}
+
+static void fill(const char *input) {
+    size_t i;
+
+    list_init(&list);
+
+    for (i = 0; i < NUM_NODES; ++i) {
+        if (strcmp(input, "sorted") == 0) {
+            vars[i].val = (int) i;
+        } else if (strcmp(input, "reversed") == 0) {
+            vars[i].val = (int) (NUM_NODES - i);
+        } else {
+            vars[i].val = rand();
+        }
+
+        list_insert_back(&list, &vars[i].node);
+    }
+}
+
+static void bench_sort(const char *name, const char *input, int algorithm) {
+    Benchmark benchmark;
+    size_t run;
+
+    benchmark_begin(&benchmark, name, input, NUM_NODES);
+
+    for (run = 0; run < NUM_RUNS; ++run) {
+        double start;
+
+        fill(input);
+        start = benchmark_now();
+
+        switch (algorithm) {
+            case 0:
+                list_sort(&list, compare);
+                break;
+            case 1:
+                list_sort_adaptive(&list, compare);
+                break;
+            default:
+                list_sort_buffered(&list, compare, scratch, 2 * NUM_NODES);
+                break;
+        }
+
+        benchmark_record(&benchmark, benchmark_now() - start, NUM_NODES);
+        benchmark_sink += (size_t) list_entry(list.head, BenchStruct, node)->val;
+    }
+
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    const char *inputs[] = { "random", "sorted", "reversed" };
+    size_t i;
+
+    srand(1);
+
+    for (i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+        bench_sort("list_sort", inputs[i], 0);
+        bench_sort("list_sort_adaptive", inputs[i], 1);
+        bench_sort("list_sort_buffered", inputs[i], 2);
+    }
+
+    return 0;
+}
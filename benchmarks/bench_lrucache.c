@@ -0,0 +1,116 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/lrucache.h"
+
+#define CAPACITY 10000
+#define NUM_KEYS (4 * CAPACITY)
+#define NUM_OPS 200000
+
+typedef struct BenchStruct {
+    int key;
+    LRUCacheNode node;
+} BenchStruct;
+
+BenchStruct vars[NUM_KEYS];
+int keys[NUM_OPS];
+int cached_keys[CAPACITY];
+HashTableNode *bucket_array[CAPACITY];
+LRUCache lrucache;
+
+static size_t hash_int(const void *key) {
+    return (size_t) *(const int*) key;
+}
+
+static int equal_int(const void *key, const HashTableNode *node) {
+    return *(const int*) key == lrucache_hash_entry(node, BenchStruct, node)->key;
+}
+
+static const void* key_int(const HashTableNode *node) {
+    return &lrucache_hash_entry(node, BenchStruct, node)->key;
+}
+
+/*
+ * Looks up the keys with @ref lrucache_get, and puts every missing key into the cache, with the @ref policy.
+ * @ref hot_percent percent of the keys are drawn from the hottest fifth of the keys.
+ */
+static void bench_config(LRUCachePolicy policy, int hot_percent) {
+    char variant[64];
+    Benchmark benchmark;
+    ListNode *n;
+    size_t i, j;
+
+    sprintf(variant, "policy=%s hot=%d%%", policy == LRUCACHE_POLICY_LRU ? "lru" : "clock", hot_percent);
+
+    for (i = 0; i < NUM_KEYS; ++i) {
+        vars[i].key = (int) i;
+    }
+
+    for (i = 0; i < NUM_OPS; ++i) {
+        keys[i] = rand() % 100 < hot_percent ? rand() % (NUM_KEYS / 5) : rand() % NUM_KEYS;
+    }
+
+    lrucache_init(&lrucache, bucket_array, CAPACITY, CAPACITY, policy, hash_int, equal_int, key_int, NULL, NULL);
+
+    for (i = 0; i < CAPACITY; ++i) {
+        lrucache_put(&lrucache, &vars[i].key, &vars[i].node);
+    }
+
+    benchmark_begin(&benchmark, "lrucache_get_or_put", variant, CAPACITY);
+    for (i = 0; i < NUM_OPS; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_OPS); ++j) {
+            if (!lrucache_get(&lrucache, &keys[j])) {
+                lrucache_put(&lrucache, &vars[keys[j]].key, &vars[keys[j]].node);
+            }
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    i = 0;
+    list_for_each(n, &lrucache.list) {
+        cached_keys[i++] = list_entry(n, BenchStruct, node.list_node)->key;
+    }
+
+    benchmark_begin(&benchmark, "lrucache_get_hit", variant, CAPACITY);
+    for (i = 0; i < NUM_OPS; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_OPS); ++j) {
+            benchmark_sink += (size_t) lrucache_get(&lrucache, &cached_keys[keys[j] % CAPACITY]);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    const int hot_percents[] = { 50, 80, 95 };
+    size_t i;
+
+    srand(1);
+
+    for (i = 0; i < sizeof(hot_percents) / sizeof(hot_percents[0]); ++i) {
+        bench_config(LRUCACHE_POLICY_LRU, hot_percents[i]);
+        bench_config(LRUCACHE_POLICY_CLOCK, hot_percents[i]);
+    }
+
+    return 0;
+}
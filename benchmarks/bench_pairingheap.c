@@ -0,0 +1,162 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/pairingheap.h"
+#include "../src/rbtree.h"
+
+#define NUM_NODES 100000
+
+typedef struct BenchStruct {
+    int key;
+    PairingHeapNode heap_node;
+    RBTreeNode tree_node;
+} BenchStruct;
+
+BenchStruct vars[NUM_NODES];
+int increments[NUM_NODES];
+PairingHeap pairingheap;
+RBTree rbtree;
+
+static int compare_heap(const PairingHeapNode *a, const PairingHeapNode *b) {
+    int x = pairingheap_entry(a, BenchStruct, heap_node)->key, y = pairingheap_entry(b, BenchStruct, heap_node)->key;
+
+    return (x > y) - (x < y);
+}
+
+/* Equal keys are told apart by address, so the RBTree never sees a collision. */
+static int compare_tree(const void *key, const RBTreeNode *node) {
+    const BenchStruct *a = (const BenchStruct*) key, *b = rbtree_entry(node, BenchStruct, tree_node);
+
+    if (a->key != b->key) {
+        return (a->key > b->key) - (a->key < b->key);
+    }
+
+    return (a > b) - (a < b);
+}
+
+static void reset_keys(void) {
+    size_t i;
+
+    for (i = 0; i < NUM_NODES; ++i) {
+        vars[i].key = rand() % NUM_NODES;
+        increments[i] = 1 + rand() % NUM_NODES;
+    }
+}
+
+/*
+ * Fills a priority queue, keeps it full while repeatedly replacing its top with a later key (the hold model of
+ * an event queue), then drains it. The RBTree variant is the usual way of getting a priority queue out of this
+ * library without a PairingHeap.
+ */
+static void bench_pairingheap(void) {
+    Benchmark benchmark;
+    PairingHeapNode *n;
+    size_t i, j;
+
+    reset_keys();
+    pairingheap_init(&pairingheap, compare_heap);
+
+    benchmark_begin(&benchmark, "priority_queue_push", "pairingheap", NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            pairingheap_push(&pairingheap, &vars[j].heap_node);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "priority_queue_hold", "pairingheap", NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            n = pairingheap_pop(&pairingheap);
+            pairingheap_entry(n, BenchStruct, heap_node)->key += increments[j];
+            pairingheap_push(&pairingheap, n);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "priority_queue_pop", "pairingheap", NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            benchmark_sink += (size_t) pairingheap_pop(&pairingheap);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+}
+
+static void bench_rbtree(void) {
+    Benchmark benchmark;
+    RBTreeNode *n;
+    BenchStruct *var;
+    size_t i, j;
+
+    reset_keys();
+    rbtree_init(&rbtree, compare_tree, NULL, NULL);
+
+    benchmark_begin(&benchmark, "priority_queue_push", "rbtree", NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            rbtree_insert(&rbtree, &vars[j], &vars[j].tree_node);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "priority_queue_hold", "rbtree", NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            n = rbtree_first(&rbtree);
+            rbtree_remove(&rbtree, n);
+            var = rbtree_entry(n, BenchStruct, tree_node);
+            var->key += increments[j];
+            rbtree_insert(&rbtree, var, n);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "priority_queue_pop", "rbtree", NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            n = rbtree_first(&rbtree);
+            rbtree_remove(&rbtree, n);
+            benchmark_sink += (size_t) n;
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    srand(1);
+
+    bench_pairingheap();
+    bench_rbtree();
+
+    return 0;
+}
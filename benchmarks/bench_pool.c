@@ -0,0 +1,145 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/pool.h"
+
+#define NUM_OBJECTS 100000
+#define BATCH_SIZE 32
+
+typedef enum Allocator {
+    ALLOCATOR_MALLOC,
+    ALLOCATOR_POOL,
+    ALLOCATOR_POOLCACHE
+} Allocator;
+
+const char *allocator_names[] = { "malloc", "pool", "poolcache" };
+
+typedef struct BenchStruct {
+    int val;
+    void *links[3];
+} BenchStruct;
+
+BenchStruct memory[NUM_OBJECTS];
+BenchStruct *objects[NUM_OBJECTS];
+size_t order[NUM_OBJECTS];
+Pool pool;
+PoolCache poolcache;
+
+static BenchStruct* bench_alloc(Allocator allocator) {
+    switch (allocator) {
+        case ALLOCATOR_MALLOC:
+            return (BenchStruct*) malloc(sizeof(BenchStruct));
+        case ALLOCATOR_POOL:
+            return (BenchStruct*) pool_alloc(&pool);
+        default:
+            return (BenchStruct*) poolcache_alloc(&poolcache);
+    }
+}
+
+static void bench_free(Allocator allocator, BenchStruct *object) {
+    switch (allocator) {
+        case ALLOCATOR_MALLOC:
+            free(object);
+            break;
+        case ALLOCATOR_POOL:
+            pool_free(&pool, object);
+            break;
+        default:
+            poolcache_free(&poolcache, object);
+            break;
+    }
+}
+
+/*
+ * Allocates NUM_OBJECTS objects, frees them in random order, and then replaces every one of them in random order,
+ * which is the steady state of a container whose nodes come and go.
+ */
+static void bench_allocator(Allocator allocator) {
+    Benchmark benchmark;
+    size_t i, j;
+
+    pool_init(&pool, memory, sizeof(memory), sizeof(BenchStruct));
+    poolcache_init(&poolcache, &pool, BATCH_SIZE);
+
+    benchmark_begin(&benchmark, "pool_alloc", allocator_names[allocator], NUM_OBJECTS);
+    for (i = 0; i < NUM_OBJECTS; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_OBJECTS); ++j) {
+            objects[j] = bench_alloc(allocator);
+            objects[j]->val = (int) j;
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "pool_free", allocator_names[allocator], NUM_OBJECTS);
+    for (i = 0; i < NUM_OBJECTS; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_OBJECTS); ++j) {
+            bench_free(allocator, objects[order[j]]);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    for (i = 0; i < NUM_OBJECTS; ++i) {
+        objects[i] = bench_alloc(allocator);
+    }
+
+    benchmark_begin(&benchmark, "pool_replace", allocator_names[allocator], NUM_OBJECTS);
+    for (i = 0; i < NUM_OBJECTS; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_OBJECTS); ++j) {
+            bench_free(allocator, objects[order[j]]);
+            objects[order[j]] = bench_alloc(allocator);
+            objects[order[j]]->val = (int) j;
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    for (i = 0; i < NUM_OBJECTS; ++i) {
+        benchmark_sink += (size_t) objects[i]->val;
+        bench_free(allocator, objects[i]);
+    }
+}
+
+int main(void) {
+    size_t i, j, tmp;
+
+    srand(1);
+
+    for (i = 0; i < NUM_OBJECTS; ++i) {
+        order[i] = i;
+    }
+
+    for (i = NUM_OBJECTS - 1; i > 0; --i) {
+        j = (size_t) rand() % (i + 1);
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    bench_allocator(ALLOCATOR_MALLOC);
+    bench_allocator(ALLOCATOR_POOL);
+    bench_allocator(ALLOCATOR_POOLCACHE);
+
+    return 0;
+}
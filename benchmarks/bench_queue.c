@@ -0,0 +1,115 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/queue.h"
+
+#define NUM_NODES 100000
+#define NUM_ROUNDS 10
+#define RING_SIZE 1024
+
+typedef struct BenchStruct {
+    int val;
+    QueueNode node;
+} BenchStruct;
+
+BenchStruct vars[NUM_NODES];
+Queue queue;
+SPSCQueue spscqueue;
+QueueNode *node_array[RING_SIZE];
+QueueNode *batch[BENCHMARK_BATCH_SIZE];
+
+/*
+ * Fills and drains the queue NUM_ROUNDS times, which keeps every node in the cache after the first round. Only
+ * the pushes are timed if @ref time_push, and only the pops otherwise.
+ */
+static void bench_rounds(int time_push) {
+    Benchmark benchmark;
+    size_t round, i, j;
+
+    queue_init(&queue);
+    benchmark_begin(&benchmark, time_push ? "queue_push" : "queue_pop", "cached", NUM_NODES);
+
+    for (round = 0; round < NUM_ROUNDS; ++round) {
+        for (i = 0; i < NUM_NODES; i = j) {
+            double start = benchmark_now();
+            for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+                queue_push(&queue, &vars[j].node);
+            }
+            if (time_push) {
+                benchmark_record(&benchmark, benchmark_now() - start, j - i);
+            }
+        }
+
+        for (i = 0; i < NUM_NODES; i = j) {
+            double start = benchmark_now();
+            for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+                benchmark_sink += (size_t) queue_pop(&queue);
+            }
+            if (!time_push) {
+                benchmark_record(&benchmark, benchmark_now() - start, j - i);
+            }
+        }
+    }
+
+    benchmark_end(&benchmark);
+}
+
+/*
+ * Passes every node through an SPSCQueue, pushing and popping one node per call, or a timing batch per call if
+ * @ref use_batch. Producer and consumer share one thread, which measures the cost of the calls themselves.
+ */
+static void bench_spscqueue(int use_batch) {
+    Benchmark benchmark;
+    size_t i, j, k;
+
+    spscqueue_init(&spscqueue, node_array, RING_SIZE);
+    benchmark_begin(&benchmark, "spscqueue_push_pop", use_batch ? "batch" : "single", NUM_NODES);
+
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        j = BENCHMARK_BATCH_END(i, NUM_NODES);
+        if (use_batch) {
+            for (k = i; k < j; ++k) {
+                batch[k - i] = &vars[k].node;
+            }
+            spscqueue_push_batch(&spscqueue, batch, j - i);
+            benchmark_sink += spscqueue_pop_batch(&spscqueue, batch, j - i);
+        } else {
+            for (k = i; k < j; ++k) {
+                spscqueue_push(&spscqueue, &vars[k].node);
+            }
+            for (k = i; k < j; ++k) {
+                benchmark_sink += (size_t) spscqueue_pop(&spscqueue);
+            }
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    bench_rounds(1);
+    bench_rounds(0);
+    bench_spscqueue(0);
+    bench_spscqueue(1);
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/rbtree.h"
+
+#define NUM_NODES 100000
+#define NUM_SPLIT_ROUNDS 100
+
+typedef struct BenchStruct {
+    int key;
+    RBTreeNode node;
+} BenchStruct;
+
+BenchStruct vars[NUM_NODES];
+size_t order[NUM_NODES];
+RBTree rbtree, rbtree2;
+
+static int compare(const void *key, const RBTreeNode *node) {
+    int x = *(const int*) key, y = rbtree_entry(node, BenchStruct, node)->key;
+
+    return (x > y) - (x < y);
+}
+
+static void shuffle(size_t *array, size_t n) {
+    size_t i;
+
+    for (i = n - 1; i > 0; --i) {
+        size_t j = (size_t) rand() % (i + 1), tmp = array[i];
+        array[i] = array[j];
+        array[j] = tmp;
+    }
+}
+
+/*
+ * Inserts, looks up and removes all nodes, visiting them in ascending key order if @ref input is "sorted" and
+ * in random order otherwise.
+ */
+static void bench_input(const char *input) {
+    Benchmark benchmark;
+    size_t i, j;
+    int missing_key;
+
+    for (i = 0; i < NUM_NODES; ++i) {
+        vars[i].key = (int) (2 * i);
+        order[i] = i;
+    }
+
+    if (strcmp(input, "sorted") != 0) {
+        shuffle(order, NUM_NODES);
+    }
+
+    rbtree_init(&rbtree, compare, NULL, NULL);
+
+    benchmark_begin(&benchmark, "rbtree_insert", input, NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            BenchStruct *var = &vars[order[j]];
+            rbtree_insert(&rbtree, &var->key, &var->node);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "rbtree_lookup_key", input, NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            benchmark_sink += (size_t) rbtree_lookup_key(&rbtree, &vars[order[j]].key);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "rbtree_lookup_key_miss", input, NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            missing_key = vars[order[j]].key + 1;
+            benchmark_sink += (size_t) rbtree_lookup_key(&rbtree, &missing_key);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "rbtree_remove", input, NUM_NODES);
+    for (i = 0; i < NUM_NODES; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+            rbtree_remove(&rbtree, &vars[order[j]].node);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+}
+
+/*
+ * Splits the tree of all nodes at a random key and joins the halves again, compared with moving the lower half
+ * into another tree one node at a time.
+ */
+static void bench_split_join(void) {
+    Benchmark benchmark;
+    RBTreeNode *n;
+    size_t i;
+    int key;
+    double start;
+
+    rbtree_init(&rbtree, compare, NULL, NULL);
+    rbtree_init(&rbtree2, compare, NULL, NULL);
+
+    for (i = 0; i < NUM_NODES; ++i) {
+        vars[i].key = (int) i;
+        rbtree_insert(&rbtree, &vars[i].key, &vars[i].node);
+    }
+
+    benchmark_begin(&benchmark, "rbtree_split", "random key", NUM_NODES);
+    for (i = 0; i < NUM_SPLIT_ROUNDS; ++i) {
+        key = rand() % NUM_NODES;
+
+        start = benchmark_now();
+        rbtree_split(&rbtree, &key, &rbtree2, &rbtree);
+        benchmark_record(&benchmark, benchmark_now() - start, 1);
+
+        rbtree_join(&rbtree2, &rbtree);
+        rbtree_join(&rbtree, &rbtree2);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "rbtree_join", "random key", NUM_NODES);
+    for (i = 0; i < NUM_SPLIT_ROUNDS; ++i) {
+        key = rand() % NUM_NODES;
+        rbtree_split(&rbtree, &key, &rbtree2, &rbtree);
+
+        start = benchmark_now();
+        rbtree_join(&rbtree2, &rbtree);
+        benchmark_record(&benchmark, benchmark_now() - start, 1);
+
+        rbtree_join(&rbtree, &rbtree2);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "rbtree_remove+insert split", "random key", NUM_NODES);
+    for (i = 0; i < NUM_SPLIT_ROUNDS / 10; ++i) {
+        key = rand() % NUM_NODES;
+
+        start = benchmark_now();
+        while ((n = rbtree_first(&rbtree)) && rbtree_entry(n, BenchStruct, node)->key < key) {
+            rbtree_remove(&rbtree, n);
+            rbtree_insert(&rbtree2, &rbtree_entry(n, BenchStruct, node)->key, n);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, 1);
+
+        rbtree_join(&rbtree2, &rbtree);
+        rbtree_join(&rbtree, &rbtree2);
+    }
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    srand(1);
+
+    bench_input("random");
+    bench_input("sorted");
+    bench_split_join();
+
+    return 0;
+}
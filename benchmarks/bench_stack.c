@@ -0,0 +1,75 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/stack.h"
+
+#define NUM_NODES 100000
+#define NUM_ROUNDS 10
+
+typedef struct BenchStruct {
+    int val;
+    StackNode node;
+} BenchStruct;
+
+BenchStruct vars[NUM_NODES];
+Stack stack;
+
+/*
+ * Fills and drains the stack NUM_ROUNDS times, which keeps every node in the cache after the first round. Only
+ * the pushes are timed if @ref time_push, and only the pops otherwise.
+ */
+static void bench_rounds(int time_push) {
+    Benchmark benchmark;
+    size_t round, i, j;
+
+    stack_init(&stack);
+    benchmark_begin(&benchmark, time_push ? "stack_push" : "stack_pop", "cached", NUM_NODES);
+
+    for (round = 0; round < NUM_ROUNDS; ++round) {
+        for (i = 0; i < NUM_NODES; i = j) {
+            double start = benchmark_now();
+            for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+                stack_push(&stack, &vars[j].node);
+            }
+            if (time_push) {
+                benchmark_record(&benchmark, benchmark_now() - start, j - i);
+            }
+        }
+
+        for (i = 0; i < NUM_NODES; i = j) {
+            double start = benchmark_now();
+            for (j = i; j < BENCHMARK_BATCH_END(i, NUM_NODES); ++j) {
+                benchmark_sink += (size_t) stack_pop(&stack);
+            }
+            if (!time_push) {
+                benchmark_record(&benchmark, benchmark_now() - start, j - i);
+            }
+        }
+    }
+
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    bench_rounds(1);
+    bench_rounds(0);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "benchmark_framework.h"
+
+#include "../src/timerwheel.h"
+#include "../src/pairingheap.h"
+
+#define NUM_TIMERS 100000
+#define MAX_TIMEOUT 30000
+
+typedef struct BenchStruct {
+    unsigned long expiry;
+    TimerWheelNode wheel_node;
+    PairingHeapNode heap_node;
+} BenchStruct;
+
+BenchStruct vars[NUM_TIMERS];
+unsigned long timeouts[NUM_TIMERS];
+TimerWheel timerwheel;
+PairingHeap pairingheap;
+
+static int compare(const PairingHeapNode *a, const PairingHeapNode *b) {
+    unsigned long x = pairingheap_entry(a, BenchStruct, heap_node)->expiry;
+    unsigned long y = pairingheap_entry(b, BenchStruct, heap_node)->expiry;
+
+    return (x > y) - (x < y);
+}
+
+static void expire(TimerWheelNode *node, void *auxiliary_data) {
+    (void) auxiliary_data;
+
+    benchmark_sink += (size_t) node;
+}
+
+/*
+ * Keeps NUM_TIMERS timeouts pending and re-arms one of them per operation, which cancels it before it fires as
+ * most timeouts are, then lets all of them fire. The PairingHeap variant keeps the timeouts in a priority
+ * queue instead.
+ */
+static void bench_timers(void) {
+    Benchmark benchmark;
+    PairingHeapNode *n;
+    unsigned long now;
+    size_t i, j;
+
+    for (i = 0; i < NUM_TIMERS; ++i) {
+        timeouts[i] = 1 + (unsigned long) rand() % MAX_TIMEOUT;
+    }
+
+    timerwheel_init(&timerwheel, 0);
+    pairingheap_init(&pairingheap, compare);
+
+    for (i = 0; i < NUM_TIMERS; ++i) {
+        timerwheel_schedule(&timerwheel, &vars[i].wheel_node, timeouts[i]);
+        vars[i].expiry = timeouts[i];
+        pairingheap_push(&pairingheap, &vars[i].heap_node);
+    }
+
+    benchmark_begin(&benchmark, "timer_rearm", "timerwheel", NUM_TIMERS);
+    for (i = 0; i < NUM_TIMERS; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_TIMERS); ++j) {
+            timerwheel_cancel(&timerwheel, &vars[j].wheel_node);
+            timerwheel_schedule(&timerwheel, &vars[j].wheel_node, timeouts[NUM_TIMERS - 1 - j]);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "timer_rearm", "pairingheap", NUM_TIMERS);
+    for (i = 0; i < NUM_TIMERS; i = j) {
+        double start = benchmark_now();
+        for (j = i; j < BENCHMARK_BATCH_END(i, NUM_TIMERS); ++j) {
+            pairingheap_remove(&pairingheap, &vars[j].heap_node);
+            vars[j].expiry = timeouts[NUM_TIMERS - 1 - j];
+            pairingheap_push(&pairingheap, &vars[j].heap_node);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - i);
+    }
+    benchmark_end(&benchmark);
+
+    /* Every operation is one tick, firing whatever is due. */
+    benchmark_begin(&benchmark, "timer_expire", "timerwheel", NUM_TIMERS);
+    for (now = 1; now <= MAX_TIMEOUT; now = j) {
+        double start = benchmark_now();
+        for (j = now; j < BENCHMARK_BATCH_END(now, MAX_TIMEOUT + 1); ++j) {
+            timerwheel_advance(&timerwheel, j, expire, NULL);
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - now);
+    }
+    benchmark_end(&benchmark);
+
+    benchmark_begin(&benchmark, "timer_expire", "pairingheap", NUM_TIMERS);
+    for (now = 1; now <= MAX_TIMEOUT; now = j) {
+        double start = benchmark_now();
+        for (j = now; j < BENCHMARK_BATCH_END(now, MAX_TIMEOUT + 1); ++j) {
+            while ((n = pairingheap_peek(&pairingheap)) && pairingheap_entry(n, BenchStruct, heap_node)->expiry <= j) {
+                benchmark_sink += (size_t) pairingheap_pop(&pairingheap);
+            }
+        }
+        benchmark_record(&benchmark, benchmark_now() - start, j - now);
+    }
+    benchmark_end(&benchmark);
+}
+
+int main(void) {
+    srand(1);
+
+    bench_timers();
+
+    return 0;
+}
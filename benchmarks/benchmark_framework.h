@@ -0,0 +1,205 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+ * @file    benchmark_framework.h
+ *
+ * Tools for benchmarking the data structures and algorithms. Operations are timed in batches of
+ * BENCHMARK_BATCH_SIZE, and every batch contributes one sample (its mean time per operation) to the latency
+ * percentiles. Every finished benchmark is printed as one CSV row with the columns (the header is printed by
+ * the "bench" target of the Makefile):
+ *
+ *      benchmark,variant,n,ops,ops_per_sec,p50_ns,p90_ns,p99_ns,max_ns
+ */
+
+#ifndef BENCHMARK_FRAMEWORK_H__
+#define BENCHMARK_FRAMEWORK_H__
+
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 199309L
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * The number of operations timed together as one sample.
+ */
+#ifndef BENCHMARK_BATCH_SIZE
+    #define BENCHMARK_BATCH_SIZE 32
+#endif
+
+/**
+ * The most samples a single benchmark keeps. Later samples still count towards the throughput.
+ */
+#ifndef BENCHMARK_MAX_SAMPLES
+    #define BENCHMARK_MAX_SAMPLES 65536
+#endif
+
+/**
+ * Returns the end of the batch starting at @ref i, where the operations are numbered 0 to @ref n - 1.
+ */
+#define BENCHMARK_BATCH_END(i, n) ((n) - (i) < BENCHMARK_BATCH_SIZE ? (n) : (i) + BENCHMARK_BATCH_SIZE)
+
+/* ========================================================================================================
+ *
+ *                                                  TYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * Represents a benchmark that is being measured.
+ */
+typedef struct Benchmark {
+    const char *name;
+    const char *variant;
+    size_t n;
+    size_t ops;
+    double total_ns;
+    size_t num_samples;
+} Benchmark;
+
+/* ========================================================================================================
+ *
+ *                                               PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * Returns the current time of a monotonic clock in nanoseconds.
+ */
+static double benchmark_now(void);
+
+/**
+ * Starts measuring the @ref benchmark.
+ *
+ * @param benchmark             The @ref Benchmark to start.
+ * @param name                  The name of the measured operation, e.g. "hashtable_insert".
+ * @param variant               The input or configuration the operation is measured with.
+ * @param n                     The number of elements the operation works on.
+ */
+static void benchmark_begin(Benchmark *benchmark, const char *name, const char *variant, size_t n);
+
+/**
+ * Adds a sample of @ref num_ops operations that took @ref elapsed_ns nanoseconds in total to the
+ * @ref benchmark.
+ *
+ * @param benchmark             The @ref Benchmark being measured.
+ * @param elapsed_ns            The time the operations took.
+ * @param num_ops               The number of operations.
+ */
+static void benchmark_record(Benchmark *benchmark, double elapsed_ns, size_t num_ops);
+
+/**
+ * Stops measuring the @ref benchmark and prints its CSV row.
+ *
+ * @param benchmark             The @ref Benchmark to stop.
+ */
+static void benchmark_end(Benchmark *benchmark);
+
+/* ========================================================================================================
+ *
+ *                                          FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static double benchmark_samples[BENCHMARK_MAX_SAMPLES];
+
+/* Results that are written here cannot be optimized away. */
+static volatile size_t benchmark_sink;
+
+static int compare_samples(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+
+    return (x > y) - (x < y);
+}
+
+static double percentile(size_t num_samples, double p) {
+    size_t i;
+
+    if (num_samples == 0) {
+        return 0.0;
+    }
+
+    i = (size_t) (p * (double) (num_samples - 1) + 0.5);
+
+    return benchmark_samples[i];
+}
+
+static double benchmark_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static void benchmark_begin(Benchmark *benchmark, const char *name, const char *variant, size_t n) {
+    benchmark->name = name;
+    benchmark->variant = variant;
+    benchmark->n = n;
+    benchmark->ops = 0;
+    benchmark->total_ns = 0.0;
+    benchmark->num_samples = 0;
+}
+
+static void benchmark_record(Benchmark *benchmark, double elapsed_ns, size_t num_ops) {
+    if (num_ops == 0) {
+        return;
+    }
+
+    benchmark->ops += num_ops;
+    benchmark->total_ns += elapsed_ns;
+
+    if (benchmark->num_samples < BENCHMARK_MAX_SAMPLES) {
+        benchmark_samples[benchmark->num_samples++] = elapsed_ns / (double) num_ops;
+    }
+}
+
+static void benchmark_end(Benchmark *benchmark) {
+    size_t num_samples = benchmark->num_samples;
+
+    qsort(benchmark_samples, num_samples, sizeof(double), compare_samples);
+
+    printf(
+        "%s,%s,%lu,%lu,%.0f,%.1f,%.1f,%.1f,%.1f\n",
+        benchmark->name,
+        benchmark->variant,
+        (unsigned long) benchmark->n,
+        (unsigned long) benchmark->ops,
+        benchmark->total_ns > 0.0 ? (double) benchmark->ops * 1e9 / benchmark->total_ns : 0.0,
+        percentile(num_samples, 0.50),
+        percentile(num_samples, 0.90),
+        percentile(num_samples, 0.99),
+        num_samples > 0 ? benchmark_samples[num_samples - 1] : 0.0
+    );
+    fflush(stdout);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BENCHMARK_FRAMEWORK_H__ */
@@ -0,0 +1,827 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "btree.h"
+
+/* The minimum number of slots of every BTreePage but the root. */
+#define MIN_SLOTS (BTREE_PAGE_SIZE / 2)
+
+/* Fails to compile if BTREE_PAGE_SIZE is too small for splits and merges to keep every BTreePage half full. */
+typedef char btree_page_size_check[BTREE_PAGE_SIZE >= 4 ? 1 : -1];
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/*
+ * Takes a @ref BTreePage off the free list of the @ref btree and returns it, emptied.
+ */
+static BTreePage* alloc_page(BTree *btree, int leaf);
+
+/*
+ * Unlinks the @ref page from its neighbors and puts it back on the free list of the @ref btree.
+ */
+static void free_page(BTree *btree, BTreePage *page);
+
+/*
+ * Returns the prefix of the @ref key, or 0 if the @ref btree has no key prefix function.
+ */
+static unsigned long prefix_of(const BTree *btree, const void *key);
+
+/*
+ * Compares the @ref key, whose prefix is @ref prefix, with the key of slot @ref index of the @ref page. The
+ * compare function is only called if the prefixes are equal.
+ */
+static int compare_slot(const BTree *btree, const void *key, unsigned long prefix, const BTreePage *page, size_t index);
+
+/*
+ * Returns the number of @ref BTreeNode's in the subtree rooted at the @ref page.
+ */
+static size_t subtree_size(const BTreePage *page);
+
+/*
+ * Adds @ref delta to the count of every slot pointing to the @ref page or one of its ancestors.
+ */
+static void add_to_counts(BTreePage *page, size_t delta);
+
+/*
+ * Points slot @ref index of the @ref page at the @ref node with the @ref prefix and, unless the @ref page is a
+ * leaf, the @ref child, which must be complete so that its count is known.
+ */
+static void set_slot(BTreePage *page, size_t index, BTreeNode *node, unsigned long prefix, BTreePage *child);
+
+/*
+ * Copies slot @ref src_index of the @ref src page to slot @ref dst_index of the @ref dst page.
+ */
+static void move_slot(BTreePage *dst, size_t dst_index, BTreePage *src, size_t src_index);
+
+/*
+ * Inserts the @ref node (and the @ref child) at slot @ref index of the @ref page, which must NOT be full.
+ */
+static void place_slot(BTreePage *page, size_t index, BTreeNode *node, unsigned long prefix, BTreePage *child);
+
+/*
+ * Removes slot @ref index of the @ref page.
+ */
+static void erase_slot(BTreePage *page, size_t index);
+
+/*
+ * Returns the index of the slot of the parent of the @ref page pointing to the @ref page.
+ */
+static size_t child_index(const BTreePage *page);
+
+/*
+ * Refreshes the first-node slots pointing to the @ref page and its ancestors after slot 0 of the @ref page
+ * changed.
+ */
+static void update_min(BTreePage *page);
+
+/*
+ * Returns the leaf of the @ref btree that the @ref key, whose prefix is @ref prefix, belongs in. The @ref btree
+ * must NOT be empty.
+ */
+static BTreePage* find_leaf(const BTree *btree, const void *key, unsigned long prefix);
+
+/*
+ * Returns the index of the first slot of the @ref leaf whose key is NOT less than the @ref key, whose prefix is
+ * @ref prefix (or the number of slots if there is none), and stores whether that key equals the @ref key in
+ * @ref found.
+ */
+static size_t leaf_lower_bound(
+    const BTree *btree,
+    const BTreePage *leaf,
+    const void *key,
+    unsigned long prefix,
+    int *found
+);
+
+/*
+ * Returns the first @ref BTreeNode at or after slot @ref index of the @ref leaf.
+ */
+static BTreeNode* node_at_or_after(const BTreePage *leaf, size_t index);
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static BTreePage* alloc_page(BTree *btree, int leaf) {
+    BTreePage *page;
+
+    assert(btree);
+    assert(btree->free_pages);
+
+    page = btree->free_pages;
+    btree->free_pages = page->next;
+    --btree->num_free_pages;
+
+    page->parent = NULL;
+    page->prev = NULL;
+    page->next = NULL;
+    page->num_slots = 0;
+    page->leaf = leaf;
+
+    return page;
+}
+
+static void free_page(BTree *btree, BTreePage *page) {
+    assert(btree && page);
+
+    if (page->prev) {
+        page->prev->next = page->next;
+    }
+
+    if (page->next) {
+        page->next->prev = page->prev;
+    }
+
+    page->parent = NULL;
+    page->prev = NULL;
+    page->next = btree->free_pages;
+    page->num_slots = 0;
+    btree->free_pages = page;
+    ++btree->num_free_pages;
+}
+
+static unsigned long prefix_of(const BTree *btree, const void *key) {
+    assert(btree);
+
+    return btree->key_prefix ? btree->key_prefix(key) : 0;
+}
+
+static int compare_slot(const BTree *btree, const void *key, unsigned long prefix, const BTreePage *page, size_t index) {
+    assert(btree && page && index < page->num_slots);
+
+    if (btree->key_prefix && prefix != page->prefixes[index]) {
+        return prefix < page->prefixes[index] ? -1 : 1;
+    }
+
+    return btree->compare(key, page->slots[index]);
+}
+
+static size_t subtree_size(const BTreePage *page) {
+    size_t size = 0, i;
+
+    assert(page);
+
+    if (page->leaf) {
+        return page->num_slots;
+    }
+
+    for (i = 0; i < page->num_slots; ++i) {
+        size += page->counts[i];
+    }
+
+    return size;
+}
+
+static void add_to_counts(BTreePage *page, size_t delta) {
+    assert(page);
+
+    for ( ; page->parent; page = page->parent) {
+        page->parent->counts[child_index(page)] += delta;
+    }
+}
+
+static void set_slot(BTreePage *page, size_t index, BTreeNode *node, unsigned long prefix, BTreePage *child) {
+    assert(page && node);
+
+    page->slots[index] = node;
+    page->prefixes[index] = prefix;
+
+    if (page->leaf) {
+        node->page = page;
+        node->index = index;
+    } else {
+        assert(child);
+
+        page->children[index] = child;
+        page->counts[index] = subtree_size(child);
+        child->parent = page;
+    }
+}
+
+static void move_slot(BTreePage *dst, size_t dst_index, BTreePage *src, size_t src_index) {
+    assert(dst && src && dst->leaf == src->leaf);
+
+    dst->slots[dst_index] = src->slots[src_index];
+    dst->prefixes[dst_index] = src->prefixes[src_index];
+
+    if (dst->leaf) {
+        dst->slots[dst_index]->page = dst;
+        dst->slots[dst_index]->index = dst_index;
+    } else {
+        dst->children[dst_index] = src->children[src_index];
+        dst->counts[dst_index] = src->counts[src_index];
+        dst->children[dst_index]->parent = dst;
+    }
+}
+
+static void place_slot(BTreePage *page, size_t index, BTreeNode *node, unsigned long prefix, BTreePage *child) {
+    size_t i;
+
+    assert(page && page->num_slots < BTREE_PAGE_SIZE && index <= page->num_slots);
+
+    for (i = page->num_slots; i > index; --i) {
+        move_slot(page, i, page, i - 1);
+    }
+
+    set_slot(page, index, node, prefix, child);
+    ++page->num_slots;
+}
+
+static void erase_slot(BTreePage *page, size_t index) {
+    size_t i;
+
+    assert(page && index < page->num_slots);
+
+    for (i = index + 1; i < page->num_slots; ++i) {
+        move_slot(page, i - 1, page, i);
+    }
+
+    --page->num_slots;
+}
+
+static size_t child_index(const BTreePage *page) {
+    const BTreePage *parent;
+    size_t i;
+
+    assert(page && page->parent);
+
+    parent = page->parent;
+
+    for (i = 0; parent->children[i] != page; ++i) {
+        assert(i + 1 < parent->num_slots);
+    }
+
+    return i;
+}
+
+static void update_min(BTreePage *page) {
+    assert(page && page->num_slots > 0);
+
+    while (page->parent) {
+        size_t i = child_index(page);
+
+        page->parent->slots[i] = page->slots[0];
+        page->parent->prefixes[i] = page->prefixes[0];
+
+        if (i != 0) {
+            break;
+        }
+
+        page = page->parent;
+    }
+}
+
+static BTreePage* find_leaf(const BTree *btree, const void *key, unsigned long prefix) {
+    BTreePage *page;
+
+    assert(btree && btree->root);
+
+    page = btree->root;
+
+    while (!page->leaf) {
+        /* Slot 0 is never compared against, since every key less than slot 1 belongs in child 0. */
+        size_t low = 1, high = page->num_slots;
+
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+
+            if (compare_slot(btree, key, prefix, page, mid) < 0) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+
+        page = page->children[low - 1];
+    }
+
+    return page;
+}
+
+static size_t leaf_lower_bound(
+    const BTree *btree,
+    const BTreePage *leaf,
+    const void *key,
+    unsigned long prefix,
+    int *found
+) {
+    size_t low = 0, high;
+
+    assert(btree && leaf && leaf->leaf && found);
+
+    high = leaf->num_slots;
+    *found = 0;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int result = compare_slot(btree, key, prefix, leaf, mid);
+
+        if (result > 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+            *found = result == 0;
+        }
+    }
+
+    return low;
+}
+
+static BTreeNode* node_at_or_after(const BTreePage *leaf, size_t index) {
+    assert(leaf && leaf->leaf);
+
+    if (index < leaf->num_slots) {
+        return leaf->slots[index];
+    }
+
+    return leaf->next ? leaf->next->slots[0] : NULL;
+}
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+void btree_init(
+    BTree *btree,
+    BTreePage *page_array,
+    size_t num_pages,
+    int (*compare)(const void *key, const BTreeNode *node),
+    void (*collide)(const BTreeNode *old_node, const BTreeNode *new_node, void *auxiliary_data),
+    void *auxiliary_data
+) {
+    assert(btree && (page_array || num_pages == 0) && compare);
+
+    btree->compare = compare;
+    btree->key_prefix = NULL;
+    btree->collide = collide;
+    btree->auxiliary_data = auxiliary_data;
+    btree->page_array = page_array;
+    btree->num_pages = num_pages;
+
+    btree_remove_all(btree);
+}
+
+void btree_set_key_prefix(BTree *btree, unsigned long (*key_prefix)(const void *key)) {
+    assert(btree && btree->size == 0);
+
+    btree->key_prefix = key_prefix;
+}
+
+BTreeNode* btree_first(const BTree *btree) {
+    BTreePage *page;
+
+    assert(btree);
+
+    if (!btree->root) {
+        return NULL;
+    }
+
+    page = btree->root;
+
+    while (!page->leaf) {
+        page = page->children[0];
+    }
+
+    return page->slots[0];
+}
+
+BTreeNode* btree_last(const BTree *btree) {
+    BTreePage *page;
+
+    assert(btree);
+
+    if (!btree->root) {
+        return NULL;
+    }
+
+    page = btree->root;
+
+    while (!page->leaf) {
+        page = page->children[page->num_slots - 1];
+    }
+
+    return page->slots[page->num_slots - 1];
+}
+
+BTreeNode* btree_prev(const BTreeNode *node) {
+    BTreePage *page;
+
+    if (!node) {
+        return NULL;
+    }
+
+    page = node->page;
+
+    if (node->index > 0) {
+        return page->slots[node->index - 1];
+    }
+
+    return page->prev ? page->prev->slots[page->prev->num_slots - 1] : NULL;
+}
+
+BTreeNode* btree_next(const BTreeNode *node) {
+    if (!node) {
+        return NULL;
+    }
+
+    return node_at_or_after(node->page, node->index + 1);
+}
+
+size_t btree_size(const BTree *btree) {
+    assert(btree);
+
+    return btree->size;
+}
+
+int btree_empty(const BTree *btree) {
+    assert(btree);
+
+    return btree->size == 0;
+}
+
+int btree_contains_key(const BTree *btree, const void *key) {
+    assert(btree);
+
+    return btree_lookup_key(btree, key) != NULL;
+}
+
+size_t btree_num_free_pages(const BTree *btree) {
+    assert(btree);
+
+    return btree->num_free_pages;
+}
+
+size_t btree_index_of(const BTree *btree, const BTreeNode *node) {
+    const BTreePage *page;
+    size_t index;
+
+    assert(btree && node);
+    (void) btree;
+
+    index = node->index;
+
+    /* Add up the BTreeNode's below the children left of the path at every level. */
+    for (page = node->page; page->parent; page = page->parent) {
+        size_t i, end = child_index(page);
+
+        for (i = 0; i < end; ++i) {
+            index += page->parent->counts[i];
+        }
+    }
+
+    return index;
+}
+
+BTreeNode* btree_at(const BTree *btree, size_t index) {
+    const BTreePage *page;
+
+    assert(btree && index < btree->size);
+
+    page = btree->root;
+
+    while (!page->leaf) {
+        size_t i = 0;
+
+        while (index >= page->counts[i]) {
+            index -= page->counts[i];
+            ++i;
+            assert(i < page->num_slots);
+        }
+
+        page = page->children[i];
+    }
+
+    return page->slots[index];
+}
+
+void btree_insert(BTree *btree, const void *key, BTreeNode *node) {
+    BTreePage *page, *child = NULL;
+    unsigned long prefix;
+    size_t index;
+    int found;
+
+    assert(btree && node);
+
+    prefix = prefix_of(btree, key);
+
+    if (!btree->root) {
+        btree->root = alloc_page(btree, 1);
+        place_slot(btree->root, 0, node, prefix, NULL);
+        btree->size = 1;
+        return;
+    }
+
+    page = find_leaf(btree, key, prefix);
+    index = leaf_lower_bound(btree, page, key, prefix, &found);
+
+    if (found) {
+        BTreeNode *old_node = page->slots[index];
+
+        set_slot(page, index, node, prefix, NULL);
+
+        if (index == 0) {
+            update_min(page);
+        }
+
+        if (btree->collide) {
+            btree->collide(old_node, node, btree->auxiliary_data);
+        }
+
+        return;
+    }
+
+    ++btree->size;
+
+    /* Every count on the path is correct from here on, but those of the BTreePage's that are split. */
+    add_to_counts(page, 1);
+
+    /* Each full BTreePage is split in two, which inserts the new half into its parent in turn. */
+    for (;;) {
+        BTreePage *right;
+        size_t i;
+
+        if (page->num_slots < BTREE_PAGE_SIZE) {
+            place_slot(page, index, node, prefix, child);
+
+            if (index == 0) {
+                update_min(page);
+            }
+
+            return;
+        }
+
+        right = alloc_page(btree, page->leaf);
+
+        for (i = MIN_SLOTS; i < BTREE_PAGE_SIZE; ++i) {
+            move_slot(right, i - MIN_SLOTS, page, i);
+        }
+
+        right->num_slots = BTREE_PAGE_SIZE - MIN_SLOTS;
+        page->num_slots = MIN_SLOTS;
+
+        right->prev = page;
+        right->next = page->next;
+
+        if (page->next) {
+            page->next->prev = right;
+        }
+
+        page->next = right;
+
+        if (index <= MIN_SLOTS) {
+            place_slot(page, index, node, prefix, child);
+        } else {
+            place_slot(right, index - MIN_SLOTS, node, prefix, child);
+        }
+
+        if (!page->parent) {
+            BTreePage *root = alloc_page(btree, 0);
+
+            place_slot(root, 0, page->slots[0], page->prefixes[0], page);
+            place_slot(root, 1, right->slots[0], right->prefixes[0], right);
+            btree->root = root;
+            return;
+        }
+
+        if (index == 0) {
+            update_min(page);
+        }
+
+        index = child_index(page) + 1;
+        page->parent->counts[index - 1] = subtree_size(page);
+        node = right->slots[0];
+        prefix = right->prefixes[0];
+        child = right;
+        page = page->parent;
+    }
+}
+
+BTreeNode* btree_lookup_key(const BTree *btree, const void *key) {
+    BTreePage *leaf;
+    unsigned long prefix;
+    size_t index;
+    int found;
+
+    assert(btree);
+
+    if (!btree->root) {
+        return NULL;
+    }
+
+    prefix = prefix_of(btree, key);
+    leaf = find_leaf(btree, key, prefix);
+    index = leaf_lower_bound(btree, leaf, key, prefix, &found);
+
+    return found ? leaf->slots[index] : NULL;
+}
+
+BTreeNode* btree_lower_bound(const BTree *btree, const void *key) {
+    BTreePage *leaf;
+    unsigned long prefix;
+    int found;
+
+    assert(btree);
+
+    if (!btree->root) {
+        return NULL;
+    }
+
+    prefix = prefix_of(btree, key);
+    leaf = find_leaf(btree, key, prefix);
+
+    return node_at_or_after(leaf, leaf_lower_bound(btree, leaf, key, prefix, &found));
+}
+
+BTreeNode* btree_upper_bound(const BTree *btree, const void *key) {
+    BTreePage *leaf;
+    unsigned long prefix;
+    size_t index;
+    int found;
+
+    assert(btree);
+
+    if (!btree->root) {
+        return NULL;
+    }
+
+    prefix = prefix_of(btree, key);
+    leaf = find_leaf(btree, key, prefix);
+    index = leaf_lower_bound(btree, leaf, key, prefix, &found);
+
+    return node_at_or_after(leaf, found ? index + 1 : index);
+}
+
+void btree_remove(BTree *btree, BTreeNode *node) {
+    BTreePage *page;
+    size_t index;
+
+    assert(btree);
+
+    if (!node) {
+        return;
+    }
+
+    page = node->page;
+    index = node->index;
+    assert(page->slots[index] == node);
+
+    node->page = BTREE_POISON_PAGE;
+    --btree->size;
+
+    /* Every count on the path is correct from here on, and borrowing or merging moves counts along. */
+    add_to_counts(page, (size_t) -1);
+
+    /* Each underfull BTreePage borrows from or merges with a sibling, which may leave its parent underfull. */
+    for (;;) {
+        BTreePage *parent, *sibling;
+        size_t i, moved;
+
+        erase_slot(page, index);
+
+        if (page == btree->root) {
+            if (page->num_slots == 0) {
+                btree->root = NULL;
+                free_page(btree, page);
+            } else if (!page->leaf && page->num_slots == 1) {
+                btree->root = page->children[0];
+                btree->root->parent = NULL;
+                free_page(btree, page);
+            }
+
+            return;
+        }
+
+        if (index == 0) {
+            update_min(page);
+        }
+
+        if (page->num_slots >= MIN_SLOTS) {
+            return;
+        }
+
+        parent = page->parent;
+        i = child_index(page);
+
+        if (i > 0 && parent->children[i - 1]->num_slots > MIN_SLOTS) {
+            sibling = parent->children[i - 1];
+            place_slot(
+                page,
+                0,
+                sibling->slots[sibling->num_slots - 1],
+                sibling->prefixes[sibling->num_slots - 1],
+                page->leaf ? NULL : sibling->children[sibling->num_slots - 1]
+            );
+            --sibling->num_slots;
+
+            moved = page->leaf ? 1 : page->counts[0];
+            parent->counts[i - 1] -= moved;
+            parent->counts[i] += moved;
+            parent->slots[i] = page->slots[0];
+            parent->prefixes[i] = page->prefixes[0];
+            return;
+        }
+
+        if (i + 1 < parent->num_slots && parent->children[i + 1]->num_slots > MIN_SLOTS) {
+            sibling = parent->children[i + 1];
+            place_slot(
+                page,
+                page->num_slots,
+                sibling->slots[0],
+                sibling->prefixes[0],
+                page->leaf ? NULL : sibling->children[0]
+            );
+            erase_slot(sibling, 0);
+
+            moved = page->leaf ? 1 : page->counts[page->num_slots - 1];
+            parent->counts[i] += moved;
+            parent->counts[i + 1] -= moved;
+            parent->slots[i + 1] = sibling->slots[0];
+            parent->prefixes[i + 1] = sibling->prefixes[0];
+            return;
+        }
+
+        /* Neither sibling can spare a slot, so the right one of the pair is merged into the left one. */
+        if (i > 0) {
+            sibling = parent->children[i - 1];
+        } else {
+            sibling = page;
+            page = parent->children[++i];
+        }
+
+        for (index = 0; index < page->num_slots; ++index) {
+            move_slot(sibling, sibling->num_slots + index, page, index);
+        }
+
+        sibling->num_slots += page->num_slots;
+        parent->counts[i - 1] += parent->counts[i];
+        free_page(btree, page);
+
+        page = parent;
+        index = i;
+    }
+}
+
+void btree_remove_key(BTree *btree, const void *key) {
+    assert(btree);
+
+    btree_remove(btree, btree_lookup_key(btree, key));
+}
+
+void btree_remove_first(BTree *btree) {
+    assert(btree);
+
+    btree_remove(btree, btree_first(btree));
+}
+
+void btree_remove_last(BTree *btree) {
+    assert(btree);
+
+    btree_remove(btree, btree_last(btree));
+}
+
+void btree_remove_all(BTree *btree) {
+    size_t i;
+
+    assert(btree);
+
+    btree->root = NULL;
+    btree->free_pages = NULL;
+    btree->num_free_pages = btree->num_pages;
+    btree->size = 0;
+
+    for (i = btree->num_pages; i > 0; --i) {
+        BTreePage *page = btree->page_array + i - 1;
+
+        page->parent = NULL;
+        page->prev = NULL;
+        page->next = btree->free_pages;
+        page->num_slots = 0;
+        btree->free_pages = page;
+    }
+}
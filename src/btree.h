@@ -0,0 +1,676 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+ * @file    btree.h
+ * @brief   B+TREE
+ *
+ * Embed one or more @ref BTreeNode's into your struct to make it a potential node in one or more B+trees. The
+ * @ref BTree structure keeps track of a tree of @ref BTreePage's, each of which holds up to BTREE_PAGE_SIZE
+ * pointers to @ref BTreeNode's (or, above the lowest level, to @ref BTreePage's) in one contiguous array. A
+ * @ref BTree MUST be initialized before it is used. A @ref BTreeNode does NOT need to be initialized before it
+ * is used. A @ref BTreeNode should belong to at most ONE @ref BTree.
+ *
+ * A @ref BTree is an alternative to a @ref RBTree with the same semantics: the user is required to define a
+ * compare function which compares a key with the key of a @ref BTreeNode, and when a @ref BTreeNode is
+ * inserted with a non-unique (an already existing) key, the old @ref BTreeNode will be discarded and the new
+ * @ref BTreeNode will take its place. The OPTIONAL collide function is called after the old @ref BTreeNode is
+ * replaced, with the old @ref BTreeNode, the new @ref BTreeNode, and the auxiliary data that was stored in the
+ * @ref BTree during initialization. Note that the auxiliary data is NEVER manipulated by the @ref BTree.
+ *
+ * A descent only visits one @ref BTreePage per level, and a @ref BTree with a fanout of B is about log2(B) times
+ * shallower than a binary tree. However, every probe of the binary search within a @ref BTreePage calls the
+ * compare function, which reads the key out of a @ref BTreeNode that may lie anywhere in memory, so a plain
+ * lookup still touches about log2(n) scattered @ref BTreeNode's, just as it does in a @ref RBTree. To avoid
+ * that, the user can OPTIONALLY install a key prefix function with @ref btree_set_key_prefix, which maps a key
+ * to an unsigned long that orders the keys like the compare function does (but may map different keys to the
+ * same value). The prefix of every @ref BTreeNode is then stored next to its pointer in the slots, and the
+ * binary searches compare prefixes within the @ref BTreePage, only calling the compare function on a tie. With
+ * a prefix that tells most keys apart (e.g. the key itself for integer keys), a lookup reads the
+ * @ref BTreePage's on its path and about one @ref BTreeNode.
+ *
+ * Ordered traversal walks the arrays of the lowest level, which are linked together, so it touches only one
+ * @ref BTreePage per BTREE_PAGE_SIZE / 2 @ref BTreeNode's or better. Every @ref BTreePage above the lowest level
+ * counts the @ref BTreeNode's below each of its children, so @ref btree_at and @ref btree_index_of take
+ * O(log(n)) time like their @ref RBTree counterparts with RBTREE_ORDER_STATISTICS. The price is that inserting
+ * or removing a @ref BTreeNode shifts up to BTREE_PAGE_SIZE slots (and the @ref BTreeNode's they point to are
+ * updated to know their new slots), and that the @ref BTreePage's must be provided by the user: the @ref BTree
+ * NEVER allocates memory. Instead, it takes the @ref BTreePage's it needs from the page array it was initialized
+ * with, and a @ref BTree holding n @ref BTreeNode's never needs more than BTREE_PAGES_NEEDED(n) of them.
+ * Inserting a @ref BTreeNode when every @ref BTreePage is in use is undefined behavior.
+ *
+ * BTREE_PAGE_SIZE defaults to 16 (so that each array of a @ref BTreePage spans two 64-byte cache lines with
+ * 64-bit words). It can be overridden, but must be at least 4, and must be defined identically for the library
+ * and every translation unit using it. Every @ref BTreePage but the root is always at least half full.
+ *
+ * Example:
+ *          struct Object {
+ *              int key;
+ *              int val;
+ *              BTreeNode n;
+ *          };
+ *
+ *          int compare(const void *key, const BTreeNode *node) {
+ *              return *(const int*)key - btree_entry(node, struct Object, n)->key;
+ *          }
+ *
+ *          int main(void) {
+ *              BTreePage page_array[BTREE_PAGES_NEEDED(1)];
+ *              struct Object obj;
+ *              BTree btree;
+ *              int copy_val;
+ *
+ *              obj.key = 1;
+ *
+ *              btree_init(&btree, page_array, BTREE_PAGES_NEEDED(1), compare, NULL, NULL);
+ *              btree_insert(&btree, &obj.key, &obj.n);
+ *
+ *              obj.val = 1000;
+ *              copy_val = btree_entry(btree_first(&btree), struct Object, n)->val;
+ *              assert(obj.val == copy_val);
+ *
+ *              return 0;
+ *          }
+ *
+ * Dependencies:
+ *      -   C89 assert.h
+ *      -   C89 stddef.h
+ *
+ * API:
+ *      ====  TYPES  ====
+ *      -   typedef struct BTree BTree
+ *      -   typedef struct BTreeNode BTreeNode
+ *      -   typedef struct BTreePage BTreePage
+ *
+ *      ====  FUNCTIONS  ====
+ *      Initializers:
+ *          -   btree_init
+ *          -   btree_set_key_prefix
+ *      Properties:
+ *          -   btree_first
+ *          -   btree_last
+ *          -   btree_prev
+ *          -   btree_next
+ *          -   btree_size
+ *          -   btree_empty
+ *          -   btree_contains_key
+ *          -   btree_num_free_pages
+ *      Array Interfacing:
+ *          -   btree_index_of
+ *          -   btree_at
+ *      Insertion:
+ *          -   btree_insert
+ *      Lookup:
+ *          -   btree_lookup_key
+ *          -   btree_lower_bound
+ *          -   btree_upper_bound
+ *      Removal:
+ *          -   btree_remove
+ *          -   btree_remove_key
+ *          -   btree_remove_first
+ *          -   btree_remove_last
+ *          -   btree_remove_all
+ *
+ *      ====  MACROS  ====
+ *      Constants:
+ *          -   BTREE_PAGE_SIZE
+ *          -   BTREE_POISON_PAGE
+ *      Page Array Sizing:
+ *          -   BTREE_PAGES_NEEDED
+ *      Convenient Node Initializer:
+ *          -   BTREE_NODE_INIT
+ *      Properties:
+ *          -   btree_entry
+ *      Traversal:
+ *          -   btree_for_each
+ *          -   btree_for_each_reverse
+ *          -   btree_for_each_safe
+ */
+
+#ifndef BTREE_H
+#define BTREE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+/**
+ * The maximum number of slots of a @ref BTreePage. Must be at least 4.
+ */
+#ifndef BTREE_PAGE_SIZE
+    #define BTREE_PAGE_SIZE 16
+#endif
+
+/* ========================================================================================================
+ *
+ *                                                  TYPES
+ *
+ * ======================================================================================================== */
+
+/* Struct type declarations. */
+struct BTree;
+struct BTreeNode;
+struct BTreePage;
+
+/* Struct typedef's. */
+typedef struct BTree BTree;
+typedef struct BTreeNode BTreeNode;
+typedef struct BTreePage BTreePage;
+
+/**
+ * Represents a B+tree.
+ */
+struct BTree {
+    int (*compare)(const void *key, const BTreeNode *node);
+    unsigned long (*key_prefix)(const void *key);
+    void (*collide)(const BTreeNode *old_node, const BTreeNode *new_node, void *auxiliary_data);
+    void *auxiliary_data;
+    BTreePage *root;
+    BTreePage *free_pages;
+    BTreePage *page_array;
+    size_t num_pages;
+    size_t num_free_pages;
+    size_t size;
+};
+
+/**
+ * Represents a node in a @ref BTree. Embed this into your structure to make it a node. It records the
+ * @ref BTreePage and the slot of that @ref BTreePage pointing to it.
+ */
+struct BTreeNode {
+    BTreePage *page;
+    size_t index;
+};
+
+/**
+ * Represents a page of a @ref BTree. The @ref BTree manages its members, so they should NEVER be modified by
+ * the user. A page on the lowest level (a leaf) points to its @ref BTreeNode's in order, and is linked to the
+ * neighboring leaves. A page above the lowest level points to its children in order, along with the first
+ * @ref BTreeNode below each child and the number of @ref BTreeNode's below each child. Every slot also holds
+ * the key prefix of its @ref BTreeNode, if the @ref BTree has a key prefix function.
+ */
+struct BTreePage {
+    BTreePage *parent;
+    BTreePage *prev;
+    BTreePage *next;
+    size_t num_slots;
+    int leaf;
+    unsigned long prefixes[BTREE_PAGE_SIZE];
+    BTreeNode *slots[BTREE_PAGE_SIZE];
+    BTreePage *children[BTREE_PAGE_SIZE];
+    size_t counts[BTREE_PAGE_SIZE];
+};
+
+/* ========================================================================================================
+ *
+ *                                               PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * Initializes/resets the @ref btree. Every @ref BTreePage of the @ref page_array is made available to the
+ * @ref btree.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *      -   @ref page_array != NULL, or @ref num_pages == 0
+ *      -   @ref compare != NULL
+ *
+ * Time complexity:
+ *      -   O(m), where m == @ref num_pages
+ *
+ * @param btree                 The @ref BTree to be initialized/reset.
+ * @param page_array            The array of @ref BTreePage's the @ref btree takes its @ref BTreePage's from.
+ *                              It does NOT need to be initialized.
+ * @param num_pages             The number of @ref BTreePage's in the @ref page_array.
+ * @param compare               The callback function used to compare a key with the key of a @ref BTreeNode.
+ * @param collide               The OPTIONAL (i.e. can be NULL) callback function used to handle key
+ *                              collisions. If non-NULL, @ref collide will be called after the old
+ *                              @ref BTreeNode is replaced by the new @ref BTreeNode.
+ * @param auxiliary_data        The auxiliary data passed to the OPTIONAL @ref collide callback function if
+ *                              the @ref collide callback function is non-NULL. This data is NEVER manipulated
+ *                              by the @ref btree. This data is user-defined. For example, this data could be
+ *                              a memory pool object that is used for freeing up resources held by the old
+ *                              @ref BTreeNode in the @ref collide callback function.
+ */
+void btree_init(
+    BTree *btree,
+    BTreePage *page_array,
+    size_t num_pages,
+    int (*compare)(const void *key, const BTreeNode *node),
+    void (*collide)(const BTreeNode *old_node, const BTreeNode *new_node, void *auxiliary_data),
+    void *auxiliary_data
+);
+
+/**
+ * Installs the @ref key_prefix function, which maps a key to an unsigned long that the @ref btree compares
+ * before calling its compare function, and stores next to the pointer to every @ref BTreeNode. NULL uninstalls
+ * it. @ref btree_init uninstalls it as well. The prefixes must be ordered like the keys: if the compare
+ * function finds a key less than another key, the prefix of the former must NOT be greater than the prefix of
+ * the latter. Equal keys must have equal prefixes.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *      -   @ref btree is empty
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ * @param key_prefix            The OPTIONAL (i.e. can be NULL) callback function mapping a key to its prefix.
+ */
+void btree_set_key_prefix(BTree *btree, unsigned long (*key_prefix)(const void *key));
+
+/**
+ * Returns the first @ref BTreeNode of the @ref btree.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree whose first @ref BTreeNode will be returned.
+ * @return                      The first @ref BTreeNode of the @ref btree.
+ */
+BTreeNode* btree_first(const BTree *btree);
+
+/**
+ * Returns the last @ref BTreeNode of the @ref btree.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree whose last @ref BTreeNode will be returned.
+ * @return                      The last @ref BTreeNode of the @ref btree.
+ */
+BTreeNode* btree_last(const BTree *btree);
+
+/**
+ * Returns the @ref BTreeNode before the @ref node. NULL if @ref node == NULL.
+ *
+ * Requirements:
+ *      -   None
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param node                  The @ref BTreeNode whose predecessor will be returned.
+ * @return                      NULL if @ref node == NULL; otherwise, the predecessor of the @ref node.
+ */
+BTreeNode* btree_prev(const BTreeNode *node);
+
+/**
+ * Returns the @ref BTreeNode after the @ref node. NULL if @ref node == NULL.
+ *
+ * Requirements:
+ *      -   None
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param node                  The @ref BTreeNode whose successor will be returned.
+ * @return                      NULL if @ref node == NULL; otherwise, the successor of the @ref node.
+ */
+BTreeNode* btree_next(const BTreeNode *node);
+
+/**
+ * Returns the size of the @ref btree.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param btree                 The @ref BTree whose size will be returned.
+ * @return                      The size of the @ref btree.
+ */
+size_t btree_size(const BTree *btree);
+
+/**
+ * Returns whether the @ref btree is empty.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param btree                 The @ref BTree to check.
+ * @return                      Whether the @ref btree is empty.
+ */
+int btree_empty(const BTree *btree);
+
+/**
+ * Returns whether the @ref btree contains the @ref key.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to check.
+ * @param key                   The key to find.
+ * @return                      Whether the @ref btree contains the @ref key.
+ */
+int btree_contains_key(const BTree *btree, const void *key);
+
+/**
+ * Returns the number of @ref BTreePage's of the page array of the @ref btree that are not in use.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param btree                 The @ref BTree whose number of free @ref BTreePage's will be returned.
+ * @return                      The number of @ref BTreePage's not in use.
+ */
+size_t btree_num_free_pages(const BTree *btree);
+
+/**
+ * Retrieves the index of the @ref node in the @ref btree.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree that contains the @ref node.
+ * @param node                  The @ref BTreeNode whose index is wanted.
+ * @return                      The index of the @ref node in the @ref btree.
+ */
+size_t btree_index_of(const BTree *btree, const BTreeNode *node);
+
+/**
+ * Retrieves @ref BTreeNode at the @ref index. The descent skips every child below which the @ref index is
+ * not, by the counts of @ref BTreeNode's of the @ref BTreePage's.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *      -   @ref index < @ref btree->size
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ * @param index                 The index of the @ref BTreeNode wanted.
+ * @return                      The @ref BTreeNode at the @ref index of the @ref btree.
+ */
+BTreeNode* btree_at(const BTree *btree, size_t index);
+
+/**
+ * Inserts the @ref node into the @ref btree. If the @ref key already exists in the @ref btree, the new
+ * @ref node will replace the old @ref BTreeNode, then the collide function (if non-NULL) will be called.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *      -   @ref node != NULL
+ *      -   The page array of the @ref btree has enough free @ref BTreePage's (i.e. is at least
+ *          BTREE_PAGES_NEEDED(@ref btree->size + 1) large)
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ * @param key                   The key of the @ref node.
+ * @param node                  The @ref BTreeNode to be inserted.
+ */
+void btree_insert(BTree *btree, const void *key, BTreeNode *node);
+
+/**
+ * Returns the @ref BTreeNode containing the @ref key. NULL if the @ref key does not exist.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ * @param key                   The key of the @ref BTreeNode to be found.
+ * @return                      NULL if the @ref key does not exist; otherwise, the @ref BTreeNode containing
+ *                              the @ref key.
+ */
+BTreeNode* btree_lookup_key(const BTree *btree, const void *key);
+
+/**
+ * Returns the first @ref BTreeNode whose key is NOT less than the @ref key. NULL if no such @ref BTreeNode
+ * exists.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ * @param key                   The key to compare against.
+ * @return                      NULL if every key of the @ref btree is less than the @ref key; otherwise, the
+ *                              first @ref BTreeNode whose key is greater than or equal to the @ref key.
+ */
+BTreeNode* btree_lower_bound(const BTree *btree, const void *key);
+
+/**
+ * Returns the first @ref BTreeNode whose key is greater than the @ref key. NULL if no such @ref BTreeNode
+ * exists.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ * @param key                   The key to compare against.
+ * @return                      NULL if no key of the @ref btree is greater than the @ref key; otherwise, the
+ *                              first @ref BTreeNode whose key is greater than the @ref key.
+ */
+BTreeNode* btree_upper_bound(const BTree *btree, const void *key);
+
+/**
+ * Removes the @ref node from the @ref btree. If @ref node == NULL, nothing happens.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *      -   @ref node belongs to the @ref btree, or @ref node == NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ * @param node                  The @ref BTreeNode to be removed.
+ */
+void btree_remove(BTree *btree, BTreeNode *node);
+
+/**
+ * Removes the @ref BTreeNode containing the @ref key. If the @ref key does not exist, nothing happens.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ * @param key                   The key of the @ref BTreeNode to be removed.
+ */
+void btree_remove_key(BTree *btree, const void *key);
+
+/**
+ * Removes the first @ref BTreeNode of the @ref btree. If the @ref btree is empty, nothing happens.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ */
+void btree_remove_first(BTree *btree);
+
+/**
+ * Removes the last @ref BTreeNode of the @ref btree. If the @ref btree is empty, nothing happens.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ */
+void btree_remove_last(BTree *btree);
+
+/**
+ * Removes every @ref BTreeNode of the @ref btree and makes every @ref BTreePage of its page array available
+ * again. The removed @ref BTreeNode's are NOT modified.
+ *
+ * Requirements:
+ *      -   @ref btree != NULL
+ *
+ * Time complexity:
+ *      -   O(m), where m == number of @ref BTreePage's of the page array
+ *
+ * @param btree                 The @ref BTree to be operated on.
+ */
+void btree_remove_all(BTree *btree);
+
+/* ========================================================================================================
+ *
+ *                                                 MACROS
+ *
+ * ======================================================================================================== */
+
+/**
+ * Non-NULL pointer that will result in page faults under normal circumstances. Is the "page" member of a
+ * removed @ref BTreeNode. Useful for identifying bugs.
+ */
+#define BTREE_POISON_PAGE ((BTreePage*) 0x100)
+
+/**
+ * The number of @ref BTreePage's a @ref BTree holding @ref num_nodes @ref BTreeNode's needs at most. Since
+ * every @ref BTreePage but the root is at least half full, this is about 2 * @ref num_nodes / BTREE_PAGE_SIZE.
+ *
+ * @param num_nodes             The maximum number of @ref BTreeNode's the @ref BTree will hold.
+ */
+#define BTREE_PAGES_NEEDED(num_nodes) ((num_nodes) / (BTREE_PAGE_SIZE / 2 - 1) + 1)
+
+/**
+ * Initializing a @ref BTreeNode before it is used is NOT required. This macro is simply for allowing you to
+ * initialize a struct (containing one or more @ref BTreeNode's) with an initializer-list conveniently.
+ */
+#define BTREE_NODE_INIT { BTREE_POISON_PAGE, 0 }
+
+/**
+ * Obtains the pointer to the struct for this entry.
+ *
+ * Requirements:
+ *      -   @ref node_ptr != NULL
+ *
+ * @param node_ptr              The pointer to the @ref BTreeNode in the struct.
+ * @param type                  The type of the struct the @ref BTreeNode is embedded in.
+ * @param member                The name of the @ref BTreeNode in the struct.
+ */
+#if defined(__GNUC__) && !defined(__STRICT_ANSI__)
+    #define btree_entry(node_ptr, type, member) \
+        ({ \
+            const typeof(((type*)0)->member) *__mptr = (node_ptr); \
+            (type*) ((char*)__mptr - offsetof(type, member)); \
+        })
+#else
+    #define btree_entry(node_ptr, type, member) \
+        ( \
+            (type*) ((char*)(node_ptr) - offsetof(type, member)) \
+        )
+#endif
+
+/**
+ * Iterates over the @ref BTree from the first @ref BTreeNode to the last @ref BTreeNode.
+ *
+ * Requirements:
+ *      -   @ref btree_ptr != NULL
+ *      -   The @ref BTree is NOT modified in the loop's body.
+ *
+ * @param cursor_node_ptr       The @ref BTreeNode to use as a loop cursor.
+ * @param btree_ptr             The pointer to a @ref BTree that will be iterated over.
+ */
+#define btree_for_each(cursor_node_ptr, btree_ptr) \
+    for ( \
+        cursor_node_ptr = btree_first(btree_ptr); \
+        cursor_node_ptr; \
+        cursor_node_ptr = btree_next(cursor_node_ptr) \
+    )
+
+/**
+ * Iterates over the @ref BTree from the last @ref BTreeNode to the first @ref BTreeNode.
+ *
+ * Requirements:
+ *      -   @ref btree_ptr != NULL
+ *      -   The @ref BTree is NOT modified in the loop's body.
+ *
+ * @param cursor_node_ptr       The @ref BTreeNode to use as a loop cursor.
+ * @param btree_ptr             The pointer to a @ref BTree that will be iterated over.
+ */
+#define btree_for_each_reverse(cursor_node_ptr, btree_ptr) \
+    for ( \
+        cursor_node_ptr = btree_last(btree_ptr); \
+        cursor_node_ptr; \
+        cursor_node_ptr = btree_prev(cursor_node_ptr) \
+    )
+
+/**
+ * Iterates over the @ref BTree from the first @ref BTreeNode to the last @ref BTreeNode. The loop cursor may
+ * be removed from the @ref BTree in the loop's body. A removal may move the remaining @ref BTreeNode's to other
+ * slots, but every @ref BTreeNode always knows its slot, so the successor stays valid.
+ *
+ * Requirements:
+ *      -   @ref btree_ptr != NULL
+ *      -   No @ref BTreeNode other than the @ref cursor_node_ptr is inserted or removed in the loop's body.
+ *
+ * @param cursor_node_ptr       The @ref BTreeNode to use as a loop cursor.
+ * @param backup_node_ptr       The @ref BTreeNode to use as temporary storage.
+ * @param btree_ptr             The pointer to a @ref BTree that will be iterated over.
+ */
+#define btree_for_each_safe(cursor_node_ptr, backup_node_ptr, btree_ptr) \
+    for ( \
+        cursor_node_ptr = btree_first(btree_ptr), \
+        backup_node_ptr = btree_next(cursor_node_ptr); \
+        \
+        cursor_node_ptr; \
+        \
+        cursor_node_ptr = backup_node_ptr, \
+        backup_node_ptr = btree_next(backup_node_ptr) \
+    )
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BTREE_H */
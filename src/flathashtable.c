@@ -0,0 +1,381 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+
+#if defined(__SSE2__) && !defined(FLATHASHTABLE_NO_SIMD)
+    #define FLATHASHTABLE_SSE2
+    #include <emmintrin.h>
+#endif
+
+#include "flathashtable.h"
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/*
+ * Returns the index of the group that the search for the @ref hash starts at.
+ */
+static size_t home_group(const FlatHashTable *flathashtable, size_t hash);
+
+/*
+ * Returns the index of the group following the group at @ref index, wrapping around.
+ */
+static size_t next_group(const FlatHashTable *flathashtable, size_t index);
+
+/*
+ * Returns the control byte of a slot holding a @ref FlatHashTableNode with the @ref hash. These control bytes
+ * always have their high bit set, so they never equal the control byte of an empty slot.
+ */
+static unsigned char hash_tag(const FlatHashTable *flathashtable, size_t hash);
+
+/*
+ * Returns a bit mask with bit i set iff control byte i of the @ref group equals the @ref tag.
+ */
+static unsigned match_tag(const FlatHashTableGroup *group, unsigned char tag);
+
+/*
+ * Returns the index of the lowest set bit of the @ref mask.
+ */
+static unsigned lowest_bit_index(unsigned mask);
+
+/*
+ * Returns the index of the group holding the @ref FlatHashTableNode containing the @ref key, whose hashcode is
+ * @ref hash, and stores its slot in @ref slot. If the @ref key does not exist, @ref flathashtable->num_groups
+ * is returned.
+ */
+static size_t find_key(const FlatHashTable *flathashtable, const void *key, size_t hash, unsigned *slot);
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static size_t home_group(const FlatHashTable *flathashtable, size_t hash) {
+    assert(flathashtable);
+
+    return hash % flathashtable->num_groups;
+}
+
+static size_t next_group(const FlatHashTable *flathashtable, size_t index) {
+    assert(flathashtable);
+
+    return index + 1 == flathashtable->num_groups ? 0 : index + 1;
+}
+
+static unsigned char hash_tag(const FlatHashTable *flathashtable, size_t hash) {
+    size_t fragment;
+
+    assert(flathashtable);
+
+    /*
+     * The quotient is independent of the group index, and the top bits are folded in so that a hash function
+     * which mixes into the high bits is still well filtered.
+     */
+    fragment = (hash / flathashtable->num_groups) ^ (hash >> (sizeof(size_t) * CHAR_BIT - 7));
+
+    return (unsigned char) (0x80 | (fragment & 0x7F));
+}
+
+static unsigned match_tag(const FlatHashTableGroup *group, unsigned char tag) {
+    #ifdef FLATHASHTABLE_SSE2
+    __m128i control = _mm_loadu_si128((const __m128i*) (const void*) group->tags);
+    __m128i pattern = _mm_set1_epi8((char) tag);
+
+    return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(control, pattern)) &
+        ((1U << FLATHASHTABLE_GROUP_SIZE) - 1);
+    #else
+    unsigned mask = 0, i;
+
+    for (i = 0; i < FLATHASHTABLE_GROUP_SIZE; ++i) {
+        mask |= (unsigned) (group->tags[i] == tag) << i;
+    }
+
+    return mask;
+    #endif /* FLATHASHTABLE_SSE2 */
+}
+
+static unsigned lowest_bit_index(unsigned mask) {
+    assert(mask);
+
+    #if defined(__GNUC__)
+    return (unsigned) __builtin_ctz(mask);
+    #else
+    {
+        unsigned i = 0;
+
+        while (!(mask & 1U)) {
+            mask >>= 1;
+            ++i;
+        }
+
+        return i;
+    }
+    #endif /* __GNUC__ */
+}
+
+static size_t find_key(const FlatHashTable *flathashtable, const void *key, size_t hash, unsigned *slot) {
+    unsigned char tag;
+    size_t index, probes;
+
+    assert(flathashtable && slot);
+
+    tag = hash_tag(flathashtable, hash);
+    index = home_group(flathashtable, hash);
+
+    for (probes = 0; probes < flathashtable->num_groups; ++probes) {
+        const FlatHashTableGroup *group = flathashtable->group_array + index;
+        unsigned mask;
+
+        for (mask = match_tag(group, tag); mask; mask &= mask - 1) {
+            unsigned i = lowest_bit_index(mask);
+            const FlatHashTableNode *n = group->slots[i];
+
+            if (n->hash == hash && flathashtable->equal(key, n)) {
+                *slot = i;
+                return index;
+            }
+        }
+
+        if (group->overflow == 0) {
+            break;
+        }
+
+        index = next_group(flathashtable, index);
+    }
+
+    return flathashtable->num_groups;
+}
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+void flathashtable_init(
+    FlatHashTable *flathashtable,
+    FlatHashTableGroup *group_array,
+    size_t num_groups,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const FlatHashTableNode *node),
+    void (*collide)(const FlatHashTableNode *old_node, const FlatHashTableNode *new_node, void *auxiliary_data),
+    void *auxiliary_data
+) {
+    size_t i;
+
+    assert(flathashtable && group_array && num_groups > 0 && hash && equal);
+
+    for (i = 0; i < num_groups; ++i) {
+        size_t j;
+
+        for (j = 0; j < FLATHASHTABLE_GROUP_SIZE; ++j) {
+            group_array[i].tags[j] = 0;
+        }
+
+        group_array[i].overflow = 0;
+        group_array[i].reserved = 0;
+    }
+
+    flathashtable->group_array = group_array;
+    flathashtable->hash = hash;
+    flathashtable->equal = equal;
+    flathashtable->collide = collide;
+    flathashtable->auxiliary_data = auxiliary_data;
+    flathashtable->num_groups = num_groups;
+    flathashtable->size = 0;
+}
+
+void flathashtable_fast_init(
+    FlatHashTable *flathashtable,
+    FlatHashTableGroup *group_array,
+    size_t num_groups,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const FlatHashTableNode *node),
+    void (*collide)(const FlatHashTableNode *old_node, const FlatHashTableNode *new_node, void *auxiliary_data),
+    void *auxiliary_data
+) {
+    assert(flathashtable && group_array && num_groups > 0 && hash && equal);
+
+    #ifndef NDEBUG
+    {
+        size_t i;
+        for (i = 0; i < num_groups; ++i) {
+            assert(match_tag(group_array + i, 0) == (1U << FLATHASHTABLE_GROUP_SIZE) - 1);
+            assert(group_array[i].overflow == 0);
+        }
+    }
+    #endif /* NDEBUG */
+
+    flathashtable->group_array = group_array;
+    flathashtable->hash = hash;
+    flathashtable->equal = equal;
+    flathashtable->collide = collide;
+    flathashtable->auxiliary_data = auxiliary_data;
+    flathashtable->num_groups = num_groups;
+    flathashtable->size = 0;
+}
+
+FlatHashTableGroup* flathashtable_group_array(const FlatHashTable *flathashtable) {
+    assert(flathashtable);
+
+    return flathashtable->group_array;
+}
+
+size_t flathashtable_num_groups(const FlatHashTable *flathashtable) {
+    assert(flathashtable);
+
+    return flathashtable->num_groups;
+}
+
+size_t flathashtable_capacity(const FlatHashTable *flathashtable) {
+    assert(flathashtable);
+
+    return flathashtable->num_groups * FLATHASHTABLE_GROUP_SIZE;
+}
+
+size_t flathashtable_size(const FlatHashTable *flathashtable) {
+    assert(flathashtable);
+
+    return flathashtable->size;
+}
+
+int flathashtable_empty(const FlatHashTable *flathashtable) {
+    assert(flathashtable);
+
+    return flathashtable->size == 0;
+}
+
+int flathashtable_contains_key(const FlatHashTable *flathashtable, const void *key) {
+    assert(flathashtable);
+
+    return flathashtable_lookup_key(flathashtable, key) != NULL;
+}
+
+void flathashtable_insert(FlatHashTable *flathashtable, const void *key, FlatHashTableNode *node) {
+    FlatHashTableGroup *group;
+    size_t hash, index;
+    unsigned slot;
+
+    assert(flathashtable && node);
+
+    hash = flathashtable->hash(key);
+    node->hash = hash;
+
+    index = find_key(flathashtable, key, hash, &slot);
+
+    if (index != flathashtable->num_groups) {
+        FlatHashTableNode *old_node = flathashtable->group_array[index].slots[slot];
+
+        flathashtable->group_array[index].slots[slot] = node;
+
+        if (flathashtable->collide) {
+            flathashtable->collide(old_node, node, flathashtable->auxiliary_data);
+        }
+
+        return;
+    }
+
+    assert(flathashtable->size < flathashtable_capacity(flathashtable));
+
+    /* Every full group passed over on the way to the first empty slot records the overflow. */
+    for (index = home_group(flathashtable, hash); ; index = next_group(flathashtable, index)) {
+        unsigned empty;
+
+        group = flathashtable->group_array + index;
+        empty = match_tag(group, 0);
+
+        if (empty) {
+            slot = lowest_bit_index(empty);
+            break;
+        }
+
+        if (group->overflow != FLATHASHTABLE_MAX_OVERFLOW) {
+            ++group->overflow;
+        }
+    }
+
+    group->tags[slot] = hash_tag(flathashtable, hash);
+    group->slots[slot] = node;
+
+    ++flathashtable->size;
+}
+
+FlatHashTableNode* flathashtable_lookup_key(const FlatHashTable *flathashtable, const void *key) {
+    size_t index;
+    unsigned slot;
+
+    assert(flathashtable);
+
+    index = find_key(flathashtable, key, flathashtable->hash(key), &slot);
+
+    return index != flathashtable->num_groups ? flathashtable->group_array[index].slots[slot] : NULL;
+}
+
+void flathashtable_remove_key(FlatHashTable *flathashtable, const void *key) {
+    size_t hash, index, i;
+    unsigned slot;
+
+    assert(flathashtable);
+
+    hash = flathashtable->hash(key);
+    index = find_key(flathashtable, key, hash, &slot);
+
+    if (index == flathashtable->num_groups) {
+        return;
+    }
+
+    flathashtable->group_array[index].tags[slot] = 0;
+    flathashtable->group_array[index].slots[slot] = NULL;
+
+    /* Undo the overflow recorded by every group passed over when the FlatHashTableNode was inserted. */
+    for (i = home_group(flathashtable, hash); i != index; i = next_group(flathashtable, i)) {
+        FlatHashTableGroup *group = flathashtable->group_array + i;
+
+        if (group->overflow != FLATHASHTABLE_MAX_OVERFLOW) {
+            --group->overflow;
+        }
+    }
+
+    --flathashtable->size;
+}
+
+void flathashtable_remove_all(FlatHashTable *flathashtable) {
+    size_t i;
+
+    assert(flathashtable);
+
+    for (i = 0; i < flathashtable->num_groups; ++i) {
+        FlatHashTableGroup *group = flathashtable->group_array + i;
+        size_t j;
+
+        for (j = 0; j < FLATHASHTABLE_GROUP_SIZE; ++j) {
+            group->tags[j] = 0;
+        }
+
+        group->overflow = 0;
+    }
+
+    flathashtable->size = 0;
+}
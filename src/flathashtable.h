@@ -0,0 +1,532 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+ * @file    flathashtable.h
+ * @brief   FLAT (OPEN ADDRESSING) HASH TABLE
+ *
+ * Embed one or more @ref FlatHashTableNode's into your struct to make it a potential node in one or more flat
+ * hashtables. The @ref FlatHashTable structure keeps track of a table of @ref FlatHashTableNode's. A
+ * @ref FlatHashTable MUST be initialized before it is used. A @ref FlatHashTableNode does NOT need to be
+ * initialized before it is used. A @ref FlatHashTableNode should belong to at most ONE @ref FlatHashTable.
+ *
+ * Unlike a chained hash table, a @ref FlatHashTable does not link its @ref FlatHashTableNode's together.
+ * Instead, the user is required to define a group array (an array of @ref FlatHashTableGroup's) that the
+ * @ref FlatHashTable will use over the course of its lifetime. Every @ref FlatHashTableGroup holds
+ * @ref FLATHASHTABLE_GROUP_SIZE slots, each of which is either empty or points to a @ref FlatHashTableNode.
+ * The slots of a @ref FlatHashTableGroup are preceded by one control byte per slot, which is zero if the slot
+ * is empty and otherwise holds a 7-bit fragment of the hashcode of the key of the @ref FlatHashTableNode in
+ * the slot. A lookup only ever compares the key with a @ref FlatHashTableNode whose hash fragment matches,
+ * and the control bytes of a @ref FlatHashTableGroup are compared all at once (with SSE2 instructions if they
+ * are available), so a lookup usually touches one @ref FlatHashTableGroup and one @ref FlatHashTableNode.
+ *
+ * A key is first looked for in the @ref FlatHashTableGroup its hashcode maps to, and then in the following
+ * @ref FlatHashTableGroup's (wrapping around) until the key is found or a @ref FlatHashTableGroup that no
+ * inserted key has ever overflowed past is reached. Every @ref FlatHashTableGroup counts the number of
+ * @ref FlatHashTableNode's that overflowed past it, so removals do not need to leave tombstones behind.
+ *
+ * The user is encouraged to create the group array filled with zero bytes in an optimized manner (such as
+ * using an initializer list, using calloc, etc), so that they can call @ref flathashtable_fast_init which
+ * skips the process of clearing the group array manually.
+ *
+ * The user is required to define a hash function which returns the hashcode of a key. This function does NOT
+ * need to convert the hashcode into a usuable group index. The returned hashcode can be ANY number, but the
+ * fewer bits the hashcodes of different keys share, the better the hash fragments filter out unequal keys.
+ * The hashcode of a key is stored in its @ref FlatHashTableNode.
+ *
+ * The user is required to define an equal function which determines if a key is equal to the key of a
+ * @ref FlatHashTableNode. When a @ref FlatHashTableNode is inserted with a non-unique (an already existing)
+ * key, the old @ref FlatHashTableNode will be discarded and the new @ref FlatHashTableNode will take its
+ * place.
+ *
+ * The user can OPTIONALLY define a collide function which is called after the old @ref FlatHashTableNode is
+ * replaced. The collide function is called with three arguments, the old @ref FlatHashTableNode, the new
+ * @ref FlatHashTableNode, and the auxiliary data that was stored in the @ref FlatHashTable during
+ * initialization. Note that the auxiliary data is NEVER manipulated by the @ref FlatHashTable.
+ *
+ * A @ref FlatHashTable can hold at most as many @ref FlatHashTableNode's as it has slots, and lookups slow
+ * down as the @ref FlatHashTable fills up, so the group array should have roughly 15% more slots than the
+ * maximum number of @ref FlatHashTableNode's that will be stored.
+ *
+ * Example:
+ *          struct Object {
+ *              int key;
+ *              int val;
+ *              FlatHashTableNode n;
+ *          };
+ *
+ *          size_t hash(const void *key) {
+ *              return *(const int*)key;
+ *          }
+ *
+ *          int equal(const void *key, const FlatHashTableNode *node) {
+ *              return *(const int*)key == flathashtable_entry(node, struct Object, n)->key;
+ *          }
+ *
+ *          int main(void) {
+ *              struct Object obj;
+ *              FlatHashTable flathashtable;
+ *              FlatHashTableGroup group_array[4];
+ *              int copy_val;
+ *
+ *              obj.key = 1;
+ *
+ *              flathashtable_init(&flathashtable, group_array, 4, hash, equal, NULL, NULL);
+ *              flathashtable_insert(&flathashtable, &obj.key, &obj.n);
+ *
+ *              obj.val = 1000;
+ *              copy_val = flathashtable_entry(
+ *                  flathashtable_lookup_key(&flathashtable, &obj.key), struct Object, n
+ *              )->val;
+ *              assert(obj.val == copy_val);
+ *              return 0;
+ *          }
+ *
+ * Dependencies:
+ *      -   C89 assert.h
+ *      -   C89 limits.h
+ *      -   C89 stddef.h
+ *      -   SSE2 emmintrin.h (only if __SSE2__ is defined and FLATHASHTABLE_NO_SIMD is not defined)
+ *
+ * API:
+ *      ====  TYPES  ====
+ *      -   typedef struct FlatHashTable FlatHashTable;
+ *      -   typedef struct FlatHashTableGroup FlatHashTableGroup;
+ *      -   typedef struct FlatHashTableNode FlatHashTableNode;
+ *
+ *      ====  FUNCTIONS  ====
+ *      Initializers:
+ *          -   flathashtable_init
+ *          -   flathashtable_fast_init
+ *      Properties:
+ *          -   flathashtable_group_array
+ *          -   flathashtable_num_groups
+ *          -   flathashtable_capacity
+ *          -   flathashtable_size
+ *          -   flathashtable_empty
+ *          -   flathashtable_contains_key
+ *      Insertion:
+ *          -   flathashtable_insert
+ *      Lookup:
+ *          -   flathashtable_lookup_key
+ *      Removal:
+ *          -   flathashtable_remove_key
+ *          -   flathashtable_remove_all
+ *
+ *      ====  MACROS  ====
+ *      Constants:
+ *          -   FLATHASHTABLE_GROUP_SIZE
+ *          -   FLATHASHTABLE_MAX_OVERFLOW
+ *      Convenient Node Initializer:
+ *          -   FLATHASHTABLE_NODE_INIT
+ *      Properties:
+ *          -   flathashtable_entry
+ *          -   flathashtable_slot
+ *      Traversal:
+ *          -   flathashtable_for_each
+ */
+
+#ifndef FLATHASHTABLE_H
+#define FLATHASHTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+/* ========================================================================================================
+ *
+ *                                                  TYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * The number of slots in a @ref FlatHashTableGroup. Together with the overflow counter and a reserved byte,
+ * the control bytes of a @ref FlatHashTableGroup fill exactly 16 bytes.
+ */
+#define FLATHASHTABLE_GROUP_SIZE 14
+
+/* Struct type declarations. */
+struct FlatHashTable;
+struct FlatHashTableGroup;
+struct FlatHashTableNode;
+
+/* Struct typedef's. */
+typedef struct FlatHashTable FlatHashTable;
+typedef struct FlatHashTableGroup FlatHashTableGroup;
+typedef struct FlatHashTableNode FlatHashTableNode;
+
+/**
+ * Represents a flat hash table.
+ */
+struct FlatHashTable {
+    FlatHashTableGroup *group_array;
+    size_t (*hash)(const void *key);
+    int (*equal)(const void *key, const FlatHashTableNode *node);
+    void (*collide)(const FlatHashTableNode *old_node, const FlatHashTableNode *new_node, void *auxiliary_data);
+    void *auxiliary_data;
+    size_t num_groups;
+    size_t size;
+};
+
+/**
+ * Represents a group of slots in a @ref FlatHashTable. The user only ever creates an array of these.
+ */
+struct FlatHashTableGroup {
+    unsigned char tags[FLATHASHTABLE_GROUP_SIZE];
+    unsigned char overflow;
+    unsigned char reserved;
+    FlatHashTableNode *slots[FLATHASHTABLE_GROUP_SIZE];
+};
+
+/**
+ * Represents a node in a @ref FlatHashTable. Embed this into your structure to make it a node.
+ */
+struct FlatHashTableNode {
+    size_t hash;
+};
+
+/* ========================================================================================================
+ *
+ *                                               PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * Initializes/resets the @ref flathashtable. Unlike @ref flathashtable_fast_init, this function clears the
+ * @ref group_array manually.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *      -   @ref group_array != NULL
+ *      -   @ref num_groups > 0
+ *      -   @ref hash != NULL
+ *      -   @ref equal != NULL
+ *
+ * Time complexity:
+ *      -   O(m), where m == number of groups in group array
+ *
+ * @param flathashtable         The @ref FlatHashTable to be initialized/reset.
+ * @param group_array           The group array created by the user. It does NOT need to already be filled
+ *                              with zero bytes.
+ * @param num_groups            The number of groups in the @ref group_array.
+ * @param hash                  The callback function used to hash a key.
+ * @param equal                 The callback function used to to determine if a key is equal to the key of a
+ *                              @ref FlatHashTableNode.
+ * @param collide               The OPTIONAL (i.e. can be NULL) callback function used to handle key
+ *                              collisions. If non-NULL, @ref collide will be called after the old
+ *                              @ref FlatHashTableNode is replaced by the new @ref FlatHashTableNode.
+ * @param auxiliary_data        The auxiliary data passed to the OPTIONAL @ref collide callback function if
+ *                              the @ref collide callback function is non-NULL. This data is NEVER manipulated
+ *                              by the @ref flathashtable.
+ */
+void flathashtable_init(
+    FlatHashTable *flathashtable,
+    FlatHashTableGroup *group_array,
+    size_t num_groups,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const FlatHashTableNode *node),
+    void (*collide)(const FlatHashTableNode *old_node, const FlatHashTableNode *new_node, void *auxiliary_data),
+    void *auxiliary_data
+);
+
+/**
+ * Initializes/resets the @ref flathashtable. Note that the control bytes of the @ref group_array MUST be
+ * zero, which is the case if the @ref group_array is filled with zero bytes (e.g. by calloc or an initializer
+ * list). This function does NOT do this because there are more time efficient ways of doing this during
+ * creation of the @ref group_array.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *      -   @ref group_array != NULL
+ *      -   @ref num_groups > 0
+ *      -   @ref hash != NULL
+ *      -   @ref equal != NULL
+ *      -   @ref group_array is filled with zero bytes
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param flathashtable         The @ref FlatHashTable to be initialized/reset.
+ * @param group_array           The group array created by the user. It MUST be filled with zero bytes.
+ * @param num_groups            The number of groups in the @ref group_array.
+ * @param hash                  The callback function used to hash a key.
+ * @param equal                 The callback function used to to determine if a key is equal to the key of a
+ *                              @ref FlatHashTableNode.
+ * @param collide               The OPTIONAL (i.e. can be NULL) callback function used to handle key
+ *                              collisions. If non-NULL, @ref collide will be called after the old
+ *                              @ref FlatHashTableNode is replaced by the new @ref FlatHashTableNode.
+ * @param auxiliary_data        The auxiliary data passed to the OPTIONAL @ref collide callback function if
+ *                              the @ref collide callback function is non-NULL. This data is NEVER manipulated
+ *                              by the @ref flathashtable.
+ */
+void flathashtable_fast_init(
+    FlatHashTable *flathashtable,
+    FlatHashTableGroup *group_array,
+    size_t num_groups,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const FlatHashTableNode *node),
+    void (*collide)(const FlatHashTableNode *old_node, const FlatHashTableNode *new_node, void *auxiliary_data),
+    void *auxiliary_data
+);
+
+/**
+ * Returns the group array used by the @ref flathashtable.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param flathashtable         The @ref FlatHashTable whose "group_array" member will be returned.
+ * @return                      @ref flathashtable->group_array.
+ */
+FlatHashTableGroup* flathashtable_group_array(const FlatHashTable *flathashtable);
+
+/**
+ * Returns the number of groups in the group array used by the @ref flathashtable.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param flathashtable         The @ref FlatHashTable whose "num_groups" member will be returned.
+ * @return                      @ref flathashtable->num_groups.
+ */
+size_t flathashtable_num_groups(const FlatHashTable *flathashtable);
+
+/**
+ * Returns the maximum number of @ref FlatHashTableNode's the @ref flathashtable can hold (i.e. its number of
+ * slots).
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param flathashtable         The @ref FlatHashTable whose capacity will be returned.
+ * @return                      @ref flathashtable->num_groups * @ref FLATHASHTABLE_GROUP_SIZE.
+ */
+size_t flathashtable_capacity(const FlatHashTable *flathashtable);
+
+/**
+ * Returns the size of the @ref flathashtable.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param flathashtable         The @ref FlatHashTable whose "size" member will be returned.
+ * @return                      @ref flathashtable->size.
+ */
+size_t flathashtable_size(const FlatHashTable *flathashtable);
+
+/**
+ * Returns whether or not the @ref flathashtable is empty (i.e. @ref flathashtable->size == 0).
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param flathashtable         The @ref FlatHashTable to be operated on.
+ * @return                      Whether or not the @ref flathashtable is empty.
+ */
+int flathashtable_empty(const FlatHashTable *flathashtable);
+
+/**
+ * Returns whether or not the @ref key is contained in the @ref flathashtable.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   Best/Avg Case: O(1)
+ *      -   Worst Case: O(n)
+ *
+ * @param flathashtable         The @ref FlatHashTable to be operated on.
+ * @param key                   The key to be searched for.
+ * @return                      Whether or not the @ref key is contained in the @ref flathashtable.
+ */
+int flathashtable_contains_key(const FlatHashTable *flathashtable, const void *key);
+
+/**
+ * Inserts the @ref node into the @ref flathashtable. If a @ref FlatHashTableNode with the same key already
+ * exists, it will be replaced by the @ref node (the @ref node takes over its slot), and the OPTIONAL collide
+ * function will then be called.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *      -   @ref node != NULL
+ *      -   @ref node is not already in the @ref flathashtable
+ *      -   The @ref key already exists in the @ref flathashtable, or the @ref flathashtable is not full (i.e.
+ *          @ref flathashtable_size < @ref flathashtable_capacity)
+ *
+ * Time complexity:
+ *      -   Best/Avg Case: O(1)
+ *      -   Worst Case: O(n)
+ *
+ * @param flathashtable         The @ref FlatHashTable to be operated on.
+ * @param key                   The key of the @ref node.
+ * @param node                  The @ref FlatHashTableNode to be inserted.
+ */
+void flathashtable_insert(FlatHashTable *flathashtable, const void *key, FlatHashTableNode *node);
+
+/**
+ * Returns the @ref FlatHashTableNode containing the @ref key. If the @ref key does not exist, the return value
+ * will be NULL.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   Best/Avg Case: O(1)
+ *      -   Worst Case: O(n)
+ *
+ * @param flathashtable         The @ref FlatHashTable to be operated on.
+ * @param key                   The key to be searched for.
+ * @return                      The @ref FlatHashTableNode containing the @ref key, or NULL if the @ref key does
+ *                              not exist.
+ */
+FlatHashTableNode* flathashtable_lookup_key(const FlatHashTable *flathashtable, const void *key);
+
+/**
+ * Removes the @ref FlatHashTableNode containing the @ref key. If the @ref key does not exist, this function
+ * does nothing. No other @ref FlatHashTableNode changes slots.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   Best/Avg Case: O(1)
+ *      -   Worst Case: O(n)
+ *
+ * @param flathashtable         The @ref FlatHashTable to be operated on.
+ * @param key                   The key of the @ref FlatHashTableNode to be removed.
+ */
+void flathashtable_remove_key(FlatHashTable *flathashtable, const void *key);
+
+/**
+ * Removes all @ref FlatHashTableNode's in the @ref flathashtable.
+ *
+ * Requirements:
+ *      -   @ref flathashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(m), where m == number of groups in group array
+ *
+ * @param flathashtable         The @ref FlatHashTable to be operated on.
+ */
+void flathashtable_remove_all(FlatHashTable *flathashtable);
+
+/* ========================================================================================================
+ *
+ *                                                 MACROS
+ *
+ * ======================================================================================================== */
+
+/**
+ * The value an overflow counter sticks at once it is reached. From then on, the @ref FlatHashTableGroup is
+ * treated as if something always overflowed past it (until @ref flathashtable_remove_all is called).
+ */
+#define FLATHASHTABLE_MAX_OVERFLOW 255
+
+/**
+ * Initializing a @ref FlatHashTableNode before it is used is NOT required. This macro is simply for allowing
+ * you to initialize a struct (containing one or more @ref FlatHashTableNode's) with an initializer-list
+ * conveniently.
+ */
+#define FLATHASHTABLE_NODE_INIT { 0 }
+
+/**
+ * Obtains the pointer to the struct for this entry.
+ *
+ * Requirements:
+ *      -   @ref node_ptr != NULL
+ *
+ * @param node_ptr              The pointer to the @ref FlatHashTableNode in the struct.
+ * @param type                  The type of the struct the @ref FlatHashTableNode is embedded in.
+ * @param member                The name of the @ref FlatHashTableNode in the struct.
+ */
+#if defined(__GNUC__) && !defined(__STRICT_ANSI__)
+    #define flathashtable_entry(node_ptr, type, member) \
+        ({ \
+            const typeof(((type*)0)->member) *__mptr = (node_ptr); \
+            (type*) ((char*)__mptr - offsetof(type, member)); \
+        })
+#else
+    #define flathashtable_entry(node_ptr, type, member) \
+        ( \
+            (type*) ((char*)(node_ptr) - offsetof(type, member)) \
+        )
+#endif
+
+/**
+ * Evaluates to the @ref FlatHashTableNode in the slot at the @ref slot_index, or NULL if the slot is empty.
+ * Slots are numbered from 0 to @ref flathashtable_capacity - 1, group after group.
+ *
+ * Requirements:
+ *      -   @ref flathashtable_ptr != NULL
+ *      -   @ref slot_index < @ref flathashtable_capacity
+ *
+ * @param flathashtable_ptr     The pointer to a @ref FlatHashTable.
+ * @param slot_index            The index of the slot.
+ */
+#define flathashtable_slot(flathashtable_ptr, slot_index) \
+    ( \
+        (flathashtable_ptr)->group_array[(slot_index) / FLATHASHTABLE_GROUP_SIZE] \
+            .tags[(slot_index) % FLATHASHTABLE_GROUP_SIZE] ? \
+        (flathashtable_ptr)->group_array[(slot_index) / FLATHASHTABLE_GROUP_SIZE] \
+            .slots[(slot_index) % FLATHASHTABLE_GROUP_SIZE] : \
+        (FlatHashTableNode*) NULL \
+    )
+
+/**
+ * Iterates over the @ref FlatHashTable in slot order. Since removing a @ref FlatHashTableNode never moves any
+ * other @ref FlatHashTableNode, this is safe against removal of the @ref cursor_node_ptr.
+ *
+ * Requirements:
+ *      -   @ref flathashtable_ptr != NULL
+ *      -   No @ref FlatHashTableNode is inserted into the @ref FlatHashTable in the loop's body.
+ *      -   The @ref slot_index is not reassigned.
+ *
+ * @param cursor_node_ptr       The @ref FlatHashTableNode to use as a loop cursor.
+ * @param slot_index            The size_t to use to keep track of the current slot index.
+ * @param flathashtable_ptr     The pointer to a @ref FlatHashTable that will be iterated over.
+ */
+#define flathashtable_for_each(cursor_node_ptr, slot_index, flathashtable_ptr) \
+    for ( \
+        slot_index = 0; \
+        slot_index < (flathashtable_ptr)->num_groups * FLATHASHTABLE_GROUP_SIZE; \
+        ++slot_index \
+    ) \
+        if (!(cursor_node_ptr = flathashtable_slot((flathashtable_ptr), slot_index))) {} else
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FLATHASHTABLE_H */
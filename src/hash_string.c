@@ -17,10 +17,142 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
 #include <assert.h>
+#include <limits.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "hash_string.h"
 
+/* ========================================================================================================
+ *
+ *                                                  TYPES
+ *
+ * ======================================================================================================== */
+
+/* The word the word-at-a-time functions operate on: 64 bits wide if possible, otherwise 32 bits wide. */
+typedef unsigned long Word;
+
+#if ULONG_MAX > 4294967295UL
+    #define HASH_STRING_WORD_64
+
+    #define SECRET_0 0x2d358dccaa6c78a5UL
+    #define SECRET_1 0x8bb84b93962eacc9UL
+    #define SECRET_2 0x4b33a62ed433d4a3UL
+    #define SECRET_3 0x4d5a2da51de1aa47UL
+#else
+    #define SECRET_0 0x53c5ca59UL
+    #define SECRET_1 0x74743c1bUL
+#endif
+
+#if defined(HASH_STRING_WORD_64) && defined(__SIZEOF_INT128__) && defined(__SIZEOF_LONG__) && \
+    __SIZEOF_LONG__ == 8 && !defined(HASH_STRING_NO_INT128)
+    #define HASH_STRING_INT128
+#endif
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/*
+ * Replaces @ref a with the low half and @ref b with the high half of the full product of @ref a and @ref b.
+ */
+static void multiply(Word *a, Word *b);
+
+#ifdef HASH_STRING_WORD_64
+/*
+ * Returns the exclusive or of the low half and the high half of the full product of @ref a and @ref b.
+ */
+static Word mix(Word a, Word b);
+#else
+/*
+ * Replaces @ref s and @ref t with the low half and the high half of the full product of @ref s and @ref t
+ * after both are combined with a secret.
+ */
+static void mix_pair(Word *s, Word *t);
+#endif /* HASH_STRING_WORD_64 */
+
+/*
+ * Returns the 4 bytes at @ref p read in little-endian byte order.
+ */
+static Word read_4(const unsigned char *p);
+
+/*
+ * Returns the 8 bytes at @ref p read in little-endian byte order.
+ */
+#ifdef HASH_STRING_WORD_64
+static Word read_8(const unsigned char *p);
+#endif /* HASH_STRING_WORD_64 */
+
+/*
+ * Returns the first, middle and last of the @ref k bytes at @ref p (where 0 < @ref k < 4) combined.
+ */
+static Word read_1_to_3(const unsigned char *p, size_t k);
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static void multiply(Word *a, Word *b) {
+    #ifdef HASH_STRING_INT128
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 product = (uint128) *a * *b;
+
+    *a = (Word) product;
+    *b = (Word) (product >> 64);
+    #else
+    const unsigned half = sizeof(Word) * CHAR_BIT / 2;
+    const Word low_mask = ((Word) 1 << half) - 1;
+    Word a_low = *a & low_mask, a_high = *a >> half;
+    Word b_low = *b & low_mask, b_high = *b >> half;
+    Word low_low = a_low * b_low;
+    Word high_low = a_high * b_low;
+    Word low_high = a_low * b_high;
+    Word high_high = a_high * b_high;
+    Word cross = (low_low >> half) + (high_low & low_mask) + low_high;
+
+    *a = *a * *b;
+    *b = high_high + (high_low >> half) + (cross >> half);
+    #endif /* HASH_STRING_INT128 */
+}
+
+#ifdef HASH_STRING_WORD_64
+static Word mix(Word a, Word b) {
+    multiply(&a, &b);
+
+    return a ^ b;
+}
+#else
+static void mix_pair(Word *s, Word *t) {
+    *s ^= SECRET_0;
+    *t ^= SECRET_1;
+    multiply(s, t);
+}
+#endif /* HASH_STRING_WORD_64 */
+
+static Word read_4(const unsigned char *p) {
+    return (Word) p[0] | ((Word) p[1] << 8) | ((Word) p[2] << 16) | ((Word) p[3] << 24);
+}
+
+#ifdef HASH_STRING_WORD_64
+static Word read_8(const unsigned char *p) {
+    return read_4(p) | (read_4(p + 4) << 32);
+}
+#endif /* HASH_STRING_WORD_64 */
+
+static Word read_1_to_3(const unsigned char *p, size_t k) {
+    return ((Word) p[0] << 16) | ((Word) p[k >> 1] << 8) | (Word) p[k - 1];
+}
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
 size_t hash_string(const void *string) {
     const char *str = (const char*) string;
     register size_t hash = 5381;
@@ -33,3 +165,106 @@ size_t hash_string(const void *string) {
 
     return hash;
 }
+
+size_t hash_string_fast(const void *string) {
+    assert(string);
+
+    return hash_bytes(string, strlen((const char*) string));
+}
+
+size_t hash_bytes(const void *bytes, size_t length) {
+    return hash_bytes_seeded(bytes, length, 0);
+}
+
+#ifdef HASH_STRING_WORD_64
+
+size_t hash_bytes_seeded(const void *bytes, size_t length, size_t seed) {
+    const unsigned char *p = (const unsigned char*) bytes;
+    Word s = (Word) seed, a, b;
+
+    assert(bytes || length == 0);
+
+    s ^= mix(s ^ SECRET_0, SECRET_1);
+
+    if (length <= 16) {
+        if (length >= 4) {
+            size_t offset = (length >> 3) << 2;
+
+            a = (read_4(p) << 32) | read_4(p + offset);
+            b = (read_4(p + length - 4) << 32) | read_4(p + length - 4 - offset);
+        } else if (length > 0) {
+            a = read_1_to_3(p, length);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = length;
+
+        /* Three independent multiplication chains keep the multiplier busy on long inputs. */
+        if (i > 48) {
+            Word s1 = s, s2 = s;
+
+            do {
+                s = mix(read_8(p) ^ SECRET_1, read_8(p + 8) ^ s);
+                s1 = mix(read_8(p + 16) ^ SECRET_2, read_8(p + 24) ^ s1);
+                s2 = mix(read_8(p + 32) ^ SECRET_3, read_8(p + 40) ^ s2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+
+            s ^= s1 ^ s2;
+        }
+
+        while (i > 16) {
+            s = mix(read_8(p) ^ SECRET_1, read_8(p + 8) ^ s);
+            p += 16;
+            i -= 16;
+        }
+
+        /* The last 16 bytes are read even if they overlap bytes that were already consumed. */
+        a = read_8(p + i - 16);
+        b = read_8(p + i - 8);
+    }
+
+    a ^= SECRET_1;
+    b ^= s;
+    multiply(&a, &b);
+
+    return (size_t) mix(a ^ SECRET_0 ^ (Word) length, b ^ SECRET_1);
+}
+
+#else
+
+size_t hash_bytes_seeded(const void *bytes, size_t length, size_t seed) {
+    const unsigned char *p = (const unsigned char*) bytes;
+    Word s = (Word) seed, t = (Word) length;
+    size_t i;
+
+    assert(bytes || length == 0);
+
+    /* Both shifts are well-defined even if size_t is only 32 bits wide. */
+    s ^= (Word) (seed >> 16 >> 16);
+    t ^= (Word) (length >> 16 >> 16);
+    mix_pair(&s, &t);
+
+    for (i = length; i > 8; i -= 8, p += 8) {
+        s ^= read_4(p);
+        t ^= read_4(p + 4);
+        mix_pair(&s, &t);
+    }
+
+    if (i >= 4) {
+        s ^= read_4(p);
+        t ^= read_4(p + i - 4);
+    } else if (i > 0) {
+        s ^= read_1_to_3(p, i);
+    }
+
+    mix_pair(&s, &t);
+    mix_pair(&s, &t);
+
+    return (size_t) (s ^ t);
+}
+
+#endif /* HASH_STRING_WORD_64 */
@@ -18,11 +18,35 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 /**
  * @file    hash_string.h
- * @brief   DJB2 HASH STRING FUNCTION
+ * @brief   HASH STRING FUNCTIONS
+ *
+ * @ref hash_string is the classic djb2 algorithm, which consumes one byte at a time. @ref hash_bytes and
+ * @ref hash_bytes_seeded are length-aware functions in the style of wyhash: they consume the input one machine
+ * word at a time and mix it with wide multiplications, which is both much faster and of much higher quality
+ * than djb2. @ref hash_string_fast adapts @ref hash_bytes to NUL-terminated strings, so that it can be used
+ * as the hash function of a hash table directly.
+ *
+ * If unsigned long is at least 64 bits wide, 64-bit words are used (with a native 128-bit multiplication if
+ * the compiler provides one and HASH_STRING_NO_INT128 is not defined, and a portable emulation otherwise).
+ * Otherwise 32-bit words are used. Words are always read in little-endian byte order, so the hashcodes of the
+ * word-at-a-time functions only depend on the word size, not on the endianness or alignment requirements of
+ * the platform.
+ *
+ * The seeded variant should be used with a secret, randomly chosen seed whenever the keys can be chosen by an
+ * attacker, so that the attacker cannot predict which keys collide.
  *
  * Dependencies:
  *      -   C89 assert.h
+ *      -   C89 limits.h
  *      -   C89 stddef.h
+ *      -   C89 string.h
+ *
+ * API:
+ *      ====  FUNCTIONS  ====
+ *      -   hash_string
+ *      -   hash_string_fast
+ *      -   hash_bytes
+ *      -   hash_bytes_seeded
  */
 
 #ifndef HASH_STRING_H
@@ -48,6 +72,52 @@ extern "C" {
  */
 size_t hash_string(const void *string);
 
+/**
+ * Returns the hash of the @ref string using @ref hash_bytes on the characters before the NUL terminator.
+ *
+ * Requirements:
+ *      -   @ref string != NULL
+ *
+ * Time complexity:
+ *      -   O(n), where n == length of string
+ *
+ * @param string                The string used for generating a hash.
+ * @return                      The hash of the @ref string.
+ */
+size_t hash_string_fast(const void *string);
+
+/**
+ * Returns the hash of the first @ref length bytes of the @ref bytes. Equivalent to calling
+ * @ref hash_bytes_seeded with a seed of 0.
+ *
+ * Requirements:
+ *      -   @ref bytes != NULL, or @ref length == 0
+ *
+ * Time complexity:
+ *      -   O(n), where n == @ref length
+ *
+ * @param bytes                 The bytes used for generating a hash. They do NOT need to be aligned.
+ * @param length                The number of bytes.
+ * @return                      The hash of the @ref bytes.
+ */
+size_t hash_bytes(const void *bytes, size_t length);
+
+/**
+ * Returns the hash of the first @ref length bytes of the @ref bytes, where the hash depends on the @ref seed.
+ *
+ * Requirements:
+ *      -   @ref bytes != NULL, or @ref length == 0
+ *
+ * Time complexity:
+ *      -   O(n), where n == @ref length
+ *
+ * @param bytes                 The bytes used for generating a hash. They do NOT need to be aligned.
+ * @param length                The number of bytes.
+ * @param seed                  The seed of the hash.
+ * @return                      The hash of the @ref bytes.
+ */
+size_t hash_bytes_seeded(const void *bytes, size_t length, size_t seed);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -17,10 +17,427 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
 #include <assert.h>
+#include <limits.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "hashtable.h"
 
+#if defined(__GNUC__)
+    #define PREFETCH(address) __builtin_prefetch(address)
+#else
+    #define PREFETCH(address) ((void) 0)
+#endif
+
+/* The word and the mask of the bit of bucket @ref index in an occupancy bitmap. */
+#define OCCUPANCY_WORD(index) ((index) / HASHTABLE_OCCUPANCY_WORD_BITS)
+#define OCCUPANCY_MASK(index) (1UL << ((index) % HASHTABLE_OCCUPANCY_WORD_BITS))
+
+/* Identifies a snapshot written by hashtable_serialize (the ASCII of "HTS1"). */
+#define SNAPSHOT_MAGIC_NUMBER ((size_t) 0x48545331UL)
+
+/* The fields of the header of a snapshot, each a size_t. The bucket array follows, then the arena. */
+enum {
+    SNAPSHOT_MAGIC,
+    SNAPSHOT_NODE_SIZE,
+    SNAPSHOT_ALIGNMENT,
+    SNAPSHOT_NUM_BUCKETS,
+    SNAPSHOT_SIZE,
+    SNAPSHOT_REDUCTION,
+    SNAPSHOT_ARENA_SIZE,
+    SNAPSHOT_NUM_FIELDS
+};
+
+/* Fails to compile if a link of a snapshot, which replaces a pointer, does not fit into one. */
+typedef char hashtable_snapshot_link_check[sizeof(ptrdiff_t) <= sizeof(HashTableNode*) ? 1 : -1];
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/*
+ * Returns the high half of the full product of @ref a and @ref b.
+ */
+static size_t multiply_high(size_t a, size_t b);
+
+/*
+ * Returns the index of the bucket that the @ref hash maps to in a bucket array of @ref num_buckets buckets,
+ * using the @ref reduction.
+ */
+static size_t reduce_hash(HashTableReduction reduction, size_t hash, size_t num_buckets);
+
+/*
+ * Returns the index of the bucket that the @ref hash maps to in a bucket array of @ref num_buckets buckets of
+ * the @ref hashtable.
+ */
+static size_t bucket_index(const HashTable *hashtable, size_t hash, size_t num_buckets);
+
+/*
+ * Returns whether or not the @ref key, whose hashcode is @ref hash, is equal to the key of the @ref node. If
+ * HASHTABLE_STORE_HASH is defined, the stored hashcode of the @ref node is compared first.
+ */
+static int node_equal(const HashTable *hashtable, const void *key, size_t hash, const HashTableNode *node);
+
+/*
+ * Returns the link (the bucket, or the "next" member of the previous @ref HashTableNode) to the first
+ * @ref HashTableNode in the chain starting at @ref link whose key is equal to the @ref key, whose hashcode is
+ * @ref hash, or NULL if there is none.
+ */
+static HashTableNode** chain_find(const HashTable *hashtable, HashTableNode **link, const void *key, size_t hash);
+
+#ifdef CDSA_STATS
+/*
+ * Adds a walk of a chain that looked at @ref probe_length @ref HashTableNode's to the counters of the
+ * @ref hashtable.
+ */
+static void record_chain_walk(const HashTable *hashtable, size_t probe_length);
+#endif /* CDSA_STATS */
+
+/*
+ * Returns the index of the lowest set bit of the @ref word, which must NOT be 0.
+ */
+static size_t lowest_bit(unsigned long word);
+
+/*
+ * Returns the index of the first set bit NOT less than @ref index in the @ref occupancy bitmap of a bucket array
+ * with @ref num_buckets buckets, or @ref num_buckets if there is none.
+ */
+static size_t find_occupied(const unsigned long *occupancy, size_t index, size_t num_buckets);
+
+/*
+ * Empties every bucket of the @ref bucket_array whose bit is set in the @ref occupancy bitmap, and clears the
+ * bitmap.
+ */
+static void clear_occupied(HashTableNode **bucket_array, unsigned long *occupancy, size_t num_buckets);
+
+/*
+ * Moves every @ref HashTableNode in the bucket at @ref index of the old bucket array of the @ref hashtable into
+ * the bucket array of the @ref hashtable.
+ */
+static void migrate_bucket(HashTable *hashtable, size_t index);
+
+/*
+ * Stops using the old bucket array of the @ref hashtable.
+ */
+static void end_rehash(HashTable *hashtable);
+
+#ifndef HASHTABLE_NO_ATOMICS
+/*
+ * Locks the stripe of the bucket at @ref index of the @ref concurrenthashtable, spinning until it is free.
+ */
+static void lock_stripe(ConcurrentHashTable *concurrenthashtable, size_t index);
+
+/*
+ * Unlocks the stripe of the bucket at @ref index of the @ref concurrenthashtable.
+ */
+static void unlock_stripe(ConcurrentHashTable *concurrenthashtable, size_t index);
+#endif /* HASHTABLE_NO_ATOMICS */
+
+/*
+ * Returns the offset of the copy of the arena from the start of a snapshot with @ref num_buckets buckets.
+ */
+static size_t snapshot_arena_offset(size_t num_buckets);
+
+/*
+ * Writes the @ref value into the header field (or bucket) at @ref index of the snapshot in the @ref buffer.
+ */
+static void write_field(char *buffer, size_t index, size_t value);
+
+/*
+ * Returns the header field (or bucket) at @ref index of the snapshot in the @ref buffer.
+ */
+static size_t read_field(const char *buffer, size_t index);
+
+/*
+ * Writes the offset from the @ref link, which lies in the @ref arena, to the @ref target (0 if NULL) into the
+ * same place of the @ref image_arena.
+ */
+static void write_link(char *image_arena, const char *arena, const void *link, const void *target);
+
+/*
+ * Returns the @ref HashTableNode the @ref link of a snapshot points to, or NULL.
+ */
+static const HashTableNode* read_link(const void *link);
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static size_t multiply_high(size_t a, size_t b) {
+    #if defined(__SIZEOF_INT128__) && defined(__SIZEOF_SIZE_T__) && __SIZEOF_SIZE_T__ == 8
+    __extension__ typedef unsigned __int128 uint128;
+
+    return (size_t) (((uint128) a * b) >> 64);
+    #else
+    const size_t half = sizeof(size_t) * CHAR_BIT / 2;
+    const size_t low_mask = ((size_t) 1 << half) - 1;
+    size_t a_low = a & low_mask, a_high = a >> half;
+    size_t b_low = b & low_mask, b_high = b >> half;
+    size_t low_low = a_low * b_low;
+    size_t high_low = a_high * b_low;
+    size_t low_high = a_low * b_high;
+    size_t high_high = a_high * b_high;
+    size_t cross = (low_low >> half) + (high_low & low_mask) + low_high;
+
+    return high_high + (high_low >> half) + (cross >> half);
+    #endif
+}
+
+static size_t reduce_hash(HashTableReduction reduction, size_t hash, size_t num_buckets) {
+    assert(num_buckets > 0);
+
+    switch (reduction) {
+        case HASHTABLE_REDUCTION_MASK:
+            return hash & (num_buckets - 1);
+        case HASHTABLE_REDUCTION_MULTIPLY_SHIFT:
+            return multiply_high(hash, num_buckets);
+        default:
+            return hash % num_buckets;
+    }
+}
+
+static size_t bucket_index(const HashTable *hashtable, size_t hash, size_t num_buckets) {
+    assert(hashtable);
+
+    return reduce_hash(hashtable->reduction, hash, num_buckets);
+}
+
+static int node_equal(const HashTable *hashtable, const void *key, size_t hash, const HashTableNode *node) {
+    assert(hashtable && node);
+
+    #ifdef HASHTABLE_STORE_HASH
+    if (node->hash != hash) {
+        return 0;
+    }
+    #else
+    (void) hash;
+    #endif /* HASHTABLE_STORE_HASH */
+
+    #ifdef CDSA_STATS
+    ++((HashTable*) hashtable)->stats.num_equal_calls;
+    #endif /* CDSA_STATS */
+
+    return hashtable->equal(key, node);
+}
+
+static HashTableNode** chain_find(const HashTable *hashtable, HashTableNode **link, const void *key, size_t hash) {
+    #ifdef CDSA_STATS
+    size_t probe_length = 0;
+    #endif /* CDSA_STATS */
+
+    while (*link && !node_equal(hashtable, key, hash, *link)) {
+        link = &(*link)->next;
+
+        #ifdef CDSA_STATS
+        ++probe_length;
+        #endif /* CDSA_STATS */
+    }
+
+    #ifdef CDSA_STATS
+    record_chain_walk(hashtable, *link ? probe_length + 1 : probe_length);
+    #endif /* CDSA_STATS */
+
+    return *link ? link : NULL;
+}
+
+#ifdef CDSA_STATS
+static void record_chain_walk(const HashTable *hashtable, size_t probe_length) {
+    HashTableStats *stats;
+
+    assert(hashtable);
+
+    /* The counters are not part of the logical state of the hash table, so lookups update them as well. */
+    stats = &((HashTable*) hashtable)->stats;
+
+    ++stats->num_chain_walks;
+    ++stats->probe_length_histogram[
+        probe_length < HASHTABLE_STATS_HISTOGRAM_SIZE ? probe_length : HASHTABLE_STATS_HISTOGRAM_SIZE - 1
+    ];
+
+    if (probe_length > stats->max_probe_length) {
+        stats->max_probe_length = probe_length;
+    }
+}
+#endif /* CDSA_STATS */
+
+static size_t lowest_bit(unsigned long word) {
+    #if defined(__GNUC__)
+    assert(word != 0);
+
+    return (size_t) __builtin_ctzl(word);
+    #else
+    size_t index = 0;
+
+    assert(word != 0);
+
+    while (!(word & 1UL)) {
+        word >>= 1;
+        ++index;
+    }
+
+    return index;
+    #endif
+}
+
+static size_t find_occupied(const unsigned long *occupancy, size_t index, size_t num_buckets) {
+    size_t word_index, num_words;
+    unsigned long word;
+
+    assert(occupancy);
+
+    if (index >= num_buckets) {
+        return num_buckets;
+    }
+
+    word_index = OCCUPANCY_WORD(index);
+    num_words = HASHTABLE_OCCUPANCY_WORDS(num_buckets);
+
+    /* Mask off the buckets before the index in its own word. */
+    word = occupancy[word_index] & ~(OCCUPANCY_MASK(index) - 1);
+
+    while (!word) {
+        if (++word_index == num_words) {
+            return num_buckets;
+        }
+
+        word = occupancy[word_index];
+    }
+
+    return word_index * HASHTABLE_OCCUPANCY_WORD_BITS + lowest_bit(word);
+}
+
+static void clear_occupied(HashTableNode **bucket_array, unsigned long *occupancy, size_t num_buckets) {
+    size_t i, num_words;
+    unsigned long word;
+
+    assert(bucket_array && occupancy);
+
+    num_words = HASHTABLE_OCCUPANCY_WORDS(num_buckets);
+
+    for (i = 0; i < num_words; ++i) {
+        for (word = occupancy[i]; word; word &= word - 1) {
+            bucket_array[i * HASHTABLE_OCCUPANCY_WORD_BITS + lowest_bit(word)] = NULL;
+        }
+
+        occupancy[i] = 0;
+    }
+}
+
+static void migrate_bucket(HashTable *hashtable, size_t index) {
+    HashTableNode *n, *next;
+
+    assert(hashtable && hashtable->old_bucket_array && index < hashtable->old_num_buckets);
+
+    for (n = hashtable->old_bucket_array[index]; n; n = next) {
+        size_t new_index;
+
+        next = n->next;
+        #ifdef HASHTABLE_STORE_HASH
+        new_index = bucket_index(hashtable, n->hash, hashtable->num_buckets);
+        #else
+        new_index = bucket_index(hashtable, hashtable->hash(hashtable->key(n)), hashtable->num_buckets);
+        #endif /* HASHTABLE_STORE_HASH */
+
+        n->next = hashtable->bucket_array[new_index];
+        hashtable->bucket_array[new_index] = n;
+
+        if (hashtable->occupancy) {
+            hashtable->occupancy[OCCUPANCY_WORD(new_index)] |= OCCUPANCY_MASK(new_index);
+        }
+    }
+
+    hashtable->old_bucket_array[index] = NULL;
+
+    if (hashtable->old_occupancy) {
+        hashtable->old_occupancy[OCCUPANCY_WORD(index)] &= ~OCCUPANCY_MASK(index);
+    }
+}
+
+static void end_rehash(HashTable *hashtable) {
+    assert(hashtable);
+
+    hashtable->old_bucket_array = NULL;
+    hashtable->key = NULL;
+    hashtable->old_num_buckets = 0;
+    hashtable->rehash_index = 0;
+    hashtable->old_occupancy = NULL;
+}
+
+#ifndef HASHTABLE_NO_ATOMICS
+static void lock_stripe(ConcurrentHashTable *concurrenthashtable, size_t index) {
+    int *locked;
+
+    assert(concurrenthashtable);
+
+    locked = &concurrenthashtable->lock_array[index % concurrenthashtable->num_locks].locked;
+
+    /* Spin on a plain load so that waiting writers do not keep stealing the cache line from each other. */
+    while (__atomic_exchange_n(locked, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(locked, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void unlock_stripe(ConcurrentHashTable *concurrenthashtable, size_t index) {
+    int *locked;
+
+    assert(concurrenthashtable);
+
+    locked = &concurrenthashtable->lock_array[index % concurrenthashtable->num_locks].locked;
+    __atomic_store_n(locked, 0, __ATOMIC_RELEASE);
+}
+#endif /* HASHTABLE_NO_ATOMICS */
+
+static size_t snapshot_arena_offset(size_t num_buckets) {
+    size_t offset = (SNAPSHOT_NUM_FIELDS + num_buckets) * sizeof(size_t);
+
+    return (offset + HASHTABLE_SNAPSHOT_ALIGNMENT - 1) / HASHTABLE_SNAPSHOT_ALIGNMENT * HASHTABLE_SNAPSHOT_ALIGNMENT;
+}
+
+static void write_field(char *buffer, size_t index, size_t value) {
+    assert(buffer);
+
+    memcpy(buffer + index * sizeof(size_t), &value, sizeof(size_t));
+}
+
+static size_t read_field(const char *buffer, size_t index) {
+    size_t value;
+
+    assert(buffer);
+
+    memcpy(&value, buffer + index * sizeof(size_t), sizeof(size_t));
+
+    return value;
+}
+
+static void write_link(char *image_arena, const char *arena, const void *link, const void *target) {
+    ptrdiff_t offset = target ? (const char*) target - (const char*) link : 0;
+
+    assert(image_arena && arena && link);
+
+    memcpy(image_arena + ((const char*) link - arena), &offset, sizeof(ptrdiff_t));
+}
+
+static const HashTableNode* read_link(const void *link) {
+    ptrdiff_t offset;
+
+    assert(link);
+
+    memcpy(&offset, link, sizeof(ptrdiff_t));
+
+    return offset ? (const HashTableNode*) ((const char*) link + offset) : NULL;
+}
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
 void hashtable_init(
     HashTable *hashtable,
     HashTableNode **bucket_array,
@@ -45,6 +462,14 @@ void hashtable_init(
     hashtable->bucket_array = bucket_array;
     hashtable->num_buckets = num_buckets;
     hashtable->size = 0;
+    hashtable->reduction = HASHTABLE_REDUCTION_MODULO;
+    hashtable->occupancy = NULL;
+
+    #ifdef CDSA_STATS
+    hashtable_reset_stats(hashtable);
+    #endif /* CDSA_STATS */
+
+    end_rehash(hashtable);
 }
 
 void hashtable_fast_init(
@@ -74,6 +499,45 @@ void hashtable_fast_init(
     hashtable->bucket_array = bucket_array;
     hashtable->num_buckets = num_buckets;
     hashtable->size = 0;
+    hashtable->reduction = HASHTABLE_REDUCTION_MODULO;
+    hashtable->occupancy = NULL;
+
+    #ifdef CDSA_STATS
+    hashtable_reset_stats(hashtable);
+    #endif /* CDSA_STATS */
+
+    end_rehash(hashtable);
+}
+
+void hashtable_set_reduction(HashTable *hashtable, HashTableReduction reduction) {
+    assert(hashtable && hashtable->size == 0 && !hashtable->old_bucket_array);
+    assert(reduction != HASHTABLE_REDUCTION_MASK || (hashtable->num_buckets & (hashtable->num_buckets - 1)) == 0);
+
+    hashtable->reduction = reduction;
+}
+
+void hashtable_set_occupancy(HashTable *hashtable, unsigned long *occupancy) {
+    size_t i, num_words;
+
+    assert(hashtable);
+
+    hashtable->occupancy = occupancy;
+
+    if (!occupancy) {
+        return;
+    }
+
+    num_words = HASHTABLE_OCCUPANCY_WORDS(hashtable->num_buckets);
+
+    for (i = 0; i < num_words; ++i) {
+        occupancy[i] = 0;
+    }
+
+    for (i = 0; i < hashtable->num_buckets; ++i) {
+        if (hashtable->bucket_array[i]) {
+            occupancy[OCCUPANCY_WORD(i)] |= OCCUPANCY_MASK(i);
+        }
+    }
 }
 
 HashTableNode** hashtable_bucket_array(const HashTable *hashtable) {
@@ -88,6 +552,12 @@ size_t hashtable_num_buckets(const HashTable *hashtable) {
     return hashtable->num_buckets;
 }
 
+HashTableReduction hashtable_reduction(const HashTable *hashtable) {
+    assert(hashtable);
+
+    return hashtable->reduction;
+}
+
 size_t hashtable_size(const HashTable *hashtable) {
     assert(hashtable);
 
@@ -107,72 +577,177 @@ int hashtable_contains_key(const HashTable *hashtable, const void *key) {
 }
 
 void hashtable_insert(HashTable *hashtable, const void *key, HashTableNode *node) {
-    HashTableNode **bucket, *n, *prev;
+    HashTableNode **bucket, **link, *n;
+    size_t hash, index;
 
     assert(hashtable && node);
 
-    bucket = hashtable->bucket_array + hashtable->hash(key) % hashtable->num_buckets;
+    hash = hashtable->hash(key);
 
-    for (n = *bucket, prev = NULL; n; prev = n, n = n->next) {
-        if (hashtable->equal(key, n)) {
-            if (prev) {
-                prev->next = node;
-            } else {
-                *bucket = node;
-            }
+    if (hashtable->old_bucket_array) {
+        /* Migrating the bucket of the key first guarantees that the key can only be in the new bucket array. */
+        migrate_bucket(hashtable, bucket_index(hashtable, hash, hashtable->old_num_buckets));
+        hashtable_rehash_step(hashtable, HASHTABLE_REHASH_STEP);
+    }
 
-            node->next = n->next;
-            n->next = HASHTABLE_POISON_NEXT;
+    index = bucket_index(hashtable, hash, hashtable->num_buckets);
+    bucket = hashtable->bucket_array + index;
 
-            if (hashtable->collide) {
-                hashtable->collide(n, node, hashtable->auxiliary_data);
-            }
+    #ifdef HASHTABLE_STORE_HASH
+    node->hash = hash;
+    #endif /* HASHTABLE_STORE_HASH */
 
-            return;
+    link = chain_find(hashtable, bucket, key, hash);
+
+    if (link) {
+        n = *link;
+        *link = node;
+        node->next = n->next;
+        n->next = HASHTABLE_POISON_NEXT;
+
+        #ifdef CDSA_STATS
+        ++hashtable->stats.num_collisions;
+        #endif /* CDSA_STATS */
+
+        if (hashtable->collide) {
+            hashtable->collide(n, node, hashtable->auxiliary_data);
         }
+
+        return;
     }
 
     node->next = *bucket;
     *bucket = node;
 
+    if (hashtable->occupancy) {
+        hashtable->occupancy[OCCUPANCY_WORD(index)] |= OCCUPANCY_MASK(index);
+    }
+
     ++hashtable->size;
 }
 
 HashTableNode* hashtable_lookup_key(const HashTable *hashtable, const void *key) {
-    HashTableNode *n;
+    HashTableNode **link;
+    size_t hash;
 
     assert(hashtable);
 
-    n = hashtable->bucket_array[hashtable->hash(key) % hashtable->num_buckets];
+    hash = hashtable->hash(key);
 
-    while (n && !hashtable->equal(key, n)) {
-        n = n->next;
+    if (hashtable->old_bucket_array) {
+        link = hashtable->old_bucket_array + bucket_index(hashtable, hash, hashtable->old_num_buckets);
+        link = chain_find(hashtable, link, key, hash);
+
+        if (link) {
+            return *link;
+        }
     }
 
-    return n;
+    link = hashtable->bucket_array + bucket_index(hashtable, hash, hashtable->num_buckets);
+    link = chain_find(hashtable, link, key, hash);
+
+    return link ? *link : NULL;
+}
+
+void hashtable_lookup_keys_batch(
+    const HashTable *hashtable,
+    const void *const *keys,
+    size_t num_keys,
+    HashTableNode **results
+) {
+    size_t hashes[HASHTABLE_BATCH_SIZE];
+    HashTableNode **buckets[HASHTABLE_BATCH_SIZE];
+    HashTableNode **old_buckets[HASHTABLE_BATCH_SIZE];
+    size_t begin;
+
+    assert(hashtable && ((keys && results) || num_keys == 0));
+
+    for (begin = 0; begin < num_keys; begin += HASHTABLE_BATCH_SIZE) {
+        size_t end = num_keys - begin < HASHTABLE_BATCH_SIZE ? num_keys : begin + HASHTABLE_BATCH_SIZE;
+        size_t i;
+
+        /* Hash every key of the chunk, and prefetch the buckets. */
+        for (i = begin; i < end; ++i) {
+            size_t hash = hashtable->hash(keys[i]);
+
+            hashes[i - begin] = hash;
+            buckets[i - begin] = hashtable->bucket_array + bucket_index(hashtable, hash, hashtable->num_buckets);
+            PREFETCH(buckets[i - begin]);
+
+            if (hashtable->old_bucket_array) {
+                old_buckets[i - begin] =
+                    hashtable->old_bucket_array + bucket_index(hashtable, hash, hashtable->old_num_buckets);
+                PREFETCH(old_buckets[i - begin]);
+            }
+        }
+
+        /* Prefetch the first HashTableNode of every bucket. */
+        for (i = begin; i < end; ++i) {
+            if (*buckets[i - begin]) {
+                PREFETCH(*buckets[i - begin]);
+            }
+
+            if (hashtable->old_bucket_array && *old_buckets[i - begin]) {
+                PREFETCH(*old_buckets[i - begin]);
+            }
+        }
+
+        /* Walk the chains. */
+        for (i = begin; i < end; ++i) {
+            HashTableNode **link = NULL;
+
+            if (hashtable->old_bucket_array) {
+                link = chain_find(hashtable, old_buckets[i - begin], keys[i], hashes[i - begin]);
+            }
+
+            if (!link) {
+                link = chain_find(hashtable, buckets[i - begin], keys[i], hashes[i - begin]);
+            }
+
+            results[i] = link ? *link : NULL;
+        }
+    }
 }
 
 void hashtable_remove_key(HashTable *hashtable, const void *key) {
-    HashTableNode **bucket, *n, *prev;
+    HashTableNode **bucket, **link, *n;
+    unsigned long *occupancy;
+    size_t hash, index;
 
     assert(hashtable);
 
-    bucket = hashtable->bucket_array + hashtable->hash(key) % hashtable->num_buckets;
+    hash = hashtable->hash(key);
 
-    for (n = *bucket, prev = NULL; n; prev = n, n = n->next) {
-        if (hashtable->equal(key, n)) {
-            if (prev) {
-                prev->next = n->next;
-            } else {
-                *bucket = n->next;
-            }
+    /*
+     * Removal does not migrate any buckets, so that removing the cursor of a traversal never moves the
+     * HashTableNode's that have yet to be visited.
+     */
+    link = NULL;
 
-            n->next = HASHTABLE_POISON_NEXT;
+    if (hashtable->old_bucket_array) {
+        index = bucket_index(hashtable, hash, hashtable->old_num_buckets);
+        bucket = hashtable->old_bucket_array + index;
+        occupancy = hashtable->old_occupancy;
+        link = chain_find(hashtable, bucket, key, hash);
+    }
 
-            --hashtable->size;
+    if (!link) {
+        index = bucket_index(hashtable, hash, hashtable->num_buckets);
+        bucket = hashtable->bucket_array + index;
+        occupancy = hashtable->occupancy;
+        link = chain_find(hashtable, bucket, key, hash);
+    }
 
-            return;
+    if (link) {
+        n = *link;
+        *link = n->next;
+        n->next = HASHTABLE_POISON_NEXT;
+
+        if (occupancy && !*bucket) {
+            occupancy[OCCUPANCY_WORD(index)] &= ~OCCUPANCY_MASK(index);
         }
+
+        --hashtable->size;
     }
 }
 
@@ -181,13 +756,534 @@ void hashtable_remove_all(HashTable *hashtable) {
 
     assert(hashtable);
 
+    if (hashtable->old_bucket_array) {
+        if (hashtable->old_occupancy) {
+            clear_occupied(hashtable->old_bucket_array, hashtable->old_occupancy, hashtable->old_num_buckets);
+        } else {
+            for (i = hashtable->rehash_index; i < hashtable->old_num_buckets; ++i) {
+                hashtable->old_bucket_array[i] = NULL;
+            }
+        }
+
+        end_rehash(hashtable);
+    }
+
     if (hashtable->size == 0) {
         return;
     }
 
-    for (i = 0; i < hashtable->num_buckets; ++i) {
-        hashtable->bucket_array[i] = NULL;
+    if (hashtable->occupancy) {
+        clear_occupied(hashtable->bucket_array, hashtable->occupancy, hashtable->num_buckets);
+    } else {
+        for (i = 0; i < hashtable->num_buckets; ++i) {
+            hashtable->bucket_array[i] = NULL;
+        }
     }
 
     hashtable->size = 0;
 }
+
+int hashtable_rehashing(const HashTable *hashtable) {
+    assert(hashtable);
+
+    return hashtable->old_bucket_array != NULL;
+}
+
+void hashtable_begin_rehash(
+    HashTable *hashtable,
+    HashTableNode **bucket_array,
+    size_t num_buckets,
+    const void* (*key)(const HashTableNode *node)
+) {
+    assert(hashtable && bucket_array && num_buckets > 0 && bucket_array != hashtable->bucket_array);
+    assert(hashtable->reduction != HASHTABLE_REDUCTION_MASK || (num_buckets & (num_buckets - 1)) == 0);
+    #ifndef HASHTABLE_STORE_HASH
+    assert(key);
+    #endif /* HASHTABLE_STORE_HASH */
+
+    #ifndef NDEBUG
+    {
+        size_t i;
+        for (i = 0; i < num_buckets; ++i) {
+            assert(!bucket_array[i]);
+        }
+    }
+    #endif /* NDEBUG */
+
+    hashtable_finish_rehash(hashtable);
+
+    hashtable->old_bucket_array = hashtable->bucket_array;
+    hashtable->key = key;
+    hashtable->old_num_buckets = hashtable->num_buckets;
+    hashtable->rehash_index = 0;
+    hashtable->old_occupancy = hashtable->occupancy;
+    hashtable->bucket_array = bucket_array;
+    hashtable->num_buckets = num_buckets;
+    hashtable->occupancy = NULL;
+}
+
+int hashtable_rehash_step(HashTable *hashtable, size_t num_buckets) {
+    assert(hashtable);
+
+    if (!hashtable->old_bucket_array) {
+        return 0;
+    }
+
+    while (num_buckets-- > 0 && hashtable->rehash_index < hashtable->old_num_buckets) {
+        migrate_bucket(hashtable, hashtable->rehash_index++);
+    }
+
+    if (hashtable->rehash_index == hashtable->old_num_buckets) {
+        end_rehash(hashtable);
+
+        return 0;
+    }
+
+    return 1;
+}
+
+void hashtable_finish_rehash(HashTable *hashtable) {
+    assert(hashtable);
+
+    hashtable_rehash_step(hashtable, (size_t) -1);
+}
+
+HashTableNode* hashtable_possible_first(const HashTable *hashtable, const void *key) {
+    size_t hash;
+
+    assert(hashtable);
+
+    hash = hashtable->hash(key);
+
+    if (hashtable->old_bucket_array) {
+        HashTableNode *n = hashtable->old_bucket_array[bucket_index(hashtable, hash, hashtable->old_num_buckets)];
+
+        if (n) {
+            return n;
+        }
+    }
+
+    return hashtable->bucket_array[bucket_index(hashtable, hash, hashtable->num_buckets)];
+}
+
+HashTableNode* hashtable_possible_next(const HashTable *hashtable, const void *key, const HashTableNode *node) {
+    assert(hashtable && node);
+
+    if (node->next) {
+        return node->next;
+    }
+
+    if (hashtable->old_bucket_array) {
+        size_t hash = hashtable->hash(key);
+        HashTableNode *n = hashtable->old_bucket_array[bucket_index(hashtable, hash, hashtable->old_num_buckets)];
+
+        /* The old bucket is traversed first, so the new bucket follows the tail of the old bucket. */
+        if (n) {
+            while (n->next) {
+                n = n->next;
+            }
+
+            if (n == node) {
+                return hashtable->bucket_array[bucket_index(hashtable, hash, hashtable->num_buckets)];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+size_t hashtable_next_occupied(const HashTable *hashtable, size_t first_index) {
+    size_t index;
+
+    assert(hashtable);
+
+    if (first_index < hashtable->num_buckets) {
+        if (!hashtable->occupancy) {
+            return first_index;
+        }
+
+        index = find_occupied(hashtable->occupancy, first_index, hashtable->num_buckets);
+
+        if (index < hashtable->num_buckets) {
+            return index;
+        }
+
+        first_index = hashtable->num_buckets;
+    }
+
+    if (!hashtable->old_occupancy) {
+        return first_index < hashtable->num_buckets + hashtable->old_num_buckets ?
+            first_index : hashtable->num_buckets + hashtable->old_num_buckets;
+    }
+
+    return hashtable->num_buckets +
+        find_occupied(hashtable->old_occupancy, first_index - hashtable->num_buckets, hashtable->old_num_buckets);
+}
+
+#ifdef CDSA_STATS
+
+void hashtable_stats(const HashTable *hashtable, HashTableStats *stats) {
+    assert(hashtable && stats);
+
+    *stats = hashtable->stats;
+}
+
+void hashtable_reset_stats(HashTable *hashtable) {
+    size_t i;
+
+    assert(hashtable);
+
+    hashtable->stats.num_chain_walks = 0;
+    hashtable->stats.num_equal_calls = 0;
+    hashtable->stats.num_collisions = 0;
+    hashtable->stats.max_probe_length = 0;
+
+    for (i = 0; i < HASHTABLE_STATS_HISTOGRAM_SIZE; ++i) {
+        hashtable->stats.probe_length_histogram[i] = 0;
+    }
+}
+
+#endif /* CDSA_STATS */
+
+size_t hashtable_serialize(const HashTable *hashtable, const void *arena, size_t arena_size, void *buffer) {
+    const char *arena_begin = (const char*) arena;
+    char *image = (char*) buffer, *image_arena;
+    const HashTableNode *n;
+    size_t arena_offset, i;
+
+    assert(hashtable && !hashtable_rehashing(hashtable) && (arena || arena_size == 0));
+
+    arena_offset = snapshot_arena_offset(hashtable->num_buckets);
+
+    if (!image) {
+        return arena_offset + arena_size;
+    }
+
+    assert((size_t) image % HASHTABLE_SNAPSHOT_ALIGNMENT == 0);
+
+    write_field(image, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_NUMBER);
+    write_field(image, SNAPSHOT_NODE_SIZE, sizeof(HashTableNode));
+    write_field(image, SNAPSHOT_ALIGNMENT, HASHTABLE_SNAPSHOT_ALIGNMENT);
+    write_field(image, SNAPSHOT_NUM_BUCKETS, hashtable->num_buckets);
+    write_field(image, SNAPSHOT_SIZE, hashtable->size);
+    write_field(image, SNAPSHOT_REDUCTION, (size_t) hashtable->reduction);
+    write_field(image, SNAPSHOT_ARENA_SIZE, arena_size);
+
+    image_arena = image + arena_offset;
+    if (arena_size) {
+        memcpy(image_arena, arena_begin, arena_size);
+    }
+
+    /* Only the links differ from the arena, and they are the same relative to any address of the image. */
+    for (i = 0; i < hashtable->num_buckets; ++i) {
+        n = hashtable->bucket_array[i];
+        write_field(image, SNAPSHOT_NUM_FIELDS + i, n ? (size_t) ((const char*) n - arena_begin) + 1 : 0);
+
+        for (; n; n = n->next) {
+            assert((const char*) n >= arena_begin && (const char*) (n + 1) <= arena_begin + arena_size);
+            write_link(image_arena, arena_begin, &n->next, n->next);
+        }
+    }
+
+    return arena_offset + arena_size;
+}
+
+int hashtable_attach(
+    HashTableImage *image,
+    const void *buffer,
+    size_t buffer_size,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const HashTableNode *node)
+) {
+    const char *snapshot = (const char*) buffer;
+    size_t num_buckets, reduction, arena_offset, arena_size;
+
+    assert(image && snapshot && hash && equal);
+    assert((size_t) snapshot % HASHTABLE_SNAPSHOT_ALIGNMENT == 0);
+
+    if (
+        buffer_size < SNAPSHOT_NUM_FIELDS * sizeof(size_t) ||
+        read_field(snapshot, SNAPSHOT_MAGIC) != SNAPSHOT_MAGIC_NUMBER ||
+        read_field(snapshot, SNAPSHOT_NODE_SIZE) != sizeof(HashTableNode) ||
+        read_field(snapshot, SNAPSHOT_ALIGNMENT) != HASHTABLE_SNAPSHOT_ALIGNMENT
+    ) {
+        return 0;
+    }
+
+    num_buckets = read_field(snapshot, SNAPSHOT_NUM_BUCKETS);
+    reduction = read_field(snapshot, SNAPSHOT_REDUCTION);
+    arena_size = read_field(snapshot, SNAPSHOT_ARENA_SIZE);
+
+    /* Bounding the number of buckets first keeps a corrupt header from overflowing the offsets. */
+    if (
+        num_buckets == 0 ||
+        num_buckets > buffer_size / sizeof(size_t) ||
+        reduction > HASHTABLE_REDUCTION_MULTIPLY_SHIFT ||
+        (reduction == HASHTABLE_REDUCTION_MASK && (num_buckets & (num_buckets - 1)) != 0)
+    ) {
+        return 0;
+    }
+
+    arena_offset = snapshot_arena_offset(num_buckets);
+
+    if (arena_offset > buffer_size || arena_size > buffer_size - arena_offset) {
+        return 0;
+    }
+
+    image->bucket_array = snapshot + SNAPSHOT_NUM_FIELDS * sizeof(size_t);
+    image->arena = snapshot + arena_offset;
+    image->num_buckets = num_buckets;
+    image->size = read_field(snapshot, SNAPSHOT_SIZE);
+    image->reduction = (HashTableReduction) reduction;
+    image->hash = hash;
+    image->equal = equal;
+
+    return 1;
+}
+
+size_t hashtable_image_size(const HashTableImage *image) {
+    assert(image);
+
+    return image->size;
+}
+
+const HashTableNode* hashtable_image_lookup_key(const HashTableImage *image, const void *key) {
+    const HashTableNode *n;
+    size_t hash, offset;
+
+    assert(image);
+
+    hash = image->hash(key);
+    offset = read_field(image->bucket_array, reduce_hash(image->reduction, hash, image->num_buckets));
+
+    for (n = offset ? (const HashTableNode*) (image->arena + offset - 1) : NULL; n; n = read_link(&n->next)) {
+        #ifdef HASHTABLE_STORE_HASH
+        if (n->hash != hash) {
+            continue;
+        }
+        #endif /* HASHTABLE_STORE_HASH */
+
+        if (image->equal(key, n)) {
+            return n;
+        }
+    }
+
+    return NULL;
+}
+
+#ifndef HASHTABLE_NO_ATOMICS
+
+void concurrenthashtable_init(
+    ConcurrentHashTable *concurrenthashtable,
+    HashTableNode **bucket_array,
+    size_t num_buckets,
+    ConcurrentHashTableLock *lock_array,
+    size_t num_locks,
+    ConcurrentHashTableReader *reader_array,
+    size_t num_readers,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const HashTableNode *node),
+    void (*collide)(const HashTableNode *old_node, const HashTableNode *new_node, void *auxiliary_data),
+    void *auxiliary_data
+) {
+    size_t i;
+
+    assert(concurrenthashtable && bucket_array && num_buckets > 0 && lock_array && num_locks > 0);
+    assert((reader_array || num_readers == 0) && hash && equal);
+
+    for (i = 0; i < num_buckets; ++i) {
+        bucket_array[i] = NULL;
+    }
+
+    for (i = 0; i < num_locks; ++i) {
+        lock_array[i].locked = 0;
+    }
+
+    for (i = 0; i < num_readers; ++i) {
+        reader_array[i].sequence = 0;
+    }
+
+    concurrenthashtable->bucket_array = bucket_array;
+    concurrenthashtable->hash = hash;
+    concurrenthashtable->equal = equal;
+    concurrenthashtable->collide = collide;
+    concurrenthashtable->auxiliary_data = auxiliary_data;
+    concurrenthashtable->num_buckets = num_buckets;
+    concurrenthashtable->size = 0;
+    concurrenthashtable->reduction = HASHTABLE_REDUCTION_MODULO;
+    concurrenthashtable->lock_array = lock_array;
+    concurrenthashtable->num_locks = num_locks;
+    concurrenthashtable->reader_array = reader_array;
+    concurrenthashtable->num_readers = num_readers;
+}
+
+void concurrenthashtable_set_reduction(ConcurrentHashTable *concurrenthashtable, HashTableReduction reduction) {
+    assert(concurrenthashtable && concurrenthashtable->size == 0);
+    assert(
+        reduction != HASHTABLE_REDUCTION_MASK ||
+        (concurrenthashtable->num_buckets & (concurrenthashtable->num_buckets - 1)) == 0
+    );
+
+    concurrenthashtable->reduction = reduction;
+}
+
+size_t concurrenthashtable_size(const ConcurrentHashTable *concurrenthashtable) {
+    assert(concurrenthashtable);
+
+    return __atomic_load_n(&concurrenthashtable->size, __ATOMIC_RELAXED);
+}
+
+void concurrenthashtable_insert(ConcurrentHashTable *concurrenthashtable, const void *key, HashTableNode *node) {
+    HashTableNode **bucket, *n, *prev;
+    size_t hash, index;
+
+    assert(concurrenthashtable && node);
+
+    hash = concurrenthashtable->hash(key);
+    index = reduce_hash(concurrenthashtable->reduction, hash, concurrenthashtable->num_buckets);
+    bucket = concurrenthashtable->bucket_array + index;
+
+    #ifdef HASHTABLE_STORE_HASH
+    node->hash = hash;
+    #endif /* HASHTABLE_STORE_HASH */
+
+    lock_stripe(concurrenthashtable, index);
+
+    /* Only writers holding the lock modify the chain, so it can be read without atomics here. */
+    for (n = *bucket, prev = NULL; n; prev = n, n = n->next) {
+        assert(n != node);
+
+        #ifdef HASHTABLE_STORE_HASH
+        if (n->hash != hash) {
+            continue;
+        }
+        #endif /* HASHTABLE_STORE_HASH */
+
+        if (concurrenthashtable->equal(key, n)) {
+            /* The old HashTableNode keeps its next pointer, so readers standing on it still reach the rest. */
+            node->next = n->next;
+            __atomic_store_n(prev ? &prev->next : bucket, node, __ATOMIC_RELEASE);
+
+            unlock_stripe(concurrenthashtable, index);
+
+            if (concurrenthashtable->collide) {
+                concurrenthashtable->collide(n, node, concurrenthashtable->auxiliary_data);
+            }
+
+            return;
+        }
+    }
+
+    node->next = *bucket;
+    __atomic_store_n(bucket, node, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&concurrenthashtable->size, 1, __ATOMIC_RELAXED);
+
+    unlock_stripe(concurrenthashtable, index);
+}
+
+HashTableNode* concurrenthashtable_lookup_key(const ConcurrentHashTable *concurrenthashtable, const void *key) {
+    HashTableNode **bucket, *n;
+    size_t hash, index;
+
+    assert(concurrenthashtable);
+
+    hash = concurrenthashtable->hash(key);
+    index = reduce_hash(concurrenthashtable->reduction, hash, concurrenthashtable->num_buckets);
+    bucket = concurrenthashtable->bucket_array + index;
+
+    for (n = __atomic_load_n(bucket, __ATOMIC_ACQUIRE); n; n = __atomic_load_n(&n->next, __ATOMIC_ACQUIRE)) {
+        #ifdef HASHTABLE_STORE_HASH
+        if (n->hash != hash) {
+            continue;
+        }
+        #endif /* HASHTABLE_STORE_HASH */
+
+        if (concurrenthashtable->equal(key, n)) {
+            return n;
+        }
+    }
+
+    return NULL;
+}
+
+HashTableNode* concurrenthashtable_remove_key(ConcurrentHashTable *concurrenthashtable, const void *key) {
+    HashTableNode **bucket, *n, *prev;
+    size_t hash, index;
+
+    assert(concurrenthashtable);
+
+    hash = concurrenthashtable->hash(key);
+    index = reduce_hash(concurrenthashtable->reduction, hash, concurrenthashtable->num_buckets);
+    bucket = concurrenthashtable->bucket_array + index;
+
+    lock_stripe(concurrenthashtable, index);
+
+    for (n = *bucket, prev = NULL; n; prev = n, n = n->next) {
+        #ifdef HASHTABLE_STORE_HASH
+        if (n->hash != hash) {
+            continue;
+        }
+        #endif /* HASHTABLE_STORE_HASH */
+
+        if (concurrenthashtable->equal(key, n)) {
+            /* The removed HashTableNode is not poisoned, since readers may still be standing on it. */
+            __atomic_store_n(prev ? &prev->next : bucket, n->next, __ATOMIC_RELEASE);
+            __atomic_sub_fetch(&concurrenthashtable->size, 1, __ATOMIC_RELAXED);
+
+            break;
+        }
+    }
+
+    unlock_stripe(concurrenthashtable, index);
+
+    return n;
+}
+
+void concurrenthashtable_read_lock(ConcurrentHashTable *concurrenthashtable, size_t reader_index) {
+    ConcurrentHashTableReader *reader;
+
+    assert(concurrenthashtable && reader_index < concurrenthashtable->num_readers);
+
+    reader = concurrenthashtable->reader_array + reader_index;
+
+    assert(!(reader->sequence & 1));
+
+    /* The odd sequence must be visible to writers before any HashTableNode is read. */
+    __atomic_store_n(&reader->sequence, reader->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void concurrenthashtable_read_unlock(ConcurrentHashTable *concurrenthashtable, size_t reader_index) {
+    ConcurrentHashTableReader *reader;
+
+    assert(concurrenthashtable && reader_index < concurrenthashtable->num_readers);
+
+    reader = concurrenthashtable->reader_array + reader_index;
+
+    assert(reader->sequence & 1);
+
+    /* Every read of the critical section happens before a writer sees the even sequence. */
+    __atomic_store_n(&reader->sequence, reader->sequence + 1, __ATOMIC_RELEASE);
+}
+
+void concurrenthashtable_synchronize(ConcurrentHashTable *concurrenthashtable) {
+    size_t i;
+
+    assert(concurrenthashtable);
+
+    /* Pairs with the fence in read_lock: a reader either sees the removal or is seen as being inside. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    for (i = 0; i < concurrenthashtable->num_readers; ++i) {
+        unsigned long *sequence = &concurrenthashtable->reader_array[i].sequence;
+        unsigned long snapshot = __atomic_load_n(sequence, __ATOMIC_ACQUIRE);
+
+        /* An odd sequence belongs to a critical section in progress, which ends once the sequence changes. */
+        if (snapshot & 1) {
+            while (__atomic_load_n(sequence, __ATOMIC_ACQUIRE) == snapshot) {
+            }
+        }
+    }
+}
+
+#endif /* HASHTABLE_NO_ATOMICS */
@@ -49,10 +49,76 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  * Note the difference between a key collision and a bucket collision. The @ref HashTable handles bucket
  * collisions internally by using a singly linked list at each bucket. This allows the @ref HashTable to grow
  * in size indefinitely without having to resize (at the cost of poor insert/lookup/removal time complexities
- * when the size of the @ref HashTable is severely greater than the number buckets). If you wish to resize a
- * @ref HashTable, you are best off creating an entirely new @ref HashTable and iteratively removing each
- * @ref HashTableNode from the old @ref HashTable while immediately inserting it into the new @ref HashTable
- * afterwards.
+ * when the size of the @ref HashTable is severely greater than the number buckets).
+ *
+ * If you wish to resize a @ref HashTable, call @ref hashtable_begin_rehash with a second bucket array (filled
+ * with NULL values) created by the user. The @ref HashTableNode's are then migrated from the old bucket array
+ * to the new bucket array incrementally: every @ref hashtable_insert migrates @ref HASHTABLE_REHASH_STEP
+ * buckets, and the user can migrate more buckets with @ref hashtable_rehash_step, or all of the remaining
+ * buckets with @ref hashtable_finish_rehash. While a rehash is in progress, lookups and removals consult both
+ * bucket arrays, and the traversal macros iterate over both bucket arrays. Because the hash function takes a
+ * key rather than a @ref HashTableNode, migrating a @ref HashTableNode requires a key function which returns
+ * the key of a @ref HashTableNode. Once the rehash completes, the old bucket array is no longer used by the
+ * @ref HashTable and can be freed by the user.
+ *
+ * Traversing or clearing a @ref HashTable visits every bucket, which is wasteful when the bucket array is much
+ * larger than the number of occupied buckets (e.g. sized for a peak load). The user can OPTIONALLY install an
+ * occupancy bitmap with @ref hashtable_set_occupancy: an array of @ref HASHTABLE_OCCUPANCY_WORDS unsigned
+ * long's with one bit per bucket, which @ref hashtable_insert and @ref hashtable_remove_key keep in sync with
+ * the bucket array. The traversal macros then jump from one occupied bucket to the next by counting trailing
+ * zeros, and @ref hashtable_remove_all only clears the occupied buckets. @ref hashtable_begin_rehash keeps the
+ * bitmap of the old bucket array until the rehash completes, and the user can install another one for the new
+ * bucket array right after it.
+ *
+ * If HASHTABLE_STORE_HASH is defined (consistently for every translation unit), every @ref HashTableNode also
+ * stores the hashcode of its key. The stored hashcode is compared before the equal function is called, so
+ * that a lookup rarely calls the equal function on a @ref HashTableNode with a different key, and migrating a
+ * @ref HashTableNode during a rehash reuses the stored hashcode instead of calling the hash function again
+ * (making the key function of @ref hashtable_begin_rehash OPTIONAL).
+ *
+ * By default, a hashcode is reduced into a bucket index with a modulo operation, which requires a division on
+ * every operation. Before inserting anything, the user can call @ref hashtable_set_reduction to select a
+ * cheaper reduction. @ref HASHTABLE_REDUCTION_MASK requires a power-of-two number of buckets and uses the low
+ * bits of the hashcode. @ref HASHTABLE_REDUCTION_MULTIPLY_SHIFT works for any number of buckets and uses the
+ * high bits of the hashcode (the high half of the product of the hashcode and the number of buckets), so it
+ * should only be used with a hash function whose hashcodes are spread over the whole range of a size_t.
+ *
+ * If CDSA_STATS is defined (consistently for every translation unit), every @ref HashTable also counts what its
+ * operations cost: how many @ref HashTableNode's every walk of a chain looked at (as a histogram and a
+ * maximum), how often the equal function was called, and how many key collisions occurred. A long tail in the
+ * histogram, or many more equal calls than operations, points at a bad hash function or an overloaded bucket
+ * array. @ref hashtable_stats takes a snapshot of the counters. Lookups update the counters as well, even
+ * though they take a const @ref HashTable, so concurrent lookups on a @ref HashTable are NOT safe in this
+ * mode. Without CDSA_STATS, neither the counters nor the functions exist, and nothing is counted.
+ *
+ * A @ref HashTable can be written into a snapshot: a position-independent image that another process can map
+ * (e.g. read-only with mmap) and look keys up in without inserting anything again. The user keeps every
+ * @ref HashTableNode in one contiguous arena (e.g. an array of structs, or a region of a memory pool) whose
+ * contents are plain data, i.e. contain no pointers of their own. @ref hashtable_serialize copies the arena
+ * into the image and stores every link as an offset from the link itself, so nothing needs fixing up when the
+ * image is mapped at a different address. @ref hashtable_attach checks the header of an image and sets up a
+ * read-only @ref HashTableImage over it, without copying anything, and @ref hashtable_image_lookup_key returns
+ * a @ref HashTableNode inside the image (from which @ref hashtable_entry gets to the copy of the struct). The
+ * image must be read by a build of the same architecture with the same HASHTABLE_STORE_HASH setting, and it is
+ * only checked for being truncated or foreign, so it must come from a trusted source.
+ *
+ * A @ref HashTable is NOT synchronized. For sharing a hash table between threads, a @ref ConcurrentHashTable
+ * stores the same @ref HashTableNode's in a user-defined bucket array, and additionally uses a user-defined
+ * array of @ref ConcurrentHashTableLock's and a user-defined array of @ref ConcurrentHashTableReader's. Writers
+ * (insertions and removals) lock the stripe of buckets they operate on (bucket i belongs to stripe i % number
+ * of locks), so writers to different stripes never wait for each other. Readers (lookups) never lock anything
+ * and never wait for writers: a writer fully links a @ref HashTableNode before publishing it, and leaves the
+ * next pointer of a removed or replaced @ref HashTableNode untouched, so a reader that is still looking at it
+ * can carry on. This means a removed or replaced @ref HashTableNode must NOT be freed or reused right away.
+ * Every reader thread owns one @ref ConcurrentHashTableReader and brackets its lookups (and its use of the
+ * looked up @ref HashTableNode's) with @ref concurrenthashtable_read_lock and
+ * @ref concurrenthashtable_read_unlock. After removing a @ref HashTableNode, a writer calls
+ * @ref concurrenthashtable_synchronize, which waits until every reader that might still see the
+ * @ref HashTableNode has left its read-side critical section (a grace period). Only then may the
+ * @ref HashTableNode be freed or reused. The collide function of a @ref ConcurrentHashTable is called after the
+ * stripe is unlocked, and the same contract applies to the old @ref HashTableNode it receives. The concurrent
+ * variant requires the GNU C atomic builtins (GCC 4.7+ or Clang), and is unavailable if HASHTABLE_NO_ATOMICS
+ * is defined.
  *
  * Example:
  *          struct Object {
@@ -88,20 +154,35 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *
  * Dependencies:
  *      -   C89 assert.h
+ *      -   C89 limits.h
  *      -   C89 stddef.h
+ *      -   C89 string.h
+ *      -   GNU C atomic builtins (concurrent variant only)
  *
  * API:
  *      ====  TYPES  ====
  *      -   typedef struct HashTable HashTable;
  *      -   typedef struct HashTableNode HashTableNode;
+ *      -   typedef enum HashTableReduction HashTableReduction
+ *          -   HASHTABLE_REDUCTION_MODULO = 0
+ *          -   HASHTABLE_REDUCTION_MASK = 1
+ *          -   HASHTABLE_REDUCTION_MULTIPLY_SHIFT = 2
+ *      -   typedef struct HashTableStats HashTableStats
+ *      -   typedef struct HashTableImage HashTableImage
+ *      -   typedef struct ConcurrentHashTable ConcurrentHashTable
+ *      -   typedef struct ConcurrentHashTableLock ConcurrentHashTableLock
+ *      -   typedef struct ConcurrentHashTableReader ConcurrentHashTableReader
  *
  *      ====  FUNCTIONS  ====
  *      Initializers:
  *          -   hashtable_init
  *          -   hashtable_fast_init
+ *          -   hashtable_set_reduction
+ *          -   hashtable_set_occupancy
  *      Properties:
  *          -   hashtable_bucket_array
  *          -   hashtable_num_buckets
+ *          -   hashtable_reduction
  *          -   hashtable_size
  *          -   hashtable_empty
  *          -   hashtable_contains_key
@@ -109,13 +190,49 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *          -   hashtable_insert
  *      Lookup:
  *          -   hashtable_lookup_key
+ *          -   hashtable_lookup_keys_batch
  *      Removal:
  *          -   hashtable_remove_key
  *          -   hashtable_remove_all
+ *      Resizing:
+ *          -   hashtable_rehashing
+ *          -   hashtable_begin_rehash
+ *          -   hashtable_rehash_step
+ *          -   hashtable_finish_rehash
+ *      Traversal Helpers:
+ *          -   hashtable_possible_first
+ *          -   hashtable_possible_next
+ *          -   hashtable_next_occupied
+ *      Instrumentation:
+ *          -   hashtable_stats
+ *          -   hashtable_reset_stats
+ *      Snapshots:
+ *          -   hashtable_serialize
+ *          -   hashtable_attach
+ *          -   hashtable_image_size
+ *          -   hashtable_image_lookup_key
+ *      Concurrent Variant:
+ *          -   concurrenthashtable_init
+ *          -   concurrenthashtable_set_reduction
+ *          -   concurrenthashtable_size
+ *          -   concurrenthashtable_insert
+ *          -   concurrenthashtable_lookup_key
+ *          -   concurrenthashtable_remove_key
+ *          -   concurrenthashtable_read_lock
+ *          -   concurrenthashtable_read_unlock
+ *          -   concurrenthashtable_synchronize
  *
  *      ====  MACROS  ====
  *      Constants:
  *          -   HASHTABLE_POISON_NEXT
+ *          -   HASHTABLE_REHASH_STEP
+ *          -   HASHTABLE_BATCH_SIZE
+ *          -   HASHTABLE_CACHE_LINE_SIZE
+ *          -   HASHTABLE_STATS_HISTOGRAM_SIZE
+ *          -   HASHTABLE_SNAPSHOT_ALIGNMENT
+ *          -   HASHTABLE_OCCUPANCY_WORD_BITS
+ *      Occupancy Bitmap Size:
+ *          -   HASHTABLE_OCCUPANCY_WORDS
  *      Convenient Node Initializer:
  *          -   HASHTABLE_NODE_INIT
  *      Properties:
@@ -134,8 +251,41 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 extern "C" {
 #endif /* __cplusplus */
 
+#include <limits.h>
 #include <stddef.h>
 
+#if !defined(HASHTABLE_NO_ATOMICS) && !defined(__ATOMIC_ACQUIRE)
+    #define HASHTABLE_NO_ATOMICS
+#endif
+
+/**
+ * The assumed size of a cache line, used to keep the @ref ConcurrentHashTableLock's and the
+ * @ref ConcurrentHashTableReader's of different threads from sharing cache lines. It only pads both to the
+ * size of a cache line, so their arrays must also start on a multiple of it to avoid false sharing. It
+ * determines the layout of both, so it can be overridden by defining it before including this header, but it
+ * must be defined identically for the library and every translation unit using it.
+ */
+#ifndef HASHTABLE_CACHE_LINE_SIZE
+    #define HASHTABLE_CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * The number of buckets of the probe length histogram of a @ref HashTableStats. Can be overridden by defining
+ * it before including this header.
+ */
+#ifndef HASHTABLE_STATS_HISTOGRAM_SIZE
+    #define HASHTABLE_STATS_HISTOGRAM_SIZE 8
+#endif
+
+/**
+ * The alignment of the buffer of a snapshot, and of the copy of the arena inside it, which must be at least
+ * the alignment of the structs in the arena. An image only attaches with the alignment it was written with.
+ * Can be overridden by defining it before including this header.
+ */
+#ifndef HASHTABLE_SNAPSHOT_ALIGNMENT
+    #define HASHTABLE_SNAPSHOT_ALIGNMENT 16
+#endif
+
 /* ========================================================================================================
  *
  *                                                  TYPES
@@ -145,10 +295,34 @@ extern "C" {
 /* Struct type declarations. */
 struct HashTable;
 struct HashTableNode;
+struct HashTableStats;
 
 /* Struct typedef's. */
 typedef struct HashTable HashTable;
 typedef struct HashTableNode HashTableNode;
+typedef struct HashTableStats HashTableStats;
+
+/**
+ * Represents the way a hashcode is reduced into the index of a bucket of a bucket array with m buckets.
+ */
+typedef enum HashTableReduction {
+    HASHTABLE_REDUCTION_MODULO = 0,
+    HASHTABLE_REDUCTION_MASK = 1,
+    HASHTABLE_REDUCTION_MULTIPLY_SHIFT = 2
+} HashTableReduction;
+
+/**
+ * Represents the counters of a @ref HashTable. Element i of the probe length histogram counts the walks of a
+ * chain that looked at i @ref HashTableNode's, and the last element also counts all longer walks. A lookup
+ * walks one chain, or two while the @ref HashTable is rehashing.
+ */
+struct HashTableStats {
+    size_t num_chain_walks;
+    size_t num_equal_calls;
+    size_t num_collisions;
+    size_t max_probe_length;
+    size_t probe_length_histogram[HASHTABLE_STATS_HISTOGRAM_SIZE];
+};
 
 /**
  * Represents a hash table.
@@ -161,6 +335,16 @@ struct HashTable {
     void *auxiliary_data;
     size_t num_buckets;
     size_t size;
+    HashTableNode **old_bucket_array;
+    const void* (*key)(const HashTableNode *node);
+    size_t old_num_buckets;
+    size_t rehash_index;
+    HashTableReduction reduction;
+    unsigned long *occupancy;
+    unsigned long *old_occupancy;
+    #ifdef CDSA_STATS
+    HashTableStats stats;
+    #endif /* CDSA_STATS */
 };
 
 /**
@@ -168,8 +352,82 @@ struct HashTable {
  */
 struct HashTableNode {
     HashTableNode *next;
+    #ifdef HASHTABLE_STORE_HASH
+    size_t hash;
+    #endif /* HASHTABLE_STORE_HASH */
 };
 
+/* Struct type declarations. */
+struct HashTableImage;
+
+/* Struct typedef's. */
+typedef struct HashTableImage HashTableImage;
+
+/**
+ * Represents a read-only view of a @ref HashTable in a snapshot, set up by @ref hashtable_attach. The
+ * "bucket_array" member points to the offsets (plus one, or 0 for an empty bucket) of the first
+ * @ref HashTableNode of every bucket from the start of the copy of the arena, which the "arena" member points
+ * to.
+ */
+struct HashTableImage {
+    const char *bucket_array;
+    const char *arena;
+    size_t num_buckets;
+    size_t size;
+    HashTableReduction reduction;
+    size_t (*hash)(const void *key);
+    int (*equal)(const void *key, const HashTableNode *node);
+};
+
+#ifndef HASHTABLE_NO_ATOMICS
+
+/* Struct type declarations. */
+struct ConcurrentHashTable;
+struct ConcurrentHashTableLock;
+struct ConcurrentHashTableReader;
+
+/* Struct typedef's. */
+typedef struct ConcurrentHashTable ConcurrentHashTable;
+typedef struct ConcurrentHashTableLock ConcurrentHashTableLock;
+typedef struct ConcurrentHashTableReader ConcurrentHashTableReader;
+
+/**
+ * Represents a hash table that can be shared between threads.
+ */
+struct ConcurrentHashTable {
+    HashTableNode **bucket_array;
+    size_t (*hash)(const void *key);
+    int (*equal)(const void *key, const HashTableNode *node);
+    void (*collide)(const HashTableNode *old_node, const HashTableNode *new_node, void *auxiliary_data);
+    void *auxiliary_data;
+    size_t num_buckets;
+    size_t size;
+    HashTableReduction reduction;
+    ConcurrentHashTableLock *lock_array;
+    size_t num_locks;
+    ConcurrentHashTableReader *reader_array;
+    size_t num_readers;
+};
+
+/**
+ * Represents the lock of a stripe of buckets of a @ref ConcurrentHashTable.
+ */
+struct ConcurrentHashTableLock {
+    int locked;
+    char padding[HASHTABLE_CACHE_LINE_SIZE - sizeof(int)];
+};
+
+/**
+ * Represents a reader thread of a @ref ConcurrentHashTable. The sequence is odd while the reader is inside a
+ * read-side critical section.
+ */
+struct ConcurrentHashTableReader {
+    unsigned long sequence;
+    char padding[HASHTABLE_CACHE_LINE_SIZE - sizeof(unsigned long)];
+};
+
+#endif /* HASHTABLE_NO_ATOMICS */
+
 /* ========================================================================================================
  *
  *                                               PROTOTYPES
@@ -259,6 +517,49 @@ void hashtable_fast_init(
     void *auxiliary_data
 );
 
+/**
+ * Sets the way the @ref hashtable reduces a hashcode into a bucket index. @ref hashtable_init and
+ * @ref hashtable_fast_init reset this to @ref HASHTABLE_REDUCTION_MODULO, which computes "hashcode % m" (where
+ * m == number of buckets in bucket array). @ref HASHTABLE_REDUCTION_MASK computes "hashcode & (m - 1)", which
+ * is equivalent to the modulo but avoids the division. @ref HASHTABLE_REDUCTION_MULTIPLY_SHIFT computes the
+ * high half of "hashcode * m", which avoids the division for any m but relies on the high bits of the
+ * hashcode.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *      -   @ref hashtable is empty
+ *      -   @ref hashtable is not rehashing
+ *      -   If @ref reduction == @ref HASHTABLE_REDUCTION_MASK:
+ *          -   m is a power of two
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param hashtable             The @ref HashTable to be operated on.
+ * @param reduction             The way hashcodes will be reduced into bucket indices.
+ */
+void hashtable_set_reduction(HashTable *hashtable, HashTableReduction reduction);
+
+/**
+ * Installs the @ref occupancy bitmap for the current bucket array of the @ref hashtable, filling it in from
+ * the bucket array. Bit (i % @ref HASHTABLE_OCCUPANCY_WORD_BITS) of word (i / @ref HASHTABLE_OCCUPANCY_WORD_BITS)
+ * is set if and only if bucket i is NOT empty. NULL uninstalls it. @ref hashtable_init and
+ * @ref hashtable_fast_init uninstall it as well, and @ref hashtable_begin_rehash hands it over to the old
+ * bucket array.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *      -   @ref occupancy == NULL, or it has at least @ref HASHTABLE_OCCUPANCY_WORDS(m) words
+ *
+ * Time complexity:
+ *      -   O(m), where m == number of buckets in bucket array
+ *
+ * @param hashtable             The @ref HashTable to be operated on.
+ * @param occupancy             The OPTIONAL (i.e. can be NULL) occupancy bitmap. This memory is owned by the
+ *                              user, and must outlive its use by the @ref hashtable.
+ */
+void hashtable_set_occupancy(HashTable *hashtable, unsigned long *occupancy);
+
 /**
  * Returns the bucket array used by the @ref hashtable.
  *
@@ -287,6 +588,20 @@ HashTableNode** hashtable_bucket_array(const HashTable *hashtable);
  */
 size_t hashtable_num_buckets(const HashTable *hashtable);
 
+/**
+ * Returns the way the @ref hashtable reduces a hashcode into a bucket index.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param hashtable             The @ref HashTable whose "reduction" member will be returned.
+ * @return                      @ref hashtable->reduction.
+ */
+HashTableReduction hashtable_reduction(const HashTable *hashtable);
+
 /**
  * Returns the size of the @ref hashtable.
  *
@@ -368,6 +683,34 @@ void hashtable_insert(HashTable *hashtable, const void *key, HashTableNode *node
  */
 HashTableNode* hashtable_lookup_key(const HashTable *hashtable, const void *key);
 
+/**
+ * Looks up every key of the @ref keys in the @ref hashtable, and stores the @ref HashTableNode associated with
+ * the i'th key (NULL if a match is not found) in the i'th element of the @ref results. The result is the same
+ * as calling @ref hashtable_lookup_key on every key, but the keys are processed in chunks of
+ * @ref HASHTABLE_BATCH_SIZE keys: all keys of a chunk are hashed first, then the buckets of all keys are
+ * prefetched, then the first @ref HashTableNode of every bucket is prefetched, and only then are the chains
+ * walked. This lets the cache misses of different keys overlap instead of being paid for one after another.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *      -   @ref keys != NULL, or @ref num_keys == 0
+ *      -   @ref results != NULL, or @ref num_keys == 0
+ *
+ * Time complexity:
+ *      -   O(k * n/m), where k == @ref num_keys, and m == number of buckets in bucket array
+ *
+ * @param hashtable             The @ref HashTable containing nodes.
+ * @param keys                  The array of keys used for lookup.
+ * @param num_keys              The number of keys in the @ref keys.
+ * @param results               The array of (at least @ref num_keys) results to be filled.
+ */
+void hashtable_lookup_keys_batch(
+    const HashTable *hashtable,
+    const void *const *keys,
+    size_t num_keys,
+    HashTableNode **results
+);
+
 /**
  * Removes the @ref HashTableNode associated with the @ref key from the @ref hashtable. If a match for the
  * @ref key is not found, this function simply returns.
@@ -385,18 +728,494 @@ void hashtable_remove_key(HashTable *hashtable, const void *key);
 
 /**
  * Removes all the @ref HashTableNode's from the @ref hashtable. If the @ref hashtable is empty, this function
- * simply returns.
+ * simply returns. With an occupancy bitmap, only the occupied buckets are cleared.
  *
  * Requirements:
  *      -   @ref hashtable != NULL
  *
  * Time complexity:
  *      -   O(m), where m == number of buckets in bucket array
+ *      -   O(m/w + k) with an occupancy bitmap, where w == @ref HASHTABLE_OCCUPANCY_WORD_BITS, and k == number
+ *          of occupied buckets
  *
  * @param hashtable             The @ref HashTable to be operated on.
  */
 void hashtable_remove_all(HashTable *hashtable);
 
+/**
+ * Returns whether or not the @ref hashtable is in the middle of a rehash (i.e. @ref HashTableNode's are still
+ * being migrated from the old bucket array to the new bucket array).
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param hashtable             The @ref HashTable whose "old_bucket_array" member will be used to determine if
+ *                              it is rehashing.
+ * @return                      Whether or not the @ref hashtable is in the middle of a rehash.
+ */
+int hashtable_rehashing(const HashTable *hashtable);
+
+/**
+ * Begins an incremental rehash of the @ref hashtable into the @ref bucket_array. The current bucket array of
+ * the @ref hashtable becomes the old bucket array, and the @ref bucket_array becomes the bucket array used by
+ * the @ref hashtable from now on (i.e. @ref hashtable_bucket_array and @ref hashtable_num_buckets return the
+ * @ref bucket_array and the @ref num_buckets respectively). No @ref HashTableNode is migrated by this
+ * function. If a rehash is already in progress, it is finished before the new rehash begins. Note that the
+ * @ref bucket_array MUST be filled with NULL values.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *      -   @ref bucket_array != NULL
+ *      -   @ref num_buckets > 0
+ *      -   @ref key != NULL (unless HASHTABLE_STORE_HASH is defined)
+ *      -   @ref bucket_array is filled with NULL values
+ *      -   @ref bucket_array is not the bucket array currently used by the @ref hashtable
+ *      -   If the reduction of the @ref hashtable is @ref HASHTABLE_REDUCTION_MASK:
+ *          -   @ref num_buckets is a power of two
+ *
+ * Time complexity:
+ *      -   If not already rehashing:
+ *          -   O(1)
+ *      -   Else:
+ *          -   O(n + m), where m == number of buckets in old bucket array
+ *
+ * @param hashtable             The @ref HashTable to be operated on.
+ * @param bucket_array          The new bucket array created by the user. It MUST be filled with NULL values.
+ * @param num_buckets           The number of buckets in the @ref bucket_array.
+ * @param key                   The callback function used to obtain the key of a @ref HashTableNode, so that
+ *                              the @ref HashTableNode can be rehashed into the @ref bucket_array. If
+ *                              HASHTABLE_STORE_HASH is defined, this is OPTIONAL (i.e. can be NULL) and
+ *                              never called, since the stored hashcode is used instead.
+ */
+void hashtable_begin_rehash(
+    HashTable *hashtable,
+    HashTableNode **bucket_array,
+    size_t num_buckets,
+    const void* (*key)(const HashTableNode *node)
+);
+
+/**
+ * Migrates at most @ref num_buckets buckets of the old bucket array into the bucket array of the
+ * @ref hashtable. When the last bucket of the old bucket array is migrated, the rehash is complete and the old
+ * bucket array is no longer used by the @ref hashtable. If the @ref hashtable is not rehashing, this
+ * function simply returns.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(k + j), where k == @ref num_buckets and j == number of @ref HashTableNode's in the migrated
+ *          buckets
+ *
+ * @param hashtable             The @ref HashTable to be operated on.
+ * @param num_buckets           The maximum number of buckets in the old bucket array to migrate.
+ * @return                      Whether or not the @ref hashtable is still rehashing.
+ */
+int hashtable_rehash_step(HashTable *hashtable, size_t num_buckets);
+
+/**
+ * Migrates all of the remaining buckets of the old bucket array into the bucket array of the
+ * @ref hashtable, completing the rehash. If the @ref hashtable is not rehashing, this function simply
+ * returns.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(n + m), where m == number of buckets in old bucket array
+ *
+ * @param hashtable             The @ref HashTable to be operated on.
+ */
+void hashtable_finish_rehash(HashTable *hashtable);
+
+/**
+ * This is a helper function for @ref hashtable_for_each_possible and @ref hashtable_for_each_possible_safe.
+ *
+ * Returns the first @ref HashTableNode which hashes to the same bucket as the @ref key. While the
+ * @ref hashtable is rehashing, this is the first @ref HashTableNode of the bucket in the old bucket array, or
+ * of the bucket in the new bucket array if the former is empty. NULL if both buckets are empty.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param hashtable             The @ref HashTable containing nodes.
+ * @param key                   The key used to determine the bucket(s).
+ * @return                      The first @ref HashTableNode which hashes to the same bucket as the @ref key.
+ */
+HashTableNode* hashtable_possible_first(const HashTable *hashtable, const void *key);
+
+/**
+ * This is a helper function for @ref hashtable_for_each_possible and @ref hashtable_for_each_possible_safe.
+ *
+ * Returns the @ref HashTableNode after the @ref node among the @ref HashTableNode's which hash to the same
+ * bucket as the @ref key. NULL if the @ref node is the last one.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *      -   @ref node != NULL
+ *      -   @ref node hashes to the same bucket as the @ref key
+ *
+ * Time complexity:
+ *      -   If not rehashing:
+ *          -   O(1)
+ *      -   Else:
+ *          -   O(n/m), where m == number of buckets in old bucket array
+ *
+ * @param hashtable             The @ref HashTable containing nodes.
+ * @param key                   The key used to determine the bucket(s).
+ * @param node                  The @ref HashTableNode whose successor will be returned.
+ * @return                      NULL if the @ref node is the last @ref HashTableNode which hashes to the same
+ *                              bucket as the @ref key; otherwise, the successor of the @ref node.
+ */
+HashTableNode* hashtable_possible_next(const HashTable *hashtable, const void *key, const HashTableNode *node);
+
+/**
+ * This is a helper function for @ref hashtable_for_each and @ref hashtable_for_each_safe.
+ *
+ * Returns the first bucket index NOT less than the @ref first_index which may be occupied, numbering the
+ * buckets of the new bucket array followed by the buckets of the old bucket array, as the traversal macros do.
+ * Buckets are skipped only if their bucket array has an occupancy bitmap. Returns the total number of buckets
+ * if there is no such bucket.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(m/w), where w == @ref HASHTABLE_OCCUPANCY_WORD_BITS
+ *
+ * @param hashtable             The @ref HashTable to be operated on.
+ * @param first_index           The bucket index to start from.
+ * @return                      The first bucket index NOT less than the @ref first_index which may be
+ *                              occupied, or the total number of buckets.
+ */
+size_t hashtable_next_occupied(const HashTable *hashtable, size_t first_index);
+
+#ifdef CDSA_STATS
+
+/**
+ * Copies the counters of the @ref hashtable into the @ref stats.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *      -   @ref stats != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param hashtable             The @ref HashTable whose counters will be copied.
+ * @param stats                 The @ref HashTableStats to copy the counters into.
+ */
+void hashtable_stats(const HashTable *hashtable, HashTableStats *stats);
+
+/**
+ * Resets all counters of the @ref hashtable to 0. @ref hashtable_init and @ref hashtable_fast_init do this as
+ * well.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param hashtable             The @ref HashTable whose counters will be reset.
+ */
+void hashtable_reset_stats(HashTable *hashtable);
+
+#endif /* CDSA_STATS */
+
+/**
+ * Writes a snapshot of the @ref hashtable into the @ref buffer, and returns its size in bytes. If
+ * @ref buffer == NULL, this function simply returns the size the snapshot needs. The @ref hashtable and the
+ * arena are NOT modified.
+ *
+ * Requirements:
+ *      -   @ref hashtable != NULL
+ *      -   @ref hashtable is NOT rehashing
+ *      -   Every @ref HashTableNode in the @ref hashtable lies within the arena
+ *      -   @ref buffer is aligned to @ref HASHTABLE_SNAPSHOT_ALIGNMENT, and does NOT overlap the arena
+ *
+ * Time complexity:
+ *      -   O(m + n + a), where m == number of buckets in bucket array, and a == @ref arena_size
+ *
+ * @param hashtable             The @ref HashTable to be written.
+ * @param arena                 The start of the memory holding every @ref HashTableNode of the @ref hashtable
+ *                              (and the structs they are embedded in).
+ * @param arena_size            The size of the arena in bytes.
+ * @param buffer                The OPTIONAL (i.e. can be NULL) memory the snapshot is written into, which
+ *                              must be at least as large as the returned size.
+ * @return                      The size of the snapshot in bytes.
+ */
+size_t hashtable_serialize(const HashTable *hashtable, const void *arena, size_t arena_size, void *buffer);
+
+/**
+ * Checks that the @ref buffer holds a complete snapshot written by @ref hashtable_serialize, and if so, sets up
+ * the @ref image to read it in place. The @ref buffer is NEVER modified, and must outlive the @ref image.
+ *
+ * Requirements:
+ *      -   @ref image != NULL
+ *      -   @ref buffer != NULL
+ *      -   @ref buffer is aligned to @ref HASHTABLE_SNAPSHOT_ALIGNMENT
+ *      -   @ref hash != NULL
+ *      -   @ref equal != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param image                 The @ref HashTableImage to be set up.
+ * @param buffer                The memory holding the snapshot (e.g. a mapped file).
+ * @param buffer_size           The size of the @ref buffer in bytes.
+ * @param hash                  The same hash function the @ref HashTable was built with.
+ * @param equal                 The callback function used to compare a key with the key of a
+ *                              @ref HashTableNode inside the image.
+ * @return                      Whether or not the @ref buffer holds a valid snapshot (the @ref image is left
+ *                              untouched if not).
+ */
+int hashtable_attach(
+    HashTableImage *image,
+    const void *buffer,
+    size_t buffer_size,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const HashTableNode *node)
+);
+
+/**
+ * Returns the number of @ref HashTableNode's in the @ref image.
+ *
+ * Requirements:
+ *      -   @ref image != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param image                 The @ref HashTableImage to be operated on.
+ * @return                      The number of @ref HashTableNode's in the @ref image.
+ */
+size_t hashtable_image_size(const HashTableImage *image);
+
+/**
+ * Returns the @ref HashTableNode associated with the @ref key in the @ref image. NULL if a match for the
+ * @ref key is not found. Any number of threads (and processes sharing the snapshot) may call this function
+ * concurrently.
+ *
+ * Requirements:
+ *      -   @ref image != NULL
+ *
+ * Time complexity:
+ *      -   O(n/m), where m == number of buckets in bucket array
+ *
+ * @param image                 The @ref HashTableImage to be searched.
+ * @param key                   The key used for lookup.
+ * @return                      NULL if a match for the @ref key is not found; otherwise, the
+ *                              @ref HashTableNode inside the @ref image associated with the @ref key.
+ */
+const HashTableNode* hashtable_image_lookup_key(const HashTableImage *image, const void *key);
+
+#ifndef HASHTABLE_NO_ATOMICS
+
+/**
+ * Initializes/resets the @ref concurrenthashtable. It must be initialized before it is shared with other
+ * threads.
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *      -   @ref bucket_array != NULL
+ *      -   @ref num_buckets > 0
+ *      -   @ref lock_array != NULL
+ *      -   @ref num_locks > 0
+ *      -   @ref reader_array != NULL, or @ref num_readers == 0
+ *      -   @ref hash != NULL
+ *      -   @ref equal != NULL
+ *
+ * Time complexity:
+ *      -   O(m + l + r), where m == number of buckets, l == number of locks, and r == number of readers
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable to be initialized/reset.
+ * @param bucket_array          The bucket array created by the user. It does NOT need to already be filled
+ *                              with NULL values.
+ * @param num_buckets           The number of buckets in the @ref bucket_array.
+ * @param lock_array            The array of locks created by the user. It does NOT need to be initialized.
+ *                              Align it to HASHTABLE_CACHE_LINE_SIZE so that no two locks share a cache line.
+ * @param num_locks             The number of locks in the @ref lock_array.
+ * @param reader_array          The array of readers created by the user. It does NOT need to be initialized.
+ *                              Every thread calling @ref concurrenthashtable_read_lock uses its own element.
+ *                              Align it to HASHTABLE_CACHE_LINE_SIZE so that no two readers share a cache
+ *                              line.
+ * @param num_readers           The number of readers in the @ref reader_array.
+ * @param hash                  The callback function used to hash a key.
+ * @param equal                 The callback function used to to determine if a key is equal to the key of a
+ *                              @ref HashTableNode.
+ * @param collide               The OPTIONAL (i.e. can be NULL) callback function used to handle key
+ *                              collisions. If non-NULL, @ref collide will be called after the old
+ *                              @ref HashTableNode is replaced by the new @ref HashTableNode, once the stripe
+ *                              is unlocked.
+ * @param auxiliary_data        The auxiliary data passed to the OPTIONAL @ref collide callback function if
+ *                              the @ref collide callback function is non-NULL. This data is NEVER manipulated
+ *                              by the @ref concurrenthashtable.
+ */
+void concurrenthashtable_init(
+    ConcurrentHashTable *concurrenthashtable,
+    HashTableNode **bucket_array,
+    size_t num_buckets,
+    ConcurrentHashTableLock *lock_array,
+    size_t num_locks,
+    ConcurrentHashTableReader *reader_array,
+    size_t num_readers,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const HashTableNode *node),
+    void (*collide)(const HashTableNode *old_node, const HashTableNode *new_node, void *auxiliary_data),
+    void *auxiliary_data
+);
+
+/**
+ * Sets the way the @ref concurrenthashtable reduces a hashcode into a bucket index, like
+ * @ref hashtable_set_reduction does for a @ref HashTable. @ref concurrenthashtable_init resets this to
+ * @ref HASHTABLE_REDUCTION_MODULO.
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *      -   @ref concurrenthashtable is empty
+ *      -   @ref concurrenthashtable is not yet shared with other threads
+ *      -   If @ref reduction == @ref HASHTABLE_REDUCTION_MASK:
+ *          -   m is a power of two, where m == number of buckets in bucket array
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable to be operated on.
+ * @param reduction             The way hashcodes will be reduced into bucket indices.
+ */
+void concurrenthashtable_set_reduction(ConcurrentHashTable *concurrenthashtable, HashTableReduction reduction);
+
+/**
+ * Returns the size of the @ref concurrenthashtable. If other threads are inserting or removing concurrently,
+ * the size may be out of date by the time it is returned.
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable whose "size" member will be returned.
+ * @return                      @ref concurrenthashtable->size.
+ */
+size_t concurrenthashtable_size(const ConcurrentHashTable *concurrenthashtable);
+
+/**
+ * Inserts the @ref node into the @ref concurrenthashtable, locking the stripe of the bucket of the @ref key.
+ * If a @ref HashTableNode with the same key already exists, it is replaced by the @ref node, and the OPTIONAL
+ * collide function is called once the stripe is unlocked. The replaced @ref HashTableNode may still be seen by
+ * readers until the next grace period (see @ref concurrenthashtable_synchronize).
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *      -   @ref node != NULL
+ *      -   @ref node is not already in the @ref concurrenthashtable
+ *
+ * Time complexity:
+ *      -   O(n/m), where m == number of buckets in bucket array
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable to be operated on.
+ * @param key                   The key associated with the @ref node.
+ * @param node                  The @ref HashTableNode to be inserted.
+ */
+void concurrenthashtable_insert(ConcurrentHashTable *concurrenthashtable, const void *key, HashTableNode *node);
+
+/**
+ * Returns the @ref HashTableNode associated with the @ref key in the @ref concurrenthashtable, without
+ * locking or waiting for writers. NULL if a match for the @ref key is not found. If @ref HashTableNode's
+ * removed from the @ref concurrenthashtable may be freed or reused, this must be called inside a read-side
+ * critical section, and the returned @ref HashTableNode may only be used until the critical section ends.
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(n/m), where m == number of buckets in bucket array
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable containing nodes.
+ * @param key                   The key used for lookup.
+ * @return                      NULL if a match for the @ref key is not found; otherwise, the
+ *                              @ref HashTableNode associated with the @ref key.
+ */
+HashTableNode* concurrenthashtable_lookup_key(const ConcurrentHashTable *concurrenthashtable, const void *key);
+
+/**
+ * Removes the @ref HashTableNode associated with the @ref key from the @ref concurrenthashtable, locking the
+ * stripe of the bucket of the @ref key. The removed @ref HashTableNode may still be seen by readers until the
+ * next grace period, so it may only be freed or reused after a subsequent call to
+ * @ref concurrenthashtable_synchronize returns.
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *
+ * Time complexity:
+ *      -   O(n/m), where m == number of buckets in bucket array
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable to be operated on.
+ * @param key                   The key of the @ref HashTableNode to be removed.
+ * @return                      The removed @ref HashTableNode, or NULL if a match for the @ref key is not found.
+ */
+HashTableNode* concurrenthashtable_remove_key(ConcurrentHashTable *concurrenthashtable, const void *key);
+
+/**
+ * Enters a read-side critical section of the reader at @ref reader_index. Critical sections of the same
+ * reader must NOT be nested. This never waits.
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *      -   @ref reader_index < number of readers
+ *      -   The reader at @ref reader_index is only used by the calling thread
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable to be operated on.
+ * @param reader_index          The index of the reader of the calling thread in the reader array.
+ */
+void concurrenthashtable_read_lock(ConcurrentHashTable *concurrenthashtable, size_t reader_index);
+
+/**
+ * Leaves the read-side critical section of the reader at @ref reader_index.
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *      -   @ref reader_index < number of readers
+ *      -   The reader at @ref reader_index is inside a read-side critical section
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable to be operated on.
+ * @param reader_index          The index of the reader of the calling thread in the reader array.
+ */
+void concurrenthashtable_read_unlock(ConcurrentHashTable *concurrenthashtable, size_t reader_index);
+
+/**
+ * Waits for a grace period: returns once every read-side critical section that was in progress when this
+ * function was called has ended. Every @ref HashTableNode removed (or replaced) before this function was
+ * called can then be freed or reused. Never call this inside a read-side critical section.
+ *
+ * Requirements:
+ *      -   @ref concurrenthashtable != NULL
+ *      -   The calling thread is not inside a read-side critical section
+ *
+ * Time complexity:
+ *      -   O(r) plus the time the readers take to leave their critical sections, where r == number of
+ *          readers
+ *
+ * @param concurrenthashtable   The @ref ConcurrentHashTable to be operated on.
+ */
+void concurrenthashtable_synchronize(ConcurrentHashTable *concurrenthashtable);
+
+#endif /* HASHTABLE_NO_ATOMICS */
+
 /* ========================================================================================================
  *
  *                                                 MACROS
@@ -409,11 +1228,46 @@ void hashtable_remove_all(HashTable *hashtable);
  */
 #define HASHTABLE_POISON_NEXT ((HashTableNode*) 0x100)
 
+/**
+ * The number of buckets of the old bucket array migrated by every @ref hashtable_insert while the
+ * @ref HashTable is rehashing. It is only used by hashtable.c, so it can be overridden by defining it when
+ * compiling hashtable.c (e.g. with -DHASHTABLE_REHASH_STEP=8), not by defining it before including this header.
+ */
+#ifndef HASHTABLE_REHASH_STEP
+    #define HASHTABLE_REHASH_STEP 4
+#endif
+
+/**
+ * The number of keys @ref hashtable_lookup_keys_batch processes at once. It is only used by hashtable.c, so it
+ * can be overridden by defining it when compiling hashtable.c (e.g. with -DHASHTABLE_BATCH_SIZE=32), not by
+ * defining it before including this header.
+ */
+#ifndef HASHTABLE_BATCH_SIZE
+    #define HASHTABLE_BATCH_SIZE 16
+#endif
+
+/**
+ * The number of buckets one word of an occupancy bitmap keeps track of.
+ */
+#define HASHTABLE_OCCUPANCY_WORD_BITS (CHAR_BIT * sizeof(unsigned long))
+
+/**
+ * The number of unsigned long's an occupancy bitmap for @ref num_buckets buckets needs.
+ *
+ * @param num_buckets           The number of buckets in the bucket array.
+ */
+#define HASHTABLE_OCCUPANCY_WORDS(num_buckets) \
+    (((num_buckets) + HASHTABLE_OCCUPANCY_WORD_BITS - 1) / HASHTABLE_OCCUPANCY_WORD_BITS)
+
 /**
  * Initializing a @ref HashTableNode before it is used is NOT required. This macro is simply for allowing you
  * to initialize a struct (containing one or more @ref HashTableNode's) with an initializer-list conveniently.
  */
-#define HASHTABLE_NODE_INIT { HASHTABLE_POISON_NEXT }
+#ifdef HASHTABLE_STORE_HASH
+    #define HASHTABLE_NODE_INIT { HASHTABLE_POISON_NEXT, 0 }
+#else
+    #define HASHTABLE_NODE_INIT { HASHTABLE_POISON_NEXT }
+#endif /* HASHTABLE_STORE_HASH */
 
 /**
  * Obtains the pointer to the struct for this entry.
@@ -439,7 +1293,9 @@ void hashtable_remove_all(HashTable *hashtable);
 #endif
 
 /**
- * Iterates over the @ref HashTable.
+ * Iterates over the @ref HashTable. While the @ref HashTable is rehashing, the @ref bucket_index runs over the
+ * buckets of the new bucket array followed by the buckets of the old bucket array. Empty buckets are skipped
+ * without being looked at if their bucket array has an occupancy bitmap.
  *
  * Requirements:
  *      -   @ref hashtable_ptr != NULL
@@ -453,19 +1309,25 @@ void hashtable_remove_all(HashTable *hashtable);
  */
 #define hashtable_for_each(cursor_node_ptr, bucket_index, hashtable_ptr) \
     for ( \
-        bucket_index = 0; \
-        bucket_index < (hashtable_ptr)->num_buckets; \
-        ++bucket_index \
+        bucket_index = (hashtable_ptr)->occupancy || (hashtable_ptr)->old_occupancy ? \
+            hashtable_next_occupied((hashtable_ptr), 0) : 0; \
+        bucket_index < (hashtable_ptr)->num_buckets + (hashtable_ptr)->old_num_buckets; \
+        bucket_index = (hashtable_ptr)->occupancy || (hashtable_ptr)->old_occupancy ? \
+            hashtable_next_occupied((hashtable_ptr), bucket_index + 1) : bucket_index + 1 \
     ) \
         for ( \
-            cursor_node_ptr = (hashtable_ptr)->bucket_array[bucket_index]; \
+            cursor_node_ptr = bucket_index < (hashtable_ptr)->num_buckets ? \
+                (hashtable_ptr)->bucket_array[bucket_index] : \
+                (hashtable_ptr)->old_bucket_array[bucket_index - (hashtable_ptr)->num_buckets]; \
             cursor_node_ptr; \
             cursor_node_ptr = cursor_node_ptr->next \
         )
 
 /**
  * Iterates over the @ref HashTable, and is safe against reassignment and/or removal of the
- * @ref cursor_node_ptr.
+ * @ref cursor_node_ptr. While the @ref HashTable is rehashing, the @ref bucket_index runs over the buckets of
+ * the new bucket array followed by the buckets of the old bucket array. Empty buckets are skipped without
+ * being looked at if their bucket array has an occupancy bitmap.
  *
  * Requirements:
  *      -   @ref hashtable_ptr != NULL
@@ -481,12 +1343,16 @@ void hashtable_remove_all(HashTable *hashtable);
  */
 #define hashtable_for_each_safe(cursor_node_ptr, backup_node_ptr, bucket_index, hashtable_ptr) \
     for ( \
-        bucket_index = 0; \
-        bucket_index < (hashtable_ptr)->num_buckets; \
-        ++bucket_index \
+        bucket_index = (hashtable_ptr)->occupancy || (hashtable_ptr)->old_occupancy ? \
+            hashtable_next_occupied((hashtable_ptr), 0) : 0; \
+        bucket_index < (hashtable_ptr)->num_buckets + (hashtable_ptr)->old_num_buckets; \
+        bucket_index = (hashtable_ptr)->occupancy || (hashtable_ptr)->old_occupancy ? \
+            hashtable_next_occupied((hashtable_ptr), bucket_index + 1) : bucket_index + 1 \
     ) \
         for ( \
-            cursor_node_ptr = (hashtable_ptr)->bucket_array[bucket_index], \
+            cursor_node_ptr = bucket_index < (hashtable_ptr)->num_buckets ? \
+                (hashtable_ptr)->bucket_array[bucket_index] : \
+                (hashtable_ptr)->old_bucket_array[bucket_index - (hashtable_ptr)->num_buckets], \
             backup_node_ptr = cursor_node_ptr ? cursor_node_ptr->next : NULL; \
             \
             cursor_node_ptr; \
@@ -509,9 +1375,9 @@ void hashtable_remove_all(HashTable *hashtable);
  */
 #define hashtable_for_each_possible(cursor_node_ptr, key_ptr, hashtable_ptr) \
     for ( \
-        cursor_node_ptr = (hashtable_ptr)->bucket_array[(hashtable_ptr)->hash((key_ptr)) % (hashtable_ptr)->num_buckets]; \
+        cursor_node_ptr = hashtable_possible_first((hashtable_ptr), (key_ptr)); \
         cursor_node_ptr; \
-        cursor_node_ptr = cursor_node_ptr->next \
+        cursor_node_ptr = hashtable_possible_next((hashtable_ptr), (key_ptr), cursor_node_ptr) \
     )
 
 /**
@@ -531,13 +1397,13 @@ void hashtable_remove_all(HashTable *hashtable);
  */
 #define hashtable_for_each_possible_safe(cursor_node_ptr, backup_node_ptr, key_ptr, hashtable_ptr) \
     for ( \
-        cursor_node_ptr = (hashtable_ptr)->bucket_array[(hashtable_ptr)->hash((key_ptr)) % (hashtable_ptr)->num_buckets], \
-        backup_node_ptr = cursor_node_ptr ? cursor_node_ptr->next : NULL; \
+        cursor_node_ptr = hashtable_possible_first((hashtable_ptr), (key_ptr)), \
+        backup_node_ptr = cursor_node_ptr ? hashtable_possible_next((hashtable_ptr), (key_ptr), cursor_node_ptr) : NULL; \
         \
         cursor_node_ptr; \
         \
         cursor_node_ptr = backup_node_ptr, \
-        backup_node_ptr = cursor_node_ptr ? cursor_node_ptr->next : NULL \
+        backup_node_ptr = cursor_node_ptr ? hashtable_possible_next((hashtable_ptr), (key_ptr), cursor_node_ptr) : NULL \
     )
 
 #ifdef __cplusplus
@@ -17,16 +17,231 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
 #include <assert.h>
+#include <limits.h>
 #include <stddef.h>
 
 #include "list.h"
 
+/* Natural runs shorter than this are extended by insertion sort before they are merged. */
+#define MIN_RUN 8
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/*
+ * Stably merges the NULL-terminated chains @ref a and @ref b, which are linked through their "next" members
+ * only, and returns the head of the result. On ties, the @ref ListNode's of @ref a come first.
+ */
+static ListNode* merge_chains(ListNode *a, ListNode *b, int (*compare)(const ListNode *a, const ListNode *b));
+
+/*
+ * Detaches the sorted run starting at @ref head as a NULL-terminated chain, linked through the "next" members
+ * only, and returns its head. Strictly descending runs are reversed, and runs shorter than MIN_RUN are
+ * extended by insertion sort. The length of the run is stored in @ref length and the first @ref ListNode
+ * after the run in @ref rest.
+ */
+static ListNode* take_run(
+    ListNode *head,
+    int (*compare)(const ListNode *a, const ListNode *b),
+    size_t *length,
+    ListNode **rest
+);
+
+/*
+ * Makes the NULL-terminated chain starting at @ref head, linked through the "next" members only, the contents
+ * of the @ref list by restoring the "prev" members.
+ */
+static void relink_chain(List *list, ListNode *head);
+
+/*
+ * Stores the @ref ListNode's of the @ref list in the @ref array, in order.
+ */
+static void copy_to_array(const List *list, ListNode **array);
+
+/*
+ * Makes the @ref num_nodes @ref ListNode's of the @ref array the contents of the @ref list, in array order.
+ */
+static void relink_array(List *list, ListNode **array, size_t num_nodes);
+
+/*
+ * Returns the slot of the @ref node in a hash table with @ref table_size slots.
+ */
+static size_t hash_node(const ListNode *node, size_t table_size);
+
+/*
+ * Rebuilds the @ref index if its @ref List has changed since it was last built.
+ */
+static void refresh_index(ListIndex *index);
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static ListNode* merge_chains(ListNode *a, ListNode *b, int (*compare)(const ListNode *a, const ListNode *b)) {
+    ListNode *head = NULL, **link = &head;
+
+    assert(compare);
+
+    while (a && b) {
+        if (compare(a, b) <= 0) {
+            *link = a;
+            link = &a->next;
+            a = a->next;
+        } else {
+            *link = b;
+            link = &b->next;
+            b = b->next;
+        }
+    }
+
+    *link = a ? a : b;
+
+    return head;
+}
+
+static ListNode* take_run(
+    ListNode *head,
+    int (*compare)(const ListNode *a, const ListNode *b),
+    size_t *length,
+    ListNode **rest
+) {
+    ListNode *n, *last;
+
+    assert(head && compare && length && rest);
+
+    *length = 1;
+    last = head;
+    n = head->next;
+
+    if (n && compare(last, n) > 0) {
+        /* Only strictly descending runs are reversed, so that equal ListNode's keep their order. */
+        head->next = NULL;
+
+        do {
+            ListNode *next = n->next;
+
+            n->next = head;
+            head = n;
+            last = n;
+            n = next;
+            ++*length;
+        } while (n && compare(last, n) > 0);
+    } else if (n) {
+        do {
+            last = n;
+            n = n->next;
+            ++*length;
+        } while (n && compare(last, n) <= 0);
+
+        last->next = NULL;
+    }
+
+    while (n && *length < MIN_RUN) {
+        ListNode *next = n->next;
+
+        if (compare(head, n) > 0) {
+            n->next = head;
+            head = n;
+        } else {
+            ListNode *position = head;
+
+            while (position->next && compare(position->next, n) <= 0) {
+                position = position->next;
+            }
+
+            n->next = position->next;
+            position->next = n;
+        }
+
+        n = next;
+        ++*length;
+    }
+
+    *rest = n;
+
+    return head;
+}
+
+static void relink_chain(List *list, ListNode *head) {
+    ListNode *n, *prev = NULL;
+
+    assert(list);
+
+    list->head = head;
+
+    for (n = head; n; n = n->next) {
+        n->prev = prev;
+        prev = n;
+    }
+
+    list->tail = prev;
+    ++list->version;
+}
+
+static void copy_to_array(const List *list, ListNode **array) {
+    ListNode *n;
+
+    assert(list && array);
+
+    for (n = list->head; n; n = n->next) {
+        *array++ = n;
+    }
+}
+
+static void relink_array(List *list, ListNode **array, size_t num_nodes) {
+    size_t i;
+
+    assert(list && array && num_nodes > 0);
+
+    array[0]->prev = NULL;
+
+    for (i = 1; i < num_nodes; ++i) {
+        array[i - 1]->next = array[i];
+        array[i]->prev = array[i - 1];
+    }
+
+    array[num_nodes - 1]->next = NULL;
+    list->head = array[0];
+    list->tail = array[num_nodes - 1];
+    ++list->version;
+}
+
+static size_t hash_node(const ListNode *node, size_t table_size) {
+    size_t hash = (size_t) node / sizeof(ListNode);
+
+    hash ^= hash >> 16;
+    hash *= 2654435761UL;
+    hash ^= hash >> 13;
+
+    return hash % table_size;
+}
+
+static void refresh_index(ListIndex *index) {
+    assert(index);
+
+    if (!index->built || index->version != index->list->version) {
+        list_index_rebuild(index);
+    }
+}
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
 void list_init(List *list) {
     assert(list);
 
     list->head = NULL;
     list->tail = NULL;
     list->size = 0;
+    list->version = 0;
 }
 
 ListNode* list_front(const List *list) {
@@ -109,6 +324,124 @@ ListNode* list_at(const List *list, size_t index) {
     return NULL;
 }
 
+void list_index_init(ListIndex *index, const List *list, ListIndexEntry *entries, size_t num_entries) {
+    assert(index && list && entries && num_entries >= 3);
+
+    index->list = list;
+    index->entries = entries;
+    index->num_entries = num_entries;
+    index->num_checkpoints = 0;
+    index->stride = 1;
+    index->version = 0;
+    index->built = 0;
+}
+
+void list_index_rebuild(ListIndex *index) {
+    const List *list;
+    ListIndexEntry *table;
+    size_t max_checkpoints, table_size, i;
+    ListNode *n;
+
+    assert(index);
+
+    list = index->list;
+    max_checkpoints = index->num_entries / 3;
+    table = index->entries + max_checkpoints;
+    table_size = index->num_entries - max_checkpoints;
+
+    for (i = 0; i < table_size; ++i) {
+        table[i].node = NULL;
+    }
+
+    /* The head is always a checkpoint, so that walking back from any node ends at one. */
+    index->stride = list->size > max_checkpoints ? (list->size + max_checkpoints - 1) / max_checkpoints : 1;
+    index->num_checkpoints = 0;
+
+    for (n = list->head, i = 0; n; n = n->next, ++i) {
+        if (i % index->stride == 0) {
+            size_t slot = hash_node(n, table_size);
+
+            while (table[slot].node) {
+                slot = slot + 1 < table_size ? slot + 1 : 0;
+            }
+
+            table[slot].node = n;
+            table[slot].position = i;
+            index->entries[index->num_checkpoints].node = n;
+            index->entries[index->num_checkpoints].position = i;
+            ++index->num_checkpoints;
+        }
+    }
+
+    index->version = list->version;
+    index->built = 1;
+}
+
+ListNode* list_index_at(ListIndex *index, size_t position) {
+    const ListIndexEntry *checkpoint;
+    ListNode *n;
+    size_t end, i;
+
+    assert(index && position < index->list->size);
+
+    refresh_index(index);
+
+    checkpoint = &index->entries[position / index->stride];
+
+    /* Walk forward from the checkpoint before, or back from the checkpoint (or tail) after, the position. */
+    if (checkpoint + 1 < index->entries + index->num_checkpoints) {
+        n = checkpoint[1].node;
+        end = checkpoint[1].position;
+    } else {
+        n = index->list->tail;
+        end = index->list->size - 1;
+    }
+
+    if (end - position < position - checkpoint->position) {
+        for (i = end; i > position; --i) {
+            n = n->prev;
+        }
+    } else {
+        n = checkpoint->node;
+        for (i = checkpoint->position; i < position; ++i) {
+            n = n->next;
+        }
+    }
+
+    return n;
+}
+
+size_t list_index_position_of(ListIndex *index, const ListNode *node) {
+    const ListIndexEntry *table;
+    size_t max_checkpoints, table_size, steps;
+
+    assert(index && node);
+
+    if (index->list->tail == node) {
+        return index->list->size - 1;
+    }
+
+    refresh_index(index);
+
+    max_checkpoints = index->num_entries / 3;
+    table = index->entries + max_checkpoints;
+    table_size = index->num_entries - max_checkpoints;
+
+    for (steps = 0; node; node = node->prev, ++steps) {
+        size_t slot = hash_node(node, table_size);
+
+        while (table[slot].node) {
+            if (table[slot].node == node) {
+                return table[slot].position + steps;
+            }
+            slot = slot + 1 < table_size ? slot + 1 : 0;
+        }
+    }
+
+    assert(0);
+    return (size_t) -1;
+}
+
 void list_insert_left(List *list, ListNode *new_node, ListNode *position) {
     assert(list && new_node);
 
@@ -236,6 +569,7 @@ void list_cut(List *list, ListNode *from, ListNode *to, size_t range_size) {
     to->next = LIST_POISON_NEXT;
 
     list->size -= range_size;
+    ++list->version;
 }
 
 void list_paste(List *list, ListNode *left, ListNode *from, ListNode *to, ListNode *right, size_t range_size) {
@@ -260,6 +594,7 @@ void list_paste(List *list, ListNode *left, ListNode *from, ListNode *to, ListNo
     to->next = right;
 
     list->size += range_size;
+    ++list->version;
 }
 
 void list_sort(List *list, int (*compare)(const ListNode *a, const ListNode *b)) {
@@ -321,4 +656,218 @@ void list_sort(List *list, int (*compare)(const ListNode *a, const ListNode *b))
     } while (num_merges > 1);
     list->head = head;
     list->tail = tail;
+    ++list->version;
+}
+
+void list_sort_adaptive(List *list, int (*compare)(const ListNode *a, const ListNode *b)) {
+    /*
+     * The runs waiting to be merged. Every run is more than twice as long as the run above it, so there are
+     * never more of them than a size_t has bits (plus the one just pushed).
+     */
+    ListNode *runs[sizeof(size_t) * CHAR_BIT + 1];
+    size_t lengths[sizeof(size_t) * CHAR_BIT + 1];
+    size_t num_runs = 0;
+    ListNode *rest;
+
+    assert(list && compare);
+
+    if (list->size < 2) {
+        return;
+    }
+
+    for (rest = list->head; rest; ) {
+        runs[num_runs] = take_run(rest, compare, &lengths[num_runs], &rest);
+        ++num_runs;
+
+        while (num_runs > 1 && lengths[num_runs - 2] <= 2 * lengths[num_runs - 1]) {
+            runs[num_runs - 2] = merge_chains(runs[num_runs - 2], runs[num_runs - 1], compare);
+            lengths[num_runs - 2] += lengths[num_runs - 1];
+            --num_runs;
+        }
+    }
+
+    while (num_runs > 1) {
+        runs[num_runs - 2] = merge_chains(runs[num_runs - 2], runs[num_runs - 1], compare);
+        --num_runs;
+    }
+
+    relink_chain(list, runs[0]);
+}
+
+void list_merge(List *list, List *src_list, int (*compare)(const ListNode *a, const ListNode *b)) {
+    assert(list && src_list && list != src_list && compare);
+
+    if (src_list->size == 0) {
+        return;
+    }
+
+    if (list->size == 0) {
+        list_splice_back(list, src_list);
+        return;
+    }
+
+    /* Sorted pieces often do not overlap at all. */
+    if (compare(list->tail, src_list->head) <= 0) {
+        list_splice_back(list, src_list);
+        return;
+    }
+
+    relink_chain(list, merge_chains(list->head, src_list->head, compare));
+    list->size += src_list->size;
+
+    src_list->head = NULL;
+    src_list->tail = NULL;
+    src_list->size = 0;
+    ++src_list->version;
+}
+
+void list_sort_buffered(
+    List *list,
+    int (*compare)(const ListNode *a, const ListNode *b),
+    ListNode **scratch,
+    size_t scratch_len
+) {
+    ListNode **src, **dst;
+    size_t num_nodes, width, i;
+
+    assert(list && compare && (scratch || list->size < 2) && (list->size < 2 || scratch_len / 2 >= list->size));
+    (void) scratch_len;
+
+    num_nodes = list->size;
+
+    if (num_nodes < 2) {
+        return;
+    }
+
+    src = scratch;
+    dst = scratch + num_nodes;
+    copy_to_array(list, src);
+
+    /* Short blocks are insertion sorted first, since merging them would only shuffle pointers around. */
+    for (i = 0; i < num_nodes; i += MIN_RUN) {
+        size_t end = num_nodes - i < MIN_RUN ? num_nodes : i + MIN_RUN, j;
+
+        for (j = i + 1; j < end; ++j) {
+            ListNode *n = src[j];
+            size_t k = j;
+
+            while (k > i && compare(src[k - 1], n) > 0) {
+                src[k] = src[k - 1];
+                --k;
+            }
+
+            src[k] = n;
+        }
+    }
+
+    for (width = MIN_RUN; width < num_nodes; width *= 2) {
+        ListNode **swap;
+
+        for (i = 0; i < num_nodes; i += 2 * width) {
+            size_t left = i, middle, right, end, k = i;
+
+            middle = num_nodes - i < width ? num_nodes : i + width;
+            end = num_nodes - middle < width ? num_nodes : middle + width;
+            right = middle;
+
+            while (left < middle && right < end) {
+                dst[k++] = compare(src[left], src[right]) <= 0 ? src[left++] : src[right++];
+            }
+
+            while (left < middle) {
+                dst[k++] = src[left++];
+            }
+
+            while (right < end) {
+                dst[k++] = src[right++];
+            }
+        }
+
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    relink_array(list, src, num_nodes);
+}
+
+void list_sort_radix(
+    List *list,
+    unsigned long (*key)(const ListNode *node),
+    ListRadixEntry *scratch,
+    size_t scratch_len
+) {
+    ListRadixEntry *src, *dst;
+    ListNode *n;
+    unsigned long all_ones, any_ones;
+    size_t num_nodes, i;
+    unsigned shift;
+
+    assert(list && key && (scratch || list->size < 2) && (list->size < 2 || scratch_len / 2 >= list->size));
+    (void) scratch_len;
+
+    num_nodes = list->size;
+
+    if (num_nodes < 2) {
+        return;
+    }
+
+    src = scratch;
+    dst = scratch + num_nodes;
+
+    all_ones = ~0UL;
+    any_ones = 0;
+
+    for (n = list->head, i = 0; n; n = n->next, ++i) {
+        src[i].node = n;
+        src[i].key = key(n);
+        all_ones &= src[i].key;
+        any_ones |= src[i].key;
+    }
+
+    /* Each pass is a stable counting sort on one byte of the keys. Bytes that all keys share are skipped. */
+    for (shift = 0; shift < sizeof(unsigned long) * CHAR_BIT; shift += CHAR_BIT) {
+        size_t counts[UCHAR_MAX + 1], total = 0;
+        ListRadixEntry *swap;
+        unsigned digit;
+
+        if ((((all_ones ^ any_ones) >> shift) & UCHAR_MAX) == 0) {
+            continue;
+        }
+
+        for (digit = 0; digit <= UCHAR_MAX; ++digit) {
+            counts[digit] = 0;
+        }
+
+        for (i = 0; i < num_nodes; ++i) {
+            ++counts[(src[i].key >> shift) & UCHAR_MAX];
+        }
+
+        for (digit = 0; digit <= UCHAR_MAX; ++digit) {
+            size_t count = counts[digit];
+
+            counts[digit] = total;
+            total += count;
+        }
+
+        for (i = 0; i < num_nodes; ++i) {
+            dst[counts[(src[i].key >> shift) & UCHAR_MAX]++] = src[i];
+        }
+
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    src[0].node->prev = NULL;
+
+    for (i = 1; i < num_nodes; ++i) {
+        src[i - 1].node->next = src[i].node;
+        src[i].node->prev = src[i - 1].node;
+    }
+
+    src[num_nodes - 1].node->next = NULL;
+    list->head = src[0].node;
+    list->tail = src[num_nodes - 1].node;
+    ++list->version;
 }
@@ -48,12 +48,16 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *
  * Dependencies:
  *      -   C89 assert.h
+ *      -   C89 limits.h
  *      -   C89 stddef.h
  *
  * API:
  *      ====  TYPES  ====
  *      -   typedef struct List List
  *      -   typedef struct ListNode ListNode
+ *      -   typedef struct ListIndex ListIndex
+ *      -   typedef struct ListIndexEntry ListIndexEntry
+ *      -   typedef struct ListRadixEntry ListRadixEntry
  *
  *      ====  FUNCTIONS  ====
  *      Initializers:
@@ -68,6 +72,11 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *      Array Interfacing:
  *          -   list_index_of
  *          -   list_at
+ *      Indexed Array Interfacing:
+ *          -   list_index_init
+ *          -   list_index_rebuild
+ *          -   list_index_at
+ *          -   list_index_position_of
  *      Insertion:
  *          -   list_insert_left
  *          -   list_insert_right
@@ -88,6 +97,10 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *          -   list_paste
  *      Sorting:
  *          -   list_sort
+ *          -   list_sort_adaptive
+ *          -   list_sort_buffered
+ *          -   list_sort_radix
+ *          -   list_merge
  *
  *      ====  MACROS  ====
  *      Constants:
@@ -130,18 +143,26 @@ extern "C" {
 /* Struct type declarations. */
 struct List;
 struct ListNode;
+struct ListIndex;
+struct ListIndexEntry;
+struct ListRadixEntry;
 
 /* Struct typedef's. */
 typedef struct List List;
 typedef struct ListNode ListNode;
+typedef struct ListIndex ListIndex;
+typedef struct ListIndexEntry ListIndexEntry;
+typedef struct ListRadixEntry ListRadixEntry;
 
 /**
- * Represents a doubly linked list.
+ * Represents a doubly linked list. The version is changed by every operation that changes the order or the
+ * contents of the list, which lets a @ref ListIndex detect that it is out of date.
  */
 struct List {
     ListNode *head;
     ListNode *tail;
     size_t size;
+    unsigned long version;
 };
 
 /**
@@ -152,6 +173,38 @@ struct ListNode {
     ListNode *next;
 };
 
+/**
+ * Represents a checkpoint of a @ref ListIndex: a @ref ListNode and its position in the @ref List.
+ */
+struct ListIndexEntry {
+    ListNode *node;
+    size_t position;
+};
+
+/**
+ * Represents a @ref ListNode and its key in the scratch buffer of @ref list_sort_radix.
+ */
+struct ListRadixEntry {
+    ListNode *node;
+    unsigned long key;
+};
+
+/**
+ * Represents a positional index over a @ref List. A third of the caller-supplied @ref ListIndexEntry's record
+ * every stride'th @ref ListNode in order, and the rest are a hash table from @ref ListNode to position, so
+ * that positional lookups only walk from the nearest checkpoint instead of from the ends of the @ref List.
+ * The index is rebuilt lazily by the first lookup after the @ref List has been changed.
+ */
+struct ListIndex {
+    const List *list;
+    ListIndexEntry *entries;
+    size_t num_entries;
+    size_t num_checkpoints;
+    size_t stride;
+    unsigned long version;
+    int built;
+};
+
 /* ========================================================================================================
  *
  *                                               PROTOTYPES
@@ -295,6 +348,85 @@ size_t list_index_of(const List *list, const ListNode *node);
  */
 ListNode* list_at(const List *list, size_t index);
 
+/**
+ * Initializes the @ref index over the @ref list, using the @ref entries as its storage. With c ==
+ * @ref num_entries / 3 checkpoints, every positional lookup walks at most about n / (2 * c) @ref ListNode's, so
+ * a @ref num_entries of 3 * sqrt(n) gives O(sqrt(n)) lookups, and larger buffers give proportionally faster
+ * ones. The @ref index is built by the first lookup. The @ref index must be initialized again if the
+ * @ref list is reinitialized with @ref list_init rather than changed through its other functions.
+ *
+ * Requirements:
+ *      -   @ref index != NULL
+ *      -   @ref list != NULL
+ *      -   @ref entries != NULL
+ *      -   @ref num_entries >= 3
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param index                 The @ref ListIndex to be initialized.
+ * @param list                  The @ref List to index.
+ * @param entries               The storage of the @ref index. It must stay valid for as long as the
+ *                              @ref index is used.
+ * @param num_entries           The number of @ref ListIndexEntry's in the @ref entries.
+ */
+void list_index_init(ListIndex *index, const List *list, ListIndexEntry *entries, size_t num_entries);
+
+/**
+ * Rebuilds the @ref index from its @ref List right away. Lookups rebuild an out-of-date @ref index by
+ * themselves, so this only moves that cost to a time of the caller's choosing.
+ *
+ * Requirements:
+ *      -   @ref index != NULL
+ *
+ * Time complexity:
+ *      -   O(n + num_entries)
+ *
+ * @param index                 The @ref ListIndex to rebuild.
+ */
+void list_index_rebuild(ListIndex *index);
+
+/**
+ * Retrieves the @ref ListNode at the @ref position in the @ref List of the @ref index, walking from the
+ * nearest checkpoint.
+ *
+ * Requirements:
+ *      -   @ref index != NULL
+ *      -   @ref position < size of the @ref List of the @ref index
+ *
+ * Time complexity:
+ *      -   If up to date:
+ *          -   O(n / num_entries)
+ *      -   Else:
+ *          -   O(n + num_entries)
+ *
+ * @param index                 The @ref ListIndex to use.
+ * @param position              The index of the wanted @ref ListNode.
+ * @return                      The @ref ListNode at the @ref position.
+ */
+ListNode* list_index_at(ListIndex *index, size_t position);
+
+/**
+ * Retrieves the index of the @ref node in the @ref List of the @ref index, walking back from the @ref node to
+ * the nearest checkpoint.
+ *
+ * Requirements:
+ *      -   @ref index != NULL
+ *      -   @ref node != NULL
+ *      -   @ref node is in the @ref List of the @ref index
+ *
+ * Time complexity:
+ *      -   If up to date:
+ *          -   O(n / num_entries)
+ *      -   Else:
+ *          -   O(n + num_entries)
+ *
+ * @param index                 The @ref ListIndex to use.
+ * @param node                  The @ref ListNode whose index is wanted.
+ * @return                      The index of the @ref node.
+ */
+size_t list_index_position_of(ListIndex *index, const ListNode *node);
+
 /**
  * Inserts the @ref new_node to the left of the @ref position. If @ref position == NULL, inserts the
  * @ref new_node at the head of the @ref list.
@@ -555,6 +687,112 @@ void list_paste(List *list, ListNode *left, ListNode *from, ListNode *to, ListNo
  */
 void list_sort(List *list, int (*compare)(const ListNode *a, const ListNode *b));
 
+/**
+ * Sorts the @ref list in-place like @ref list_sort, but adapts to existing order: the @ref list is split into
+ * its natural runs (ascending runs, and strictly descending runs, which are reversed), which are then merged
+ * in a balanced order. An already sorted (or strictly reverse sorted) @ref list is sorted with n - 1 comparisons, and a
+ * @ref list made of r runs with O(nlog(r)) comparisons. This sort is stable (order of "equal" @ref ListNode's
+ * is preserved). The runs waiting to be merged take O(log(n)) auxiliary space on the call stack.
+ *
+ * Requirements:
+ *      -   @ref list != NULL
+ *      -   @ref compare != NULL
+ *
+ * Time complexity:
+ *      -   Best case:      O(n)
+ *      -   Worst case:     O(nlog(n))
+ *
+ * @param list                  The @ref List to sort.
+ * @param compare               The compare function to be used.
+ */
+void list_sort_adaptive(List *list, int (*compare)(const ListNode *a, const ListNode *b));
+
+/**
+ * Sorts the @ref list like @ref list_sort, but on an array of pointers to its @ref ListNode's instead of on
+ * the @ref ListNode's themselves: the pointers are copied into the @ref scratch buffer, merge sorted there,
+ * and the @ref list is relinked in a single pass at the end. Since the merges read and write contiguous
+ * memory instead of following "next" members all over the heap, this is much faster on large @ref List's.
+ * This sort is stable (order of "equal" @ref ListNode's is preserved).
+ *
+ * Requirements:
+ *      -   @ref list != NULL
+ *      -   @ref compare != NULL
+ *      -   @ref scratch holds at least 2 * @ref list->size pointers (or @ref list->size < 2)
+ *
+ * Time complexity:
+ *      -   O(nlog(n))
+ *
+ * @param list                  The @ref List to sort.
+ * @param compare               The compare function to be used.
+ * @param scratch               The buffer the sort works in. Its contents before and after the sort are
+ *                              irrelevant.
+ * @param scratch_len           The number of pointers the @ref scratch buffer holds.
+ */
+void list_sort_buffered(
+    List *list,
+    int (*compare)(const ListNode *a, const ListNode *b),
+    ListNode **scratch,
+    size_t scratch_len
+);
+
+/**
+ * Sorts the @ref list in ascending order of the integer keys returned by @ref key, using a least significant
+ * digit radix sort (one byte per pass) on an array of @ref ListRadixEntry's, which lives in the @ref scratch
+ * buffer. The key of every @ref ListNode is read once into its @ref ListRadixEntry, so the passes only walk the
+ * contiguous @ref scratch buffer, and the @ref ListNode's are only touched again to relink them. No comparisons
+ * are made at all, and bytes that every key has in common are skipped, so small keys only take a pass or two.
+ * This sort is stable (order of @ref ListNode's with equal keys is preserved).
+ *
+ * Requirements:
+ *      -   @ref list != NULL
+ *      -   @ref key != NULL
+ *      -   @ref scratch holds at least 2 * @ref list->size @ref ListRadixEntry's (or @ref list->size < 2)
+ *
+ * Time complexity:
+ *      -   O(n * k), where k == number of bytes of an unsigned long
+ *
+ * @param list                  The @ref List to sort.
+ * @param key                   The callback function returning the key of a @ref ListNode. It is called
+ *                              exactly once per @ref ListNode.
+ * @param scratch               The buffer the sort works in. Its contents before and after the sort are
+ *                              irrelevant.
+ * @param scratch_len           The number of @ref ListRadixEntry's the @ref scratch buffer holds.
+ */
+void list_sort_radix(
+    List *list,
+    unsigned long (*key)(const ListNode *node),
+    ListRadixEntry *scratch,
+    size_t scratch_len
+);
+
+/**
+ * Merges the sorted @ref src_list into the sorted @ref list, leaving the @ref src_list empty. The merge is
+ * stable, and on ties the @ref ListNode's of the @ref list come first. If the last @ref ListNode of the
+ * @ref list is not greater than the first @ref ListNode of the @ref src_list, it is simply spliced on.
+ *
+ * A large @ref List can be sorted on several threads with this: @ref list_cut it into pieces, give each piece
+ * its own @ref List with @ref list_paste, sort the pieces concurrently, then merge them back together (in
+ * pairs, so that the merges can be concurrent as well).
+ *
+ * Requirements:
+ *      -   @ref list != NULL
+ *      -   @ref src_list != NULL
+ *      -   @ref list != @ref src_list
+ *      -   @ref compare != NULL
+ *      -   @ref list and @ref src_list are both sorted according to @ref compare
+ *
+ * Time complexity:
+ *      -   If the @ref List's do not overlap:
+ *          -   O(1)
+ *      -   Else:
+ *          -   O(n + m), where m == size of @ref src_list
+ *
+ * @param list                  The sorted @ref List to merge into.
+ * @param src_list              The sorted @ref List whose @ref ListNode's are moved into the @ref list.
+ * @param compare               The compare function to be used.
+ */
+void list_merge(List *list, List *src_list, int (*compare)(const ListNode *a, const ListNode *b));
+
 /* ========================================================================================================
  *
  *                                                 MACROS
@@ -0,0 +1,272 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "lrucache.h"
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/*
+ * Links the @ref node, which was just inserted into the @ref HashTable of the @ref lrucache, into its
+ * @ref List. The @ref node becomes the most recently used @ref LRUCacheNode, or, under
+ * @ref LRUCACHE_POLICY_CLOCK, the last one the sweep reaches.
+ */
+static void link_node(LRUCache *lrucache, LRUCacheNode *node);
+
+/*
+ * Unlinks the @ref node from the @ref List of the @ref lrucache, moving the hand past it if needed.
+ */
+static void unlink_node(LRUCache *lrucache, LRUCacheNode *node);
+
+/*
+ * Returns the @ref LRUCacheNode of the @ref lrucache to be evicted next. Under @ref LRUCACHE_POLICY_CLOCK, the
+ * hand is left at the returned @ref LRUCacheNode.
+ */
+static LRUCacheNode* choose_victim(LRUCache *lrucache);
+
+/*
+ * Collide callback function of the @ref HashTable of the @ref LRUCache passed as the @ref auxiliary_data.
+ * Gives the @ref new_node the place of the @ref old_node in the @ref List, then calls the evict callback
+ * function on the @ref old_node.
+ */
+static void collide(const HashTableNode *old_node, const HashTableNode *new_node, void *auxiliary_data);
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static void link_node(LRUCache *lrucache, LRUCacheNode *node) {
+    assert(lrucache && node);
+
+    node->referenced = 0;
+
+    /* The sweep moves towards the front and wraps around, so the node right behind the hand is reached last. */
+    if (lrucache->policy == LRUCACHE_POLICY_CLOCK && lrucache->hand) {
+        list_insert_right(&lrucache->list, &node->list_node, lrucache->hand);
+    } else {
+        list_insert_front(&lrucache->list, &node->list_node);
+    }
+}
+
+static void unlink_node(LRUCache *lrucache, LRUCacheNode *node) {
+    assert(lrucache && node);
+
+    if (lrucache->hand == &node->list_node) {
+        lrucache->hand = node->list_node.prev;
+    }
+
+    list_remove(&lrucache->list, &node->list_node);
+}
+
+static LRUCacheNode* choose_victim(LRUCache *lrucache) {
+    ListNode *n;
+
+    assert(lrucache && lrucache->list.tail);
+
+    if (lrucache->policy == LRUCACHE_POLICY_LRU) {
+        return list_entry(lrucache->list.tail, LRUCacheNode, list_node);
+    }
+
+    /* Every LRUCacheNode passed over loses its flag, so this takes at most one full circle. */
+    n = lrucache->hand ? lrucache->hand : lrucache->list.tail;
+
+    while (list_entry(n, LRUCacheNode, list_node)->referenced) {
+        list_entry(n, LRUCacheNode, list_node)->referenced = 0;
+        n = n->prev ? n->prev : lrucache->list.tail;
+    }
+
+    lrucache->hand = n;
+
+    return list_entry(n, LRUCacheNode, list_node);
+}
+
+static void collide(const HashTableNode *old_node, const HashTableNode *new_node, void *auxiliary_data) {
+    LRUCache *lrucache = (LRUCache*) auxiliary_data;
+    LRUCacheNode *old_entry = hashtable_entry(old_node, LRUCacheNode, hash_node);
+    LRUCacheNode *new_entry = hashtable_entry(new_node, LRUCacheNode, hash_node);
+
+    assert(lrucache);
+
+    if (lrucache->policy == LRUCACHE_POLICY_CLOCK) {
+        /* Replacing a LRUCacheNode in place keeps the sweep where it is, and counts as a use of the key. */
+        list_insert_right(&lrucache->list, &new_entry->list_node, &old_entry->list_node);
+        new_entry->referenced = 1;
+
+        if (lrucache->hand == &old_entry->list_node) {
+            lrucache->hand = &new_entry->list_node;
+        }
+
+        list_remove(&lrucache->list, &old_entry->list_node);
+    } else {
+        unlink_node(lrucache, old_entry);
+        link_node(lrucache, new_entry);
+    }
+
+    if (lrucache->evict) {
+        lrucache->evict(old_entry, lrucache->auxiliary_data);
+    }
+}
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+void lrucache_init(
+    LRUCache *lrucache,
+    HashTableNode **bucket_array,
+    size_t num_buckets,
+    size_t capacity,
+    LRUCachePolicy policy,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const HashTableNode *node),
+    const void* (*key)(const HashTableNode *node),
+    void (*evict)(LRUCacheNode *node, void *auxiliary_data),
+    void *auxiliary_data
+) {
+    assert(lrucache && capacity > 0 && key);
+    assert(policy == LRUCACHE_POLICY_LRU || policy == LRUCACHE_POLICY_CLOCK);
+
+    hashtable_init(&lrucache->hashtable, bucket_array, num_buckets, hash, equal, collide, lrucache);
+    list_init(&lrucache->list);
+    lrucache->hand = NULL;
+    lrucache->capacity = capacity;
+    lrucache->policy = policy;
+    lrucache->key = key;
+    lrucache->evict = evict;
+    lrucache->auxiliary_data = auxiliary_data;
+}
+
+size_t lrucache_capacity(const LRUCache *lrucache) {
+    assert(lrucache);
+
+    return lrucache->capacity;
+}
+
+size_t lrucache_size(const LRUCache *lrucache) {
+    assert(lrucache);
+
+    return hashtable_size(&lrucache->hashtable);
+}
+
+int lrucache_empty(const LRUCache *lrucache) {
+    assert(lrucache);
+
+    return hashtable_empty(&lrucache->hashtable);
+}
+
+int lrucache_contains_key(const LRUCache *lrucache, const void *key) {
+    assert(lrucache);
+
+    return hashtable_contains_key(&lrucache->hashtable, key);
+}
+
+void lrucache_put(LRUCache *lrucache, const void *key, LRUCacheNode *node) {
+    LRUCacheNode *victim = NULL;
+    size_t size;
+
+    assert(lrucache && node);
+
+    size = hashtable_size(&lrucache->hashtable);
+    hashtable_insert(&lrucache->hashtable, key, &node->hash_node);
+
+    /* On a key collision, the collide callback function has already put the node in place. */
+    if (hashtable_size(&lrucache->hashtable) == size) {
+        return;
+    }
+
+    /* The node is not linked yet, so it cannot be chosen. */
+    if (size == lrucache->capacity) {
+        victim = choose_victim(lrucache);
+        unlink_node(lrucache, victim);
+        hashtable_remove_key(&lrucache->hashtable, lrucache->key(&victim->hash_node));
+    }
+
+    link_node(lrucache, node);
+
+    if (victim && lrucache->evict) {
+        lrucache->evict(victim, lrucache->auxiliary_data);
+    }
+}
+
+LRUCacheNode* lrucache_get(LRUCache *lrucache, const void *key) {
+    HashTableNode *n;
+    LRUCacheNode *node;
+
+    assert(lrucache);
+
+    n = hashtable_lookup_key(&lrucache->hashtable, key);
+
+    if (!n) {
+        return NULL;
+    }
+
+    node = hashtable_entry(n, LRUCacheNode, hash_node);
+
+    if (lrucache->policy == LRUCACHE_POLICY_CLOCK) {
+        /* Not writing a flag that is already set keeps repeated hits from dirtying the cache line. */
+        if (!node->referenced) {
+            node->referenced = 1;
+        }
+    } else if (lrucache->list.head != &node->list_node) {
+        list_remove(&lrucache->list, &node->list_node);
+        list_insert_front(&lrucache->list, &node->list_node);
+    }
+
+    return node;
+}
+
+LRUCacheNode* lrucache_peek(const LRUCache *lrucache, const void *key) {
+    HashTableNode *n;
+
+    assert(lrucache);
+
+    n = hashtable_lookup_key(&lrucache->hashtable, key);
+
+    return n ? hashtable_entry(n, LRUCacheNode, hash_node) : NULL;
+}
+
+void lrucache_remove_key(LRUCache *lrucache, const void *key) {
+    HashTableNode *n;
+
+    assert(lrucache);
+
+    n = hashtable_lookup_key(&lrucache->hashtable, key);
+
+    if (n) {
+        unlink_node(lrucache, hashtable_entry(n, LRUCacheNode, hash_node));
+        hashtable_remove_key(&lrucache->hashtable, key);
+    }
+}
+
+void lrucache_remove_all(LRUCache *lrucache) {
+    assert(lrucache);
+
+    hashtable_remove_all(&lrucache->hashtable);
+    list_remove_all(&lrucache->list);
+    lrucache->hand = NULL;
+}
@@ -0,0 +1,437 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+ * @file    lrucache.h
+ * @brief   LRU/CLOCK CACHE
+ *
+ * Embed one or more @ref LRUCacheNode's into your struct to make it a potential entry in one or more caches.
+ * The @ref LRUCache structure keeps track of at most a fixed number (the capacity) of @ref LRUCacheNode's,
+ * and evicts one whenever inserting another would exceed the capacity. A @ref LRUCache MUST be initialized
+ * before it is used. A @ref LRUCacheNode does NOT need to be initialized before it is used. A
+ * @ref LRUCacheNode should belong to at most ONE @ref LRUCache.
+ *
+ * Unlike the other data structures of this library, a @ref LRUCache is built on two of them: a
+ * @ref HashTable finds the @ref LRUCacheNode of a key, and a @ref List orders the @ref LRUCacheNode's for
+ * eviction. A @ref LRUCacheNode embeds both a @ref HashTableNode and a @ref ListNode, so one @ref lrucache_get
+ * looks a key up and updates the eviction order without a second lookup. The header/source pairs of both
+ * data structures are therefore required as well.
+ *
+ * The eviction order is decided by the policy of the @ref LRUCache:
+ *      -   @ref LRUCACHE_POLICY_LRU evicts the least recently used @ref LRUCacheNode. Every hit moves the
+ *          @ref LRUCacheNode to the front of the @ref List, which writes to the @ref LRUCacheNode and its
+ *          neighbors.
+ *      -   @ref LRUCACHE_POLICY_CLOCK approximates it with the CLOCK (second chance) algorithm. A hit merely
+ *          sets the referenced flag of the @ref LRUCacheNode (if it is not set already), and the @ref List is
+ *          only relinked on insertion and eviction. A "hand" sweeps the @ref List in a circle, and evicts the
+ *          first @ref LRUCacheNode whose flag is not set, clearing the flags it passes over.
+ *
+ * The user is required to define a bucket array, a hash function and an equal function, which are used
+ * exactly as for a @ref HashTable (see hashtable.h), and a key function which returns the key of a
+ * @ref LRUCacheNode, which is needed to remove an evicted @ref LRUCacheNode from the @ref HashTable. The
+ * equal and key functions receive the "hash_node" member of a @ref LRUCacheNode, which @ref lrucache_hash_entry
+ * converts into the struct it is embedded in. The bucket array should have about as many buckets as the
+ * capacity, since the @ref LRUCache never rehashes.
+ *
+ * The user can OPTIONALLY define an evict function, which is called with every @ref LRUCacheNode that
+ * @ref lrucache_put removes from the @ref LRUCache, either because the capacity was reached or because a
+ * @ref LRUCacheNode with the same key was put into the @ref LRUCache, and with the auxiliary data that was
+ * stored in the @ref LRUCache during initialization. The @ref LRUCacheNode is no longer in the @ref LRUCache
+ * when the evict function is called, so it can be freed or reused right away. Note that the auxiliary data is
+ * NEVER manipulated by the @ref LRUCache.
+ *
+ * A @ref LRUCache is NOT synchronized.
+ *
+ * Example:
+ *          struct Object {
+ *              int key;
+ *              int val;
+ *              LRUCacheNode n;
+ *          };
+ *
+ *          size_t hash(const void *key) {
+ *              return *(const int*)key;
+ *          }
+ *
+ *          int equal(const void *key, const HashTableNode *node) {
+ *              return *(const int*)key == lrucache_hash_entry(node, struct Object, n)->key;
+ *          }
+ *
+ *          const void* key(const HashTableNode *node) {
+ *              return &lrucache_hash_entry(node, struct Object, n)->key;
+ *          }
+ *
+ *          int main(void) {
+ *              struct Object obj;
+ *              LRUCache lrucache;
+ *              HashTableNode *bucket_array[4];
+ *              int copy_val;
+ *
+ *              obj.key = 1;
+ *
+ *              lrucache_init(&lrucache, bucket_array, 4, 4, LRUCACHE_POLICY_LRU, hash, equal, key, NULL, NULL);
+ *              lrucache_put(&lrucache, &obj.key, &obj.n);
+ *
+ *              obj.val = 1000;
+ *              copy_val = lrucache_entry(lrucache_get(&lrucache, &obj.key), struct Object, n)->val;
+ *              assert(obj.val == copy_val);
+ *
+ *              return 0;
+ *          }
+ *
+ * Dependencies:
+ *      -   C89 assert.h
+ *      -   C89 stddef.h
+ *      -   hashtable.h
+ *      -   list.h
+ *
+ * API:
+ *      ====  TYPES  ====
+ *      -   typedef struct LRUCache LRUCache
+ *      -   typedef struct LRUCacheNode LRUCacheNode
+ *      -   typedef enum LRUCachePolicy LRUCachePolicy
+ *          -   LRUCACHE_POLICY_LRU = 0
+ *          -   LRUCACHE_POLICY_CLOCK = 1
+ *
+ *      ====  FUNCTIONS  ====
+ *      Initializers:
+ *          -   lrucache_init
+ *      Properties:
+ *          -   lrucache_capacity
+ *          -   lrucache_size
+ *          -   lrucache_empty
+ *          -   lrucache_contains_key
+ *      Insertion:
+ *          -   lrucache_put
+ *      Lookup:
+ *          -   lrucache_get
+ *          -   lrucache_peek
+ *      Removal:
+ *          -   lrucache_remove_key
+ *          -   lrucache_remove_all
+ *
+ *      ====  MACROS  ====
+ *      Convenient Node Initializer:
+ *          -   LRUCACHE_NODE_INIT
+ *      Properties:
+ *          -   lrucache_entry
+ *          -   lrucache_hash_entry
+ */
+
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+#include "hashtable.h"
+#include "list.h"
+
+/* ========================================================================================================
+ *
+ *                                                  TYPES
+ *
+ * ======================================================================================================== */
+
+/* Struct type declarations. */
+struct LRUCache;
+struct LRUCacheNode;
+
+/* Struct typedef's. */
+typedef struct LRUCache LRUCache;
+typedef struct LRUCacheNode LRUCacheNode;
+
+/**
+ * Represents the way a @ref LRUCache chooses the @ref LRUCacheNode to evict.
+ */
+typedef enum LRUCachePolicy {
+    LRUCACHE_POLICY_LRU = 0,
+    LRUCACHE_POLICY_CLOCK = 1
+} LRUCachePolicy;
+
+/**
+ * Represents a cache. The "hand" is the @ref ListNode the CLOCK sweep continues at, or NULL if it continues at
+ * the back of the @ref List.
+ */
+struct LRUCache {
+    HashTable hashtable;
+    List list;
+    ListNode *hand;
+    size_t capacity;
+    LRUCachePolicy policy;
+    const void* (*key)(const HashTableNode *node);
+    void (*evict)(LRUCacheNode *node, void *auxiliary_data);
+    void *auxiliary_data;
+};
+
+/**
+ * Represents a node in a @ref LRUCache. Embed this into your structure to make it a node.
+ */
+struct LRUCacheNode {
+    HashTableNode hash_node;
+    ListNode list_node;
+    int referenced;
+};
+
+/* ========================================================================================================
+ *
+ *                                               PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * Initializes/resets the @ref lrucache. Clears the @ref bucket_array.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *      -   @ref bucket_array != NULL
+ *      -   @ref num_buckets > 0
+ *      -   @ref capacity > 0
+ *      -   @ref hash != NULL
+ *      -   @ref equal != NULL
+ *      -   @ref key != NULL
+ *
+ * Time complexity:
+ *      -   O(m), where m == @ref num_buckets
+ *
+ * @param lrucache              The @ref LRUCache to be initialized/reset.
+ * @param bucket_array          The bucket array of the @ref HashTable of the @ref lrucache.
+ * @param num_buckets           The number of buckets in the @ref bucket_array.
+ * @param capacity              The maximum number of @ref LRUCacheNode's in the @ref lrucache.
+ * @param policy                The way the @ref lrucache chooses the @ref LRUCacheNode to evict.
+ * @param hash                  The callback function used to obtain the hashcode of a key.
+ * @param equal                 The callback function used to determine if a key is equal to the key of the
+ *                              @ref LRUCacheNode whose "hash_node" member is passed.
+ * @param key                   The callback function used to obtain the key of the @ref LRUCacheNode whose
+ *                              "hash_node" member is passed.
+ * @param evict                 The OPTIONAL (i.e. can be NULL) callback function called with every
+ *                              @ref LRUCacheNode that @ref lrucache_put removes from the @ref lrucache.
+ * @param auxiliary_data        The auxiliary data passed to the OPTIONAL @ref evict callback function if the
+ *                              @ref evict callback function is non-NULL. This data is NEVER manipulated by
+ *                              the @ref lrucache.
+ */
+void lrucache_init(
+    LRUCache *lrucache,
+    HashTableNode **bucket_array,
+    size_t num_buckets,
+    size_t capacity,
+    LRUCachePolicy policy,
+    size_t (*hash)(const void *key),
+    int (*equal)(const void *key, const HashTableNode *node),
+    const void* (*key)(const HashTableNode *node),
+    void (*evict)(LRUCacheNode *node, void *auxiliary_data),
+    void *auxiliary_data
+);
+
+/**
+ * Returns the maximum number of @ref LRUCacheNode's in the @ref lrucache.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ * @return                      The capacity of the @ref lrucache.
+ */
+size_t lrucache_capacity(const LRUCache *lrucache);
+
+/**
+ * Returns the number of @ref LRUCacheNode's in the @ref lrucache.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ * @return                      The size of the @ref lrucache.
+ */
+size_t lrucache_size(const LRUCache *lrucache);
+
+/**
+ * Returns whether the @ref lrucache is empty.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ * @return                      1 if the @ref lrucache is empty, otherwise 0.
+ */
+int lrucache_empty(const LRUCache *lrucache);
+
+/**
+ * Returns whether the @ref lrucache contains a @ref LRUCacheNode with the @ref key. Does NOT count as a use
+ * of the @ref LRUCacheNode.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *
+ * Time complexity:
+ *      -   Best/Average Case: O(1)
+ *      -   Worst Case: O(n)
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ * @param key                   The key used for lookup.
+ * @return                      1 if the @ref lrucache contains the @ref key, otherwise 0.
+ */
+int lrucache_contains_key(const LRUCache *lrucache, const void *key);
+
+/**
+ * Inserts the @ref node into the @ref lrucache as its most recently used @ref LRUCacheNode. If a
+ * @ref LRUCacheNode with the same key is in the @ref lrucache, the @ref node replaces it. Otherwise, if the
+ * @ref lrucache is full, a @ref LRUCacheNode is evicted first. Either way, the evict callback function (if
+ * non-NULL) is called on the @ref LRUCacheNode that left the @ref lrucache, after the @ref node is inserted.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   Best/Average Case: O(1) (amortized for @ref LRUCACHE_POLICY_CLOCK)
+ *      -   Worst Case: O(n)
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ * @param key                   The key of the @ref node.
+ * @param node                  The @ref LRUCacheNode to be inserted.
+ */
+void lrucache_put(LRUCache *lrucache, const void *key, LRUCacheNode *node);
+
+/**
+ * Returns the @ref LRUCacheNode with the @ref key, and marks it as used, or returns NULL if there is none.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *
+ * Time complexity:
+ *      -   Best/Average Case: O(1)
+ *      -   Worst Case: O(n)
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ * @param key                   The key used for lookup.
+ * @return                      The @ref LRUCacheNode with the @ref key, or NULL if there is none.
+ */
+LRUCacheNode* lrucache_get(LRUCache *lrucache, const void *key);
+
+/**
+ * Returns the @ref LRUCacheNode with the @ref key, or NULL if there is none, WITHOUT marking it as used.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *
+ * Time complexity:
+ *      -   Best/Average Case: O(1)
+ *      -   Worst Case: O(n)
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ * @param key                   The key used for lookup.
+ * @return                      The @ref LRUCacheNode with the @ref key, or NULL if there is none.
+ */
+LRUCacheNode* lrucache_peek(const LRUCache *lrucache, const void *key);
+
+/**
+ * Removes the @ref LRUCacheNode with the @ref key from the @ref lrucache, WITHOUT calling the evict callback
+ * function. If there is none, this function simply returns.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *
+ * Time complexity:
+ *      -   Best/Average Case: O(1)
+ *      -   Worst Case: O(n)
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ * @param key                   The key used for lookup.
+ */
+void lrucache_remove_key(LRUCache *lrucache, const void *key);
+
+/**
+ * Removes all the @ref LRUCacheNode's from the @ref lrucache, WITHOUT calling the evict callback function.
+ *
+ * Requirements:
+ *      -   @ref lrucache != NULL
+ *
+ * Time complexity:
+ *      -   O(m), where m == number of buckets in bucket array
+ *
+ * @param lrucache              The @ref LRUCache to be operated on.
+ */
+void lrucache_remove_all(LRUCache *lrucache);
+
+/* ========================================================================================================
+ *
+ *                                                 MACROS
+ *
+ * ======================================================================================================== */
+
+/**
+ * Initializing a @ref LRUCacheNode before it is used is NOT required. This macro is simply for allowing you to
+ * initialize a struct (containing one or more @ref LRUCacheNode's) with an initializer-list conveniently.
+ */
+#define LRUCACHE_NODE_INIT { HASHTABLE_NODE_INIT, LIST_NODE_INIT, 0 }
+
+/**
+ * Obtains the pointer to the struct for this entry.
+ *
+ * Requirements:
+ *      -   @ref node_ptr != NULL
+ *
+ * @param node_ptr              The pointer to the @ref LRUCacheNode in the struct.
+ * @param type                  The type of the struct the @ref LRUCacheNode is embedded in.
+ * @param member                The name of the @ref LRUCacheNode in the struct.
+ */
+#if defined(__GNUC__) && !defined(__STRICT_ANSI__)
+    #define lrucache_entry(node_ptr, type, member) \
+        ({ \
+            const typeof(((type*)0)->member) *__mptr = (node_ptr); \
+            (type*) ((char*)__mptr - offsetof(type, member)); \
+        })
+#else
+    #define lrucache_entry(node_ptr, type, member) \
+        ( \
+            (type*) ((char*)(node_ptr) - offsetof(type, member)) \
+        )
+#endif
+
+/**
+ * Obtains the pointer to the struct for this entry from the "hash_node" member of its @ref LRUCacheNode, as
+ * passed to the equal and key callback functions.
+ *
+ * Requirements:
+ *      -   @ref node_ptr != NULL
+ *
+ * @param node_ptr              The pointer to the "hash_node" member of the @ref LRUCacheNode in the struct.
+ * @param type                  The type of the struct the @ref LRUCacheNode is embedded in.
+ * @param member                The name of the @ref LRUCacheNode in the struct.
+ */
+#define lrucache_hash_entry(node_ptr, type, member) \
+    lrucache_entry(hashtable_entry((node_ptr), LRUCacheNode, hash_node), type, member)
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LRUCACHE_H */
@@ -0,0 +1,266 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "pairingheap.h"
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/*
+ * Melds the trees rooted at @ref a and @ref b, by making the root of the lower priority the first child of the
+ * other, and returns the root of the result. Neither the "next" nor the "prev" member of the returned root is
+ * set.
+ */
+static PairingHeapNode* meld(const PairingHeap *pairingheap, PairingHeapNode *a, PairingHeapNode *b);
+
+/*
+ * Melds the chain of siblings starting at @ref first into a single tree with the two-pass pairing, and returns
+ * its root (with NULL "next" and "prev" members), or NULL if @ref first == NULL.
+ */
+static PairingHeapNode* combine_siblings(const PairingHeap *pairingheap, PairingHeapNode *first);
+
+/*
+ * Cuts the tree rooted at the @ref node, which must NOT be the root, off from its parent and siblings.
+ */
+static void cut(PairingHeapNode *node);
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static PairingHeapNode* meld(const PairingHeap *pairingheap, PairingHeapNode *a, PairingHeapNode *b) {
+    PairingHeapNode *n;
+
+    assert(pairingheap && a && b);
+
+    if (pairingheap->compare(b, a) < 0) {
+        n = a;
+        a = b;
+        b = n;
+    }
+
+    b->next = a->child;
+    b->prev = a;
+
+    if (a->child) {
+        a->child->prev = b;
+    }
+
+    a->child = b;
+
+    return a;
+}
+
+static PairingHeapNode* combine_siblings(const PairingHeap *pairingheap, PairingHeapNode *first) {
+    PairingHeapNode *pairs = NULL, *root, *a, *b;
+
+    assert(pairingheap);
+
+    if (!first) {
+        return NULL;
+    }
+
+    /* First pass: meld the siblings in pairs from left to right, chaining the results in reverse order. */
+    while (first) {
+        a = first;
+        b = a->next;
+
+        if (b) {
+            first = b->next;
+            a = meld(pairingheap, a, b);
+        } else {
+            first = NULL;
+        }
+
+        a->next = pairs;
+        pairs = a;
+    }
+
+    /* Second pass: meld the results from right to left into the last one. */
+    root = pairs;
+    pairs = pairs->next;
+
+    while (pairs) {
+        a = pairs;
+        pairs = pairs->next;
+        root = meld(pairingheap, root, a);
+    }
+
+    root->next = NULL;
+    root->prev = NULL;
+
+    return root;
+}
+
+static void cut(PairingHeapNode *node) {
+    assert(node && node->prev);
+
+    if (node->prev->child == node) {
+        node->prev->child = node->next;
+    } else {
+        node->prev->next = node->next;
+    }
+
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+void pairingheap_init(PairingHeap *pairingheap, int (*compare)(const PairingHeapNode *a, const PairingHeapNode *b)) {
+    assert(pairingheap && compare);
+
+    pairingheap->compare = compare;
+    pairingheap->root = NULL;
+    pairingheap->size = 0;
+}
+
+PairingHeapNode* pairingheap_peek(const PairingHeap *pairingheap) {
+    assert(pairingheap);
+
+    return pairingheap->root;
+}
+
+size_t pairingheap_size(const PairingHeap *pairingheap) {
+    assert(pairingheap);
+
+    return pairingheap->size;
+}
+
+int pairingheap_empty(const PairingHeap *pairingheap) {
+    assert(pairingheap);
+
+    return pairingheap->size == 0;
+}
+
+void pairingheap_push(PairingHeap *pairingheap, PairingHeapNode *node) {
+    assert(pairingheap && node);
+
+    node->child = NULL;
+    node->next = NULL;
+    node->prev = NULL;
+
+    pairingheap->root = pairingheap->root ? meld(pairingheap, pairingheap->root, node) : node;
+    pairingheap->root->next = NULL;
+    pairingheap->root->prev = NULL;
+
+    ++pairingheap->size;
+}
+
+void pairingheap_merge(PairingHeap *pairingheap, PairingHeap *src_pairingheap) {
+    assert(pairingheap && src_pairingheap && pairingheap != src_pairingheap);
+
+    if (!src_pairingheap->root) {
+        return;
+    }
+
+    if (pairingheap->root) {
+        pairingheap->root = meld(pairingheap, pairingheap->root, src_pairingheap->root);
+        pairingheap->root->next = NULL;
+        pairingheap->root->prev = NULL;
+    } else {
+        pairingheap->root = src_pairingheap->root;
+    }
+
+    pairingheap->size += src_pairingheap->size;
+
+    src_pairingheap->root = NULL;
+    src_pairingheap->size = 0;
+}
+
+void pairingheap_decrease_key(PairingHeap *pairingheap, PairingHeapNode *node) {
+    assert(pairingheap && pairingheap->root && node);
+
+    if (node == pairingheap->root) {
+        return;
+    }
+
+    cut(node);
+
+    pairingheap->root = meld(pairingheap, pairingheap->root, node);
+    pairingheap->root->next = NULL;
+    pairingheap->root->prev = NULL;
+}
+
+PairingHeapNode* pairingheap_pop(PairingHeap *pairingheap) {
+    PairingHeapNode *n;
+
+    assert(pairingheap);
+
+    n = pairingheap->root;
+
+    if (n) {
+        pairingheap_remove(pairingheap, n);
+    }
+
+    return n;
+}
+
+void pairingheap_remove(PairingHeap *pairingheap, PairingHeapNode *node) {
+    PairingHeapNode *subtree;
+
+    assert(pairingheap && pairingheap->root && node);
+
+    if (node == pairingheap->root) {
+        pairingheap->root = combine_siblings(pairingheap, node->child);
+    } else {
+        cut(node);
+        subtree = combine_siblings(pairingheap, node->child);
+
+        if (subtree) {
+            pairingheap->root = meld(pairingheap, pairingheap->root, subtree);
+            pairingheap->root->next = NULL;
+            pairingheap->root->prev = NULL;
+        }
+    }
+
+    node->child = PAIRINGHEAP_POISON_CHILD;
+    node->next = PAIRINGHEAP_POISON_NEXT;
+    node->prev = PAIRINGHEAP_POISON_PREV;
+
+    --pairingheap->size;
+}
+
+void pairingheap_remove_all(PairingHeap *pairingheap) {
+    assert(pairingheap);
+
+    if (pairingheap->root) {
+        pairingheap->root->child = PAIRINGHEAP_POISON_CHILD;
+        pairingheap->root->next = PAIRINGHEAP_POISON_NEXT;
+        pairingheap->root->prev = PAIRINGHEAP_POISON_PREV;
+    }
+
+    pairingheap->root = NULL;
+    pairingheap->size = 0;
+}
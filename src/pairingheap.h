@@ -0,0 +1,373 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+ * @file    pairingheap.h
+ * @brief   PAIRING HEAP (PRIORITY QUEUE)
+ *
+ * Embed one or more @ref PairingHeapNode's into your struct to make it a potential node in one or more
+ * pairing heaps. The @ref PairingHeap structure keeps track of a tree of @ref PairingHeapNode's, whose root
+ * (the top) is always a @ref PairingHeapNode of the highest priority. A @ref PairingHeap MUST be initialized
+ * before it is used. A @ref PairingHeapNode does NOT need to be initialized before it is used. A
+ * @ref PairingHeapNode should belong to at most ONE @ref PairingHeap.
+ *
+ * The user is required to define a compare function which compares two @ref PairingHeapNode's, and returns a
+ * negative number if the first one has a higher priority than the second one (i.e. the smallest
+ * @ref PairingHeapNode is the top if the compare function compares like strcmp). @ref PairingHeapNode's of
+ * equal priority are popped in an unspecified order.
+ *
+ * Insertion and merging only link two trees, so they never call the compare function more than once. The cost
+ * of restructuring the tree is paid by @ref pairingheap_pop and @ref pairingheap_remove, which pair up the
+ * children of the removed @ref PairingHeapNode in two passes. Unlike a balanced search tree used as a priority
+ * queue, nothing is rebalanced on insertion, which makes a @ref PairingHeap one of the fastest priority queues
+ * in practice. Every @ref PairingHeapNode knows its parent or previous sibling, so an arbitrary
+ * @ref PairingHeapNode can be removed, or moved up after its priority was raised, without searching for it.
+ *
+ * Example:
+ *          struct Object {
+ *              int priority;
+ *              PairingHeapNode n;
+ *          };
+ *
+ *          int compare(const PairingHeapNode *a, const PairingHeapNode *b) {
+ *              return pairingheap_entry(a, struct Object, n)->priority -
+ *                     pairingheap_entry(b, struct Object, n)->priority;
+ *          }
+ *
+ *          int main(void) {
+ *              struct Object obj1, obj2;
+ *              PairingHeap pairingheap;
+ *
+ *              obj1.priority = 2;
+ *              obj2.priority = 1;
+ *
+ *              pairingheap_init(&pairingheap, compare);
+ *              pairingheap_push(&pairingheap, &obj1.n);
+ *              pairingheap_push(&pairingheap, &obj2.n);
+ *
+ *              assert(pairingheap_pop(&pairingheap) == &obj2.n);
+ *              assert(pairingheap_pop(&pairingheap) == &obj1.n);
+ *
+ *              return 0;
+ *          }
+ *
+ * Dependencies:
+ *      -   C89 assert.h
+ *      -   C89 stddef.h
+ *
+ * API:
+ *      ====  TYPES  ====
+ *      -   typedef struct PairingHeap PairingHeap
+ *      -   typedef struct PairingHeapNode PairingHeapNode
+ *
+ *      ====  FUNCTIONS  ====
+ *      Initializers:
+ *          -   pairingheap_init
+ *      Properties:
+ *          -   pairingheap_peek
+ *          -   pairingheap_size
+ *          -   pairingheap_empty
+ *      Insertion:
+ *          -   pairingheap_push
+ *          -   pairingheap_merge
+ *      Priority Changes:
+ *          -   pairingheap_decrease_key
+ *      Removal:
+ *          -   pairingheap_pop
+ *          -   pairingheap_remove
+ *          -   pairingheap_remove_all
+ *
+ *      ====  MACROS  ====
+ *      Constants:
+ *          -   PAIRINGHEAP_POISON_CHILD
+ *          -   PAIRINGHEAP_POISON_NEXT
+ *          -   PAIRINGHEAP_POISON_PREV
+ *      Convenient Node Initializer:
+ *          -   PAIRINGHEAP_NODE_INIT
+ *      Properties:
+ *          -   pairingheap_entry
+ */
+
+#ifndef PAIRINGHEAP_H
+#define PAIRINGHEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+/* ========================================================================================================
+ *
+ *                                                  TYPES
+ *
+ * ======================================================================================================== */
+
+/* Struct type declarations. */
+struct PairingHeap;
+struct PairingHeapNode;
+
+/* Struct typedef's. */
+typedef struct PairingHeap PairingHeap;
+typedef struct PairingHeapNode PairingHeapNode;
+
+/**
+ * Represents a pairing heap.
+ */
+struct PairingHeap {
+    int (*compare)(const PairingHeapNode *a, const PairingHeapNode *b);
+    PairingHeapNode *root;
+    size_t size;
+};
+
+/**
+ * Represents a node in a @ref PairingHeap. Embed this into your structure to make it a node. The "prev"
+ * member points to the previous sibling, or to the parent of the first child, and is NULL for the root.
+ */
+struct PairingHeapNode {
+    PairingHeapNode *child;
+    PairingHeapNode *next;
+    PairingHeapNode *prev;
+};
+
+/* ========================================================================================================
+ *
+ *                                               PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * Initializes/resets the @ref pairingheap.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *      -   @ref compare != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pairingheap           The @ref PairingHeap to be initialized/reset.
+ * @param compare               The callback function used to compare the priorities of two
+ *                              @ref PairingHeapNode's. Returns a negative number if @ref a has a higher
+ *                              priority than @ref b, 0 if their priorities are equal, and a positive number
+ *                              otherwise.
+ */
+void pairingheap_init(PairingHeap *pairingheap, int (*compare)(const PairingHeapNode *a, const PairingHeapNode *b));
+
+/**
+ * Returns the top @ref PairingHeapNode (i.e. one of the highest priority) of the @ref pairingheap.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ * @return                      The top @ref PairingHeapNode if the @ref pairingheap is not empty, otherwise
+ *                              NULL.
+ */
+PairingHeapNode* pairingheap_peek(const PairingHeap *pairingheap);
+
+/**
+ * Returns the number of @ref PairingHeapNode's in the @ref pairingheap.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ * @return                      The size of the @ref pairingheap.
+ */
+size_t pairingheap_size(const PairingHeap *pairingheap);
+
+/**
+ * Returns whether the @ref pairingheap is empty.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ * @return                      1 if the @ref pairingheap is empty, otherwise 0.
+ */
+int pairingheap_empty(const PairingHeap *pairingheap);
+
+/**
+ * Inserts the @ref node into the @ref pairingheap.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ * @param node                  The @ref PairingHeapNode to be inserted.
+ */
+void pairingheap_push(PairingHeap *pairingheap, PairingHeapNode *node);
+
+/**
+ * Moves all the @ref PairingHeapNode's of the @ref src_pairingheap into the @ref pairingheap. The
+ * @ref src_pairingheap is empty afterwards.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *      -   @ref src_pairingheap != NULL
+ *      -   @ref pairingheap != @ref src_pairingheap
+ *      -   Both have equivalent compare functions
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ * @param src_pairingheap       The @ref PairingHeap whose @ref PairingHeapNode's will be moved.
+ */
+void pairingheap_merge(PairingHeap *pairingheap, PairingHeap *src_pairingheap);
+
+/**
+ * Restores the order of the @ref pairingheap after the priority of the @ref node was raised (i.e. its key was
+ * decreased, for a min-heap). The @ref node is cut off from its parent together with its children and linked
+ * with the root.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *      -   @ref node is in @ref pairingheap
+ *      -   The priority of the @ref node was NOT lowered
+ *
+ * Time complexity:
+ *      -   O(1) (the restructuring it causes is paid for by later removals, o(log(n)) amortized)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ * @param node                  The @ref PairingHeapNode whose priority was raised.
+ */
+void pairingheap_decrease_key(PairingHeap *pairingheap, PairingHeapNode *node);
+
+/**
+ * Removes the top @ref PairingHeapNode of the @ref pairingheap AND returns it. If the @ref pairingheap is
+ * empty, this function simply returns NULL.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *
+ * Time complexity:
+ *      -   Amortized: O(log(n))
+ *      -   Worst Case: O(n)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ * @return                      The removed top @ref PairingHeapNode.
+ */
+PairingHeapNode* pairingheap_pop(PairingHeap *pairingheap);
+
+/**
+ * Removes the @ref node from the @ref pairingheap, wherever it is.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *      -   @ref node is in @ref pairingheap
+ *
+ * Time complexity:
+ *      -   Amortized: O(log(n))
+ *      -   Worst Case: O(n)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ * @param node                  The @ref PairingHeapNode to be removed.
+ */
+void pairingheap_remove(PairingHeap *pairingheap, PairingHeapNode *node);
+
+/**
+ * Removes all @ref PairingHeapNode's from the @ref pairingheap. If the @ref pairingheap is empty, this
+ * function simply returns.
+ *
+ * Requirements:
+ *      -   @ref pairingheap != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pairingheap           The @ref PairingHeap to be operated on.
+ */
+void pairingheap_remove_all(PairingHeap *pairingheap);
+
+/* ========================================================================================================
+ *
+ *                                                 MACROS
+ *
+ * ======================================================================================================== */
+
+/**
+ * Non-NULL pointer that will result in page faults under normal circumstances. Is the "child" member of a
+ * removed @ref PairingHeapNode (or of the root of a tree of removed @ref PairingHeapNode's). Useful for
+ * identifying bugs.
+ */
+#define PAIRINGHEAP_POISON_CHILD ((PairingHeapNode*) 0x100)
+
+/**
+ * Non-NULL pointer that will result in page faults under normal circumstances. Is the "next" member of a
+ * removed @ref PairingHeapNode (or of the root of a tree of removed @ref PairingHeapNode's). Useful for
+ * identifying bugs.
+ */
+#define PAIRINGHEAP_POISON_NEXT ((PairingHeapNode*) 0x200)
+
+/**
+ * Non-NULL pointer that will result in page faults under normal circumstances. Is the "prev" member of a
+ * removed @ref PairingHeapNode (or of the root of a tree of removed @ref PairingHeapNode's). Useful for
+ * identifying bugs.
+ */
+#define PAIRINGHEAP_POISON_PREV ((PairingHeapNode*) 0x300)
+
+/**
+ * Initializing a @ref PairingHeapNode before it is used is NOT required. This macro is simply for allowing
+ * you to initialize a struct (containing one or more @ref PairingHeapNode's) with an initializer-list
+ * conveniently.
+ */
+#define PAIRINGHEAP_NODE_INIT { PAIRINGHEAP_POISON_CHILD, PAIRINGHEAP_POISON_NEXT, PAIRINGHEAP_POISON_PREV }
+
+/**
+ * Obtains the pointer to the struct for this entry.
+ *
+ * Requirements:
+ *      -   @ref node_ptr != NULL
+ *
+ * @param node_ptr              The pointer to the @ref PairingHeapNode in the struct.
+ * @param type                  The type of the struct the @ref PairingHeapNode is embedded in.
+ * @param member                The name of the @ref PairingHeapNode in the struct.
+ */
+#if defined(__GNUC__) && !defined(__STRICT_ANSI__)
+    #define pairingheap_entry(node_ptr, type, member) \
+        ({ \
+            const typeof(((type*)0)->member) *__mptr = (node_ptr); \
+            (type*) ((char*)__mptr - offsetof(type, member)); \
+        })
+#else
+    #define pairingheap_entry(node_ptr, type, member) \
+        ( \
+            (type*) ((char*)(node_ptr) - offsetof(type, member)) \
+        )
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* PAIRINGHEAP_H */
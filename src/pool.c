@@ -0,0 +1,273 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "pool.h"
+
+/* The free object linked after the @ref object, which must be free. */
+#define NEXT_FREE(object) (*(void**) (object))
+
+/* Fails to compile if POOL_ALIGNMENT is not a power of two, or too small to hold the link of a free object. */
+typedef char pool_alignment_check[
+    (POOL_ALIGNMENT & (POOL_ALIGNMENT - 1)) == 0 && POOL_ALIGNMENT >= sizeof(void*) ? 1 : -1
+];
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+#ifndef POOL_NO_ATOMICS
+/*
+ * Spins until the lock of the @ref pool is acquired.
+ */
+static void lock_pool(Pool *pool);
+
+/*
+ * Releases the lock of the @ref pool.
+ */
+static void unlock_pool(Pool *pool);
+
+/*
+ * Returns the @ref count >= 1 least recently freed objects held by the @ref poolcache to its @ref Pool, so the
+ * ones most likely still in the cache of the CPU are kept.
+ */
+static void give_back(PoolCache *poolcache, size_t count);
+#endif /* POOL_NO_ATOMICS */
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+#ifndef POOL_NO_ATOMICS
+static void lock_pool(Pool *pool) {
+    assert(pool);
+
+    /* Spin on a plain load so that waiting threads do not keep stealing the cache line from each other. */
+    while (__atomic_exchange_n(&pool->locked, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&pool->locked, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void unlock_pool(Pool *pool) {
+    assert(pool);
+
+    __atomic_store_n(&pool->locked, 0, __ATOMIC_RELEASE);
+}
+
+static void give_back(PoolCache *poolcache, size_t count) {
+    void *first, *last, *kept = NULL;
+    size_t i;
+
+    assert(poolcache && count > 0 && count <= poolcache->size);
+
+    /* Detach the chain before taking the lock, so the lock is held for O(1) only. */
+    first = poolcache->free_list;
+
+    for (i = count; i < poolcache->size; ++i) {
+        kept = first;
+        first = NEXT_FREE(first);
+    }
+
+    if (kept) {
+        NEXT_FREE(kept) = NULL;
+    } else {
+        poolcache->free_list = NULL;
+    }
+
+    for (last = first, i = 1; i < count; ++i) {
+        last = NEXT_FREE(last);
+    }
+
+    poolcache->size -= count;
+
+    lock_pool(poolcache->pool);
+
+    NEXT_FREE(last) = poolcache->pool->free_list;
+    poolcache->pool->free_list = first;
+    poolcache->pool->size -= count;
+
+    unlock_pool(poolcache->pool);
+}
+#endif /* POOL_NO_ATOMICS */
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+void pool_init(Pool *pool, void *memory, size_t memory_size, size_t object_size) {
+    size_t offset;
+
+    assert(pool && memory && object_size > 0);
+
+    offset = (POOL_ALIGNMENT - (size_t) memory % POOL_ALIGNMENT) % POOL_ALIGNMENT;
+    object_size = (object_size + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT * POOL_ALIGNMENT;
+
+    if (offset > memory_size) {
+        offset = memory_size;
+    }
+
+    pool->memory = (char*) memory + offset;
+    pool->end = pool->memory + (memory_size - offset) / object_size * object_size;
+    pool->fresh = pool->memory;
+    pool->free_list = NULL;
+    pool->object_size = object_size;
+    pool->size = 0;
+    pool->locked = 0;
+}
+
+size_t pool_object_size(const Pool *pool) {
+    assert(pool);
+
+    return pool->object_size;
+}
+
+size_t pool_capacity(const Pool *pool) {
+    assert(pool);
+
+    return (size_t) (pool->end - pool->memory) / pool->object_size;
+}
+
+size_t pool_size(const Pool *pool) {
+    assert(pool);
+
+    return pool->size;
+}
+
+int pool_contains(const Pool *pool, const void *object) {
+    assert(pool);
+
+    return (const char*) object >= pool->memory &&
+           (const char*) object < pool->end &&
+           (size_t) ((const char*) object - pool->memory) % pool->object_size == 0;
+}
+
+void* pool_alloc(Pool *pool) {
+    void *object;
+
+    assert(pool);
+
+    if (pool->free_list) {
+        object = pool->free_list;
+        pool->free_list = NEXT_FREE(object);
+    } else if (pool->fresh != pool->end) {
+        object = pool->fresh;
+        pool->fresh += pool->object_size;
+    } else {
+        return NULL;
+    }
+
+    ++pool->size;
+
+    return object;
+}
+
+void pool_free(Pool *pool, void *object) {
+    assert(pool && pool->size > 0 && pool_contains(pool, object) && (char*) object < pool->fresh);
+
+    NEXT_FREE(object) = pool->free_list;
+    pool->free_list = object;
+
+    --pool->size;
+}
+
+void pool_reset(Pool *pool) {
+    assert(pool);
+
+    pool->fresh = pool->memory;
+    pool->free_list = NULL;
+    pool->size = 0;
+}
+
+#ifndef POOL_NO_ATOMICS
+void poolcache_init(PoolCache *poolcache, Pool *pool, size_t batch_size) {
+    assert(poolcache && pool && batch_size > 0);
+
+    poolcache->pool = pool;
+    poolcache->free_list = NULL;
+    poolcache->size = 0;
+    poolcache->batch_size = batch_size;
+}
+
+size_t poolcache_batch_size(const PoolCache *poolcache) {
+    assert(poolcache);
+
+    return poolcache->batch_size;
+}
+
+size_t poolcache_size(const PoolCache *poolcache) {
+    assert(poolcache);
+
+    return poolcache->size;
+}
+
+void* poolcache_alloc(PoolCache *poolcache) {
+    void *object;
+
+    assert(poolcache);
+
+    if (!poolcache->free_list) {
+        lock_pool(poolcache->pool);
+
+        while (poolcache->size < poolcache->batch_size && (object = pool_alloc(poolcache->pool))) {
+            NEXT_FREE(object) = poolcache->free_list;
+            poolcache->free_list = object;
+            ++poolcache->size;
+        }
+
+        unlock_pool(poolcache->pool);
+
+        if (!poolcache->free_list) {
+            return NULL;
+        }
+    }
+
+    object = poolcache->free_list;
+    poolcache->free_list = NEXT_FREE(object);
+    --poolcache->size;
+
+    return object;
+}
+
+void poolcache_free(PoolCache *poolcache, void *object) {
+    assert(poolcache && pool_contains(poolcache->pool, object));
+
+    NEXT_FREE(object) = poolcache->free_list;
+    poolcache->free_list = object;
+
+    if (++poolcache->size >= 2 * poolcache->batch_size) {
+        give_back(poolcache, poolcache->batch_size);
+    }
+}
+
+void poolcache_flush(PoolCache *poolcache) {
+    assert(poolcache);
+
+    if (poolcache->size > 0) {
+        give_back(poolcache, poolcache->size);
+    }
+}
+#endif /* POOL_NO_ATOMICS */
@@ -0,0 +1,396 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+ * @file    pool.h
+ * @brief   FIXED-SIZE OBJECT POOL
+ *
+ * A @ref Pool hands out objects of one fixed size from a block of memory supplied by the user, which makes it a
+ * natural companion to the intrusive data structures of this library: the structs embedding their nodes can be
+ * allocated from a @ref Pool instead of one by one with malloc, so they are contiguous in memory, and once the
+ * @ref Pool is set up no further allocation takes place. A @ref Pool MUST be initialized before it is used,
+ * and never allocates or frees memory itself.
+ *
+ * The memory is cut into slots of @ref pool_object_size bytes each, the requested size rounded up to a multiple
+ * of @ref POOL_ALIGNMENT. A freed object is pushed onto a free list that is stored inside the object itself, and
+ * popped again by the next allocation, so both are O(1) and a @ref Pool has no overhead per object. Slots that
+ * were never allocated are not put onto the free list, but handed out in order of address after the free list is
+ * empty, so initializing a @ref Pool is O(1) however large its memory is, and so is @ref pool_reset, which frees
+ * every object at once for arena-style teardown.
+ *
+ * A @ref Pool is not thread-safe by itself. A @ref PoolCache is a free list of objects private to one thread,
+ * which refills from and returns to a shared @ref Pool in batches of @ref poolcache_batch_size objects while
+ * holding its lock, so most allocations and frees never touch the shared @ref Pool at all. An object may be freed
+ * into another @ref PoolCache than the one it was allocated from. While any @ref PoolCache is in use, the
+ * @ref Pool must only be accessed through @ref PoolCache's. The caches require the GNU C atomic builtins (GCC 4.7+
+ * or Clang), and are unavailable if POOL_NO_ATOMICS is defined.
+ *
+ * Example:
+ *          struct Object {
+ *              int key;
+ *              RBTreeNode n;
+ *          };
+ *
+ *          void collide(const RBTreeNode *old_node, const RBTreeNode *new_node, void *auxiliary_data) {
+ *              pool_free((Pool*) auxiliary_data, rbtree_entry((RBTreeNode*) old_node, struct Object, n));
+ *          }
+ *
+ *          int main(void) {
+ *              static char memory[100 * sizeof(struct Object)];
+ *              struct Object *obj;
+ *              RBTree rbtree;
+ *              Pool pool;
+ *
+ *              pool_init(&pool, memory, sizeof(memory), sizeof(struct Object));
+ *              rbtree_init(&rbtree, compare, collide, &pool);
+ *
+ *              obj = (struct Object*) pool_alloc(&pool);
+ *              obj->key = 1;
+ *              rbtree_insert(&rbtree, &obj->key, &obj->n);
+ *              ...
+ *              rbtree_remove_all(&rbtree);
+ *              pool_reset(&pool);
+ *
+ *              return 0;
+ *          }
+ *
+ * Dependencies:
+ *      -   C89 assert.h
+ *      -   C89 stddef.h
+ *
+ * API:
+ *      ====  TYPES  ====
+ *      -   typedef struct Pool Pool
+ *      -   typedef struct PoolCache PoolCache
+ *
+ *      ====  FUNCTIONS  ====
+ *      Initializers:
+ *          -   pool_init
+ *          -   poolcache_init
+ *      Properties:
+ *          -   pool_object_size
+ *          -   pool_capacity
+ *          -   pool_size
+ *          -   pool_contains
+ *          -   poolcache_batch_size
+ *          -   poolcache_size
+ *      Allocation:
+ *          -   pool_alloc
+ *          -   poolcache_alloc
+ *      Deallocation:
+ *          -   pool_free
+ *          -   pool_reset
+ *          -   poolcache_free
+ *          -   poolcache_flush
+ *
+ *      ====  MACROS  ====
+ *      Constants:
+ *          -   POOL_ALIGNMENT
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+/**
+ * Every object of a @ref Pool is aligned to this many bytes, which must be a power of two, at least sizeof(void*),
+ * and at least the alignment the objects need. Can be overridden by defining it before including this header,
+ * identically for the library and every translation unit using it.
+ */
+#ifndef POOL_ALIGNMENT
+    #define POOL_ALIGNMENT 8
+#endif
+
+/* The caches need the GNU C atomic builtins. */
+#if !defined(POOL_NO_ATOMICS) && !defined(__ATOMIC_ACQUIRE)
+    #define POOL_NO_ATOMICS
+#endif
+
+/* ========================================================================================================
+ *
+ *                                                  TYPES
+ *
+ * ======================================================================================================== */
+
+/* Struct type declarations. */
+struct Pool;
+struct PoolCache;
+
+/* Struct typedef's. */
+typedef struct Pool Pool;
+typedef struct PoolCache PoolCache;
+
+/**
+ * Represents a pool of fixed-size objects. The "free_list" member is the most recently freed object, whose first
+ * bytes point to the one freed before it, and the "fresh" member is the first slot that was never allocated.
+ */
+struct Pool {
+    char *memory;
+    char *fresh;
+    char *end;
+    void *free_list;
+    size_t object_size;
+    size_t size;
+    int locked;
+};
+
+/**
+ * Represents a free list of objects of a @ref Pool, private to one thread.
+ */
+struct PoolCache {
+    Pool *pool;
+    void *free_list;
+    size_t size;
+    size_t batch_size;
+};
+
+/* ========================================================================================================
+ *
+ *                                               PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * Initializes/resets the @ref pool to hand out objects of @ref object_size bytes from the @ref memory, whose
+ * first bytes are skipped if it is not aligned to @ref POOL_ALIGNMENT. The @ref memory must outlive the
+ * @ref pool, and must not be used otherwise while the @ref pool is.
+ *
+ * Requirements:
+ *      -   @ref pool != NULL
+ *      -   @ref memory != NULL
+ *      -   @ref object_size > 0
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pool                  The @ref Pool to be initialized/reset.
+ * @param memory                The memory the objects are placed in.
+ * @param memory_size           The number of bytes of the @ref memory.
+ * @param object_size           The number of bytes of an object.
+ */
+void pool_init(Pool *pool, void *memory, size_t memory_size, size_t object_size);
+
+/**
+ * Returns the number of bytes of a slot of the @ref pool, which is the object size it was initialized with,
+ * rounded up to a multiple of @ref POOL_ALIGNMENT and to at least sizeof(void*).
+ *
+ * Requirements:
+ *      -   @ref pool != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pool                  The @ref Pool to be operated on.
+ * @return                      The number of bytes of a slot of the @ref pool.
+ */
+size_t pool_object_size(const Pool *pool);
+
+/**
+ * Returns the number of objects that fit into the memory of the @ref pool.
+ *
+ * Requirements:
+ *      -   @ref pool != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pool                  The @ref Pool to be operated on.
+ * @return                      The capacity of the @ref pool.
+ */
+size_t pool_capacity(const Pool *pool);
+
+/**
+ * Returns the number of objects allocated from the @ref pool, which includes the objects held by the
+ * @ref PoolCache's of the @ref pool.
+ *
+ * Requirements:
+ *      -   @ref pool != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pool                  The @ref Pool to be operated on.
+ * @return                      The number of allocated objects of the @ref pool.
+ */
+size_t pool_size(const Pool *pool);
+
+/**
+ * Returns whether the @ref object points to the start of a slot of the @ref pool, whether or not it is allocated.
+ *
+ * Requirements:
+ *      -   @ref pool != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pool                  The @ref Pool to be operated on.
+ * @param object                The pointer to be checked.
+ * @return                      1 if the @ref object is a slot of the @ref pool, otherwise 0.
+ */
+int pool_contains(const Pool *pool, const void *object);
+
+/**
+ * Allocates an object from the @ref pool. The most recently freed object is reused first.
+ *
+ * Requirements:
+ *      -   @ref pool != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pool                  The @ref Pool to be operated on.
+ * @return                      The allocated object, or NULL if every object of the @ref pool is allocated.
+ */
+void* pool_alloc(Pool *pool);
+
+/**
+ * Frees the @ref object back into the @ref pool.
+ *
+ * Requirements:
+ *      -   @ref pool != NULL
+ *      -   @ref object was allocated from the @ref pool, and is NOT free
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pool                  The @ref Pool to be operated on.
+ * @param object                The object to be freed.
+ */
+void pool_free(Pool *pool, void *object);
+
+/**
+ * Frees every object of the @ref pool at once. Nothing ever points into the freed objects, so they need not be
+ * freed one by one before the data structures that contain them are abandoned or reset.
+ *
+ * Requirements:
+ *      -   @ref pool != NULL
+ *      -   The @ref pool has no @ref PoolCache in use
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param pool                  The @ref Pool to be operated on.
+ */
+void pool_reset(Pool *pool);
+
+#ifndef POOL_NO_ATOMICS
+
+/**
+ * Initializes/resets the @ref poolcache, which is empty afterwards, to allocate from and free into the @ref pool,
+ * @ref batch_size objects at a time. The @ref poolcache holds up to twice @ref batch_size objects.
+ *
+ * Requirements:
+ *      -   @ref poolcache != NULL
+ *      -   @ref pool != NULL
+ *      -   @ref batch_size > 0
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param poolcache             The @ref PoolCache to be initialized/reset.
+ * @param pool                  The @ref Pool the @ref poolcache belongs to.
+ * @param batch_size            The number of objects moved between the @ref poolcache and the @ref pool at once.
+ */
+void poolcache_init(PoolCache *poolcache, Pool *pool, size_t batch_size);
+
+/**
+ * Returns the number of objects moved between the @ref poolcache and its @ref Pool at once.
+ *
+ * Requirements:
+ *      -   @ref poolcache != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param poolcache             The @ref PoolCache to be operated on.
+ * @return                      The batch size of the @ref poolcache.
+ */
+size_t poolcache_batch_size(const PoolCache *poolcache);
+
+/**
+ * Returns the number of free objects held by the @ref poolcache.
+ *
+ * Requirements:
+ *      -   @ref poolcache != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param poolcache             The @ref PoolCache to be operated on.
+ * @return                      The number of objects held by the @ref poolcache.
+ */
+size_t poolcache_size(const PoolCache *poolcache);
+
+/**
+ * Allocates an object from the @ref poolcache. If the @ref poolcache is empty, it first takes up to
+ * @ref poolcache_batch_size objects from its @ref Pool.
+ *
+ * Requirements:
+ *      -   @ref poolcache != NULL
+ *
+ * Time complexity:
+ *      -   O(1) amortized
+ *
+ * @param poolcache             The @ref PoolCache to be operated on.
+ * @return                      The allocated object, or NULL if the @ref poolcache is empty and every object of
+ *                              its @ref Pool is allocated.
+ */
+void* poolcache_alloc(PoolCache *poolcache);
+
+/**
+ * Frees the @ref object into the @ref poolcache. If the @ref poolcache then holds twice
+ * @ref poolcache_batch_size objects, it returns the @ref poolcache_batch_size least recently freed of them to
+ * its @ref Pool.
+ *
+ * Requirements:
+ *      -   @ref poolcache != NULL
+ *      -   @ref object was allocated from the @ref Pool of the @ref poolcache, and is NOT free
+ *
+ * Time complexity:
+ *      -   O(1) amortized
+ *
+ * @param poolcache             The @ref PoolCache to be operated on.
+ * @param object                The object to be freed.
+ */
+void poolcache_free(PoolCache *poolcache, void *object);
+
+/**
+ * Returns every object held by the @ref poolcache to its @ref Pool, e.g. before the thread owning it exits.
+ *
+ * Requirements:
+ *      -   @ref poolcache != NULL
+ *
+ * Time complexity:
+ *      -   O(n), where n == @ref poolcache_size
+ *
+ * @param poolcache             The @ref PoolCache to be operated on.
+ */
+void poolcache_flush(PoolCache *poolcache);
+
+#endif /* POOL_NO_ATOMICS */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* POOL_H */
@@ -62,6 +62,27 @@ void queue_push(Queue *queue, QueueNode *node) {
     ++queue->size;
 }
 
+void queue_splice_back(Queue *queue, Queue *src_queue) {
+    assert(queue && src_queue && queue != src_queue);
+
+    if (!src_queue->head) {
+        return;
+    }
+
+    if (!queue->head) {
+        queue->head = src_queue->head;
+    } else {
+        queue->tail->next = src_queue->head;
+    }
+
+    queue->tail = src_queue->tail;
+    queue->size += src_queue->size;
+
+    src_queue->head = NULL;
+    src_queue->tail = NULL;
+    src_queue->size = 0;
+}
+
 QueueNode *queue_pop(Queue *queue) {
     QueueNode *n;
 
@@ -85,6 +106,20 @@ QueueNode *queue_pop(Queue *queue) {
     return n;
 }
 
+QueueNode* queue_pop_all(Queue *queue) {
+    QueueNode *n;
+
+    assert(queue);
+
+    n = queue->head;
+
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->size = 0;
+
+    return n;
+}
+
 void queue_remove_all(Queue *queue) {
     assert(queue);
 
@@ -97,3 +132,249 @@ void queue_remove_all(Queue *queue) {
     queue->tail = NULL;
     queue->size = 0;
 }
+
+#ifndef QUEUE_NO_ATOMICS
+
+void mpscqueue_init(MPSCQueue *mpscqueue) {
+    assert(mpscqueue);
+
+    mpscqueue->stub.next = NULL;
+    mpscqueue->back = &mpscqueue->stub;
+    mpscqueue->front = &mpscqueue->stub;
+}
+
+void mpscqueue_push(MPSCQueue *mpscqueue, QueueNode *node) {
+    QueueNode *prev;
+
+    assert(mpscqueue && node);
+
+    __atomic_store_n(&node->next, NULL, __ATOMIC_RELAXED);
+
+    /* Until the second store, the consumer cannot reach the node (or any node pushed after it). */
+    prev = __atomic_exchange_n(&mpscqueue->back, node, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+}
+
+QueueNode* mpscqueue_pop(MPSCQueue *mpscqueue) {
+    QueueNode *front, *next;
+
+    assert(mpscqueue);
+
+    front = mpscqueue->front;
+    next = __atomic_load_n(&front->next, __ATOMIC_ACQUIRE);
+
+    /* The stub is skipped here, and pushed again whenever the last node would otherwise be popped. */
+    if (front == &mpscqueue->stub) {
+        if (!next) {
+            return NULL;
+        }
+
+        mpscqueue->front = next;
+        front = next;
+        next = __atomic_load_n(&front->next, __ATOMIC_ACQUIRE);
+    }
+
+    if (!next) {
+        /* If front is not the back, a push is underway and front cannot be unlinked yet. */
+        if (front != __atomic_load_n(&mpscqueue->back, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+
+        mpscqueue_push(mpscqueue, &mpscqueue->stub);
+        next = __atomic_load_n(&front->next, __ATOMIC_ACQUIRE);
+
+        if (!next) {
+            return NULL;
+        }
+    }
+
+    mpscqueue->front = next;
+    front->next = QUEUE_POISON_NEXT;
+
+    return front;
+}
+
+void mpmcqueue_init(MPMCQueue *mpmcqueue, MPMCQueueCell *cell_array, size_t num_cells) {
+    size_t i;
+
+    assert(mpmcqueue && cell_array && num_cells >= 2 && (num_cells & (num_cells - 1)) == 0);
+
+    for (i = 0; i < num_cells; ++i) {
+        cell_array[i].sequence = i;
+        cell_array[i].node = NULL;
+    }
+
+    mpmcqueue->cell_array = cell_array;
+    mpmcqueue->mask = num_cells - 1;
+    mpmcqueue->push_position = 0;
+    mpmcqueue->pop_position = 0;
+}
+
+int mpmcqueue_push(MPMCQueue *mpmcqueue, QueueNode *node) {
+    MPMCQueueCell *cell;
+    size_t position;
+
+    assert(mpmcqueue && node);
+
+    position = __atomic_load_n(&mpmcqueue->push_position, __ATOMIC_RELAXED);
+
+    for (;;) {
+        size_t sequence;
+
+        cell = &mpmcqueue->cell_array[position & mpmcqueue->mask];
+        sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+
+        if (sequence == position) {
+            /* On failure, position is reloaded with the position some other producer left behind. */
+            if (__atomic_compare_exchange_n(
+                &mpmcqueue->push_position,
+                &position,
+                position + 1,
+                1,
+                __ATOMIC_RELAXED,
+                __ATOMIC_RELAXED
+            )) {
+                break;
+            }
+        } else if (position - sequence <= (size_t) -1 / 2) {
+            /* The cell still holds the node pushed one lap ago. */
+            return 0;
+        } else {
+            position = __atomic_load_n(&mpmcqueue->push_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->node = node;
+    __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+QueueNode* mpmcqueue_pop(MPMCQueue *mpmcqueue) {
+    MPMCQueueCell *cell;
+    QueueNode *node;
+    size_t position;
+
+    assert(mpmcqueue);
+
+    position = __atomic_load_n(&mpmcqueue->pop_position, __ATOMIC_RELAXED);
+
+    for (;;) {
+        size_t sequence;
+
+        cell = &mpmcqueue->cell_array[position & mpmcqueue->mask];
+        sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+
+        if (sequence == position + 1) {
+            if (__atomic_compare_exchange_n(
+                &mpmcqueue->pop_position,
+                &position,
+                position + 1,
+                1,
+                __ATOMIC_RELAXED,
+                __ATOMIC_RELAXED
+            )) {
+                break;
+            }
+        } else if (position + 1 - sequence <= (size_t) -1 / 2) {
+            /* The cell has not been pushed to in this lap yet. */
+            return NULL;
+        } else {
+            position = __atomic_load_n(&mpmcqueue->pop_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    node = cell->node;
+    __atomic_store_n(&cell->sequence, position + mpmcqueue->mask + 1, __ATOMIC_RELEASE);
+
+    return node;
+}
+
+void spscqueue_init(SPSCQueue *spscqueue, QueueNode **node_array, size_t num_nodes) {
+    assert(spscqueue && node_array && num_nodes > 0 && (num_nodes & (num_nodes - 1)) == 0);
+
+    spscqueue->node_array = node_array;
+    spscqueue->mask = num_nodes - 1;
+    spscqueue->push_position = 0;
+    spscqueue->cached_pop_position = 0;
+    spscqueue->pop_position = 0;
+    spscqueue->cached_push_position = 0;
+}
+
+int spscqueue_push(SPSCQueue *spscqueue, QueueNode *node) {
+    assert(spscqueue && node);
+
+    return spscqueue_push_batch(spscqueue, &node, 1) == 1;
+}
+
+size_t spscqueue_push_batch(SPSCQueue *spscqueue, QueueNode *const *nodes, size_t num_nodes) {
+    size_t position, num_free, i;
+
+    assert(spscqueue && nodes);
+
+    /* Only this thread writes the push position, so it needs no atomic load. */
+    position = spscqueue->push_position;
+    num_free = spscqueue->mask + 1 - (position - spscqueue->cached_pop_position);
+
+    /* The consumer's cache line is only read when the ring looks too full. */
+    if (num_free < num_nodes) {
+        spscqueue->cached_pop_position = __atomic_load_n(&spscqueue->pop_position, __ATOMIC_ACQUIRE);
+        num_free = spscqueue->mask + 1 - (position - spscqueue->cached_pop_position);
+
+        if (num_free < num_nodes) {
+            num_nodes = num_free;
+        }
+    }
+
+    for (i = 0; i < num_nodes; ++i) {
+        assert(nodes[i]);
+        spscqueue->node_array[(position + i) & spscqueue->mask] = nodes[i];
+    }
+
+    if (num_nodes > 0) {
+        __atomic_store_n(&spscqueue->push_position, position + num_nodes, __ATOMIC_RELEASE);
+    }
+
+    return num_nodes;
+}
+
+QueueNode* spscqueue_pop(SPSCQueue *spscqueue) {
+    QueueNode *node;
+
+    assert(spscqueue);
+
+    return spscqueue_pop_batch(spscqueue, &node, 1) == 1 ? node : NULL;
+}
+
+size_t spscqueue_pop_batch(SPSCQueue *spscqueue, QueueNode **nodes, size_t max_nodes) {
+    size_t position, num_used, i;
+
+    assert(spscqueue && nodes);
+
+    /* Only this thread writes the pop position, so it needs no atomic load. */
+    position = spscqueue->pop_position;
+    num_used = spscqueue->cached_push_position - position;
+
+    /* The producer's cache line is only read when the ring looks too empty. */
+    if (num_used < max_nodes) {
+        spscqueue->cached_push_position = __atomic_load_n(&spscqueue->push_position, __ATOMIC_ACQUIRE);
+        num_used = spscqueue->cached_push_position - position;
+
+        if (num_used < max_nodes) {
+            max_nodes = num_used;
+        }
+    }
+
+    for (i = 0; i < max_nodes; ++i) {
+        nodes[i] = spscqueue->node_array[(position + i) & spscqueue->mask];
+    }
+
+    /* The release keeps the producer from reusing the slots before they have been read. */
+    if (max_nodes > 0) {
+        __atomic_store_n(&spscqueue->pop_position, position + max_nodes, __ATOMIC_RELEASE);
+    }
+
+    return max_nodes;
+}
+
+#endif /* QUEUE_NO_ATOMICS */
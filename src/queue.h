@@ -25,6 +25,21 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  * before it is used. A @ref QueueNode structure does NOT need to be initialized before it is used.  A
  * @ref QueueNode should belong to at most ONE @ref Queue.
  *
+ * There are also three lock-free variants for handing @ref QueueNode's from thread to thread, which use the same
+ * @ref QueueNode's and @ref queue_entry. An @ref MPSCQueue is an unbounded intrusive queue after Dmitry Vyukov,
+ * with a stub @ref QueueNode inside the @ref MPSCQueue: any number of threads may push concurrently, and a
+ * push is a single atomic exchange, but only ONE thread at a time may pop. An @ref MPMCQueue is a bounded queue
+ * of pointers to @ref QueueNode's in a user-supplied array of @ref MPMCQueueCell's, also after Dmitry Vyukov,
+ * which any number of threads may push to and pop from concurrently. It is bounded because an unbounded
+ * intrusive queue with several consumers would need to know when a popped @ref QueueNode can no longer be
+ * read by another consumer. An @ref SPSCQueue is a bounded ring of pointers to @ref QueueNode's in a
+ * user-supplied array, for exactly ONE producer thread and ONE consumer thread: neither ever writes to the
+ * cache line of the other, each one keeps a copy of the position of the other and only reloads it when the
+ * ring looks full (or empty), and the batch calls move many @ref QueueNode's with a single publish. Unlike a
+ * @ref Queue, popping does not read the @ref QueueNode, so handing a @ref QueueNode over costs no cache miss
+ * on the @ref QueueNode itself. All three variants require the GNU C atomic builtins (GCC 4.7+ or Clang), and
+ * are unavailable if QUEUE_NO_ATOMICS is defined.
+ *
  * Example:
  *          struct Object {
  *              int val;
@@ -49,11 +64,16 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  * Dependencies:
  *      -   C89 assert.h
  *      -   C89 stddef.h
+ *      -   GNU C atomic builtins (lock-free variants only)
  *
  * API:
  *      ====  TYPES  ====
  *      -   typedef struct Queue Queue
  *      -   typedef struct QueueNode QueueNode
+ *      -   typedef struct MPSCQueue MPSCQueue
+ *      -   typedef struct MPMCQueue MPMCQueue
+ *      -   typedef struct MPMCQueueCell MPMCQueueCell
+ *      -   typedef struct SPSCQueue SPSCQueue
  *
  *      ====  FUNCTIONS  ====
  *      Initializers:
@@ -64,9 +84,24 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *          -   queue_empty
  *      Insertion:
  *          -   queue_push
+ *      Splicing:
+ *          -   queue_splice_back
  *      Removal:
  *          -   queue_pop
+ *          -   queue_pop_all
  *          -   queue_remove_all
+ *      Lock-Free Variants:
+ *          -   mpscqueue_init
+ *          -   mpscqueue_push
+ *          -   mpscqueue_pop
+ *          -   mpmcqueue_init
+ *          -   mpmcqueue_push
+ *          -   mpmcqueue_pop
+ *          -   spscqueue_init
+ *          -   spscqueue_push
+ *          -   spscqueue_push_batch
+ *          -   spscqueue_pop
+ *          -   spscqueue_pop_batch
  *
  *      ====  MACROS  ====
  *      Constants:
@@ -89,6 +124,19 @@ extern "C" {
 
 #include <stddef.h>
 
+#if !defined(QUEUE_NO_ATOMICS) && !defined(__ATOMIC_ACQUIRE)
+    #define QUEUE_NO_ATOMICS
+#endif
+
+/**
+ * The assumed size of a cache line, used to keep the producers and the consumers of the lock-free variants
+ * from sharing cache lines. It determines their layout, so it can be overridden by defining it before including
+ * this header, but it must be defined identically for the library and every translation unit using it.
+ */
+#ifndef QUEUE_CACHE_LINE_SIZE
+    #define QUEUE_CACHE_LINE_SIZE 64
+#endif
+
 /* ========================================================================================================
  *
  *                                                  TYPES
@@ -119,6 +167,72 @@ struct QueueNode {
     QueueNode *next;
 };
 
+#ifndef QUEUE_NO_ATOMICS
+
+/* Struct type declarations. */
+struct MPSCQueue;
+struct MPMCQueue;
+struct MPMCQueueCell;
+struct SPSCQueue;
+
+/* Struct typedef's. */
+typedef struct MPSCQueue MPSCQueue;
+typedef struct MPMCQueue MPMCQueue;
+typedef struct MPMCQueueCell MPMCQueueCell;
+typedef struct SPSCQueue SPSCQueue;
+
+/**
+ * Represents a lock-free queue with many producers and one consumer. The producers only touch the "back"
+ * member, and the consumer mostly touches the "front" member, so they are kept on different cache lines.
+ */
+struct MPSCQueue {
+    QueueNode *back;
+    char padding[QUEUE_CACHE_LINE_SIZE - sizeof(QueueNode*)];
+    QueueNode *front;
+    QueueNode stub;
+};
+
+/**
+ * Represents a lock-free, bounded queue with many producers and many consumers.
+ */
+struct MPMCQueue {
+    MPMCQueueCell *cell_array;
+    size_t mask;
+    char padding0[QUEUE_CACHE_LINE_SIZE - sizeof(MPMCQueueCell*) - sizeof(size_t)];
+    size_t push_position;
+    char padding1[QUEUE_CACHE_LINE_SIZE - sizeof(size_t)];
+    size_t pop_position;
+    char padding2[QUEUE_CACHE_LINE_SIZE - sizeof(size_t)];
+};
+
+/**
+ * Represents a slot of an @ref MPMCQueue. The sequence tells whose turn it is to use the slot: the producer of
+ * the push position equal to it, or the consumer of the pop position one less than it.
+ */
+struct MPMCQueueCell {
+    size_t sequence;
+    QueueNode *node;
+};
+
+/**
+ * Represents a lock-free, bounded queue with one producer and one consumer. The positions only ever grow, and
+ * each one is written by its own thread only. The producer owns the cache line of the "push_position" member
+ * and its copy of the "pop_position" member, and the consumer owns the cache line of the other two.
+ */
+struct SPSCQueue {
+    QueueNode **node_array;
+    size_t mask;
+    char padding0[QUEUE_CACHE_LINE_SIZE - sizeof(QueueNode**) - sizeof(size_t)];
+    size_t push_position;
+    size_t cached_pop_position;
+    char padding1[QUEUE_CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+    size_t pop_position;
+    size_t cached_push_position;
+    char padding2[QUEUE_CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+};
+
+#endif /* QUEUE_NO_ATOMICS */
+
 /* ========================================================================================================
  *
  *                                               PROTOTYPES
@@ -195,6 +309,23 @@ int queue_empty(const Queue *queue);
  */
 void queue_push(Queue *queue, QueueNode *node);
 
+/**
+ * Removes all the @ref QueueNode's in the @ref src_queue, and inserts them into the back of the @ref queue,
+ * keeping their order.
+ *
+ * Requirements:
+ *      -   @ref queue != NULL
+ *      -   @ref src_queue != NULL
+ *      -   @ref queue != @ref src_queue
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param queue                 The consumer @ref Queue to which elements are moved.
+ * @param src_queue             The producer @ref Queue from which elements are removed.
+ */
+void queue_splice_back(Queue *queue, Queue *src_queue);
+
 /**
  * Pops off the front @ref QueueNode of the @ref queue AND returns it. If the @ref queue is empty, this
  * function simply returns NULL.
@@ -210,6 +341,22 @@ void queue_push(Queue *queue, QueueNode *node);
  */
 QueueNode* queue_pop(Queue *queue);
 
+/**
+ * Removes all @ref QueueNode's from the @ref queue AND returns the front one. The removed @ref QueueNode's stay
+ * chained through their "next" members, from front to back, and the back one has a "next" member of NULL. If
+ * the @ref queue is empty, this function simply returns NULL.
+ *
+ * Requirements:
+ *      -   @ref queue != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param queue                 The @ref Queue to be operated on.
+ * @return                      The front @ref QueueNode of the removed chain.
+ */
+QueueNode* queue_pop_all(Queue *queue);
+
 /**
  * Removes all @ref QueueNode's from the @ref queue. If the @ref queue is empty, this function simply returns.
  *
@@ -223,6 +370,204 @@ QueueNode* queue_pop(Queue *queue);
  */
 void queue_remove_all(Queue *queue);
 
+#ifndef QUEUE_NO_ATOMICS
+
+/**
+ * Initializes/resets the @ref mpscqueue. It must be initialized before it is shared with other threads.
+ *
+ * Requirements:
+ *      -   @ref mpscqueue != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param mpscqueue             The @ref MPSCQueue to be initialized/reset.
+ */
+void mpscqueue_init(MPSCQueue *mpscqueue);
+
+/**
+ * Pushes the @ref node into the back of the @ref mpscqueue. Any number of threads may call this function
+ * concurrently with each other and with @ref mpscqueue_pop. It never waits for other threads.
+ *
+ * Requirements:
+ *      -   @ref mpscqueue != NULL
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param mpscqueue             The @ref MPSCQueue to be operated on.
+ * @param node                  The @ref QueueNode to be inserted.
+ */
+void mpscqueue_push(MPSCQueue *mpscqueue, QueueNode *node);
+
+/**
+ * Pops off the front @ref QueueNode of the @ref mpscqueue AND returns it. If the @ref mpscqueue is empty, this
+ * function simply returns NULL. A push that has swapped itself in but not yet linked itself up is not seen,
+ * so NULL may also be returned while some other thread is still inside @ref mpscqueue_push (the
+ * @ref QueueNode's of that thread and of all later pushes are returned by a later call). Only ONE thread at a
+ * time may call this function.
+ *
+ * Requirements:
+ *      -   @ref mpscqueue != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param mpscqueue             The @ref MPSCQueue to be operated on.
+ * @return                      The removed front @ref QueueNode.
+ */
+QueueNode* mpscqueue_pop(MPSCQueue *mpscqueue);
+
+/**
+ * Initializes/resets the @ref mpmcqueue. It must be initialized before it is shared with other threads.
+ *
+ * Requirements:
+ *      -   @ref mpmcqueue != NULL
+ *      -   @ref cell_array != NULL
+ *      -   @ref num_cells is a power of 2
+ *      -   @ref num_cells >= 2
+ *
+ * Time complexity:
+ *      -   O(n), where n == @ref num_cells
+ *
+ * @param mpmcqueue             The @ref MPMCQueue to be initialized/reset.
+ * @param cell_array            The array of cells created by the user. It does NOT need to be initialized.
+ * @param num_cells             The number of cells in the @ref cell_array, which is the most
+ *                              @ref QueueNode's the @ref mpmcqueue can hold.
+ */
+void mpmcqueue_init(MPMCQueue *mpmcqueue, MPMCQueueCell *cell_array, size_t num_cells);
+
+/**
+ * Pushes the @ref node into the back of the @ref mpmcqueue, unless the @ref mpmcqueue is full. Any number of
+ * threads may call this function and @ref mpmcqueue_pop concurrently. The "next" member of the @ref node is
+ * NOT used.
+ *
+ * Requirements:
+ *      -   @ref mpmcqueue != NULL
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   O(1) without contention
+ *
+ * @param mpmcqueue             The @ref MPMCQueue to be operated on.
+ * @param node                  The @ref QueueNode to be inserted.
+ * @return                      Whether or not the @ref node was pushed (i.e. the @ref mpmcqueue was not full).
+ */
+int mpmcqueue_push(MPMCQueue *mpmcqueue, QueueNode *node);
+
+/**
+ * Pops off the front @ref QueueNode of the @ref mpmcqueue AND returns it. If the @ref mpmcqueue is empty, this
+ * function simply returns NULL. Any number of threads may call this function and @ref mpmcqueue_push
+ * concurrently.
+ *
+ * Requirements:
+ *      -   @ref mpmcqueue != NULL
+ *
+ * Time complexity:
+ *      -   O(1) without contention
+ *
+ * @param mpmcqueue             The @ref MPMCQueue to be operated on.
+ * @return                      The removed front @ref QueueNode.
+ */
+QueueNode* mpmcqueue_pop(MPMCQueue *mpmcqueue);
+
+/**
+ * Initializes/resets the @ref spscqueue. It must be initialized before it is shared with other threads.
+ *
+ * Requirements:
+ *      -   @ref spscqueue != NULL
+ *      -   @ref node_array != NULL
+ *      -   @ref num_nodes is a power of 2
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param spscqueue             The @ref SPSCQueue to be initialized/reset.
+ * @param node_array            The array of @ref QueueNode pointers created by the user. It does NOT need to
+ *                              be initialized.
+ * @param num_nodes             The number of pointers in the @ref node_array, which is the most
+ *                              @ref QueueNode's the @ref spscqueue can hold.
+ */
+void spscqueue_init(SPSCQueue *spscqueue, QueueNode **node_array, size_t num_nodes);
+
+/**
+ * Pushes the @ref node into the back of the @ref spscqueue, unless the @ref spscqueue is full. Only the ONE
+ * producer thread may call this function and @ref spscqueue_push_batch, concurrently with the consumer. The
+ * "next" member of the @ref node is NOT used.
+ *
+ * Requirements:
+ *      -   @ref spscqueue != NULL
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param spscqueue             The @ref SPSCQueue to be operated on.
+ * @param node                  The @ref QueueNode to be inserted.
+ * @return                      Whether or not the @ref node was pushed (i.e. the @ref spscqueue was not full).
+ */
+int spscqueue_push(SPSCQueue *spscqueue, QueueNode *node);
+
+/**
+ * Pushes as many of the @ref num_nodes @ref QueueNode's in the @ref nodes array into the back of the
+ * @ref spscqueue as there is room for, in order, and publishes them to the consumer all at once. Only the ONE
+ * producer thread may call this function and @ref spscqueue_push, concurrently with the consumer.
+ *
+ * Requirements:
+ *      -   @ref spscqueue != NULL
+ *      -   @ref nodes != NULL, and its first @ref num_nodes elements are non-NULL
+ *
+ * Time complexity:
+ *      -   O(k), where k == returned value
+ *
+ * @param spscqueue             The @ref SPSCQueue to be operated on.
+ * @param nodes                 The array of @ref QueueNode's to be inserted. It is NEVER manipulated by the
+ *                              @ref spscqueue.
+ * @param num_nodes             The number of @ref QueueNode's in the @ref nodes array.
+ * @return                      The number of @ref QueueNode's pushed, which are the first ones of the
+ *                              @ref nodes array.
+ */
+size_t spscqueue_push_batch(SPSCQueue *spscqueue, QueueNode *const *nodes, size_t num_nodes);
+
+/**
+ * Pops off the front @ref QueueNode of the @ref spscqueue AND returns it. If the @ref spscqueue is empty, this
+ * function simply returns NULL. Only the ONE consumer thread may call this function and
+ * @ref spscqueue_pop_batch, concurrently with the producer.
+ *
+ * Requirements:
+ *      -   @ref spscqueue != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param spscqueue             The @ref SPSCQueue to be operated on.
+ * @return                      The removed front @ref QueueNode.
+ */
+QueueNode* spscqueue_pop(SPSCQueue *spscqueue);
+
+/**
+ * Pops off up to @ref max_nodes @ref QueueNode's from the front of the @ref spscqueue into the @ref nodes
+ * array, in order, and hands their slots back to the producer all at once. Only the ONE consumer thread may
+ * call this function and @ref spscqueue_pop, concurrently with the producer.
+ *
+ * Requirements:
+ *      -   @ref spscqueue != NULL
+ *      -   @ref nodes != NULL
+ *
+ * Time complexity:
+ *      -   O(k), where k == returned value
+ *
+ * @param spscqueue             The @ref SPSCQueue to be operated on.
+ * @param nodes                 The array that receives the removed @ref QueueNode's.
+ * @param max_nodes             The most @ref QueueNode's to be removed (i.e. the length of the @ref nodes
+ *                              array).
+ * @return                      The number of @ref QueueNode's removed.
+ */
+size_t spscqueue_pop_batch(SPSCQueue *spscqueue, QueueNode **nodes, size_t max_nodes);
+
+#endif /* QUEUE_NO_ATOMICS */
+
 /* ========================================================================================================
  *
  *                                                 MACROS
@@ -17,10 +17,39 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
 #include <assert.h>
+#include <limits.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "rbtree.h"
 
+#ifdef RBTREE_COMPACT
+/* The parent pointer is stored in a size_t, which therefore must be wide enough to hold it. */
+typedef char rbtree_compact_requires_pointer_sized_size_t[sizeof(size_t) == sizeof(RBTreeNode*) ? 1 : -1];
+#endif /* RBTREE_COMPACT */
+
+/* Identifies a snapshot written by rbtree_serialize (the ASCII of "RBS1"). */
+#define SNAPSHOT_MAGIC_NUMBER ((size_t) 0x52425331UL)
+
+/* The fields of the header of a snapshot, each a size_t. The arena follows. */
+enum {
+    SNAPSHOT_MAGIC,
+    SNAPSHOT_NODE_SIZE,
+    SNAPSHOT_ALIGNMENT,
+    SNAPSHOT_SIZE,
+    SNAPSHOT_ROOT,
+    SNAPSHOT_ARENA_SIZE,
+    SNAPSHOT_NUM_FIELDS
+};
+
+/* The offset of the copy of the arena from the start of a snapshot. */
+#define SNAPSHOT_ARENA_OFFSET \
+    ((SNAPSHOT_NUM_FIELDS * sizeof(size_t) + RBTREE_SNAPSHOT_ALIGNMENT - 1) / \
+     RBTREE_SNAPSHOT_ALIGNMENT * RBTREE_SNAPSHOT_ALIGNMENT)
+
+/* Fails to compile if a link of a snapshot, which replaces a pointer, does not fit into one. */
+typedef char rbtree_snapshot_link_check[sizeof(ptrdiff_t) <= sizeof(RBTreeNode*) ? 1 : -1];
+
 /* ========================================================================================================
  *
  *                                        STATIC FUNCTION PROTOTYPES
@@ -32,6 +61,32 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 static RBTreeNodeColor color(const RBTreeNode *node);
 
+/*
+ * Sets the color of the @ref node to @ref node_color.
+ */
+static void set_color(RBTreeNode *node, RBTreeNodeColor node_color);
+
+/*
+ * Returns the parent of the @ref node.
+ */
+static RBTreeNode* parent_of(const RBTreeNode *node);
+
+/*
+ * Sets the parent of the @ref node to @ref parent.
+ */
+static void set_parent(RBTreeNode *node, RBTreeNode *parent);
+
+/*
+ * Returns the result of comparing the @ref key with the key of the @ref node using the compare function of the
+ * @ref rbtree.
+ */
+static int compare_key(const RBTree *rbtree, const void *key, const RBTreeNode *node);
+
+/*
+ * Sets the color of the @ref node to @ref node_color while repairing the @ref rbtree.
+ */
+static void recolor(RBTree *rbtree, RBTreeNode *node, RBTreeNodeColor node_color);
+
 /*
 * Returns the sibling of the @ref node.
 */
@@ -47,6 +102,62 @@ static RBTreeNode* grandparent(const RBTreeNode *node);
 */
 static RBTreeNode* uncle(const RBTreeNode *node);
 
+#ifdef RBTREE_ORDER_STATISTICS
+/*
+ * Returns the number of @ref RBTreeNode's in the subtree rooted at the @ref node. If @ref node == NULL, return 0.
+ */
+static size_t count(const RBTreeNode *node);
+
+/*
+ * Recomputes the subtree count of the @ref node from the subtree counts of its children.
+ */
+static void update_count(RBTreeNode *node);
+
+/*
+ * Adds @ref delta (modulo 2^N, where N == number of bits in a size_t) to the subtree count of the @ref node and
+ * every ancestor of the @ref node.
+ */
+static void add_to_counts(RBTreeNode *node, size_t delta);
+#endif /* RBTREE_ORDER_STATISTICS */
+
+/*
+ * Returns the first inorder @ref RBTreeNode of the subtree rooted at the @ref node, or NULL if @ref node == NULL.
+ */
+static RBTreeNode* inorder_first_below(const RBTreeNode *node);
+
+/*
+ * Returns the last inorder @ref RBTreeNode of the subtree rooted at the @ref node, or NULL if @ref node == NULL.
+ */
+static RBTreeNode* inorder_last_below(const RBTreeNode *node);
+
+/*
+ * Returns the first postorder @ref RBTreeNode of the subtree rooted at the @ref node (i.e. the leftmost leaf).
+ */
+static RBTreeNode* postorder_first_below(const RBTreeNode *node);
+
+/*
+ * Returns the next @ref RBTreeNode of the array whose cursor is @ref context.
+ */
+static RBTreeNode* next_in_array(void *context);
+
+/*
+ * Builds a balanced subtree out of the next @ref num_nodes @ref RBTreeNode's returned by @ref next and returns
+ * its root. Only the @ref RBTreeNode's at @ref red_depth (where the root is at depth 0) are colored red.
+ */
+static RBTreeNode* build_subtree(
+    const RBTree *rbtree,
+    size_t num_nodes,
+    size_t red_depth,
+    RBTreeNode* (*next)(void *context),
+    void *context
+);
+
+/*
+ * Links the new @ref node into the @ref rbtree as the left (if @ref left is non-zero) or right child of the
+ * @ref parent, which must NOT have that child yet, or as the root if @ref parent == NULL, then rebalances.
+ */
+static void attach(RBTree *rbtree, RBTreeNode *node, RBTreeNode *parent, int left);
+
 /*
  * Replaces the @ref old_node with the @ref new_node in the @ref rbtree.
  */
@@ -74,15 +185,54 @@ static void rotate_left(RBTree *rbtree, RBTreeNode *node);
 static void rotate_right(RBTree *rbtree, RBTreeNode *node);
 
 /*
- * Repairs the @ref rbtree after the insertion of the @ref node.
+ * Repairs the @ref rbtree after the insertion of the @ref node. Returns whether the red root had to be colored
+ * black, i.e. whether the black height of the @ref rbtree grew by one.
  */
-static void repair_after_insert(RBTree *rbtree, RBTreeNode *node);
+static int repair_after_insert(RBTree *rbtree, RBTreeNode *node);
 
 /*
  * Repairs the @ref rbtree after the removal of the @ref node.
  */
 static void repair_after_remove(RBTree *rbtree, RBTreeNode *node);
 
+/*
+ * Returns the number of black @ref RBTreeNode's on a path from the @ref node down to a leaf, including the
+ * @ref node itself. If @ref node == NULL, return 0.
+ */
+static size_t black_height(const RBTreeNode *node);
+
+/*
+ * Joins the subtree rooted at @ref left, the @ref node, and the subtree rooted at @ref right, whose black
+ * heights are @ref left_height, 1 and @ref right_height, into one red-black tree, makes it the root of the
+ * @ref rbtree (whose old root is ignored), and returns its black height. Every key in @ref left must be less
+ * than the key of the @ref node, which must be less than every key in @ref right, and the roots of both
+ * subtrees must be black and have no parent.
+ */
+static size_t join(
+    RBTree *rbtree,
+    RBTreeNode *left,
+    size_t left_height,
+    RBTreeNode *node,
+    RBTreeNode *right,
+    size_t right_height
+);
+
+/*
+ * Returns the address of the member of the @ref node that holds its parent.
+ */
+static const void* parent_link(const RBTreeNode *node);
+
+/*
+ * Writes the offset from the @ref link, which lies in the @ref arena, to the @ref target (0 if NULL) into the
+ * same place of the @ref image_arena.
+ */
+static void write_link(char *image_arena, const char *arena, const void *link, const void *target);
+
+/*
+ * Returns the @ref RBTreeNode the @ref link of a snapshot points to, or NULL.
+ */
+static const RBTreeNode* read_link(const void *link);
+
 /* ========================================================================================================
  *
  *                                        STATIC FUNCTION DEFINITIONS
@@ -90,29 +240,296 @@ static void repair_after_remove(RBTree *rbtree, RBTreeNode *node);
  * ======================================================================================================== */
 
 static RBTreeNodeColor color(const RBTreeNode *node) {
+    #ifdef RBTREE_COMPACT
+    return node ? (RBTreeNodeColor) (node->parent_color & 1) : RBTREE_NODE_BLACK;
+    #else
     return node ? node->color : RBTREE_NODE_BLACK;
+    #endif /* RBTREE_COMPACT */
+}
+
+static void set_color(RBTreeNode *node, RBTreeNodeColor node_color) {
+    assert(node);
+
+    #ifdef RBTREE_COMPACT
+    node->parent_color = (node->parent_color & ~(size_t) 1) | (size_t) node_color;
+    #else
+    node->color = node_color;
+    #endif /* RBTREE_COMPACT */
+}
+
+static RBTreeNode* parent_of(const RBTreeNode *node) {
+    assert(node);
+
+    #ifdef RBTREE_COMPACT
+    return (RBTreeNode*) (node->parent_color & ~(size_t) 1);
+    #else
+    return node->parent;
+    #endif /* RBTREE_COMPACT */
+}
+
+static void set_parent(RBTreeNode *node, RBTreeNode *parent) {
+    assert(node);
+
+    #ifdef RBTREE_COMPACT
+    assert(((size_t) parent & 1) == 0);
+
+    node->parent_color = (size_t) parent | (node->parent_color & 1);
+    #else
+    node->parent = parent;
+    #endif /* RBTREE_COMPACT */
+}
+
+static int compare_key(const RBTree *rbtree, const void *key, const RBTreeNode *node) {
+    #ifdef CDSA_STATS
+    /* The counters are not part of the logical state of the red-black tree, so lookups update them as well. */
+    ++((RBTree*) rbtree)->stats.num_compare_calls;
+    #endif /* CDSA_STATS */
+
+    return rbtree->compare(key, node);
+}
+
+static void recolor(RBTree *rbtree, RBTreeNode *node, RBTreeNodeColor node_color) {
+    #ifdef CDSA_STATS
+    if (color(node) != node_color) {
+        ++rbtree->stats.num_recolorings;
+    }
+    #else
+    (void) rbtree;
+    #endif /* CDSA_STATS */
+
+    set_color(node, node_color);
 }
 
 static RBTreeNode* sibling(const RBTreeNode *node) {
-    assert(node && node->parent);
+    assert(node && parent_of(node));
 
-    if (node == node->parent->left_child) {
-        return node->parent->right_child;
+    if (node == parent_of(node)->left_child) {
+        return parent_of(node)->right_child;
     } else {
-        return node->parent->left_child;
+        return parent_of(node)->left_child;
     }
 }
 
 static RBTreeNode* grandparent(const RBTreeNode *node) {
-    assert(node && node->parent && node->parent->parent);
+    assert(node && parent_of(node) && parent_of(parent_of(node)));
 
-    return node->parent->parent;
+    return parent_of(parent_of(node));
 }
 
 static RBTreeNode* uncle(const RBTreeNode *node) {
-    assert(node && node->parent && node->parent->parent);
+    assert(node && parent_of(node) && parent_of(parent_of(node)));
+
+    return sibling(parent_of(node));
+}
+
+#ifdef RBTREE_ORDER_STATISTICS
+static size_t count(const RBTreeNode *node) {
+    return node ? node->count : 0;
+}
+
+static void update_count(RBTreeNode *node) {
+    assert(node);
+
+    node->count = 1 + count(node->left_child) + count(node->right_child);
+}
+
+static void add_to_counts(RBTreeNode *node, size_t delta) {
+    for ( ; node; node = parent_of(node)) {
+        node->count += delta;
+    }
+}
+#endif /* RBTREE_ORDER_STATISTICS */
+
+static RBTreeNode* inorder_first_below(const RBTreeNode *node) {
+    if (!node) {
+        return NULL;
+    }
+
+    while (node->left_child) {
+        node = node->left_child;
+    }
+
+    return (RBTreeNode*) node;
+}
+
+static RBTreeNode* inorder_last_below(const RBTreeNode *node) {
+    if (!node) {
+        return NULL;
+    }
+
+    while (node->right_child) {
+        node = node->right_child;
+    }
+
+    return (RBTreeNode*) node;
+}
+
+static RBTreeNode* postorder_first_below(const RBTreeNode *node) {
+    assert(node);
+
+    for ( ; ; ) {
+        if (node->left_child) {
+            node = node->left_child;
+        } else if (node->right_child) {
+            node = node->right_child;
+        } else {
+            return (RBTreeNode*) node;
+        }
+    }
+}
+
+static RBTreeNode* next_in_array(void *context) {
+    RBTreeNode ***cursor = (RBTreeNode***) context;
+
+    assert(cursor && *cursor && **cursor);
+
+    return *(*cursor)++;
+}
+
+static RBTreeNode* build_subtree(
+    const RBTree *rbtree,
+    size_t num_nodes,
+    size_t red_depth,
+    RBTreeNode* (*next)(void *context),
+    void *context
+) {
+    /*
+     * Each frame is a subtree still being built. Its depth never exceeds the number of bits of a size_t, since
+     * every level halves the number of nodes, so the explicit stack replaces the recursion in bounded space.
+     */
+    struct {
+        size_t num_nodes;
+        RBTreeNode *node;
+        int state;
+    } stack[sizeof(size_t) * CHAR_BIT + 1];
+    size_t depth = 0;
+    RBTreeNode *subtree = NULL;
+
+    assert(rbtree && next);
+
+    stack[0].num_nodes = num_nodes;
+    stack[0].node = NULL;
+    stack[0].state = 0;
+
+    for (;;) {
+        size_t n = stack[depth].num_nodes;
+
+        if (n == 0 || stack[depth].state == 2) {
+            RBTreeNode *node = stack[depth].node;
+
+            if (n != 0) {
+                /* Both subtrees are built, so the node is complete. */
+                node->right_child = subtree;
+                set_color(node, depth == red_depth ? RBTREE_NODE_RED : RBTREE_NODE_BLACK);
+
+                if (node->left_child) {
+                    set_parent(node->left_child, node);
+                }
+
+                if (node->right_child) {
+                    set_parent(node->right_child, node);
+                }
+
+                #ifdef RBTREE_ORDER_STATISTICS
+                node->count = n;
+                #endif /* RBTREE_ORDER_STATISTICS */
+
+                /* The parent is not linked yet, so this only computes the summary of the node itself. */
+                if (rbtree->augment) {
+                    set_parent(node, NULL);
+                    rbtree->augment->propagate(node, NULL);
+                }
+            }
+
+            subtree = node;
+
+            if (depth == 0) {
+                return subtree;
+            }
+
+            --depth;
+        } else if (stack[depth].state == 0) {
+            /* The subtrees differ in size by at most one, so every level above the deepest one is full. */
+            stack[depth].state = 1;
+            stack[depth + 1].num_nodes = (n - 1) / 2;
+            stack[depth + 1].node = NULL;
+            stack[depth + 1].state = 0;
+            ++depth;
+        } else {
+            RBTreeNode *node = next(context);
+
+            assert(node);
+
+            node->left_child = subtree;
+            stack[depth].node = node;
+            stack[depth].state = 2;
+            stack[depth + 1].num_nodes = n - 1 - (n - 1) / 2;
+            stack[depth + 1].node = NULL;
+            stack[depth + 1].state = 0;
+            ++depth;
+        }
+    }
+}
+
+static void attach(RBTree *rbtree, RBTreeNode *node, RBTreeNode *parent, int left) {
+    assert(rbtree && node);
+
+    if (!parent) {
+        assert(!rbtree->root);
+
+        rbtree->root = node;
+        rbtree->first = node;
+        rbtree->last = node;
+    } else if (left) {
+        assert(!parent->left_child);
+
+        parent->left_child = node;
+
+        if (parent == rbtree->first) {
+            rbtree->first = node;
+        }
+    } else {
+        assert(!parent->right_child);
+
+        parent->right_child = node;
+
+        if (parent == rbtree->last) {
+            rbtree->last = node;
+        }
+    }
+
+    set_parent(node, parent);
+    node->left_child = NULL;
+    node->right_child = NULL;
+    set_color(node, RBTREE_NODE_RED);
+
+    #ifdef CDSA_STATS
+    {
+        size_t depth = 0;
+        RBTreeNode *n;
+
+        for (n = parent; n; n = parent_of(n)) {
+            ++depth;
+        }
+
+        if (depth > rbtree->stats.max_depth) {
+            rbtree->stats.max_depth = depth;
+        }
+    }
+    #endif /* CDSA_STATS */
+
+    #ifdef RBTREE_ORDER_STATISTICS
+    node->count = 1;
+    add_to_counts(parent, 1);
+    #endif /* RBTREE_ORDER_STATISTICS */
 
-    return sibling(node->parent);
+    if (rbtree->augment) {
+        rbtree->augment->propagate(node, NULL);
+    }
+
+    repair_after_insert(rbtree, node);
+
+    ++rbtree->size;
 }
 
 static void replace(RBTree *rbtree, RBTreeNode *old_node, RBTreeNode *new_node) {
@@ -120,23 +537,37 @@ static void replace(RBTree *rbtree, RBTreeNode *old_node, RBTreeNode *new_node)
 
     if (rbtree->root == old_node) {
         rbtree->root = new_node;
-    } else if (old_node == old_node->parent->left_child) {
-        old_node->parent->left_child = new_node;
+    } else if (old_node == parent_of(old_node)->left_child) {
+        parent_of(old_node)->left_child = new_node;
     } else {
-        old_node->parent->right_child = new_node;
+        parent_of(old_node)->right_child = new_node;
     }
 
     if (old_node->left_child) {
-        old_node->left_child->parent = new_node;
+        set_parent(old_node->left_child, new_node);
     }
 
     if (old_node->right_child) {
-        old_node->right_child->parent = new_node;
+        set_parent(old_node->right_child, new_node);
+    }
+
+    if (rbtree->first == old_node) {
+        rbtree->first = new_node;
+    }
+
+    if (rbtree->last == old_node) {
+        rbtree->last = new_node;
     }
 
     *new_node = *old_node;
 
-    old_node->parent = RBTREE_POISON_PARENT;
+    /* The key of the new_node equals the key of the old_node, but anything else it summarizes may differ. */
+    if (rbtree->augment) {
+        rbtree->augment->copy(old_node, new_node);
+        rbtree->augment->propagate(new_node, NULL);
+    }
+
+    set_parent(old_node, RBTREE_POISON_PARENT);
     old_node->left_child = RBTREE_POISON_LEFT_CHILD;
     old_node->right_child = RBTREE_POISON_RIGHT_CHILD;
 }
@@ -144,16 +575,16 @@ static void replace(RBTree *rbtree, RBTreeNode *old_node, RBTreeNode *new_node)
 static void transplant(RBTree *rbtree, RBTreeNode *old_node, RBTreeNode *new_node) {
     assert(rbtree && old_node);
 
-    if (!old_node->parent) {
+    if (!parent_of(old_node)) {
         rbtree->root = new_node;
-    } else if (old_node == old_node->parent->left_child) {
-        old_node->parent->left_child = new_node;
+    } else if (old_node == parent_of(old_node)->left_child) {
+        parent_of(old_node)->left_child = new_node;
     } else {
-        old_node->parent->right_child = new_node;
+        parent_of(old_node)->right_child = new_node;
     }
 
     if (new_node) {
-        new_node->parent = old_node->parent;
+        set_parent(new_node, parent_of(old_node));
     }
 }
 
@@ -162,55 +593,60 @@ static void swap_places(RBTree *rbtree, RBTreeNode *high_node, RBTreeNode *low_n
 
     assert(rbtree && high_node && low_node);
 
-    if (!high_node->parent) {
+    if (!parent_of(high_node)) {
         rbtree->root = low_node;
-    } else if (high_node->parent->left_child == high_node) {
-        high_node->parent->left_child = low_node;
+    } else if (parent_of(high_node)->left_child == high_node) {
+        parent_of(high_node)->left_child = low_node;
     } else {
-        high_node->parent->right_child = low_node;
+        parent_of(high_node)->right_child = low_node;
     }
 
     if (low_node->left_child) {
-        low_node->left_child->parent = high_node;
+        set_parent(low_node->left_child, high_node);
     }
 
     if (low_node->right_child) {
-        low_node->right_child->parent = high_node;
+        set_parent(low_node->right_child, high_node);
     }
 
     if (high_node->left_child == low_node) {
         if (high_node->right_child) {
-            high_node->right_child->parent = low_node;
+            set_parent(high_node->right_child, low_node);
         }
 
         high_node->left_child = high_node;
-        low_node->parent = low_node;
+        set_parent(low_node, low_node);
     } else if (high_node->right_child == low_node) {
         if (high_node->left_child) {
-            high_node->left_child->parent = low_node;
+            set_parent(high_node->left_child, low_node);
         }
 
         high_node->right_child = high_node;
-        low_node->parent = low_node;
+        set_parent(low_node, low_node);
     } else {
         if (high_node->left_child) {
-            high_node->left_child->parent = low_node;
+            set_parent(high_node->left_child, low_node);
         }
 
         if (high_node->right_child) {
-            high_node->right_child->parent = low_node;
+            set_parent(high_node->right_child, low_node);
         }
 
-        if (low_node->parent->left_child == low_node) {
-            low_node->parent->left_child = high_node;
+        if (parent_of(low_node)->left_child == low_node) {
+            parent_of(low_node)->left_child = high_node;
         } else {
-            low_node->parent->right_child = high_node;
+            parent_of(low_node)->right_child = high_node;
         }
     }
 
     high_cpy = *high_node;
     *high_node = *low_node;
     *low_node = high_cpy;
+
+    /* The low_node now roots the subtree of the high_node, which is recomputed once the removal is done. */
+    if (rbtree->augment) {
+        rbtree->augment->copy(high_node, low_node);
+    }
 }
 
 static void rotate_left(RBTree *rbtree, RBTreeNode *node) {
@@ -218,6 +654,10 @@ static void rotate_left(RBTree *rbtree, RBTreeNode *node) {
 
     assert(rbtree && node);
 
+    #ifdef CDSA_STATS
+    ++rbtree->stats.num_rotations;
+    #endif /* CDSA_STATS */
+
     n = node->right_child;
 
     transplant(rbtree, node, n);
@@ -225,11 +665,20 @@ static void rotate_left(RBTree *rbtree, RBTreeNode *node) {
     node->right_child = n->left_child;
 
     if (n->left_child) {
-        n->left_child->parent = node;
+        set_parent(n->left_child, node);
     }
 
     n->left_child = node;
-    node->parent = n;
+    set_parent(node, n);
+
+    #ifdef RBTREE_ORDER_STATISTICS
+    n->count = node->count;
+    update_count(node);
+    #endif /* RBTREE_ORDER_STATISTICS */
+
+    if (rbtree->augment) {
+        rbtree->augment->rotate(node, n);
+    }
 }
 
 static void rotate_right(RBTree *rbtree, RBTreeNode *node) {
@@ -237,6 +686,10 @@ static void rotate_right(RBTree *rbtree, RBTreeNode *node) {
 
     assert(rbtree && node);
 
+    #ifdef CDSA_STATS
+    ++rbtree->stats.num_rotations;
+    #endif /* CDSA_STATS */
+
     n = node->left_child;
 
     transplant(rbtree, node, n);
@@ -244,56 +697,68 @@ static void rotate_right(RBTree *rbtree, RBTreeNode *node) {
     node->left_child = n->right_child;
 
     if (n->right_child) {
-        n->right_child->parent = node;
+        set_parent(n->right_child, node);
     }
 
     n->right_child = node;
-    node->parent = n;
+    set_parent(node, n);
+
+    #ifdef RBTREE_ORDER_STATISTICS
+    n->count = node->count;
+    update_count(node);
+    #endif /* RBTREE_ORDER_STATISTICS */
+
+    if (rbtree->augment) {
+        rbtree->augment->rotate(node, n);
+    }
 }
 
-static void repair_after_insert(RBTree *rbtree, RBTreeNode *node) {
+static int repair_after_insert(RBTree *rbtree, RBTreeNode *node) {
+    int grew;
+
     assert(rbtree && node);
 
     for ( ; ; ) {
-        if (!node->parent) {
-            node->color = RBTREE_NODE_BLACK;
+        if (!parent_of(node)) {
+            grew = color(node) == RBTREE_NODE_RED;
+            recolor(rbtree, node, RBTREE_NODE_BLACK);
 
-            break;
+            return grew;
         }
 
-        if (color(node->parent) == RBTREE_NODE_BLACK) {
-            break;
+        if (color(parent_of(node)) == RBTREE_NODE_BLACK) {
+            return 0;
         }
 
         if (color(uncle(node)) == RBTREE_NODE_RED) {
-            node->parent->color = RBTREE_NODE_BLACK;
-            uncle(node)->color = RBTREE_NODE_BLACK;
-            grandparent(node)->color = RBTREE_NODE_RED;
+            recolor(rbtree, parent_of(node), RBTREE_NODE_BLACK);
+            recolor(rbtree, uncle(node), RBTREE_NODE_BLACK);
+            recolor(rbtree, grandparent(node), RBTREE_NODE_RED);
             node = grandparent(node);
 
             continue;
         }
 
-        if (node == node->parent->right_child && node->parent == grandparent(node)->left_child) {
-            rotate_left(rbtree, node->parent);
+        if (node == parent_of(node)->right_child && parent_of(node) == grandparent(node)->left_child) {
+            rotate_left(rbtree, parent_of(node));
 
             node = node->left_child;
-        } else if (node == node->parent->left_child && node->parent == grandparent(node)->right_child) {
-            rotate_right(rbtree, node->parent);
+        } else if (node == parent_of(node)->left_child && parent_of(node) == grandparent(node)->right_child) {
+            rotate_right(rbtree, parent_of(node));
 
             node = node->right_child;
         }
 
-        node->parent->color = RBTREE_NODE_BLACK;
-        grandparent(node)->color = RBTREE_NODE_RED;
+        recolor(rbtree, parent_of(node), RBTREE_NODE_BLACK);
+        recolor(rbtree, grandparent(node), RBTREE_NODE_RED);
 
-        if (node == node->parent->left_child && node->parent == grandparent(node)->left_child) {
+        if (node == parent_of(node)->left_child && parent_of(node) == grandparent(node)->left_child) {
             rotate_right(rbtree, grandparent(node));
         } else {
             rotate_left(rbtree, grandparent(node));
         }
 
-        break;
+        return 0;
     }
 }
 
@@ -301,84 +766,213 @@ static void repair_after_remove(RBTree *rbtree, RBTreeNode *node) {
     assert(rbtree && node);
 
     for ( ; ; ) {
-        if (!node->parent) {
+        if (!parent_of(node)) {
             break;
         }
 
         if (color(sibling(node)) == RBTREE_NODE_RED) {
-            node->parent->color = RBTREE_NODE_RED;
-            sibling(node)->color = RBTREE_NODE_BLACK;
+            recolor(rbtree, parent_of(node), RBTREE_NODE_RED);
+            recolor(rbtree, sibling(node), RBTREE_NODE_BLACK);
 
-            if (node == node->parent->left_child) {
-                rotate_left(rbtree, node->parent);
+            if (node == parent_of(node)->left_child) {
+                rotate_left(rbtree, parent_of(node));
             } else {
-                rotate_right(rbtree, node->parent);
+                rotate_right(rbtree, parent_of(node));
             }
         }
 
         if (
-            color(node->parent) == RBTREE_NODE_BLACK &&
+            color(parent_of(node)) == RBTREE_NODE_BLACK &&
             color(sibling(node)) == RBTREE_NODE_BLACK &&
             color(sibling(node)->left_child) == RBTREE_NODE_BLACK &&
             color(sibling(node)->right_child) == RBTREE_NODE_BLACK
         ) {
-            sibling(node)->color = RBTREE_NODE_RED;
-            node = node->parent;
+            recolor(rbtree, sibling(node), RBTREE_NODE_RED);
+            node = parent_of(node);
 
             continue;
         }
 
         if (
-            color(node->parent) == RBTREE_NODE_RED &&
+            color(parent_of(node)) == RBTREE_NODE_RED &&
             color(sibling(node)) == RBTREE_NODE_BLACK &&
             color(sibling(node)->left_child) == RBTREE_NODE_BLACK &&
             color(sibling(node)->right_child) == RBTREE_NODE_BLACK
         ) {
-            sibling(node)->color = RBTREE_NODE_RED;
-            node->parent->color = RBTREE_NODE_BLACK;
+            recolor(rbtree, sibling(node), RBTREE_NODE_RED);
+            recolor(rbtree, parent_of(node), RBTREE_NODE_BLACK);
 
             break;
         }
 
         if (
-            node == node->parent->left_child &&
+            node == parent_of(node)->left_child &&
             color(sibling(node)) == RBTREE_NODE_BLACK &&
             color(sibling(node)->left_child) == RBTREE_NODE_RED &&
             color(sibling(node)->right_child) == RBTREE_NODE_BLACK
         ) {
-            sibling(node)->color = RBTREE_NODE_RED;
-            sibling(node)->left_child->color = RBTREE_NODE_BLACK;
+            recolor(rbtree, sibling(node), RBTREE_NODE_RED);
+            recolor(rbtree, sibling(node)->left_child, RBTREE_NODE_BLACK);
 
             rotate_right(rbtree, sibling(node));
         } else if (
-            node == node->parent->right_child &&
+            node == parent_of(node)->right_child &&
             color(sibling(node)) == RBTREE_NODE_BLACK &&
             color(sibling(node)->left_child) == RBTREE_NODE_BLACK &&
             color(sibling(node)->right_child) == RBTREE_NODE_RED
         ) {
-            sibling(node)->color = RBTREE_NODE_RED;
-            sibling(node)->right_child->color = RBTREE_NODE_BLACK;
+            recolor(rbtree, sibling(node), RBTREE_NODE_RED);
+            recolor(rbtree, sibling(node)->right_child, RBTREE_NODE_BLACK);
 
             rotate_left(rbtree, sibling(node));
         }
 
-        sibling(node)->color = color(node->parent);
-        node->parent->color = RBTREE_NODE_BLACK;
+        recolor(rbtree, sibling(node), color(parent_of(node)));
+        recolor(rbtree, parent_of(node), RBTREE_NODE_BLACK);
 
-        if (node == node->parent->left_child) {
-            sibling(node)->right_child->color = RBTREE_NODE_BLACK;
+        if (node == parent_of(node)->left_child) {
+            recolor(rbtree, sibling(node)->right_child, RBTREE_NODE_BLACK);
 
-            rotate_left(rbtree, node->parent);
+            rotate_left(rbtree, parent_of(node));
         } else {
-            sibling(node)->left_child->color = RBTREE_NODE_BLACK;
+            recolor(rbtree, sibling(node)->left_child, RBTREE_NODE_BLACK);
 
-            rotate_right(rbtree, node->parent);
+            rotate_right(rbtree, parent_of(node));
         }
 
         break;
     }
 }
 
+static size_t black_height(const RBTreeNode *node) {
+    size_t height = 0;
+
+    for ( ; node; node = node->left_child) {
+        if (color(node) == RBTREE_NODE_BLACK) {
+            ++height;
+        }
+    }
+
+    return height;
+}
+
+static size_t join(
+    RBTree *rbtree,
+    RBTreeNode *left,
+    size_t left_height,
+    RBTreeNode *node,
+    RBTreeNode *right,
+    size_t right_height
+) {
+    RBTreeNode *n, *parent = NULL;
+    size_t height;
+
+    assert(rbtree && node && color(left) == RBTREE_NODE_BLACK && color(right) == RBTREE_NODE_BLACK);
+    assert((!left || !parent_of(left)) && (!right || !parent_of(right)));
+
+    if (left_height == right_height) {
+        node->left_child = left;
+        node->right_child = right;
+        set_parent(node, NULL);
+        set_color(node, RBTREE_NODE_BLACK);
+        height = left_height + 1;
+    } else if (left_height > right_height) {
+        /* Descend the right spine of the taller tree to the first black node as high as the shorter tree. */
+        for (n = left, height = left_height; n && (color(n) == RBTREE_NODE_RED || height > right_height); ) {
+            if (color(n) == RBTREE_NODE_BLACK) {
+                --height;
+            }
+
+            parent = n;
+            n = n->right_child;
+        }
+
+        parent->right_child = node;
+        node->left_child = n;
+        node->right_child = right;
+        height = left_height;
+    } else {
+        for (n = right, height = right_height; n && (color(n) == RBTREE_NODE_RED || height > left_height); ) {
+            if (color(n) == RBTREE_NODE_BLACK) {
+                --height;
+            }
+
+            parent = n;
+            n = n->left_child;
+        }
+
+        parent->left_child = node;
+        node->left_child = left;
+        node->right_child = n;
+        height = right_height;
+    }
+
+    if (node->left_child) {
+        set_parent(node->left_child, node);
+    }
+
+    if (node->right_child) {
+        set_parent(node->right_child, node);
+    }
+
+    #ifdef RBTREE_ORDER_STATISTICS
+    update_count(node);
+    #endif /* RBTREE_ORDER_STATISTICS */
+
+    if (!parent) {
+        rbtree->root = node;
+
+        if (rbtree->augment) {
+            rbtree->augment->propagate(node, NULL);
+        }
+
+        return height;
+    }
+
+    /* The node is linked like a red leaf with subtrees, so the ordinary insertion repair applies. */
+    rbtree->root = left_height > right_height ? left : right;
+    set_parent(node, parent);
+    set_color(node, RBTREE_NODE_RED);
+
+    #ifdef RBTREE_ORDER_STATISTICS
+    add_to_counts(parent, 1 + (left_height > right_height ? count(right) : count(left)));
+    #endif /* RBTREE_ORDER_STATISTICS */
+
+    if (rbtree->augment) {
+        rbtree->augment->propagate(node, NULL);
+    }
+
+    return height + (size_t) repair_after_insert(rbtree, node);
+}
+
+static const void* parent_link(const RBTreeNode *node) {
+    assert(node);
+
+    #ifdef RBTREE_COMPACT
+    return &node->parent_color;
+    #else
+    return &node->parent;
+    #endif /* RBTREE_COMPACT */
+}
+
+static void write_link(char *image_arena, const char *arena, const void *link, const void *target) {
+    ptrdiff_t offset = target ? (const char*) target - (const char*) link : 0;
+
+    assert(image_arena && arena && link);
+
+    memcpy(image_arena + ((const char*) link - arena), &offset, sizeof(ptrdiff_t));
+}
+
+static const RBTreeNode* read_link(const void *link) {
+    ptrdiff_t offset;
+
+    assert(link);
+
+    memcpy(&offset, link, sizeof(ptrdiff_t));
+
+    return offset ? (const RBTreeNode*) ((const char*) link + offset) : NULL;
+}
+
 /* ========================================================================================================
  *
  *                                        EXTERN FUNCTION DEFINITIONS
@@ -397,44 +991,34 @@ void rbtree_init(
     rbtree->collide = collide;
     rbtree->auxiliary_data = auxiliary_data;
     rbtree->root = NULL;
+    rbtree->first = NULL;
+    rbtree->last = NULL;
     rbtree->size = 0;
-}
-
-RBTreeNode* rbtree_first(const RBTree *rbtree) {
-    RBTreeNode *n;
+    rbtree->augment = NULL;
 
-    assert(rbtree);
+    #ifdef CDSA_STATS
+    rbtree_reset_stats(rbtree);
+    #endif /* CDSA_STATS */
+}
 
-    n = rbtree->root;
+void rbtree_set_augment(RBTree *rbtree, const RBTreeAugment *augment) {
+    assert(rbtree && rbtree->size == 0);
+    assert(!augment || (augment->propagate && augment->copy && augment->rotate));
 
-    if (!n) {
-        return NULL;
-    }
+    rbtree->augment = augment;
+}
 
-    while (n->left_child) {
-        n = n->left_child;
-    }
+RBTreeNode* rbtree_first(const RBTree *rbtree) {
+    assert(rbtree);
 
-    return n;
+    return rbtree->first;
 }
 
 RBTreeNode* rbtree_last(const RBTree *rbtree) {
-    RBTreeNode *n;
-
     assert(rbtree);
 
-    n = rbtree->root;
-
-    if (!n) {
-        return NULL;
-    }
-
-    while (n->right_child) {
-        n = n->right_child;
-    }
-
-    return n;
-}
+    return rbtree->last;
+}
 
 RBTreeNode* rbtree_prev(const RBTreeNode *node) {
     RBTreeNode *n;
@@ -453,7 +1037,7 @@ RBTreeNode* rbtree_prev(const RBTreeNode *node) {
         return (RBTreeNode*) node;
     }
 
-    while ((n = node->parent) && node == n->left_child) {
+    while ((n = parent_of(node)) && node == n->left_child) {
         node = n;
     }
 
@@ -477,13 +1061,46 @@ RBTreeNode* rbtree_next(const RBTreeNode *node) {
         return (RBTreeNode*) node;
     }
 
-    while ((n = node->parent) && node == n->right_child) {
+    while ((n = parent_of(node)) && node == n->right_child) {
         node = n;
     }
 
     return n;
 }
 
+RBTreeNode* rbtree_postorder_first(const RBTree *rbtree) {
+    assert(rbtree);
+
+    return rbtree->root ? postorder_first_below(rbtree->root) : NULL;
+}
+
+RBTreeNode* rbtree_postorder_next(const RBTreeNode *node) {
+    RBTreeNode *n;
+
+    if (!node || !(n = parent_of(node))) {
+        return NULL;
+    }
+
+    /* The children of the node are compared by address only, since they may already be freed. */
+    if (node == n->left_child && n->right_child) {
+        return postorder_first_below(n->right_child);
+    }
+
+    return n;
+}
+
+RBTreeNode* rbtree_parent(const RBTreeNode *node) {
+    assert(node);
+
+    return parent_of(node);
+}
+
+RBTreeNodeColor rbtree_color(const RBTreeNode *node) {
+    assert(node);
+
+    return color(node);
+}
+
 size_t rbtree_size(const RBTree *rbtree) {
     assert(rbtree);
 
@@ -502,9 +1119,31 @@ int rbtree_contains_key(const RBTree *rbtree, const void *key) {
     return rbtree_lookup_key(rbtree, key) != NULL;
 }
 
+const RBTreeAugment* rbtree_augment(const RBTree *rbtree) {
+    assert(rbtree);
+
+    return rbtree->augment;
+}
+
 size_t rbtree_index_of(const RBTree *rbtree, const RBTreeNode *node) {
     assert(rbtree && node);
 
+    #ifdef RBTREE_ORDER_STATISTICS
+    {
+        size_t index = count(node->left_child);
+
+        (void) rbtree;
+
+        /* Every step up from a right child passes over the parent and the parent's left subtree. */
+        for ( ; parent_of(node); node = parent_of(node)) {
+            if (node == parent_of(node)->right_child) {
+                index += 1 + count(parent_of(node)->left_child);
+            }
+        }
+
+        return index;
+    }
+    #else
     if (rbtree_last(rbtree) == node) {
         return rbtree->size - 1;
     } else {
@@ -520,14 +1159,31 @@ size_t rbtree_index_of(const RBTree *rbtree, const RBTreeNode *node) {
 
     assert(0);
     return (size_t) -1;
+    #endif /* RBTREE_ORDER_STATISTICS */
 }
 
 RBTreeNode* rbtree_at(const RBTree *rbtree, size_t index) {
     RBTreeNode *n;
+    #ifndef RBTREE_ORDER_STATISTICS
     size_t i;
+    #endif /* RBTREE_ORDER_STATISTICS */
 
     assert(rbtree && index < rbtree->size);
 
+    #ifdef RBTREE_ORDER_STATISTICS
+    for (n = rbtree->root; ; ) {
+        size_t left_count = count(n->left_child);
+
+        if (index < left_count) {
+            n = n->left_child;
+        } else if (index > left_count) {
+            index -= left_count + 1;
+            n = n->right_child;
+        } else {
+            return n;
+        }
+    }
+    #else
     if (index < rbtree->size / 2) {
         i = 0;
         rbtree_for_each(n, rbtree) {
@@ -548,59 +1204,176 @@ RBTreeNode* rbtree_at(const RBTree *rbtree, size_t index) {
 
     assert(0);
     return NULL;
+    #endif /* RBTREE_ORDER_STATISTICS */
+}
+
+size_t rbtree_rank_of_key(const RBTree *rbtree, const void *key) {
+    RBTreeNode *n;
+
+    assert(rbtree);
+
+    #ifdef RBTREE_ORDER_STATISTICS
+    {
+        size_t rank = 0;
+
+        for (n = rbtree->root; n; ) {
+            if (compare_key(rbtree, key, n) <= 0) {
+                n = n->left_child;
+            } else {
+                rank += count(n->left_child) + 1;
+                n = n->right_child;
+            }
+        }
+
+        return rank;
+    }
+    #else
+    n = rbtree_lower_bound(rbtree, key);
+
+    return n ? rbtree_index_of(rbtree, n) : rbtree->size;
+    #endif /* RBTREE_ORDER_STATISTICS */
 }
 
 void rbtree_insert(RBTree *rbtree, const void *key, RBTreeNode *node) {
     RBTreeNode *n;
+    int cmp = 0;
 
     assert(rbtree && node);
 
     n = rbtree->root;
 
-    if (n) {
-        for ( ; ; ) {
-            int cmp = rbtree->compare(key, n);
+    while (n) {
+        cmp = compare_key(rbtree, key, n);
 
-            if (cmp < 0) {
-                if (n->left_child) {
-                    n = n->left_child;
-                } else {
-                    n->left_child = node;
+        if (cmp < 0 && n->left_child) {
+            n = n->left_child;
+        } else if (cmp > 0 && n->right_child) {
+            n = n->right_child;
+        } else {
+            break;
+        }
+    }
 
-                    break;
-                }
-            } else if (cmp > 0) {
-                if (n->right_child) {
-                    n = n->right_child;
-                } else {
-                    n->right_child = node;
+    if (n && cmp == 0) {
+        replace(rbtree, n, node);
 
-                    break;
-                }
+        #ifdef CDSA_STATS
+        ++rbtree->stats.num_collisions;
+        #endif /* CDSA_STATS */
+
+        if (rbtree->collide) {
+            rbtree->collide(n, node, rbtree->auxiliary_data);
+        }
+
+        return;
+    }
+
+    attach(rbtree, node, n, cmp < 0);
+}
+
+void rbtree_insert_hint(RBTree *rbtree, const void *key, RBTreeNode *node, RBTreeNode *hint) {
+    RBTreeNode *neighbor;
+    int cmp;
+
+    assert(rbtree && node);
+
+    if (!rbtree->root) {
+        attach(rbtree, node, NULL, 0);
+        return;
+    }
+
+    if (!hint) {
+        hint = rbtree->last;
+    }
+
+    cmp = compare_key(rbtree, key, hint);
+
+    if (cmp < 0) {
+        /* The key belongs right before the hint if it is greater than the key of the predecessor. */
+        neighbor = hint == rbtree->first ? NULL : rbtree_prev(hint);
+
+        if (!neighbor || (cmp = compare_key(rbtree, key, neighbor)) > 0) {
+            if (!hint->left_child) {
+                attach(rbtree, node, hint, 1);
             } else {
-                replace(rbtree, n, node);
+                attach(rbtree, node, neighbor, 0);
+            }
 
-                if (rbtree->collide) {
-                    rbtree->collide(n, node, rbtree->auxiliary_data);
-                }
+            return;
+        }
+    } else if (cmp > 0) {
+        /* The key belongs right after the hint if it is less than the key of the successor. */
+        neighbor = hint == rbtree->last ? NULL : rbtree_next(hint);
 
-                return;
+        if (!neighbor || (cmp = compare_key(rbtree, key, neighbor)) < 0) {
+            if (!hint->right_child) {
+                attach(rbtree, node, hint, 0);
+            } else {
+                attach(rbtree, node, neighbor, 1);
             }
+
+            return;
         }
+    } else {
+        neighbor = hint;
     }
 
-    node->parent = n;
-    node->left_child = NULL;
-    node->right_child = NULL;
-    node->color = RBTREE_NODE_RED;
+    if (cmp == 0) {
+        replace(rbtree, neighbor, node);
 
-    if (!n) {
-        rbtree->root = node;
+        #ifdef CDSA_STATS
+        ++rbtree->stats.num_collisions;
+        #endif /* CDSA_STATS */
+
+        if (rbtree->collide) {
+            rbtree->collide(neighbor, node, rbtree->auxiliary_data);
+        }
+
+        return;
     }
 
-    repair_after_insert(rbtree, node);
+    /* The hint was wrong. */
+    rbtree_insert(rbtree, key, node);
+}
 
-    ++rbtree->size;
+void rbtree_insert_last(RBTree *rbtree, const void *key, RBTreeNode *node) {
+    assert(rbtree && node);
+
+    rbtree_insert_hint(rbtree, key, node, NULL);
+}
+
+void rbtree_build_sorted(RBTree *rbtree, RBTreeNode **nodes, size_t num_nodes) {
+    assert(rbtree && (nodes || num_nodes == 0));
+
+    rbtree_build_sorted_sequence(rbtree, num_nodes, next_in_array, &nodes);
+}
+
+void rbtree_build_sorted_sequence(RBTree *rbtree, size_t num_nodes, RBTreeNode* (*next)(void *context), void *context) {
+    size_t red_depth = (size_t) -1;
+
+    assert(rbtree && rbtree->size == 0 && (next || num_nodes == 0));
+
+    if (num_nodes == 0) {
+        return;
+    }
+
+    /*
+     * Unless the tree is perfect, every path to a leaf ends in either the deepest, incomplete level or the one
+     * above it. Coloring exactly the deepest level red gives every path the same number of black nodes.
+     */
+    if ((num_nodes & (num_nodes + 1)) != 0) {
+        size_t n;
+
+        for (red_depth = 0, n = num_nodes; n > 1; n >>= 1) {
+            ++red_depth;
+        }
+    }
+
+    rbtree->root = build_subtree(rbtree, num_nodes, red_depth, next, context);
+    set_parent(rbtree->root, NULL);
+    rbtree->first = inorder_first_below(rbtree->root);
+    rbtree->last = inorder_last_below(rbtree->root);
+    rbtree->size = num_nodes;
 }
 
 RBTreeNode* rbtree_lookup_key(const RBTree *rbtree, const void *key) {
@@ -609,7 +1382,7 @@ RBTreeNode* rbtree_lookup_key(const RBTree *rbtree, const void *key) {
     assert(rbtree);
 
     for (n = rbtree->root; n; ) {
-        int cmp = rbtree->compare(key, n);
+        int cmp = compare_key(rbtree, key, n);
 
         if (cmp < 0) {
             n = n->left_child;
@@ -623,6 +1396,40 @@ RBTreeNode* rbtree_lookup_key(const RBTree *rbtree, const void *key) {
     return n;
 }
 
+RBTreeNode* rbtree_lower_bound(const RBTree *rbtree, const void *key) {
+    RBTreeNode *n, *bound = NULL;
+
+    assert(rbtree);
+
+    for (n = rbtree->root; n; ) {
+        if (compare_key(rbtree, key, n) <= 0) {
+            bound = n;
+            n = n->left_child;
+        } else {
+            n = n->right_child;
+        }
+    }
+
+    return bound;
+}
+
+RBTreeNode* rbtree_upper_bound(const RBTree *rbtree, const void *key) {
+    RBTreeNode *n, *bound = NULL;
+
+    assert(rbtree);
+
+    for (n = rbtree->root; n; ) {
+        if (compare_key(rbtree, key, n) < 0) {
+            bound = n;
+            n = n->left_child;
+        } else {
+            n = n->right_child;
+        }
+    }
+
+    return bound;
+}
+
 void rbtree_remove(RBTree *rbtree, RBTreeNode *node) {
     RBTreeNode *n;
 
@@ -632,6 +1439,15 @@ void rbtree_remove(RBTree *rbtree, RBTreeNode *node) {
         return;
     }
 
+    /* The first and the last RBTreeNode have at most one child, a leaf, so their neighbors are close. */
+    if (node == rbtree->first) {
+        rbtree->first = rbtree_next(node);
+    }
+
+    if (node == rbtree->last) {
+        rbtree->last = rbtree_prev(node);
+    }
+
     if (node->left_child && node->right_child) {
         RBTreeNode *k = node->left_child;
 
@@ -645,18 +1461,28 @@ void rbtree_remove(RBTree *rbtree, RBTreeNode *node) {
     n = node->right_child ? node->right_child : node->left_child;
 
     if (color(node) == RBTREE_NODE_BLACK) {
-        node->color = color(n);
+        set_color(node, color(n));
 
         repair_after_remove(rbtree, node);
     }
 
     transplant(rbtree, node, n);
 
-    if (!node->parent && n) {
-        n->color = RBTREE_NODE_BLACK;
+    #ifdef RBTREE_ORDER_STATISTICS
+    /* The repair rotations counted the node as still being in the tree, so only its ancestors are stale. */
+    add_to_counts(parent_of(node), (size_t) -1);
+    #endif /* RBTREE_ORDER_STATISTICS */
+
+    /* Every summary that the rotations and the swap left out of date belongs to an ancestor of the node. */
+    if (rbtree->augment && parent_of(node)) {
+        rbtree->augment->propagate(parent_of(node), NULL);
     }
 
-    node->parent = RBTREE_POISON_PARENT;
+    if (!parent_of(node) && n) {
+        set_color(n, RBTREE_NODE_BLACK);
+    }
+
+    set_parent(node, RBTREE_POISON_PARENT);
     node->left_child = RBTREE_POISON_LEFT_CHILD;
     node->right_child = RBTREE_POISON_RIGHT_CHILD;
 
@@ -672,24 +1498,369 @@ void rbtree_remove_key(RBTree *rbtree, const void *key) {
 void rbtree_remove_first(RBTree *rbtree) {
     assert(rbtree);
 
-    rbtree_remove(rbtree, rbtree_first(rbtree));
+    rbtree_remove(rbtree, rbtree->first);
 }
 
 void rbtree_remove_last(RBTree *rbtree) {
     assert(rbtree);
 
-    rbtree_remove(rbtree, rbtree_last(rbtree));
+    rbtree_remove(rbtree, rbtree->last);
+}
+
+void rbtree_remove_range(RBTree *rbtree, const void *low_key, const void *high_key) {
+    RBTreeNode *n, *next;
+
+    assert(rbtree);
+
+    /* Removal never moves another RBTreeNode out of the tree, so the successor stays valid. */
+    for (n = rbtree_lower_bound(rbtree, low_key); n && compare_key(rbtree, high_key, n) >= 0; n = next) {
+        next = rbtree_next(n);
+        rbtree_remove(rbtree, n);
+    }
 }
 
 void rbtree_remove_all(RBTree *rbtree) {
     assert(rbtree);
 
     if (rbtree->root) {
-        rbtree->root->parent = RBTREE_POISON_PARENT;
+        set_parent(rbtree->root, RBTREE_POISON_PARENT);
         rbtree->root->left_child = RBTREE_POISON_LEFT_CHILD;
         rbtree->root->right_child = RBTREE_POISON_RIGHT_CHILD;
     }
 
     rbtree->root = NULL;
+    rbtree->first = NULL;
+    rbtree->last = NULL;
     rbtree->size = 0;
 }
+
+void rbtree_destroy(RBTree *rbtree, void (*destroy)(RBTreeNode *node, void *auxiliary_data), void *auxiliary_data) {
+    RBTreeNode *n, *backup;
+
+    assert(rbtree && destroy);
+
+    rbtree_for_each_postorder_safe(n, backup, rbtree) {
+        destroy(n, auxiliary_data);
+    }
+
+    rbtree->root = NULL;
+    rbtree->first = NULL;
+    rbtree->last = NULL;
+    rbtree->size = 0;
+}
+
+void rbtree_split(RBTree *rbtree, const void *key, RBTree *left, RBTree *right) {
+    /* A red-black tree with n nodes is at most 2 * log2(n + 1) high. */
+    struct {
+        RBTreeNode *node;
+        size_t height;
+        int to_right;
+    } path[2 * sizeof(size_t) * CHAR_BIT];
+    RBTreeNode *n, *subtree, *left_root = NULL, *right_root = NULL;
+    size_t depth = 0, height, subtree_height, left_height = 0, right_height = 0, left_size;
+    RBTree config;
+
+    assert(rbtree && left && right && left != right);
+
+    config = *rbtree;
+
+    for (n = rbtree->root, height = black_height(n); n; ++depth) {
+        path[depth].node = n;
+        path[depth].height = height;
+        path[depth].to_right = compare_key(rbtree, key, n) <= 0;
+
+        if (color(n) == RBTREE_NODE_BLACK) {
+            --height;
+        }
+
+        n = path[depth].to_right ? n->left_child : n->right_child;
+    }
+
+    /*
+     * Going back up, every node on the path is joined with its subtree off the path into the half it belongs to.
+     * The halves collected so far hold keys between that node and the key, so they go next to the node.
+     */
+    while (depth-- > 0) {
+        n = path[depth].node;
+        subtree = path[depth].to_right ? n->right_child : n->left_child;
+        subtree_height = path[depth].height - (color(n) == RBTREE_NODE_BLACK ? 1 : 0);
+
+        if (subtree) {
+            set_parent(subtree, NULL);
+
+            if (color(subtree) == RBTREE_NODE_RED) {
+                recolor(rbtree, subtree, RBTREE_NODE_BLACK);
+                ++subtree_height;
+            }
+        }
+
+        if (path[depth].to_right) {
+            right_height = join(rbtree, right_root, right_height, n, subtree, subtree_height);
+            right_root = rbtree->root;
+        } else {
+            left_height = join(rbtree, subtree, subtree_height, n, left_root, left_height);
+            left_root = rbtree->root;
+        }
+    }
+
+    #ifdef RBTREE_ORDER_STATISTICS
+    left_size = count(left_root);
+    #else
+    {
+        RBTreeNode *a = inorder_first_below(left_root), *b = inorder_first_below(right_root);
+        size_t k = 0;
+
+        /* Walking both halves in step stops at the end of the smaller one, which settles both sizes. */
+        for ( ; a && b; ++k) {
+            a = rbtree_next(a);
+            b = rbtree_next(b);
+        }
+
+        left_size = a ? config.size - k : k;
+    }
+    #endif /* RBTREE_ORDER_STATISTICS */
+
+    /* The counters move into the left half only, so that summing the counters of all trees counts nothing twice. */
+    #ifdef CDSA_STATS
+    config.stats = rbtree->stats;
+    rbtree_reset_stats(rbtree);
+    #endif /* CDSA_STATS */
+
+    rbtree->root = NULL;
+    rbtree->first = NULL;
+    rbtree->last = NULL;
+    rbtree->size = 0;
+
+    *left = config;
+    left->root = left_root;
+    left->first = left_root ? config.first : NULL;
+    left->last = inorder_last_below(left_root);
+    left->size = left_size;
+
+    *right = config;
+    right->root = right_root;
+    right->first = inorder_first_below(right_root);
+    right->last = right_root ? config.last : NULL;
+    right->size = config.size - left_size;
+
+    #ifdef CDSA_STATS
+    rbtree_reset_stats(right);
+    #endif /* CDSA_STATS */
+}
+
+void rbtree_join(RBTree *rbtree, RBTree *src_rbtree) {
+    RBTreeNode *node, *left_root, *last;
+    size_t size;
+
+    assert(rbtree && src_rbtree && rbtree != src_rbtree && rbtree->augment == src_rbtree->augment);
+
+    if (!src_rbtree->root) {
+        return;
+    }
+
+    if (!rbtree->root) {
+        rbtree->root = src_rbtree->root;
+        rbtree->first = src_rbtree->first;
+        rbtree->last = src_rbtree->last;
+        rbtree->size = src_rbtree->size;
+    } else {
+        /* The smallest node of the src_rbtree lies between both trees, so it becomes the joining node. */
+        size = rbtree->size + src_rbtree->size;
+        last = src_rbtree->last;
+        node = src_rbtree->first;
+        rbtree_remove(src_rbtree, node);
+
+        left_root = rbtree->root;
+        join(rbtree, left_root, black_height(left_root), node, src_rbtree->root, black_height(src_rbtree->root));
+        rbtree->last = last;
+        rbtree->size = size;
+    }
+
+    src_rbtree->root = NULL;
+    src_rbtree->first = NULL;
+    src_rbtree->last = NULL;
+    src_rbtree->size = 0;
+}
+
+#ifdef CDSA_STATS
+
+void rbtree_stats(const RBTree *rbtree, RBTreeStats *stats) {
+    assert(rbtree && stats);
+
+    *stats = rbtree->stats;
+}
+
+void rbtree_reset_stats(RBTree *rbtree) {
+    assert(rbtree);
+
+    rbtree->stats.num_compare_calls = 0;
+    rbtree->stats.num_collisions = 0;
+    rbtree->stats.num_rotations = 0;
+    rbtree->stats.num_recolorings = 0;
+    rbtree->stats.max_depth = 0;
+}
+
+#endif /* CDSA_STATS */
+
+size_t rbtree_serialize(const RBTree *rbtree, const void *arena, size_t arena_size, void *buffer) {
+    const char *arena_begin = (const char*) arena;
+    char *image = (char*) buffer, *image_arena;
+    const RBTreeNode *n;
+    size_t fields[SNAPSHOT_NUM_FIELDS];
+
+    assert(rbtree && (arena || arena_size == 0));
+
+    if (!image) {
+        return SNAPSHOT_ARENA_OFFSET + arena_size;
+    }
+
+    assert((size_t) image % RBTREE_SNAPSHOT_ALIGNMENT == 0);
+
+    fields[SNAPSHOT_MAGIC] = SNAPSHOT_MAGIC_NUMBER;
+    fields[SNAPSHOT_NODE_SIZE] = sizeof(RBTreeNode);
+    fields[SNAPSHOT_ALIGNMENT] = RBTREE_SNAPSHOT_ALIGNMENT;
+    fields[SNAPSHOT_SIZE] = rbtree->size;
+    fields[SNAPSHOT_ROOT] = rbtree->root ? (size_t) ((const char*) rbtree->root - arena_begin) + 1 : 0;
+    fields[SNAPSHOT_ARENA_SIZE] = arena_size;
+    memcpy(image, fields, sizeof(fields));
+
+    image_arena = image + SNAPSHOT_ARENA_OFFSET;
+    if (arena_size) {
+        memcpy(image_arena, arena_begin, arena_size);
+    }
+
+    /* Only the links differ from the arena, and they are the same relative to any address of the image. */
+    for (n = rbtree_first(rbtree); n; n = rbtree_next(n)) {
+        assert((const char*) n >= arena_begin && (const char*) (n + 1) <= arena_begin + arena_size);
+
+        write_link(image_arena, arena_begin, parent_link(n), parent_of(n));
+        write_link(image_arena, arena_begin, &n->left_child, n->left_child);
+        write_link(image_arena, arena_begin, &n->right_child, n->right_child);
+    }
+
+    return SNAPSHOT_ARENA_OFFSET + arena_size;
+}
+
+int rbtree_attach(
+    RBTreeImage *image,
+    const void *buffer,
+    size_t buffer_size,
+    int (*compare)(const void *key, const RBTreeNode *node)
+) {
+    const char *snapshot = (const char*) buffer;
+    size_t fields[SNAPSHOT_NUM_FIELDS];
+
+    assert(image && snapshot && compare);
+    assert((size_t) snapshot % RBTREE_SNAPSHOT_ALIGNMENT == 0);
+
+    if (buffer_size < SNAPSHOT_ARENA_OFFSET) {
+        return 0;
+    }
+
+    memcpy(fields, snapshot, sizeof(fields));
+
+    if (
+        fields[SNAPSHOT_MAGIC] != SNAPSHOT_MAGIC_NUMBER ||
+        fields[SNAPSHOT_NODE_SIZE] != sizeof(RBTreeNode) ||
+        fields[SNAPSHOT_ALIGNMENT] != RBTREE_SNAPSHOT_ALIGNMENT ||
+        fields[SNAPSHOT_ARENA_SIZE] > buffer_size - SNAPSHOT_ARENA_OFFSET ||
+        (fields[SNAPSHOT_ROOT] == 0) != (fields[SNAPSHOT_SIZE] == 0) ||
+        (
+            fields[SNAPSHOT_ROOT] != 0 &&
+            (
+                fields[SNAPSHOT_ARENA_SIZE] < sizeof(RBTreeNode) ||
+                fields[SNAPSHOT_ROOT] - 1 > fields[SNAPSHOT_ARENA_SIZE] - sizeof(RBTreeNode)
+            )
+        )
+    ) {
+        return 0;
+    }
+
+    image->arena = snapshot + SNAPSHOT_ARENA_OFFSET;
+    image->root = fields[SNAPSHOT_ROOT] ? (const RBTreeNode*) (image->arena + fields[SNAPSHOT_ROOT] - 1) : NULL;
+    image->size = fields[SNAPSHOT_SIZE];
+    image->compare = compare;
+
+    return 1;
+}
+
+size_t rbtree_image_size(const RBTreeImage *image) {
+    assert(image);
+
+    return image->size;
+}
+
+const RBTreeNode* rbtree_image_lookup_key(const RBTreeImage *image, const void *key) {
+    const RBTreeNode *n;
+
+    assert(image);
+
+    for (n = image->root; n; ) {
+        int cmp = image->compare(key, n);
+
+        if (cmp < 0) {
+            n = read_link(&n->left_child);
+        } else if (cmp > 0) {
+            n = read_link(&n->right_child);
+        } else {
+            break;
+        }
+    }
+
+    return n;
+}
+
+const RBTreeNode* rbtree_image_lower_bound(const RBTreeImage *image, const void *key) {
+    const RBTreeNode *n, *bound = NULL;
+
+    assert(image);
+
+    for (n = image->root; n; ) {
+        if (image->compare(key, n) <= 0) {
+            bound = n;
+            n = read_link(&n->left_child);
+        } else {
+            n = read_link(&n->right_child);
+        }
+    }
+
+    return bound;
+}
+
+const RBTreeNode* rbtree_image_first(const RBTreeImage *image) {
+    const RBTreeNode *n, *left;
+
+    assert(image);
+
+    n = image->root;
+
+    while (n && (left = read_link(&n->left_child))) {
+        n = left;
+    }
+
+    return n;
+}
+
+const RBTreeNode* rbtree_image_next(const RBTreeNode *node) {
+    const RBTreeNode *n;
+
+    if (!node) {
+        return NULL;
+    }
+
+    if ((n = read_link(&node->right_child))) {
+        node = n;
+
+        while ((n = read_link(&node->left_child))) {
+            node = n;
+        }
+
+        return node;
+    }
+
+    while ((n = read_link(parent_link(node))) && node == read_link(&n->right_child)) {
+        node = n;
+    }
+
+    return n;
+}
@@ -37,6 +37,45 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  * @ref RBTree. This data is user-defined. This data, for example, could be a memory pool object that is used
  * for freeing up resources held by the old @ref RBTreeNode in the collide function.
  *
+ * If RBTREE_ORDER_STATISTICS is defined, every @ref RBTreeNode additionally stores the number of
+ * @ref RBTreeNode's in its subtree, which insertions, removals and rotations keep up to date at no extra
+ * asymptotic cost. This makes @ref rbtree_index_of, @ref rbtree_at and @ref rbtree_rank_of_key O(log(n))
+ * instead of O(n), at the price of one size_t per @ref RBTreeNode. RBTREE_ORDER_STATISTICS must be defined
+ * identically for the library and every translation unit using it.
+ *
+ * If RBTREE_COMPACT is defined, the color of a @ref RBTreeNode is stored in the lowest bit of its parent
+ * pointer (which is always clear, since a @ref RBTreeNode is at least pointer-aligned), shrinking a
+ * @ref RBTreeNode from four words to three. This requires size_t to be as wide as a pointer. The parent and
+ * color are then read with @ref rbtree_parent and @ref rbtree_color, which work in either layout. Like
+ * RBTREE_ORDER_STATISTICS, it must be defined identically everywhere.
+ *
+ * Arbitrary per-subtree summaries (e.g. the maximum endpoint of an interval tree, or the sum of the values in
+ * a subtree) can be maintained by installing a @ref RBTreeAugment with @ref rbtree_set_augment. Its three
+ * callbacks are called whenever the shape of the @ref RBTree changes: "propagate" recomputes the summary of a
+ * @ref RBTreeNode and its ancestors, "copy" passes the summary of a @ref RBTreeNode on to the
+ * @ref RBTreeNode taking its place, and "rotate" does the same for a rotation, after which only the old
+ * subtree root needs its summary recomputed from its children. Every update then costs O(log(n)) summary
+ * computations. The summaries live in the user's struct, next to the @ref RBTreeNode, and are NEVER touched by
+ * the @ref RBTree itself.
+ *
+ * If CDSA_STATS is defined (consistently for every translation unit), every @ref RBTree also counts what its
+ * operations cost: how often the compare function was called, how many key collisions, rotations and
+ * recolorings occurred, and the maximum depth at which a @ref RBTreeNode was ever inserted. Many more compare
+ * calls or a greater maximum depth than about log2(n) per operation point at a degenerate access pattern, for
+ * which the hinted or bulk insertions may be better suited. @ref rbtree_stats takes a snapshot of the
+ * counters. Lookups update the counters as well, even though they take a const @ref RBTree, so concurrent
+ * lookups on a @ref RBTree are NOT safe in this mode. Without CDSA_STATS, neither the counters nor the
+ * functions exist, and nothing is counted.
+ *
+ * A @ref RBTree can be written into a snapshot: a position-independent image that another process can map
+ * (e.g. read-only with mmap) and search or traverse in order without inserting anything again. The user keeps
+ * every @ref RBTreeNode in one contiguous arena whose contents are plain data, i.e. contain no pointers of their
+ * own. @ref rbtree_serialize copies the arena into the image and stores every link as an offset from the link
+ * itself, and @ref rbtree_attach checks the header of an image and sets up a read-only @ref RBTreeImage over
+ * it, without copying anything. The colors are NOT kept, since an image is never modified. As with a snapshot
+ * of a HashTable, the image must be read by a build of the same architecture with the same RBTREE_COMPACT and
+ * RBTREE_ORDER_STATISTICS settings, and must come from a trusted source.
+ *
  * Example:
  *          struct Object {
  *              int key;
@@ -67,12 +106,17 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *
  * Dependencies:
  *      -   C89 assert.h
+ *      -   C89 limits.h
  *      -   C89 stddef.h
+ *      -   C89 string.h
  *
  * API:
  *      ====  TYPES  ====
  *      -   typedef struct RBTree RBTree
  *      -   typedef struct RBTreeNode RBTreeNode
+ *      -   typedef struct RBTreeAugment RBTreeAugment
+ *      -   typedef struct RBTreeStats RBTreeStats
+ *      -   typedef struct RBTreeImage RBTreeImage
  *      -   typedef enum RBTreeNodeColor RBTreeNodeColor
  *          -   RBTREE_NODE_RED = 0
  *          -   RBTREE_NODE_BLACK = 1
@@ -80,33 +124,63 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *      ====  FUNCTIONS  ====
  *      Initializers:
  *          -   rbtree_init
+ *          -   rbtree_set_augment
  *      Properties:
  *          -   rbtree_first
  *          -   rbtree_last
  *          -   rbtree_prev
  *          -   rbtree_next
+ *          -   rbtree_postorder_first
+ *          -   rbtree_postorder_next
+ *          -   rbtree_parent
+ *          -   rbtree_color
  *          -   rbtree_size
  *          -   rbtree_empty
  *          -   rbtree_contains_key
+ *          -   rbtree_augment
  *      Array Interfacing:
  *          -   rbtree_index_of
  *          -   rbtree_at
+ *          -   rbtree_rank_of_key
  *      Insertion:
  *          -   rbtree_insert
+ *          -   rbtree_insert_hint
+ *          -   rbtree_insert_last
+ *          -   rbtree_build_sorted
+ *          -   rbtree_build_sorted_sequence
  *      Lookup:
  *          -   rbtree_lookup_key
+ *          -   rbtree_lower_bound
+ *          -   rbtree_upper_bound
  *      Removal:
  *          -   rbtree_remove
  *          -   rbtree_remove_key
  *          -   rbtree_remove_first
  *          -   rbtree_remove_last
+ *          -   rbtree_remove_range
  *          -   rbtree_remove_all
+ *          -   rbtree_destroy
+ *      Splitting and Joining:
+ *          -   rbtree_split
+ *          -   rbtree_join
+ *      Instrumentation:
+ *          -   rbtree_stats
+ *          -   rbtree_reset_stats
+ *      Snapshots:
+ *          -   rbtree_serialize
+ *          -   rbtree_attach
+ *          -   rbtree_image_size
+ *          -   rbtree_image_lookup_key
+ *          -   rbtree_image_lower_bound
+ *          -   rbtree_image_first
+ *          -   rbtree_image_next
  *
  *      ====  MACROS  ====
  *      Constants:
  *          -   RBTREE_POISON_PARENT
  *          -   RBTREE_POISON_LEFT_CHILD
  *          -   RBTREE_POISON_RIGHT_CHILD
+ *          -   RBTREE_SNAPSHOT_ALIGNMENT
  *      Convenient Node Initializer:
  *          -   RBTREE_NODE_INIT
  *      Properties:
@@ -124,6 +198,9 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *          -   rbtree_for_each_from_reverse
  *          -   rbtree_for_each_safe_from
  *          -   rbtree_for_each_safe_from_reverse
+ *          -   rbtree_for_each_in_range
+ *          -   rbtree_for_each_postorder
+ *          -   rbtree_for_each_postorder_safe
  */
 
 #ifndef RBTREE_H
@@ -135,6 +212,14 @@ extern "C" {
 
 #include <stddef.h>
 
+/**
+ * The alignment of the buffer of a snapshot, and of the copy of the arena inside it, which must be at least
+ * the alignment of the structs in the arena. Can be overridden by defining it before including this header.
+ */
+#ifndef RBTREE_SNAPSHOT_ALIGNMENT
+    #define RBTREE_SNAPSHOT_ALIGNMENT 16
+#endif
+
 /* ========================================================================================================
  *
  *                                                  TYPES
@@ -144,20 +229,44 @@ extern "C" {
 /* Struct type declarations. */
 struct RBTree;
 struct RBTreeNode;
+struct RBTreeAugment;
+struct RBTreeStats;
+struct RBTreeImage;
 
 /* Struct typedef's. */
 typedef struct RBTree RBTree;
 typedef struct RBTreeNode RBTreeNode;
+typedef struct RBTreeAugment RBTreeAugment;
+typedef struct RBTreeStats RBTreeStats;
+typedef struct RBTreeImage RBTreeImage;
 
 /**
- * Represents a red-black tree.
+ * Represents the counters of a @ref RBTree. The depth of the root is 0.
+ */
+struct RBTreeStats {
+    size_t num_compare_calls;
+    size_t num_collisions;
+    size_t num_rotations;
+    size_t num_recolorings;
+    size_t max_depth;
+};
+
+/**
+ * Represents a red-black tree. The first and the last inorder @ref RBTreeNode are cached, so that both ends of
+ * the @ref RBTree can be reached without a descent.
  */
 struct RBTree {
     int (*compare)(const void *key, const RBTreeNode *node);
     void (*collide)(const RBTreeNode *old_node, const RBTreeNode *new_node, void *auxiliary_data);
     void *auxiliary_data;
     RBTreeNode *root;
+    RBTreeNode *first;
+    RBTreeNode *last;
     size_t size;
+    const RBTreeAugment *augment;
+    #ifdef CDSA_STATS
+    RBTreeStats stats;
+    #endif /* CDSA_STATS */
 };
 
 /**
@@ -169,13 +278,56 @@ typedef enum RBTreeNodeColor {
 } RBTreeNodeColor;
 
 /**
- * Represents a node in a @ref RBTree. Embed this into your structure to make it a node.
+ * Represents a node in a @ref RBTree. Embed this into your structure to make it a node. If RBTREE_COMPACT is
+ * defined, the color is stored in the lowest bit of the parent pointer, so use @ref rbtree_parent and
+ * @ref rbtree_color instead of accessing the members directly.
  */
 struct RBTreeNode {
+    #ifdef RBTREE_COMPACT
+    size_t parent_color;
+    #else
     RBTreeNode *parent;
+    #endif /* RBTREE_COMPACT */
     RBTreeNode *left_child;
     RBTreeNode *right_child;
+    #ifndef RBTREE_COMPACT
     RBTreeNodeColor color;
+    #endif /* RBTREE_COMPACT */
+    #ifdef RBTREE_ORDER_STATISTICS
+    size_t count;
+    #endif /* RBTREE_ORDER_STATISTICS */
+};
+
+/**
+ * Represents the callbacks maintaining a user-defined summary of every subtree of a @ref RBTree. All three
+ * callbacks are required.
+ *
+ * propagate:   Recomputes the summary of the @ref node from its own key/value and the summaries of its
+ *              children, then does the same for each ancestor of the @ref node, stopping before @ref stop (or
+ *              after the root if @ref stop == NULL). It must NOT stop early when a summary does not change,
+ *              since the summaries of the ancestors may be out of date.
+ * copy:        Gives the @ref new_node the summary of the @ref old_node. The @ref new_node has taken the place
+ *              of the @ref old_node in the @ref RBTree.
+ * rotate:      Gives the @ref new_node the summary of the @ref old_node, then recomputes the summary of the
+ *              @ref old_node from its own key/value and the summaries of its children. The @ref new_node was a
+ *              child of the @ref old_node and has been rotated into its place, so it now roots the subtree
+ *              the @ref old_node used to root.
+ */
+struct RBTreeAugment {
+    void (*propagate)(RBTreeNode *node, RBTreeNode *stop);
+    void (*copy)(RBTreeNode *old_node, RBTreeNode *new_node);
+    void (*rotate)(RBTreeNode *old_node, RBTreeNode *new_node);
+};
+
+/**
+ * Represents a read-only view of a @ref RBTree in a snapshot, set up by @ref rbtree_attach. The "root" member
+ * points into the copy of the arena, which the "arena" member points to.
+ */
+struct RBTreeImage {
+    const char *arena;
+    const RBTreeNode *root;
+    size_t size;
+    int (*compare)(const void *key, const RBTreeNode *node);
 };
 
 /* ========================================================================================================
@@ -212,6 +364,24 @@ void rbtree_init(
     void *auxiliary_data
 );
 
+/**
+ * Installs the @ref augment callbacks, which maintain a user-defined summary of every subtree of the
+ * @ref rbtree from then on. NULL uninstalls them. @ref rbtree_init uninstalls them as well.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref rbtree is empty
+ *      -   @ref augment == NULL, or all its callbacks are non-NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param rbtree                The @ref RBTree to be operated on.
+ * @param augment               The OPTIONAL (i.e. can be NULL) callbacks, which must outlive their use by the
+ *                              @ref rbtree. They are NEVER copied by the @ref rbtree.
+ */
+void rbtree_set_augment(RBTree *rbtree, const RBTreeAugment *augment);
+
 /**
  * Returns the first inorder @ref RBTreeNode of the @ref rbtree.
  *
@@ -219,7 +389,7 @@ void rbtree_init(
  *      -   @ref rbtree != NULL
  *
  * Time complexity:
- *      -   O(log(n))
+ *      -   O(1)
  *
  * @param rbtree                The @ref RBTree whose first inorder @ref RBTreeNode will be returned.
  * @return                      The first inorder @ref RBTreeNode of the @ref rbtree.
@@ -233,7 +403,7 @@ RBTreeNode* rbtree_first(const RBTree *rbtree);
  *      -   @ref rbtree != NULL
  *
  * Time complexity:
- *      -   O(log(n))
+ *      -   O(1)
  *
  * @param rbtree                The @ref RBTree whose last inorder @ref RBTreeNode will be returned.
  * @return                      The last inorder @ref RBTreeNode of the @ref rbtree.
@@ -269,6 +439,65 @@ RBTreeNode* rbtree_prev(const RBTreeNode *node);
  */
 RBTreeNode* rbtree_next(const RBTreeNode *node);
 
+/**
+ * Returns the first postorder @ref RBTreeNode of the @ref rbtree (i.e. the first @ref RBTreeNode visited when
+ * every @ref RBTreeNode is visited after its children).
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param rbtree                The @ref RBTree whose first postorder @ref RBTreeNode will be returned.
+ * @return                      The first postorder @ref RBTreeNode of the @ref rbtree.
+ */
+RBTreeNode* rbtree_postorder_first(const RBTree *rbtree);
+
+/**
+ * Returns the @ref RBTreeNode after the @ref node in postorder. NULL if @ref node == NULL. Only the @ref node
+ * and its ancestors are read, so the children of the @ref node may already have been freed.
+ *
+ * Requirements:
+ *      -   None
+ *
+ * Time complexity:
+ *      -   On average:     O(1)
+ *      -   Worst case:     O(log(n))
+ *
+ * @param node                  The @ref RBTreeNode whose postorder successor will be returned.
+ * @return                      NULL if @ref node == NULL; otherwise, the postorder successor of the @ref node.
+ */
+RBTreeNode* rbtree_postorder_next(const RBTreeNode *node);
+
+/**
+ * Returns the parent of the @ref node. NULL if the @ref node is the root.
+ *
+ * Requirements:
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param node                  The @ref RBTreeNode whose parent will be returned.
+ * @return                      The parent of the @ref node.
+ */
+RBTreeNode* rbtree_parent(const RBTreeNode *node);
+
+/**
+ * Returns the color of the @ref node.
+ *
+ * Requirements:
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param node                  The @ref RBTreeNode whose color will be returned.
+ * @return                      The color of the @ref node.
+ */
+RBTreeNodeColor rbtree_color(const RBTreeNode *node);
+
 /**
  * Returns the size of the @ref rbtree.
  *
@@ -314,6 +543,20 @@ int rbtree_empty(const RBTree *rbtree);
  */
 int rbtree_contains_key(const RBTree *rbtree, const void *key);
 
+/**
+ * Returns the augment callbacks of the @ref rbtree, or NULL if none are installed.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param rbtree                The @ref RBTree whose "augment" member will be returned.
+ * @return                      @ref rbtree->augment.
+ */
+const RBTreeAugment* rbtree_augment(const RBTree *rbtree);
+
 /**
  * Retrieves the (inorder) index of the @ref node in the @ref rbtree.
  *
@@ -322,7 +565,9 @@ int rbtree_contains_key(const RBTree *rbtree, const void *key);
  *      -   @ref node != NULL
  *
  * Time complexity:
- *      -   If first/last:
+ *      -   If RBTREE_ORDER_STATISTICS is defined:
+ *          -   O(log(n))
+ *      -   Else if first/last:
  *          -   O(1)
  *      -   Else:
  *          -   On average:     O(n/2)
@@ -342,8 +587,10 @@ size_t rbtree_index_of(const RBTree *rbtree, const RBTreeNode *node);
  *      -   @ref index < @ref rbtree->size
  *
  * Time complexity:
- *      -   If first/last:
- *          -   O(1)
+ *      -   If RBTREE_ORDER_STATISTICS is defined:
+ *          -   O(log(n))
+ *      -   Else if first/last:
+ *          -   O(log(n))
  *      -   Else:
  *          -   On average:     O(n/4)
  *          -   Worst case:     O(n/2)
@@ -354,6 +601,28 @@ size_t rbtree_index_of(const RBTree *rbtree, const RBTreeNode *node);
  */
 RBTreeNode* rbtree_at(const RBTree *rbtree, size_t index);
 
+/**
+ * Returns the number of @ref RBTreeNode's in the @ref rbtree whose key is less than the @ref key. If the
+ * @ref key exists in the @ref rbtree, this is the (inorder) index of its @ref RBTreeNode; otherwise, it is the
+ * index the @ref key would have if it were inserted.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *
+ * Time complexity:
+ *      -   If RBTREE_ORDER_STATISTICS is defined:
+ *          -   O(log(n))
+ *      -   Else:
+ *          -   On average:     O(n/2)
+ *          -   Worst case:     O(n)
+ *
+ * @param rbtree                The @ref RBTree containing nodes.
+ * @param key                   The key whose rank is wanted. It does NOT need to exist in the @ref rbtree.
+ * @return                      The number of @ref RBTreeNode's in the @ref rbtree whose key is less than the
+ *                              @ref key.
+ */
+size_t rbtree_rank_of_key(const RBTree *rbtree, const void *key);
+
 /**
  * Inserts the @ref node with associated @ref key into the @ref rbtree. If a @ref RBTreeNode already exists
  * with the same @ref key, the already existing @ref RBTreeNode will be replaced by the new @ref RBTreeNode,
@@ -372,6 +641,116 @@ RBTreeNode* rbtree_at(const RBTree *rbtree, size_t index);
  */
 void rbtree_insert(RBTree *rbtree, const void *key, RBTreeNode *node);
 
+/**
+ * Inserts the @ref node with associated @ref key into the @ref rbtree, expecting it to belong right next to
+ * the @ref hint (i.e. the @ref hint is expected to be its inorder predecessor or successor, or the
+ * @ref RBTreeNode with the same @ref key). If @ref hint == NULL, the @ref node is expected to belong after the
+ * last @ref RBTreeNode. If the @ref hint is right, the @ref node is linked in without searching, using at
+ * most two comparisons; otherwise, this behaves exactly like @ref rbtree_insert. Key collisions are handled
+ * like in @ref rbtree_insert.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref node != NULL
+ *      -   @ref hint belongs to the @ref rbtree, or @ref hint == NULL
+ *
+ * Time complexity:
+ *      -   If the @ref hint is right and is NULL, the first or the last @ref RBTreeNode, and neither
+ *          RBTREE_ORDER_STATISTICS nor CDSA_STATS is defined and no augment callbacks are installed:
+ *          -   Amortized:      O(1)
+ *      -   Else:
+ *          -   O(log(n))
+ *
+ * @param rbtree                The @ref RBTree to be operated on.
+ * @param key                   The key associated with the @ref node.
+ * @param node                  The @ref RBTreeNode to be inserted.
+ * @param hint                  The OPTIONAL (i.e. can be NULL) @ref RBTreeNode expected to be next to the
+ *                              @ref node.
+ */
+void rbtree_insert_hint(RBTree *rbtree, const void *key, RBTreeNode *node, RBTreeNode *hint);
+
+/**
+ * Inserts the @ref node with associated @ref key into the @ref rbtree, expecting the @ref key to be greater
+ * than every key of the @ref rbtree (e.g. when inserting increasing timestamps). Equivalent to calling
+ * @ref rbtree_insert_hint with a NULL hint: the cached last @ref RBTreeNode is the parent of the @ref node, so
+ * only one comparison is made and no descent is needed if the expectation holds.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   If the @ref key is the greatest and neither RBTREE_ORDER_STATISTICS nor CDSA_STATS is defined and
+ *          no augment callbacks are installed:
+ *          -   Amortized:      O(1)
+ *      -   Else:
+ *          -   O(log(n))
+ *
+ * @param rbtree                The @ref RBTree to be operated on.
+ * @param key                   The key associated with the @ref node.
+ * @param node                  The @ref RBTreeNode to be inserted.
+ */
+void rbtree_insert_last(RBTree *rbtree, const void *key, RBTreeNode *node);
+
+/**
+ * Links the @ref num_nodes @ref RBTreeNode's of the @ref nodes array, which must already be in strictly
+ * ascending key order, into a balanced and validly colored @ref rbtree. The compare function is NEVER called,
+ * so this is much faster than inserting the @ref RBTreeNode's one by one. Subtree counts (if
+ * RBTREE_ORDER_STATISTICS is defined) and augmented summaries (if augment callbacks are installed) are
+ * computed as well.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref rbtree is empty
+ *      -   @ref nodes != NULL, or @ref num_nodes == 0
+ *      -   The keys of the @ref nodes are unique and in ascending order
+ *
+ * Time complexity:
+ *      -   O(n), where n == @ref num_nodes
+ *
+ * @param rbtree                The @ref RBTree to be operated on.
+ * @param nodes                 The array of @ref RBTreeNode's to be linked into the @ref rbtree. The array
+ *                              itself is NOT referenced after this function returns.
+ * @param num_nodes             The number of @ref RBTreeNode's in the @ref nodes array.
+ */
+void rbtree_build_sorted(RBTree *rbtree, RBTreeNode **nodes, size_t num_nodes);
+
+/**
+ * Like @ref rbtree_build_sorted, but obtains the @ref num_nodes @ref RBTreeNode's one at a time, in ascending
+ * key order, from the @ref next callback. This allows building from a sorted sequence that is not an array,
+ * for example a sorted @ref List, without allocating an array first:
+ *
+ *          RBTreeNode* next(void *context) {
+ *              ListNode **cursor = (ListNode**) context;
+ *              struct Object *obj = list_entry(*cursor, struct Object, list_node);
+ *
+ *              *cursor = (*cursor)->next;
+ *
+ *              return &obj->rbtree_node;
+ *          }
+ *
+ *          ListNode *cursor = list_front(&list);
+ *          rbtree_build_sorted_sequence(&rbtree, list_size(&list), next, &cursor);
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref rbtree is empty
+ *      -   @ref next != NULL, or @ref num_nodes == 0
+ *      -   The @ref next callback returns @ref num_nodes distinct non-NULL @ref RBTreeNode's whose keys are
+ *          unique and in ascending order
+ *
+ * Time complexity:
+ *      -   O(n), where n == @ref num_nodes
+ *
+ * @param rbtree                The @ref RBTree to be operated on.
+ * @param num_nodes             The number of @ref RBTreeNode's to be linked into the @ref rbtree.
+ * @param next                  The callback function returning the next @ref RBTreeNode in ascending key
+ *                              order. It is called exactly @ref num_nodes times.
+ * @param context               The user-defined data passed to the @ref next callback function. This data is
+ *                              NEVER manipulated by the @ref rbtree.
+ */
+void rbtree_build_sorted_sequence(RBTree *rbtree, size_t num_nodes, RBTreeNode* (*next)(void *context), void *context);
+
 /**
  * Returns the @ref RBTreeNode associated with the @ref key in the @ref rbtree. NULL if a match for the @ref
  * key is not found.
@@ -389,6 +768,40 @@ void rbtree_insert(RBTree *rbtree, const void *key, RBTreeNode *node);
  */
 RBTreeNode* rbtree_lookup_key(const RBTree *rbtree, const void *key);
 
+/**
+ * Returns the first inorder @ref RBTreeNode in the @ref rbtree whose key is NOT less than the @ref key. NULL if
+ * there is no such @ref RBTreeNode.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param rbtree                The @ref RBTree containing nodes.
+ * @param key                   The key used for lookup. It does NOT need to exist in the @ref rbtree.
+ * @return                      NULL if every key in the @ref rbtree is less than the @ref key; otherwise, the
+ *                              first @ref RBTreeNode whose key is greater than or equal to the @ref key.
+ */
+RBTreeNode* rbtree_lower_bound(const RBTree *rbtree, const void *key);
+
+/**
+ * Returns the first inorder @ref RBTreeNode in the @ref rbtree whose key is greater than the @ref key. NULL if
+ * there is no such @ref RBTreeNode.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param rbtree                The @ref RBTree containing nodes.
+ * @param key                   The key used for lookup. It does NOT need to exist in the @ref rbtree.
+ * @return                      NULL if no key in the @ref rbtree is greater than the @ref key; otherwise, the
+ *                              first @ref RBTreeNode whose key is greater than the @ref key.
+ */
+RBTreeNode* rbtree_upper_bound(const RBTree *rbtree, const void *key);
+
 /**
  * Removes the @ref node from the @ref rbtree. If @ref node == NULL, this function simply returns.
  *
@@ -446,6 +859,23 @@ void rbtree_remove_first(RBTree *rbtree);
  */
 void rbtree_remove_last(RBTree *rbtree);
 
+/**
+ * Removes every @ref RBTreeNode whose key lies in the closed range [@ref low_key, @ref high_key] from the
+ * @ref rbtree. If the range is empty (including when @ref high_key is less than @ref low_key), this function
+ * simply returns.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *
+ * Time complexity:
+ *      -   O((k + 1) * log(n)), where k == number of removed @ref RBTreeNode's
+ *
+ * @param rbtree                The @ref RBTree to be operated on.
+ * @param low_key               The lowest key to be removed. It does NOT need to exist in the @ref rbtree.
+ * @param high_key              The highest key to be removed. It does NOT need to exist in the @ref rbtree.
+ */
+void rbtree_remove_range(RBTree *rbtree, const void *low_key, const void *high_key);
+
 /**
  * Removes all the @ref RBTreeNode's from the @ref rbtree. If the @ref rbtree is empty, this function simply
  * returns.
@@ -460,6 +890,235 @@ void rbtree_remove_last(RBTree *rbtree);
  */
 void rbtree_remove_all(RBTree *rbtree);
 
+/**
+ * Removes all the @ref RBTreeNode's from the @ref rbtree, calling @ref destroy on each of them exactly once in
+ * postorder (children before parents), without rebalancing. @ref destroy may free or reuse the
+ * @ref RBTreeNode it receives, which is NOT accessed by the @ref rbtree afterwards. Unlike
+ * @ref rbtree_remove_all, no @ref RBTreeNode is poisoned.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref destroy != NULL
+ *
+ * Time complexity:
+ *      -   O(n)
+ *
+ * @param rbtree                The @ref RBTree to be operated on.
+ * @param destroy               The callback function called on every @ref RBTreeNode.
+ * @param auxiliary_data        The auxiliary data passed to the @ref destroy callback function. This data is
+ *                              NEVER manipulated by the @ref rbtree.
+ */
+void rbtree_destroy(RBTree *rbtree, void (*destroy)(RBTreeNode *node, void *auxiliary_data), void *auxiliary_data);
+
+/**
+ * Moves every @ref RBTreeNode of the @ref rbtree whose key is less than the @ref key into @ref left, and every
+ * other @ref RBTreeNode into @ref right, leaving the @ref rbtree empty. Both @ref left and @ref right are
+ * overwritten (i.e. anything they held is discarded) with the callbacks, auxiliary data and augment of the
+ * @ref rbtree, and either of them may be the @ref rbtree itself. No @ref RBTreeNode is copied or reallocated;
+ * the halves are assembled out of whole subtrees joined by their black heights. If CDSA_STATS is defined,
+ * @ref left takes over the counters of the @ref rbtree, including those of the split itself, and the counters
+ * of @ref right (and of the @ref rbtree, unless it is @ref left) are reset.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref left != NULL
+ *      -   @ref right != NULL
+ *      -   @ref left != @ref right
+ *
+ * Time complexity:
+ *      -   If RBTREE_ORDER_STATISTICS is defined:
+ *          -   O(log(n))
+ *      -   Else:
+ *          -   O(log(n) + min(k, n - k)), where k == number of @ref RBTreeNode's moved into @ref left, since
+ *              the sizes of the halves have to be counted
+ *
+ * @param rbtree                The @ref RBTree to be split.
+ * @param key                   The key to split at. It does NOT need to exist in the @ref rbtree.
+ * @param left                  The @ref RBTree receiving the @ref RBTreeNode's whose keys are less than the
+ *                              @ref key.
+ * @param right                 The @ref RBTree receiving the @ref RBTreeNode's whose keys are NOT less than
+ *                              the @ref key.
+ */
+void rbtree_split(RBTree *rbtree, const void *key, RBTree *left, RBTree *right);
+
+/**
+ * Moves every @ref RBTreeNode of the @ref src_rbtree into the @ref rbtree, leaving the @ref src_rbtree empty.
+ * Every key in the @ref src_rbtree must be greater than every key in the @ref rbtree, which is NOT checked.
+ * No @ref RBTreeNode is copied or reallocated; the trees are joined by their black heights.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref src_rbtree != NULL
+ *      -   @ref rbtree != @ref src_rbtree
+ *      -   Both have the same augment
+ *      -   Every key in @ref src_rbtree is greater than every key in @ref rbtree
+ *
+ * Time complexity:
+ *      -   O(log(n + m)), where m == number of @ref RBTreeNode's in @ref src_rbtree
+ *
+ * @param rbtree                The @ref RBTree receiving the @ref RBTreeNode's after its own.
+ * @param src_rbtree            The @ref RBTree whose @ref RBTreeNode's will be moved.
+ */
+void rbtree_join(RBTree *rbtree, RBTree *src_rbtree);
+
+#ifdef CDSA_STATS
+
+/**
+ * Copies the counters of the @ref rbtree into the @ref stats.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   @ref stats != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param rbtree                The @ref RBTree whose counters will be copied.
+ * @param stats                 The @ref RBTreeStats to copy the counters into.
+ */
+void rbtree_stats(const RBTree *rbtree, RBTreeStats *stats);
+
+/**
+ * Resets all counters of the @ref rbtree to 0. @ref rbtree_init does this as well.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param rbtree                The @ref RBTree whose counters will be reset.
+ */
+void rbtree_reset_stats(RBTree *rbtree);
+
+#endif /* CDSA_STATS */
+
+/**
+ * Writes a snapshot of the @ref rbtree into the @ref buffer, and returns its size in bytes. If
+ * @ref buffer == NULL, this function simply returns the size the snapshot needs. The @ref rbtree and the arena
+ * are NOT modified.
+ *
+ * Requirements:
+ *      -   @ref rbtree != NULL
+ *      -   Every @ref RBTreeNode in the @ref rbtree lies within the arena
+ *      -   @ref buffer is aligned to @ref RBTREE_SNAPSHOT_ALIGNMENT, and does NOT overlap the arena
+ *
+ * Time complexity:
+ *      -   O(n + a), where a == @ref arena_size
+ *
+ * @param rbtree                The @ref RBTree to be written.
+ * @param arena                 The start of the memory holding every @ref RBTreeNode of the @ref rbtree (and
+ *                              the structs they are embedded in).
+ * @param arena_size            The size of the arena in bytes.
+ * @param buffer                The OPTIONAL (i.e. can be NULL) memory the snapshot is written into, which
+ *                              must be at least as large as the returned size.
+ * @return                      The size of the snapshot in bytes.
+ */
+size_t rbtree_serialize(const RBTree *rbtree, const void *arena, size_t arena_size, void *buffer);
+
+/**
+ * Checks that the @ref buffer holds a complete snapshot written by @ref rbtree_serialize, and if so, sets up
+ * the @ref image to read it in place. The @ref buffer is NEVER modified, and must outlive the @ref image.
+ *
+ * Requirements:
+ *      -   @ref image != NULL
+ *      -   @ref buffer != NULL
+ *      -   @ref buffer is aligned to @ref RBTREE_SNAPSHOT_ALIGNMENT
+ *      -   @ref compare != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param image                 The @ref RBTreeImage to be set up.
+ * @param buffer                The memory holding the snapshot (e.g. a mapped file).
+ * @param buffer_size           The size of the @ref buffer in bytes.
+ * @param compare               The callback function used to compare a key with the key of a @ref RBTreeNode
+ *                              inside the image, ordering keys the same way the @ref RBTree did.
+ * @return                      Whether or not the @ref buffer holds a valid snapshot (the @ref image is left
+ *                              untouched if not).
+ */
+int rbtree_attach(
+    RBTreeImage *image,
+    const void *buffer,
+    size_t buffer_size,
+    int (*compare)(const void *key, const RBTreeNode *node)
+);
+
+/**
+ * Returns the number of @ref RBTreeNode's in the @ref image.
+ *
+ * Requirements:
+ *      -   @ref image != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param image                 The @ref RBTreeImage to be operated on.
+ * @return                      The number of @ref RBTreeNode's in the @ref image.
+ */
+size_t rbtree_image_size(const RBTreeImage *image);
+
+/**
+ * Returns the @ref RBTreeNode associated with the @ref key in the @ref image. NULL if a match for the
+ * @ref key is not found. Any number of threads (and processes sharing the snapshot) may call this function
+ * concurrently.
+ *
+ * Requirements:
+ *      -   @ref image != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param image                 The @ref RBTreeImage to be searched.
+ * @param key                   The key used for lookup.
+ * @return                      NULL if a match for the @ref key is not found; otherwise, the @ref RBTreeNode
+ *                              inside the @ref image associated with the @ref key.
+ */
+const RBTreeNode* rbtree_image_lookup_key(const RBTreeImage *image, const void *key);
+
+/**
+ * Returns the first inorder @ref RBTreeNode in the @ref image whose key is NOT less than the @ref key. NULL if
+ * there is no such @ref RBTreeNode.
+ *
+ * Requirements:
+ *      -   @ref image != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param image                 The @ref RBTreeImage to be searched.
+ * @param key                   The key used for lookup.
+ * @return                      The first inorder @ref RBTreeNode inside the @ref image whose key is NOT less
+ *                              than the @ref key, or NULL.
+ */
+const RBTreeNode* rbtree_image_lower_bound(const RBTreeImage *image, const void *key);
+
+/**
+ * Returns the first inorder @ref RBTreeNode in the @ref image. NULL if the @ref image is empty.
+ *
+ * Requirements:
+ *      -   @ref image != NULL
+ *
+ * Time complexity:
+ *      -   O(log(n))
+ *
+ * @param image                 The @ref RBTreeImage to be operated on.
+ * @return                      The first inorder @ref RBTreeNode inside the @ref image, or NULL.
+ */
+const RBTreeNode* rbtree_image_first(const RBTreeImage *image);
+
+/**
+ * Returns the inorder successor of the @ref node, which must lie inside a @ref RBTreeImage. NULL if the
+ * @ref node is the last one or is NULL.
+ *
+ * Time complexity:
+ *      -   O(log(n)) worst case, O(1) amortized over a full traversal
+ *
+ * @param node                  The @ref RBTreeNode inside a @ref RBTreeImage to be operated on.
+ * @return                      The inorder successor of the @ref node, or NULL.
+ */
+const RBTreeNode* rbtree_image_next(const RBTreeNode *node);
+
 /* ========================================================================================================
  *
  *                                                 MACROS
@@ -491,7 +1150,15 @@ void rbtree_remove_all(RBTree *rbtree);
  * Initializing a @ref RBTreeNode before it is used is NOT required. This macro is simply for allowing you to
  * initialize a struct (containing one or more @ref RBTreeNode's) with an initializer-list conveniently.
  */
-#define RBTREE_NODE_INIT { RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, RBTREE_NODE_RED }
+#if defined(RBTREE_COMPACT) && defined(RBTREE_ORDER_STATISTICS)
+    #define RBTREE_NODE_INIT { 0x100, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, 0 }
+#elif defined(RBTREE_COMPACT)
+    #define RBTREE_NODE_INIT { 0x100, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD }
+#elif defined(RBTREE_ORDER_STATISTICS)
+    #define RBTREE_NODE_INIT { RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, RBTREE_NODE_RED, 0 }
+#else
+    #define RBTREE_NODE_INIT { RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, RBTREE_NODE_RED }
+#endif
 
 /**
  * Obtains the pointer to the struct for this entry.
@@ -756,6 +1423,74 @@ void rbtree_remove_all(RBTree *rbtree);
         backup_node_ptr = rbtree_prev(cursor_node_ptr) \
     )
 
+/**
+ * Iterates over the @ref RBTree (inorder) over every @ref RBTreeNode whose key lies in the closed range
+ * [@ref low_key_ptr, @ref high_key_ptr], using the compare function of the @ref RBTree. Finding the first
+ * @ref RBTreeNode takes O(log(n)); every further step takes O(1) on average.
+ *
+ * Requirements:
+ *      -   @ref rbtree_ptr != NULL
+ *      -   The @ref cursor_node_ptr is neither reassigned nor removed from its associated @ref RBTree in the
+ *          loop's body.
+ *
+ * @param cursor_node_ptr       The @ref RBTreeNode to use as a loop cursor.
+ * @param low_key_ptr           The pointer to the lowest key to be visited.
+ * @param high_key_ptr          The pointer to the highest key to be visited.
+ * @param rbtree_ptr            The pointer to a @ref RBTree that will be iterated over.
+ */
+#define rbtree_for_each_in_range(cursor_node_ptr, low_key_ptr, high_key_ptr, rbtree_ptr) \
+    for ( \
+        cursor_node_ptr = rbtree_lower_bound((rbtree_ptr), (low_key_ptr)); \
+        cursor_node_ptr && (rbtree_ptr)->compare((high_key_ptr), cursor_node_ptr) >= 0; \
+        cursor_node_ptr = rbtree_next(cursor_node_ptr) \
+    )
+
+/**
+ * Iterates over the @ref RBTree in postorder, visiting every @ref RBTreeNode after its children.
+ *
+ * Requirements:
+ *      -   @ref rbtree_ptr != NULL
+ *      -   The @ref cursor_node_ptr is neither reassigned nor removed from its associated @ref RBTree in the
+ *          loop's body.
+ *
+ * @param cursor_node_ptr       The @ref RBTreeNode to use as a loop cursor.
+ * @param rbtree_ptr            The pointer to a @ref RBTree that will be iterated over.
+ */
+#define rbtree_for_each_postorder(cursor_node_ptr, rbtree_ptr) \
+    for ( \
+        cursor_node_ptr = rbtree_postorder_first(rbtree_ptr); \
+        cursor_node_ptr; \
+        cursor_node_ptr = rbtree_postorder_next(cursor_node_ptr) \
+    )
+
+/**
+ * Iterates over the @ref RBTree in postorder, visiting every @ref RBTreeNode after its children, and is safe
+ * against reassignment and/or freeing of the @ref cursor_node_ptr. This is meant for tearing down the
+ * @ref RBTree in O(n): the @ref RBTreeNode's are NOT removed from the @ref RBTree (so it must be reinitialized
+ * or @ref rbtree_remove_all'd afterwards), but every visited @ref RBTreeNode can be freed, since it is never
+ * accessed again.
+ *
+ * Requirements:
+ *      -   @ref rbtree_ptr != NULL
+ *      -   No @ref RBTreeNode is inserted into or removed from the @ref RBTree in the loop's body.
+ *      -   @ref backup_node_ptr is not reassigned in the loop's body.
+ *      -   @ref backup_node_ptr and @ref cursor_node_ptr are not the same variable.
+ *
+ * @param cursor_node_ptr       The @ref RBTreeNode to use as a loop cursor.
+ * @param backup_node_ptr       Another @ref RBTreeNode to use as temporary storage.
+ * @param rbtree_ptr            The pointer to a @ref RBTree that will be iterated over.
+ */
+#define rbtree_for_each_postorder_safe(cursor_node_ptr, backup_node_ptr, rbtree_ptr) \
+    for ( \
+        cursor_node_ptr = rbtree_postorder_first(rbtree_ptr), \
+        backup_node_ptr = rbtree_postorder_next(cursor_node_ptr); \
+        \
+        cursor_node_ptr; \
+        \
+        cursor_node_ptr = backup_node_ptr, \
+        backup_node_ptr = rbtree_postorder_next(cursor_node_ptr) \
+    )
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
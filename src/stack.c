@@ -25,6 +25,7 @@ void stack_init(Stack *stack) {
     assert(stack);
 
     stack->tail = NULL;
+    stack->head = NULL;
     stack->size = 0;
 }
 
@@ -49,12 +50,37 @@ int stack_empty(const Stack *stack) {
 void stack_push(Stack *stack, StackNode *node) {
     assert(stack && node);
 
+    if (!stack->tail) {
+        stack->head = node;
+    }
+
     node->prev = stack->tail;
     stack->tail = node;
 
     ++stack->size;
 }
 
+void stack_splice(Stack *stack, Stack *src_stack) {
+    assert(stack && src_stack && stack != src_stack);
+
+    if (!src_stack->tail) {
+        return;
+    }
+
+    src_stack->head->prev = stack->tail;
+
+    if (!stack->tail) {
+        stack->head = src_stack->head;
+    }
+
+    stack->tail = src_stack->tail;
+    stack->size += src_stack->size;
+
+    src_stack->tail = NULL;
+    src_stack->head = NULL;
+    src_stack->size = 0;
+}
+
 StackNode* stack_pop(Stack *stack) {
     StackNode *n;
 
@@ -68,6 +94,10 @@ StackNode* stack_pop(Stack *stack) {
 
     stack->tail = n->prev;
 
+    if (!stack->tail) {
+        stack->head = NULL;
+    }
+
     n->prev = STACK_POISON_PREV;
 
     --stack->size;
@@ -75,6 +105,39 @@ StackNode* stack_pop(Stack *stack) {
     return n;
 }
 
+StackNode* stack_pop_n(Stack *stack, size_t n) {
+    StackNode *top, *bottom;
+    size_t i;
+
+    assert(stack);
+
+    top = stack->tail;
+
+    if (!top || n == 0) {
+        return NULL;
+    }
+
+    /* Taking everything needs no walk, since the bottom is known. */
+    if (n >= stack->size) {
+        stack->tail = NULL;
+        stack->head = NULL;
+        stack->size = 0;
+
+        return top;
+    }
+
+    for (i = 1, bottom = top; i < n; ++i) {
+        bottom = bottom->prev;
+    }
+
+    stack->tail = bottom->prev;
+    bottom->prev = NULL;
+
+    stack->size -= n;
+
+    return top;
+}
+
 void stack_remove_all(Stack *stack) {
     assert(stack);
 
@@ -83,5 +146,97 @@ void stack_remove_all(Stack *stack) {
     }
 
     stack->tail = NULL;
+    stack->head = NULL;
     stack->size = 0;
 }
+
+#ifdef STACK_ATOMICS
+
+void concurrentstack_init(ConcurrentStack *concurrentstack) {
+    assert(concurrentstack);
+
+    concurrentstack->tail = NULL;
+    concurrentstack->tag = 0;
+}
+
+void concurrentstack_push(ConcurrentStack *concurrentstack, StackNode *node) {
+    ConcurrentStack expected, desired;
+
+    assert(concurrentstack && node);
+
+    __atomic_load(concurrentstack, &expected, __ATOMIC_RELAXED);
+    desired.tail = node;
+
+    do {
+        /* A pop that read this node during an earlier push of it may still load the "prev" member. */
+        __atomic_store_n(&node->prev, expected.tail, __ATOMIC_RELAXED);
+        desired.tag = expected.tag + 1;
+    } while (!__atomic_compare_exchange(
+        concurrentstack,
+        &expected,
+        &desired,
+        1,
+        __ATOMIC_RELEASE,
+        __ATOMIC_RELAXED
+    ));
+}
+
+StackNode* concurrentstack_pop(ConcurrentStack *concurrentstack) {
+    ConcurrentStack expected, desired;
+
+    assert(concurrentstack);
+
+    __atomic_load(concurrentstack, &expected, __ATOMIC_ACQUIRE);
+
+    do {
+        if (!expected.tail) {
+            return NULL;
+        }
+
+        /*
+         * If the tail is popped and pushed again before the CAS, the "prev" member read here is stale, but the
+         * tag has changed, so the CAS fails.
+         */
+        desired.tail = __atomic_load_n(&expected.tail->prev, __ATOMIC_RELAXED);
+        desired.tag = expected.tag + 1;
+    } while (!__atomic_compare_exchange(
+        concurrentstack,
+        &expected,
+        &desired,
+        1,
+        __ATOMIC_ACQUIRE,
+        __ATOMIC_ACQUIRE
+    ));
+
+    __atomic_store_n(&expected.tail->prev, STACK_POISON_PREV, __ATOMIC_RELAXED);
+
+    return expected.tail;
+}
+
+StackNode* concurrentstack_pop_all(ConcurrentStack *concurrentstack) {
+    ConcurrentStack expected, desired;
+
+    assert(concurrentstack);
+
+    __atomic_load(concurrentstack, &expected, __ATOMIC_ACQUIRE);
+    desired.tail = NULL;
+
+    do {
+        if (!expected.tail) {
+            return NULL;
+        }
+
+        desired.tag = expected.tag + 1;
+    } while (!__atomic_compare_exchange(
+        concurrentstack,
+        &expected,
+        &desired,
+        1,
+        __ATOMIC_ACQUIRE,
+        __ATOMIC_ACQUIRE
+    ));
+
+    return expected.tail;
+}
+
+#endif /* STACK_ATOMICS */
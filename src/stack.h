@@ -25,6 +25,17 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  * before it is used. A @ref StackNode structure does NOT need to be initialized before it is used.  A
  * @ref StackNode should belong to at most ONE @ref Stack.
  *
+ * A @ref ConcurrentStack is a Treiber stack for sharing a stack between threads, e.g. as a free list of
+ * objects, which uses the same @ref StackNode's and @ref stack_entry. Its tail is paired with a tag that every
+ * successful operation increments, and both are replaced by a single double-width compare-and-swap, so a pop
+ * that read a tail which was popped and pushed again meanwhile (the ABA problem) fails and retries instead of
+ * corrupting the chain. A pop may read the "prev" member of a @ref StackNode that another thread has just
+ * popped, so the memory of a @ref StackNode must stay readable for as long as other threads may pop the
+ * @ref ConcurrentStack it was in (e.g. it is reused, but never returned to the operating system). The variant is
+ * only compiled if STACK_ATOMICS is defined, and then requires the GNU C atomic builtins (GCC 4.7+ or Clang) and
+ * libatomic (-latomic) on most platforms. It is only lock-free where the double-width compare-and-swap is a
+ * native instruction (e.g. x86-64 with -mcx16); otherwise libatomic implements it with a lock.
+ *
  * Example:
  *          struct Object {
  *              int val;
@@ -49,11 +60,13 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  * Dependencies:
  *      -   C89 assert.h
  *      -   C89 stddef.h
+ *      -   GNU C atomic builtins and libatomic (STACK_ATOMICS only)
  *
  * API:
  *      ====  TYPES  ====
  *      -   typedef struct Stack Stack
  *      -   typedef struct StackNode StackNode
+ *      -   typedef struct ConcurrentStack ConcurrentStack
  *
  *      ====  FUNCTIONS  ====
  *      Initializers:
@@ -64,9 +77,17 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *          -   stack_empty
  *      Insertion:
  *          -   stack_push
+ *      Splicing:
+ *          -   stack_splice
  *      Removal:
  *          -   stack_pop
+ *          -   stack_pop_n
  *          -   stack_remove_all
+ *      Concurrent Variant (STACK_ATOMICS only):
+ *          -   concurrentstack_init
+ *          -   concurrentstack_push
+ *          -   concurrentstack_pop
+ *          -   concurrentstack_pop_all
  *
  *      ====  MACROS  ====
  *      Constants:
@@ -89,6 +110,10 @@ extern "C" {
 
 #include <stddef.h>
 
+#if defined(STACK_ATOMICS) && (!defined(__GNUC__) || !defined(__ATOMIC_ACQUIRE))
+    #error "STACK_ATOMICS requires the GNU C atomic builtins (GCC 4.7+ or Clang)."
+#endif
+
 /* ========================================================================================================
  *
  *                                                  TYPES
@@ -104,10 +129,12 @@ typedef struct Stack Stack;
 typedef struct StackNode StackNode;
 
 /**
- * Represents a stack.
+ * Represents a stack. The "tail" member is the top @ref StackNode, and the "head" member is the bottom one, so
+ * that a whole @ref Stack can be spliced onto another one in O(1).
  */
 struct Stack {
     StackNode *tail;
+    StackNode *head;
     size_t size;
 };
 
@@ -118,6 +145,25 @@ struct StackNode {
     StackNode *prev;
 };
 
+#ifdef STACK_ATOMICS
+
+/* Struct type declarations. */
+struct ConcurrentStack;
+
+/* Struct typedef's. */
+typedef struct ConcurrentStack ConcurrentStack;
+
+/**
+ * Represents a stack that can be shared between threads. It is aligned to its size, so that it can be replaced
+ * by a single double-width compare-and-swap.
+ */
+struct ConcurrentStack {
+    StackNode *tail;
+    size_t tag;
+} __attribute__((aligned(2 * sizeof(size_t))));
+
+#endif /* STACK_ATOMICS */
+
 /* ========================================================================================================
  *
  *                                               PROTOTYPES
@@ -194,6 +240,24 @@ int stack_empty(const Stack *stack);
  */
 void stack_push(Stack *stack, StackNode *node);
 
+/**
+ * Removes all the @ref StackNode's in the @ref src_stack, and pushes them onto the top of the @ref stack,
+ * keeping their order (i.e. the top @ref StackNode of the @ref src_stack becomes the top one of the
+ * @ref stack).
+ *
+ * Requirements:
+ *      -   @ref stack != NULL
+ *      -   @ref src_stack != NULL
+ *      -   @ref stack != @ref src_stack
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param stack                 The consumer @ref Stack to which elements are moved.
+ * @param src_stack             The producer @ref Stack from which elements are removed.
+ */
+void stack_splice(Stack *stack, Stack *src_stack);
+
 /**
  * Pops off the top @ref StackNode of the @ref stack AND returns it. If the @ref stack is empty, this function
  * simply returns NULL.
@@ -209,6 +273,23 @@ void stack_push(Stack *stack, StackNode *node);
  */
 StackNode* stack_pop(Stack *stack);
 
+/**
+ * Pops off up to @ref n @ref StackNode's from the top of the @ref stack AND returns the top one. The removed
+ * @ref StackNode's stay chained through their "prev" members, from top to bottom, and the bottom one has a
+ * "prev" member of NULL. If the @ref stack is empty or @ref n == 0, this function simply returns NULL.
+ *
+ * Requirements:
+ *      -   @ref stack != NULL
+ *
+ * Time complexity:
+ *      -   O(k), where k == min(@ref n, size of @ref stack), or O(1) if @ref n >= size of @ref stack
+ *
+ * @param stack                 The @ref Stack to be operated on.
+ * @param n                     The most @ref StackNode's to be removed.
+ * @return                      The top @ref StackNode of the removed chain.
+ */
+StackNode* stack_pop_n(Stack *stack, size_t n);
+
 /**
  * Removes all @ref StackNode's from the @ref stack. If the @ref stack is empty, this function simply returns.
  *
@@ -222,6 +303,73 @@ StackNode* stack_pop(Stack *stack);
  */
 void stack_remove_all(Stack *stack);
 
+#ifdef STACK_ATOMICS
+
+/**
+ * Initializes/resets the @ref concurrentstack. It must be initialized before it is shared with other
+ * threads.
+ *
+ * Requirements:
+ *      -   @ref concurrentstack != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param concurrentstack       The @ref ConcurrentStack to be initialized/reset.
+ */
+void concurrentstack_init(ConcurrentStack *concurrentstack);
+
+/**
+ * Pushes the @ref node onto the top of the @ref concurrentstack. Any number of threads may call the functions
+ * of the @ref concurrentstack concurrently.
+ *
+ * Requirements:
+ *      -   @ref concurrentstack != NULL
+ *      -   @ref node != NULL
+ *
+ * Time complexity:
+ *      -   O(1) without contention
+ *
+ * @param concurrentstack       The @ref ConcurrentStack to be operated on.
+ * @param node                  The @ref StackNode to be inserted.
+ */
+void concurrentstack_push(ConcurrentStack *concurrentstack, StackNode *node);
+
+/**
+ * Pops off the top @ref StackNode of the @ref concurrentstack AND returns it. If the @ref concurrentstack is
+ * empty, this function simply returns NULL. Any number of threads may call the functions of the
+ * @ref concurrentstack concurrently.
+ *
+ * Requirements:
+ *      -   @ref concurrentstack != NULL
+ *
+ * Time complexity:
+ *      -   O(1) without contention
+ *
+ * @param concurrentstack       The @ref ConcurrentStack to be operated on.
+ * @return                      The removed top @ref StackNode.
+ */
+StackNode* concurrentstack_pop(ConcurrentStack *concurrentstack);
+
+/**
+ * Detaches ALL @ref StackNode's from the @ref concurrentstack in one atomic operation AND returns the top one.
+ * The detached @ref StackNode's stay chained through their "prev" members, from top to bottom, and the
+ * bottom one has a "prev" member of NULL. If the @ref concurrentstack is empty, this function simply returns
+ * NULL. Any number of threads may call the functions of the @ref concurrentstack concurrently.
+ *
+ * Requirements:
+ *      -   @ref concurrentstack != NULL
+ *
+ * Time complexity:
+ *      -   O(1) without contention
+ *
+ * @param concurrentstack       The @ref ConcurrentStack to be operated on.
+ * @return                      The top @ref StackNode of the detached chain.
+ */
+StackNode* concurrentstack_pop_all(ConcurrentStack *concurrentstack);
+
+#endif /* STACK_ATOMICS */
+
 /* ========================================================================================================
  *
  *                                                 MACROS
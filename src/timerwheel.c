@@ -0,0 +1,227 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+
+#include "timerwheel.h"
+
+/* The number of ticks a TimerWheel tells apart, which must fit into an unsigned long. */
+#define TIMERWHEEL_RANGE (1UL << (TIMERWHEEL_LEVEL_BITS * TIMERWHEEL_NUM_LEVELS))
+
+/* Fails to compile if the levels of a TimerWheel span more bits than an unsigned long has. */
+typedef char timerwheel_range_check[
+    TIMERWHEEL_LEVEL_BITS * TIMERWHEEL_NUM_LEVELS < (int) (CHAR_BIT * sizeof(unsigned long)) ? 1 : -1
+];
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/*
+ * Puts the @ref node into the slot of the @ref timerwheel for the tick @ref expiry, which must NOT be before
+ * the current tick. If @ref expiry is too far away to be told apart, the @ref node is put into the top level
+ * slot for the last tick that can be.
+ */
+static void place(TimerWheel *timerwheel, TimerWheelNode *node, unsigned long expiry);
+
+/*
+ * Empties the slot of the @ref level that the current tick of the @ref timerwheel has just crossed into, and
+ * puts its @ref TimerWheelNode's into the lower levels again.
+ */
+static void cascade(TimerWheel *timerwheel, int level);
+
+/* ========================================================================================================
+ *
+ *                                        STATIC FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+static void place(TimerWheel *timerwheel, TimerWheelNode *node, unsigned long expiry) {
+    unsigned long delta;
+    TimerWheelNode **slot;
+    int level = 0;
+
+    assert(timerwheel && node && expiry >= timerwheel->now);
+
+    delta = expiry - timerwheel->now;
+
+    if (delta >= TIMERWHEEL_RANGE) {
+        delta = TIMERWHEEL_RANGE - 1;
+        expiry = timerwheel->now + delta;
+    }
+
+    while (delta >> (TIMERWHEEL_LEVEL_BITS * (level + 1))) {
+        ++level;
+    }
+
+    slot = &timerwheel->slots[level][(expiry >> (TIMERWHEEL_LEVEL_BITS * level)) & (TIMERWHEEL_NUM_SLOTS - 1)];
+
+    node->next = *slot;
+    node->pprev = slot;
+
+    if (*slot) {
+        (*slot)->pprev = &node->next;
+    }
+
+    *slot = node;
+}
+
+static void cascade(TimerWheel *timerwheel, int level) {
+    TimerWheelNode **slot, *n, *next;
+
+    assert(timerwheel && level > 0 && level < TIMERWHEEL_NUM_LEVELS);
+
+    slot = &timerwheel->slots[level][(timerwheel->now >> (TIMERWHEEL_LEVEL_BITS * level)) & (TIMERWHEEL_NUM_SLOTS - 1)];
+    n = *slot;
+    *slot = NULL;
+
+    /* Every TimerWheelNode here expires in a later slot of a lower level, or is still too far away. */
+    while (n) {
+        next = n->next;
+        place(timerwheel, n, n->expiry);
+        n = next;
+    }
+}
+
+/* ========================================================================================================
+ *
+ *                                        EXTERN FUNCTION DEFINITIONS
+ *
+ * ======================================================================================================== */
+
+void timerwheel_init(TimerWheel *timerwheel, unsigned long now) {
+    int level, i;
+
+    assert(timerwheel);
+
+    for (level = 0; level < TIMERWHEEL_NUM_LEVELS; ++level) {
+        for (i = 0; i < TIMERWHEEL_NUM_SLOTS; ++i) {
+            timerwheel->slots[level][i] = NULL;
+        }
+    }
+
+    timerwheel->now = now;
+    timerwheel->size = 0;
+}
+
+unsigned long timerwheel_now(const TimerWheel *timerwheel) {
+    assert(timerwheel);
+
+    return timerwheel->now;
+}
+
+size_t timerwheel_size(const TimerWheel *timerwheel) {
+    assert(timerwheel);
+
+    return timerwheel->size;
+}
+
+int timerwheel_empty(const TimerWheel *timerwheel) {
+    assert(timerwheel);
+
+    return timerwheel->size == 0;
+}
+
+void timerwheel_schedule(TimerWheel *timerwheel, TimerWheelNode *node, unsigned long expiry) {
+    assert(timerwheel && node);
+
+    node->expiry = expiry;
+
+    /* The slot of the current tick has already expired. */
+    place(timerwheel, node, expiry > timerwheel->now ? expiry : timerwheel->now + 1);
+
+    ++timerwheel->size;
+}
+
+void timerwheel_cancel(TimerWheel *timerwheel, TimerWheelNode *node) {
+    assert(timerwheel && timerwheel->size > 0 && node && node->pprev && node->pprev != TIMERWHEEL_POISON_PPREV);
+
+    *node->pprev = node->next;
+
+    if (node->next) {
+        node->next->pprev = node->pprev;
+    }
+
+    node->next = TIMERWHEEL_POISON_NEXT;
+    node->pprev = TIMERWHEEL_POISON_PPREV;
+
+    --timerwheel->size;
+}
+
+void timerwheel_advance(
+    TimerWheel *timerwheel,
+    unsigned long now,
+    void (*expire)(TimerWheelNode *node, void *auxiliary_data),
+    void *auxiliary_data
+) {
+    TimerWheelNode **slot, *head, *n;
+    int level;
+
+    assert(timerwheel && now >= timerwheel->now && expire);
+
+    while (timerwheel->now < now) {
+        if (timerwheel->size == 0) {
+            timerwheel->now = now;
+            break;
+        }
+
+        ++timerwheel->now;
+
+        for (
+            level = 1;
+            level < TIMERWHEEL_NUM_LEVELS &&
+            !(timerwheel->now & ((1UL << (TIMERWHEEL_LEVEL_BITS * level)) - 1));
+            ++level
+        ) {
+            cascade(timerwheel, level);
+        }
+
+        slot = &timerwheel->slots[0][timerwheel->now & (TIMERWHEEL_NUM_SLOTS - 1)];
+
+        if (!*slot) {
+            continue;
+        }
+
+        /*
+         * Detach the slot, so TimerWheelNode's scheduled by the expire callback function, which always land in
+         * a later slot, or cancelled by it, which may still be in this chain, are dealt with correctly.
+         */
+        head = *slot;
+        *slot = NULL;
+        head->pprev = &head;
+
+        while (head) {
+            n = head;
+            head = n->next;
+
+            if (head) {
+                head->pprev = &head;
+            }
+
+            n->next = TIMERWHEEL_POISON_NEXT;
+            n->pprev = TIMERWHEEL_POISON_PPREV;
+            --timerwheel->size;
+
+            expire(n, auxiliary_data);
+        }
+    }
+}
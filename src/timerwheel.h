@@ -0,0 +1,353 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+ * @file    timerwheel.h
+ * @brief   HIERARCHICAL TIMER WHEEL
+ *
+ * Embed one or more @ref TimerWheelNode's into your struct to make it a potential timer in one or more timer
+ * wheels. The @ref TimerWheel structure keeps track of the scheduled @ref TimerWheelNode's. A @ref TimerWheel
+ * MUST be initialized before it is used. A @ref TimerWheelNode does NOT need to be initialized before it is
+ * used. A @ref TimerWheelNode should belong to at most ONE @ref TimerWheel.
+ *
+ * Time is measured in ticks of a user-defined length (e.g. milliseconds), and the @ref TimerWheel keeps track
+ * of the current tick. A @ref TimerWheelNode is scheduled to expire at an absolute tick, and
+ * @ref timerwheel_advance moves the current tick forward, calling the user-defined expire function on every
+ * @ref TimerWheelNode whose tick has come.
+ *
+ * The @ref TimerWheel consists of @ref TIMERWHEEL_NUM_LEVELS levels of @ref TIMERWHEEL_NUM_SLOTS slots each,
+ * and every slot holds an unordered chain of @ref TimerWheelNode's. A slot of level 0 spans one tick, and a
+ * slot of every further level spans all the slots of the level below. A @ref TimerWheelNode is put into the
+ * lowest level whose slots can tell its tick apart from the current one, so scheduling is O(1), and since
+ * every @ref TimerWheelNode knows the link pointing at it, so is cancelling, which never touches any other
+ * slot. Whenever the current tick crosses into the next slot of a level above 0, that slot is emptied and its
+ * @ref TimerWheelNode's are put into the lower levels again (cascading). A @ref TimerWheelNode is thus moved
+ * at most @ref TIMERWHEEL_NUM_LEVELS - 1 times before it expires, and not at all if it is cancelled early,
+ * which is what most timeouts are.
+ *
+ * A @ref TimerWheelNode that expires further in the future than the top level can tell apart is kept in the
+ * top level, and put back there until it is close enough. Ticks are never allowed to wrap around.
+ *
+ * Example:
+ *          struct Connection {
+ *              int fd;
+ *              TimerWheelNode timeout;
+ *          };
+ *
+ *          void expire(TimerWheelNode *node, void *auxiliary_data) {
+ *              ++*(int*) auxiliary_data;
+ *          }
+ *
+ *          int main(void) {
+ *              struct Connection conn1, conn2;
+ *              TimerWheel timerwheel;
+ *              int num_expired = 0;
+ *
+ *              timerwheel_init(&timerwheel, 0);
+ *              timerwheel_schedule(&timerwheel, &conn1.timeout, 100);
+ *              timerwheel_schedule(&timerwheel, &conn2.timeout, 200);
+ *
+ *              timerwheel_cancel(&timerwheel, &conn1.timeout);
+ *              timerwheel_advance(&timerwheel, 300, expire, &num_expired);
+ *              assert(num_expired == 1);
+ *
+ *              return 0;
+ *          }
+ *
+ * Dependencies:
+ *      -   C89 assert.h
+ *      -   C89 limits.h
+ *      -   C89 stddef.h
+ *
+ * API:
+ *      ====  TYPES  ====
+ *      -   typedef struct TimerWheel TimerWheel
+ *      -   typedef struct TimerWheelNode TimerWheelNode
+ *
+ *      ====  FUNCTIONS  ====
+ *      Initializers:
+ *          -   timerwheel_init
+ *      Properties:
+ *          -   timerwheel_now
+ *          -   timerwheel_size
+ *          -   timerwheel_empty
+ *      Insertion:
+ *          -   timerwheel_schedule
+ *      Removal:
+ *          -   timerwheel_cancel
+ *      Expiration:
+ *          -   timerwheel_advance
+ *
+ *      ====  MACROS  ====
+ *      Constants:
+ *          -   TIMERWHEEL_LEVEL_BITS
+ *          -   TIMERWHEEL_NUM_LEVELS
+ *          -   TIMERWHEEL_NUM_SLOTS
+ *          -   TIMERWHEEL_POISON_NEXT
+ *          -   TIMERWHEEL_POISON_PPREV
+ *      Convenient Node Initializer:
+ *          -   TIMERWHEEL_NODE_INIT
+ *      Properties:
+ *          -   timerwheel_entry
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+/**
+ * The base 2 logarithm of the number of slots per level of a @ref TimerWheel. Can be overridden by defining it
+ * before including this header, identically for the library and every translation unit using it.
+ */
+#ifndef TIMERWHEEL_LEVEL_BITS
+    #define TIMERWHEEL_LEVEL_BITS 6
+#endif
+
+/**
+ * The number of levels of a @ref TimerWheel. A @ref TimerWheel tells apart the ticks of the next
+ * 2^(@ref TIMERWHEEL_LEVEL_BITS * @ref TIMERWHEEL_NUM_LEVELS) ticks, which must be fewer than the number of
+ * values of an unsigned long. Can be overridden by defining it before including this header, identically for
+ * the library and every translation unit using it.
+ */
+#ifndef TIMERWHEEL_NUM_LEVELS
+    #define TIMERWHEEL_NUM_LEVELS 4
+#endif
+
+/**
+ * The number of slots per level of a @ref TimerWheel.
+ */
+#define TIMERWHEEL_NUM_SLOTS (1 << TIMERWHEEL_LEVEL_BITS)
+
+/* ========================================================================================================
+ *
+ *                                                  TYPES
+ *
+ * ======================================================================================================== */
+
+/* Struct type declarations. */
+struct TimerWheel;
+struct TimerWheelNode;
+
+/* Struct typedef's. */
+typedef struct TimerWheel TimerWheel;
+typedef struct TimerWheelNode TimerWheelNode;
+
+/**
+ * Represents a hierarchical timer wheel. The current tick is the last tick whose @ref TimerWheelNode's have
+ * expired.
+ */
+struct TimerWheel {
+    unsigned long now;
+    size_t size;
+    TimerWheelNode *slots[TIMERWHEEL_NUM_LEVELS][TIMERWHEEL_NUM_SLOTS];
+};
+
+/**
+ * Represents a node in a @ref TimerWheel. Embed this into your structure to make it a node. The "pprev" member
+ * points to the link pointing at the @ref TimerWheelNode (a slot, or the "next" member of the previous
+ * @ref TimerWheelNode in the chain of the slot).
+ */
+struct TimerWheelNode {
+    TimerWheelNode *next;
+    TimerWheelNode **pprev;
+    unsigned long expiry;
+};
+
+/* ========================================================================================================
+ *
+ *                                               PROTOTYPES
+ *
+ * ======================================================================================================== */
+
+/**
+ * Initializes/resets the @ref timerwheel, whose current tick becomes @ref now.
+ *
+ * Requirements:
+ *      -   @ref timerwheel != NULL
+ *
+ * Time complexity:
+ *      -   O(@ref TIMERWHEEL_NUM_LEVELS * @ref TIMERWHEEL_NUM_SLOTS)
+ *
+ * @param timerwheel            The @ref TimerWheel to be initialized/reset.
+ * @param now                   The current tick.
+ */
+void timerwheel_init(TimerWheel *timerwheel, unsigned long now);
+
+/**
+ * Returns the current tick of the @ref timerwheel.
+ *
+ * Requirements:
+ *      -   @ref timerwheel != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param timerwheel            The @ref TimerWheel to be operated on.
+ * @return                      The current tick of the @ref timerwheel.
+ */
+unsigned long timerwheel_now(const TimerWheel *timerwheel);
+
+/**
+ * Returns the number of scheduled @ref TimerWheelNode's in the @ref timerwheel.
+ *
+ * Requirements:
+ *      -   @ref timerwheel != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param timerwheel            The @ref TimerWheel to be operated on.
+ * @return                      The size of the @ref timerwheel.
+ */
+size_t timerwheel_size(const TimerWheel *timerwheel);
+
+/**
+ * Returns whether the @ref timerwheel is empty.
+ *
+ * Requirements:
+ *      -   @ref timerwheel != NULL
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param timerwheel            The @ref TimerWheel to be operated on.
+ * @return                      1 if the @ref timerwheel is empty, otherwise 0.
+ */
+int timerwheel_empty(const TimerWheel *timerwheel);
+
+/**
+ * Schedules the @ref node to expire at the tick @ref expiry, which is stored in its "expiry" member. If
+ * @ref expiry is not after the current tick, the @ref node expires at the next tick.
+ *
+ * Requirements:
+ *      -   @ref timerwheel != NULL
+ *      -   @ref node != NULL
+ *      -   @ref node is NOT scheduled
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param timerwheel            The @ref TimerWheel to be operated on.
+ * @param node                  The @ref TimerWheelNode to be scheduled.
+ * @param expiry                The tick at which the @ref node expires.
+ */
+void timerwheel_schedule(TimerWheel *timerwheel, TimerWheelNode *node, unsigned long expiry);
+
+/**
+ * Cancels the @ref node, which will not expire anymore.
+ *
+ * Requirements:
+ *      -   @ref timerwheel != NULL
+ *      -   @ref node is scheduled in the @ref timerwheel
+ *
+ * Time complexity:
+ *      -   O(1)
+ *
+ * @param timerwheel            The @ref TimerWheel to be operated on.
+ * @param node                  The @ref TimerWheelNode to be cancelled.
+ */
+void timerwheel_cancel(TimerWheel *timerwheel, TimerWheelNode *node);
+
+/**
+ * Moves the current tick of the @ref timerwheel forward to @ref now, one tick at a time, and calls the
+ * @ref expire callback function on every @ref TimerWheelNode whose tick is reached, in the order of their
+ * ticks. A @ref TimerWheelNode is no longer scheduled when the @ref expire callback function is called with
+ * it, so the @ref expire callback function may schedule it again, and may schedule or cancel any other
+ * @ref TimerWheelNode as well. If the @ref timerwheel is empty, this function simply moves the current tick.
+ *
+ * Requirements:
+ *      -   @ref timerwheel != NULL
+ *      -   @ref now is not before the current tick of the @ref timerwheel
+ *      -   @ref expire != NULL
+ *
+ * Time complexity:
+ *      -   O(t + k), where t == number of ticks moved while the @ref timerwheel is not empty, and k == number
+ *          of @ref TimerWheelNode's that expire or cascade
+ *
+ * @param timerwheel            The @ref TimerWheel to be operated on.
+ * @param now                   The new current tick.
+ * @param expire                The callback function called on every expired @ref TimerWheelNode.
+ * @param auxiliary_data        The auxiliary data passed to the @ref expire callback function. This data is
+ *                              NEVER manipulated by the @ref timerwheel.
+ */
+void timerwheel_advance(
+    TimerWheel *timerwheel,
+    unsigned long now,
+    void (*expire)(TimerWheelNode *node, void *auxiliary_data),
+    void *auxiliary_data
+);
+
+/* ========================================================================================================
+ *
+ *                                                 MACROS
+ *
+ * ======================================================================================================== */
+
+/**
+ * Non-NULL pointer that will result in page faults under normal circumstances. Is the "next" member of a
+ * @ref TimerWheelNode that was cancelled or has expired. Useful for identifying bugs.
+ */
+#define TIMERWHEEL_POISON_NEXT ((TimerWheelNode*) 0x100)
+
+/**
+ * Non-NULL pointer that will result in page faults under normal circumstances. Is the "pprev" member of a
+ * @ref TimerWheelNode that was cancelled or has expired. Useful for identifying bugs, and for telling
+ * whether a @ref TimerWheelNode initialized with @ref TIMERWHEEL_NODE_INIT is scheduled.
+ */
+#define TIMERWHEEL_POISON_PPREV ((TimerWheelNode**) 0x200)
+
+/**
+ * Initializing a @ref TimerWheelNode before it is used is NOT required. This macro is simply for allowing you
+ * to initialize a struct (containing one or more @ref TimerWheelNode's) with an initializer-list
+ * conveniently.
+ */
+#define TIMERWHEEL_NODE_INIT { TIMERWHEEL_POISON_NEXT, TIMERWHEEL_POISON_PPREV, 0 }
+
+/**
+ * Obtains the pointer to the struct for this entry.
+ *
+ * Requirements:
+ *      -   @ref node_ptr != NULL
+ *
+ * @param node_ptr              The pointer to the @ref TimerWheelNode in the struct.
+ * @param type                  The type of the struct the @ref TimerWheelNode is embedded in.
+ * @param member                The name of the @ref TimerWheelNode in the struct.
+ */
+#if defined(__GNUC__) && !defined(__STRICT_ANSI__)
+    #define timerwheel_entry(node_ptr, type, member) \
+        ({ \
+            const typeof(((type*)0)->member) *__mptr = (node_ptr); \
+            (type*) ((char*)__mptr - offsetof(type, member)); \
+        })
+#else
+    #define timerwheel_entry(node_ptr, type, member) \
+        ( \
+            (type*) ((char*)(node_ptr) - offsetof(type, member)) \
+        )
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* TIMERWHEEL_H */
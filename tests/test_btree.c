@@ -0,0 +1,1052 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+
+#include "testing_framework.h"
+
+/* Test header guard. */
+#include "../src/btree.h"
+#include "../src/btree.h"
+
+/* ========================================================================================================
+ *
+ *                                             TESTING UTILITIES
+ *
+ * ======================================================================================================== */
+
+#define NUM_MANY 1000
+#define NUM_PAGES BTREE_PAGES_NEEDED(NUM_MANY)
+
+typedef struct TestStruct {
+    int key;
+    int num_similar_keys;
+    BTreeNode node;
+} TestStruct;
+
+TestStruct var1, var2, var3, var4, var5, var6, var7;
+TestStruct many[NUM_MANY];
+BTreePage page_array[NUM_PAGES];
+BTree btree;
+size_t counter;
+void *aux_ptr;
+
+#define ASSERT_BTREE(btree, size_of_btree) \
+    do { \
+        assert(btree.size == size_of_btree); \
+        assert((btree.root == NULL) == (size_of_btree == 0)); \
+    } while (0)
+
+#define POISON_NODE(node) \
+    do { \
+        BTreeNode poisoned_node_ = BTREE_NODE_INIT; \
+        (node) = poisoned_node_; \
+    } while (0)
+
+#define ASSERT_INORDERNESS(btree) \
+    do { \
+        assert(btree_first(&btree) == &var1.node); \
+        \
+        assert(btree_last(&btree) == &var7.node); \
+        \
+        assert(btree_next(&var1.node) == &var2.node); \
+        assert(btree_next(&var2.node) == &var3.node); \
+        assert(btree_next(&var3.node) == &var4.node); \
+        assert(btree_next(&var4.node) == &var5.node); \
+        assert(btree_next(&var5.node) == &var6.node); \
+        assert(btree_next(&var6.node) == &var7.node); \
+        assert(btree_next(&var7.node) == NULL); \
+        \
+        assert(btree_prev(&var7.node) == &var6.node); \
+        assert(btree_prev(&var6.node) == &var5.node); \
+        assert(btree_prev(&var5.node) == &var4.node); \
+        assert(btree_prev(&var4.node) == &var3.node); \
+        assert(btree_prev(&var3.node) == &var2.node); \
+        assert(btree_prev(&var2.node) == &var1.node); \
+        assert(btree_prev(&var1.node) == NULL); \
+    } while (0)
+
+static int key_of_(const BTreeNode *node) {
+    return btree_entry(node, TestStruct, node)->key;
+}
+
+/*
+ * Checks the shape of the subtree rooted at the @ref page and returns the number of BTreeNode's in it.
+ */
+static size_t p1_(const BTree *btree, const BTreePage *page, const BTreePage *parent, size_t depth, size_t *leaf_depth) {
+    size_t num_nodes = 0, i;
+
+    assert(page->parent == parent);
+    assert(page->num_slots > 0 && page->num_slots <= BTREE_PAGE_SIZE);
+
+    if (page != btree->root) {
+        assert(page->num_slots >= BTREE_PAGE_SIZE / 2);
+    } else if (!page->leaf) {
+        assert(page->num_slots >= 2);
+    }
+
+    if (page->leaf) {
+        if (*leaf_depth == (size_t) -1) {
+            *leaf_depth = depth;
+        }
+
+        assert(*leaf_depth == depth);
+
+        for (i = 0; i < page->num_slots; ++i) {
+            assert(page->slots[i]->page == page);
+            assert(page->slots[i]->index == i);
+
+            if (btree->key_prefix) {
+                int key = key_of_(page->slots[i]);
+                assert(page->prefixes[i] == btree->key_prefix(&key));
+            }
+        }
+
+        return page->num_slots;
+    }
+
+    for (i = 0; i < page->num_slots; ++i) {
+        const BTreePage *child = page->children[i];
+
+        while (!child->leaf) {
+            child = child->children[0];
+        }
+
+        assert(page->slots[i] == child->slots[0]);
+        assert(page->prefixes[i] == child->prefixes[0]);
+        assert(page->counts[i] == p1_(btree, page->children[i], page, depth + 1, leaf_depth));
+
+        num_nodes += page->counts[i];
+    }
+
+    return num_nodes;
+}
+
+/*
+ * Checks the order and the links of the leaves and the accounting of the BTreePage's.
+ */
+static void p2_(const BTree *btree) {
+    const BTreeNode *n, *prev = NULL;
+    size_t num_nodes = 0, num_free = 0;
+    const BTreePage *page;
+
+    btree_for_each(n, btree) {
+        if (prev) {
+            assert(key_of_(prev) < key_of_(n));
+            assert(btree_prev(n) == prev);
+        }
+
+        prev = n;
+        ++num_nodes;
+    }
+
+    assert(num_nodes == btree->size);
+
+    for (page = btree->free_pages; page; page = page->next) {
+        ++num_free;
+    }
+
+    assert(num_free == btree->num_free_pages);
+
+    if (btree->size > 0) {
+        assert(btree->num_pages - btree->num_free_pages <= BTREE_PAGES_NEEDED(btree->size));
+    } else {
+        assert(btree->num_free_pages == btree->num_pages);
+    }
+}
+
+#define ASSERT_PROPERTIES(btree) \
+    do { \
+        if (btree.root) { \
+            size_t leaf_depth_ = (size_t) -1; \
+            assert(btree.root->parent == NULL); \
+            assert(p1_(&btree, btree.root, NULL, 0, &leaf_depth_) == btree.size); \
+        } \
+        p2_(&btree); \
+    } while (0)
+
+#define FILL_SEQUENTIALLY(btree) \
+    do { \
+        btree_insert(&btree, &var1.key, &var1.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var2.key, &var2.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var3.key, &var3.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var4.key, &var4.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var5.key, &var5.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var6.key, &var6.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var7.key, &var7.node); \
+        ASSERT_PROPERTIES(btree); \
+    } while (0)
+
+#define FILL_SEQUENTIALLY_REVERSE(btree) \
+    do { \
+        btree_insert(&btree, &var7.key, &var7.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var6.key, &var6.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var5.key, &var5.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var4.key, &var4.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var3.key, &var3.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var2.key, &var2.node); \
+        ASSERT_PROPERTIES(btree); \
+        btree_insert(&btree, &var1.key, &var1.node); \
+        ASSERT_PROPERTIES(btree); \
+    } while (0)
+
+#define FILL_MANY_RANDOMLY(btree) \
+    do { \
+        size_t i_; \
+        for (i_ = 0; i_ < NUM_MANY; ++i_) { \
+            size_t j_ = (size_t) rand() % (i_ + 1); \
+            int key_ = many[i_].key; \
+            many[i_].key = many[j_].key; \
+            many[j_].key = key_; \
+        } \
+        for (i_ = 0; i_ < NUM_MANY; ++i_) { \
+            btree_insert(&btree, &many[i_].key, &many[i_].node); \
+        } \
+        ASSERT_PROPERTIES(btree); \
+    } while (0)
+
+#define loop \
+    for (counter = 0; counter < 100; ++counter)
+
+static int compare_func(const void *key, const BTreeNode *node) {
+    return *(const int*)key - btree_entry(node, TestStruct, node)->key;
+}
+
+/* Coarse enough that neighbouring keys share a prefix and the compare function has to break the tie. */
+static unsigned long key_prefix_func(const void *key) {
+    return (unsigned long) *(const int*)key / 8;
+}
+
+static void collide_func(const BTreeNode *old_node, const BTreeNode *new_node, void *auxiliary_data) {
+    assert(old_node->page == new_node->page && old_node->index == new_node->index);
+    assert((void**) auxiliary_data == &aux_ptr);
+
+    btree_entry(new_node, TestStruct, node)->num_similar_keys += 1 + btree_entry(old_node, TestStruct, node)->num_similar_keys;
+}
+
+static void reset_globals(void) {
+    size_t i;
+
+    btree_init(&btree, page_array, NUM_PAGES, compare_func, collide_func, &aux_ptr);
+
+    var1.key = 1;
+    var1.num_similar_keys = 0;
+    POISON_NODE(var1.node);
+
+    var2.key = 2;
+    var2.num_similar_keys = 0;
+    POISON_NODE(var2.node);
+
+    var3.key = 3;
+    var3.num_similar_keys = 0;
+    POISON_NODE(var3.node);
+
+    var4.key = 4;
+    var4.num_similar_keys = 0;
+    POISON_NODE(var4.node);
+
+    var5.key = 5;
+    var5.num_similar_keys = 0;
+    POISON_NODE(var5.node);
+
+    var6.key = 6;
+    var6.num_similar_keys = 0;
+    POISON_NODE(var6.node);
+
+    var7.key = 7;
+    var7.num_similar_keys = 0;
+    POISON_NODE(var7.node);
+
+    for (i = 0; i < NUM_MANY; ++i) {
+        many[i].key = (int) i;
+        many[i].num_similar_keys = 0;
+        POISON_NODE(many[i].node);
+    }
+}
+
+/* ========================================================================================================
+ *
+ *                                              TEST FUNCTIONS
+ *
+ * ======================================================================================================== */
+
+void test_btree_init(void) {
+    btree_init(&btree, page_array, NUM_PAGES, compare_func, NULL, NULL);
+    ASSERT_BTREE(btree, 0);
+    assert(btree.compare == compare_func);
+    assert(btree.key_prefix == NULL);
+    assert(btree.collide == NULL);
+    assert(btree.auxiliary_data == NULL);
+    assert(btree.page_array == page_array);
+    assert(btree.num_pages == NUM_PAGES);
+    assert(btree.num_free_pages == NUM_PAGES);
+    ASSERT_PROPERTIES(btree);
+
+    btree_init(&btree, page_array, NUM_PAGES, compare_func, collide_func, &aux_ptr);
+    ASSERT_BTREE(btree, 0);
+    assert(btree.compare == compare_func);
+    assert(btree.collide == collide_func);
+    assert(btree.auxiliary_data == &aux_ptr);
+    ASSERT_PROPERTIES(btree);
+
+    FILL_SEQUENTIALLY(btree);
+    btree_init(&btree, page_array, NUM_PAGES, compare_func, collide_func, &aux_ptr);
+    ASSERT_BTREE(btree, 0);
+    ASSERT_PROPERTIES(btree);
+
+    btree_init(&btree, NULL, 0, compare_func, NULL, NULL);
+    ASSERT_BTREE(btree, 0);
+    assert(btree.num_free_pages == 0);
+    ASSERT_PROPERTIES(btree);
+}
+
+void test_btree_set_key_prefix(void) {
+    TestStruct duplicate;
+    size_t i;
+    int key;
+
+    btree_set_key_prefix(&btree, key_prefix_func);
+    assert(btree.key_prefix == key_prefix_func);
+    ASSERT_PROPERTIES(btree);
+
+    FILL_MANY_RANDOMLY(btree);
+    ASSERT_BTREE(btree, NUM_MANY);
+
+    for (key = 0; key < NUM_MANY; ++key) {
+        assert(key_of_(btree_lookup_key(&btree, &key)) == key);
+        assert(key_of_(btree_lower_bound(&btree, &key)) == key);
+        assert(key_of_(btree_at(&btree, (size_t) key)) == key);
+        assert(btree_index_of(&btree, btree_lookup_key(&btree, &key)) == (size_t) key);
+    }
+
+    key = NUM_MANY;
+    assert(btree_lookup_key(&btree, &key) == NULL);
+    assert(btree_lower_bound(&btree, &key) == NULL);
+    key = 10;
+    assert(key_of_(btree_upper_bound(&btree, &key)) == 11);
+
+    /* A key equal to one in the BTree replaces it, even though the prefix alone cannot tell them apart. */
+    duplicate.key = 10;
+    duplicate.num_similar_keys = 0;
+    btree_insert(&btree, &duplicate.key, &duplicate.node);
+    ASSERT_BTREE(btree, NUM_MANY);
+    ASSERT_PROPERTIES(btree);
+    assert(btree_lookup_key(&btree, &key) == &duplicate.node);
+    assert(duplicate.num_similar_keys == 1);
+
+    for (i = 0; i < NUM_MANY; i += 2) {
+        btree_remove_key(&btree, &many[i].key);
+        ASSERT_PROPERTIES(btree);
+    }
+    ASSERT_BTREE(btree, NUM_MANY / 2);
+
+    btree_remove_all(&btree);
+    btree_set_key_prefix(&btree, NULL);
+    assert(btree.key_prefix == NULL);
+    ASSERT_PROPERTIES(btree);
+
+    btree_set_key_prefix(&btree, key_prefix_func);
+    btree_init(&btree, page_array, NUM_PAGES, compare_func, collide_func, &aux_ptr);
+    assert(btree.key_prefix == NULL);
+}
+
+void test_btree_first(void) {
+    assert(btree_first(&btree) == NULL);
+    btree_insert(&btree, &var4.key, &var4.node);
+    assert(btree_first(&btree) == &var4.node);
+    btree_insert(&btree, &var5.key, &var5.node);
+    assert(btree_first(&btree) == &var4.node);
+    btree_insert(&btree, &var2.key, &var2.node);
+    assert(btree_first(&btree) == &var2.node);
+    reset_globals();
+
+    FILL_SEQUENTIALLY_REVERSE(btree);
+    assert(btree_first(&btree) == &var1.node);
+    reset_globals();
+
+    loop {
+        FILL_MANY_RANDOMLY(btree);
+        assert(key_of_(btree_first(&btree)) == 0);
+        reset_globals();
+    }
+}
+
+void test_btree_last(void) {
+    assert(btree_last(&btree) == NULL);
+    btree_insert(&btree, &var4.key, &var4.node);
+    assert(btree_last(&btree) == &var4.node);
+    btree_insert(&btree, &var2.key, &var2.node);
+    assert(btree_last(&btree) == &var4.node);
+    btree_insert(&btree, &var5.key, &var5.node);
+    assert(btree_last(&btree) == &var5.node);
+    reset_globals();
+
+    FILL_SEQUENTIALLY(btree);
+    assert(btree_last(&btree) == &var7.node);
+    reset_globals();
+
+    loop {
+        FILL_MANY_RANDOMLY(btree);
+        assert(key_of_(btree_last(&btree)) == NUM_MANY - 1);
+        reset_globals();
+    }
+}
+
+void test_btree_prev(void) {
+    size_t i;
+
+    assert(btree_prev(NULL) == NULL);
+    btree_insert(&btree, &var1.key, &var1.node);
+    assert(btree_prev(&var1.node) == NULL);
+    reset_globals();
+
+    FILL_SEQUENTIALLY(btree);
+    ASSERT_INORDERNESS(btree);
+    reset_globals();
+
+    FILL_SEQUENTIALLY_REVERSE(btree);
+    ASSERT_INORDERNESS(btree);
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    for (i = 0; i < NUM_MANY; ++i) {
+        if (many[i].key == 0) {
+            assert(btree_prev(&many[i].node) == NULL);
+        } else {
+            assert(key_of_(btree_prev(&many[i].node)) == many[i].key - 1);
+        }
+    }
+}
+
+void test_btree_next(void) {
+    size_t i;
+
+    assert(btree_next(NULL) == NULL);
+    btree_insert(&btree, &var1.key, &var1.node);
+    assert(btree_next(&var1.node) == NULL);
+    reset_globals();
+
+    FILL_SEQUENTIALLY(btree);
+    ASSERT_INORDERNESS(btree);
+    reset_globals();
+
+    FILL_SEQUENTIALLY_REVERSE(btree);
+    ASSERT_INORDERNESS(btree);
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    for (i = 0; i < NUM_MANY; ++i) {
+        if (many[i].key == NUM_MANY - 1) {
+            assert(btree_next(&many[i].node) == NULL);
+        } else {
+            assert(key_of_(btree_next(&many[i].node)) == many[i].key + 1);
+        }
+    }
+}
+
+void test_btree_size(void) {
+    assert(btree_size(&btree) == 0);
+    btree_insert(&btree, &var1.key, &var1.node);
+    assert(btree_size(&btree) == 1);
+    btree_insert(&btree, &var2.key, &var2.node);
+    assert(btree_size(&btree) == 2);
+    btree_insert(&btree, &var2.key, &var3.node);
+    assert(btree_size(&btree) == 2);
+    btree_remove(&btree, &var1.node);
+    assert(btree_size(&btree) == 1);
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    assert(btree_size(&btree) == NUM_MANY);
+}
+
+void test_btree_empty(void) {
+    assert(btree_empty(&btree));
+    btree_insert(&btree, &var1.key, &var1.node);
+    assert(!btree_empty(&btree));
+    btree_remove(&btree, &var1.node);
+    assert(btree_empty(&btree));
+}
+
+void test_btree_contains_key(void) {
+    int key = 8;
+    size_t i;
+
+    assert(!btree_contains_key(&btree, &var1.key));
+    FILL_SEQUENTIALLY(btree);
+    assert(btree_contains_key(&btree, &var1.key));
+    assert(btree_contains_key(&btree, &var4.key));
+    assert(btree_contains_key(&btree, &var7.key));
+    assert(!btree_contains_key(&btree, &key));
+    key = 0;
+    assert(!btree_contains_key(&btree, &key));
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    for (i = 0; i < NUM_MANY; ++i) {
+        assert(btree_contains_key(&btree, &many[i].key));
+    }
+    key = -1;
+    assert(!btree_contains_key(&btree, &key));
+    key = NUM_MANY;
+    assert(!btree_contains_key(&btree, &key));
+}
+
+void test_btree_num_free_pages(void) {
+    size_t i;
+
+    assert(btree_num_free_pages(&btree) == NUM_PAGES);
+    btree_insert(&btree, &var1.key, &var1.node);
+    assert(btree_num_free_pages(&btree) == NUM_PAGES - 1);
+    btree_remove(&btree, &var1.node);
+    assert(btree_num_free_pages(&btree) == NUM_PAGES);
+
+    /* Sequential insertion leaves every BTreePage but the last one of each level half full. */
+    for (i = 0; i < NUM_MANY; ++i) {
+        btree_insert(&btree, &many[i].key, &many[i].node);
+        ASSERT_PROPERTIES(btree);
+    }
+
+    for (i = 0; i < NUM_MANY; ++i) {
+        btree_remove(&btree, &many[i].node);
+        ASSERT_PROPERTIES(btree);
+    }
+
+    assert(btree_num_free_pages(&btree) == NUM_PAGES);
+
+    for (i = NUM_MANY; i > 0; --i) {
+        btree_insert(&btree, &many[i - 1].key, &many[i - 1].node);
+        ASSERT_PROPERTIES(btree);
+    }
+
+    for (i = NUM_MANY; i > 0; --i) {
+        btree_remove(&btree, &many[i - 1].node);
+        ASSERT_PROPERTIES(btree);
+    }
+
+    assert(btree_num_free_pages(&btree) == NUM_PAGES);
+}
+
+void test_btree_index_of(void) {
+    size_t i;
+
+    FILL_SEQUENTIALLY(btree);
+    assert(btree_index_of(&btree, &var1.node) == 0);
+    assert(btree_index_of(&btree, &var2.node) == 1);
+    assert(btree_index_of(&btree, &var3.node) == 2);
+    assert(btree_index_of(&btree, &var4.node) == 3);
+    assert(btree_index_of(&btree, &var5.node) == 4);
+    assert(btree_index_of(&btree, &var6.node) == 5);
+    assert(btree_index_of(&btree, &var7.node) == 6);
+    reset_globals();
+
+    loop {
+        FILL_MANY_RANDOMLY(btree);
+        for (i = 0; i < NUM_MANY; ++i) {
+            assert(btree_index_of(&btree, &many[i].node) == (size_t) many[i].key);
+        }
+        reset_globals();
+    }
+}
+
+void test_btree_at(void) {
+    size_t i;
+
+    FILL_SEQUENTIALLY_REVERSE(btree);
+    assert(btree_at(&btree, 0) == &var1.node);
+    assert(btree_at(&btree, 1) == &var2.node);
+    assert(btree_at(&btree, 2) == &var3.node);
+    assert(btree_at(&btree, 3) == &var4.node);
+    assert(btree_at(&btree, 4) == &var5.node);
+    assert(btree_at(&btree, 5) == &var6.node);
+    assert(btree_at(&btree, 6) == &var7.node);
+    reset_globals();
+
+    loop {
+        FILL_MANY_RANDOMLY(btree);
+        for (i = 0; i < NUM_MANY; ++i) {
+            assert(key_of_(btree_at(&btree, i)) == (int) i);
+        }
+        reset_globals();
+    }
+}
+
+void test_btree_insert(void) {
+    size_t i;
+
+    btree.collide = NULL;
+    btree_insert(&btree, &var1.key, &var1.node);
+    ASSERT_BTREE(btree, 1);
+    assert(var1.node.page == btree.root && var1.node.index == 0);
+    ASSERT_PROPERTIES(btree);
+    btree_insert(&btree, &var2.key, &var2.node);
+    ASSERT_BTREE(btree, 2);
+    assert(var2.node.page == btree.root && var2.node.index == 1);
+    ASSERT_PROPERTIES(btree);
+    var3.key = var1.key;
+    btree_insert(&btree, &var3.key, &var3.node);
+    ASSERT_BTREE(btree, 2);
+    assert(var3.node.page == btree.root && var3.node.index == 0);
+    assert(btree_first(&btree) == &var3.node);
+    assert(var3.num_similar_keys == 0);
+    ASSERT_PROPERTIES(btree);
+    reset_globals();
+
+    btree_insert(&btree, &var1.key, &var1.node);
+    var2.key = var1.key;
+    btree_insert(&btree, &var2.key, &var2.node);
+    assert(var2.num_similar_keys == 1);
+    var3.key = var1.key;
+    btree_insert(&btree, &var3.key, &var3.node);
+    assert(var3.num_similar_keys == 2);
+    ASSERT_BTREE(btree, 1);
+    ASSERT_PROPERTIES(btree);
+    reset_globals();
+
+    FILL_SEQUENTIALLY(btree);
+    ASSERT_BTREE(btree, 7);
+    ASSERT_INORDERNESS(btree);
+    reset_globals();
+
+    FILL_SEQUENTIALLY_REVERSE(btree);
+    ASSERT_BTREE(btree, 7);
+    ASSERT_INORDERNESS(btree);
+    reset_globals();
+
+    /* Replacing the first BTreeNode of a leaf must also replace it as the separator of every ancestor. */
+    loop {
+        FILL_MANY_RANDOMLY(btree);
+        var1.key = (int) (rand() % NUM_MANY);
+        btree_insert(&btree, &var1.key, &var1.node);
+        ASSERT_BTREE(btree, NUM_MANY);
+        assert(btree_at(&btree, (size_t) var1.key) == &var1.node);
+        assert(var1.num_similar_keys == 1);
+        ASSERT_PROPERTIES(btree);
+        reset_globals();
+    }
+
+    for (i = 0; i < NUM_MANY; ++i) {
+        btree_insert(&btree, &many[i].key, &many[i].node);
+        ASSERT_PROPERTIES(btree);
+    }
+    ASSERT_BTREE(btree, NUM_MANY);
+}
+
+void test_btree_lookup_key(void) {
+    int key = 8;
+    size_t i;
+
+    assert(btree_lookup_key(&btree, &var1.key) == NULL);
+    FILL_SEQUENTIALLY(btree);
+    assert(btree_lookup_key(&btree, &var1.key) == &var1.node);
+    assert(btree_lookup_key(&btree, &var2.key) == &var2.node);
+    assert(btree_lookup_key(&btree, &var3.key) == &var3.node);
+    assert(btree_lookup_key(&btree, &var4.key) == &var4.node);
+    assert(btree_lookup_key(&btree, &var5.key) == &var5.node);
+    assert(btree_lookup_key(&btree, &var6.key) == &var6.node);
+    assert(btree_lookup_key(&btree, &var7.key) == &var7.node);
+    assert(btree_lookup_key(&btree, &key) == NULL);
+    reset_globals();
+
+    loop {
+        FILL_MANY_RANDOMLY(btree);
+        for (i = 0; i < NUM_MANY; ++i) {
+            assert(btree_lookup_key(&btree, &many[i].key) == &many[i].node);
+        }
+        reset_globals();
+    }
+}
+
+void test_btree_lower_bound(void) {
+    int key = 0;
+    size_t i;
+
+    assert(btree_lower_bound(&btree, &key) == NULL);
+    btree_insert(&btree, &var2.key, &var2.node);
+    btree_insert(&btree, &var4.key, &var4.node);
+    btree_insert(&btree, &var6.key, &var6.node);
+    assert(btree_lower_bound(&btree, &key) == &var2.node);
+    key = 2;
+    assert(btree_lower_bound(&btree, &key) == &var2.node);
+    key = 3;
+    assert(btree_lower_bound(&btree, &key) == &var4.node);
+    key = 6;
+    assert(btree_lower_bound(&btree, &key) == &var6.node);
+    key = 7;
+    assert(btree_lower_bound(&btree, &key) == NULL);
+    reset_globals();
+
+    /* Only the even keys are inserted, so every odd key is bounded by the following even key. */
+    for (i = 0; i < NUM_MANY; ++i) {
+        many[i].key = 2 * (int) i;
+        btree_insert(&btree, &many[i].key, &many[i].node);
+    }
+    ASSERT_PROPERTIES(btree);
+
+    for (key = -1; key < 2 * NUM_MANY; ++key) {
+        BTreeNode *n = btree_lower_bound(&btree, &key);
+
+        if (key > 2 * (NUM_MANY - 1)) {
+            assert(n == NULL);
+        } else {
+            assert(key_of_(n) == (key < 0 ? 0 : key + key % 2));
+        }
+    }
+}
+
+void test_btree_upper_bound(void) {
+    int key = 0;
+    size_t i;
+
+    assert(btree_upper_bound(&btree, &key) == NULL);
+    btree_insert(&btree, &var2.key, &var2.node);
+    btree_insert(&btree, &var4.key, &var4.node);
+    btree_insert(&btree, &var6.key, &var6.node);
+    assert(btree_upper_bound(&btree, &key) == &var2.node);
+    key = 2;
+    assert(btree_upper_bound(&btree, &key) == &var4.node);
+    key = 3;
+    assert(btree_upper_bound(&btree, &key) == &var4.node);
+    key = 6;
+    assert(btree_upper_bound(&btree, &key) == NULL);
+    reset_globals();
+
+    for (i = 0; i < NUM_MANY; ++i) {
+        many[i].key = 2 * (int) i;
+        btree_insert(&btree, &many[i].key, &many[i].node);
+    }
+    ASSERT_PROPERTIES(btree);
+
+    for (key = -1; key < 2 * NUM_MANY; ++key) {
+        BTreeNode *n = btree_upper_bound(&btree, &key);
+
+        if (key >= 2 * (NUM_MANY - 1)) {
+            assert(n == NULL);
+        } else {
+            assert(key_of_(n) == (key < 0 ? 0 : key + 2 - key % 2));
+        }
+    }
+}
+
+void test_btree_remove(void) {
+    size_t i;
+
+    btree_remove(&btree, NULL);
+    ASSERT_BTREE(btree, 0);
+
+    btree_insert(&btree, &var1.key, &var1.node);
+    btree_remove(&btree, &var1.node);
+    ASSERT_BTREE(btree, 0);
+    assert(var1.node.page == BTREE_POISON_PAGE);
+    ASSERT_PROPERTIES(btree);
+
+    FILL_SEQUENTIALLY(btree);
+    btree_remove(&btree, &var4.node);
+    ASSERT_BTREE(btree, 6);
+    assert(var4.node.page == BTREE_POISON_PAGE);
+    assert(btree_next(&var3.node) == &var5.node);
+    ASSERT_PROPERTIES(btree);
+    btree_remove(&btree, &var1.node);
+    btree_remove(&btree, &var7.node);
+    ASSERT_BTREE(btree, 4);
+    assert(btree_first(&btree) == &var2.node);
+    assert(btree_last(&btree) == &var6.node);
+    ASSERT_PROPERTIES(btree);
+    reset_globals();
+
+    /* Every removal order exercises borrowing from both siblings and merging on every level. */
+    loop {
+        FILL_MANY_RANDOMLY(btree);
+
+        for (i = 0; i < NUM_MANY; ++i) {
+            btree_remove(&btree, &many[i].node);
+            assert(many[i].node.page == BTREE_POISON_PAGE);
+
+            if (i % 50 == 0) {
+                ASSERT_PROPERTIES(btree);
+            }
+        }
+
+        ASSERT_BTREE(btree, 0);
+        ASSERT_PROPERTIES(btree);
+        reset_globals();
+    }
+
+    for (i = 0; i < NUM_MANY; ++i) {
+        btree_insert(&btree, &many[i].key, &many[i].node);
+    }
+
+    for (i = 0; i < NUM_MANY; ++i) {
+        btree_remove(&btree, &many[(i * 7) % NUM_MANY].node);
+        ASSERT_PROPERTIES(btree);
+    }
+
+    ASSERT_BTREE(btree, 0);
+}
+
+void test_btree_remove_key(void) {
+    int key = 8;
+    size_t i;
+
+    btree_remove_key(&btree, &key);
+    ASSERT_BTREE(btree, 0);
+
+    FILL_SEQUENTIALLY(btree);
+    btree_remove_key(&btree, &key);
+    ASSERT_BTREE(btree, 7);
+    btree_remove_key(&btree, &var2.key);
+    ASSERT_BTREE(btree, 6);
+    assert(!btree_contains_key(&btree, &var2.key));
+    assert(var2.node.page == BTREE_POISON_PAGE);
+    ASSERT_PROPERTIES(btree);
+    reset_globals();
+
+    loop {
+        FILL_MANY_RANDOMLY(btree);
+
+        for (i = 0; i < NUM_MANY; i += 2) {
+            key = (int) i;
+            btree_remove_key(&btree, &key);
+        }
+
+        ASSERT_BTREE(btree, NUM_MANY / 2);
+        ASSERT_PROPERTIES(btree);
+
+        for (i = 0; i < NUM_MANY; ++i) {
+            key = (int) i;
+            assert(btree_contains_key(&btree, &key) == (int) (i % 2));
+        }
+
+        reset_globals();
+    }
+}
+
+void test_btree_remove_first(void) {
+    size_t i;
+
+    btree_remove_first(&btree);
+    ASSERT_BTREE(btree, 0);
+
+    FILL_SEQUENTIALLY(btree);
+    btree_remove_first(&btree);
+    ASSERT_BTREE(btree, 6);
+    assert(btree_first(&btree) == &var2.node);
+    assert(var1.node.page == BTREE_POISON_PAGE);
+    ASSERT_PROPERTIES(btree);
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    for (i = 0; i < NUM_MANY; ++i) {
+        assert(key_of_(btree_first(&btree)) == (int) i);
+        btree_remove_first(&btree);
+        ASSERT_PROPERTIES(btree);
+    }
+    ASSERT_BTREE(btree, 0);
+}
+
+void test_btree_remove_last(void) {
+    size_t i;
+
+    btree_remove_last(&btree);
+    ASSERT_BTREE(btree, 0);
+
+    FILL_SEQUENTIALLY(btree);
+    btree_remove_last(&btree);
+    ASSERT_BTREE(btree, 6);
+    assert(btree_last(&btree) == &var6.node);
+    assert(var7.node.page == BTREE_POISON_PAGE);
+    ASSERT_PROPERTIES(btree);
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    for (i = NUM_MANY; i > 0; --i) {
+        assert(key_of_(btree_last(&btree)) == (int) i - 1);
+        btree_remove_last(&btree);
+        ASSERT_PROPERTIES(btree);
+    }
+    ASSERT_BTREE(btree, 0);
+}
+
+void test_btree_remove_all(void) {
+    btree_remove_all(&btree);
+    ASSERT_BTREE(btree, 0);
+    ASSERT_PROPERTIES(btree);
+
+    FILL_SEQUENTIALLY(btree);
+    btree_remove_all(&btree);
+    ASSERT_BTREE(btree, 0);
+    assert(btree_num_free_pages(&btree) == NUM_PAGES);
+    ASSERT_PROPERTIES(btree);
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    btree_remove_all(&btree);
+    ASSERT_BTREE(btree, 0);
+    assert(btree_num_free_pages(&btree) == NUM_PAGES);
+    ASSERT_PROPERTIES(btree);
+
+    /* The BTreePage's are reusable afterwards. */
+    FILL_MANY_RANDOMLY(btree);
+    ASSERT_BTREE(btree, NUM_MANY);
+}
+
+void test_btree_entry(void) {
+    btree_insert(&btree, &var1.key, &var1.node);
+    assert(btree_entry(btree_first(&btree), TestStruct, node) == &var1);
+    assert(btree_entry(&var2.node, TestStruct, node) == &var2);
+}
+
+void test_btree_for_each(void) {
+    BTreeNode *n;
+    size_t index = 0;
+
+    btree_for_each(n, &btree) {
+        assert(0);
+    }
+
+    FILL_SEQUENTIALLY_REVERSE(btree);
+    btree_for_each(n, &btree) {
+        assert(key_of_(n) == (int) index + 1);
+        ++index;
+    }
+    assert(index == 7);
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    index = 0;
+    btree_for_each(n, &btree) {
+        assert(key_of_(n) == (int) index);
+        ++index;
+    }
+    assert(index == NUM_MANY);
+}
+
+void test_btree_for_each_reverse(void) {
+    BTreeNode *n;
+    size_t index = 7;
+
+    btree_for_each_reverse(n, &btree) {
+        assert(0);
+    }
+
+    FILL_SEQUENTIALLY(btree);
+    btree_for_each_reverse(n, &btree) {
+        assert(key_of_(n) == (int) index);
+        --index;
+    }
+    assert(index == 0);
+    reset_globals();
+
+    FILL_MANY_RANDOMLY(btree);
+    index = NUM_MANY;
+    btree_for_each_reverse(n, &btree) {
+        --index;
+        assert(key_of_(n) == (int) index);
+    }
+    assert(index == 0);
+}
+
+void test_btree_for_each_safe(void) {
+    BTreeNode *n, *backup;
+    size_t index = 0;
+
+    btree_for_each_safe(n, backup, &btree) {
+        assert(0);
+    }
+
+    FILL_SEQUENTIALLY(btree);
+    btree_for_each_safe(n, backup, &btree) {
+        assert(key_of_(n) == (int) index + 1);
+        btree_remove(&btree, n);
+        ++index;
+    }
+    assert(index == 7);
+    ASSERT_BTREE(btree, 0);
+    reset_globals();
+
+    /* Removing every other BTreeNode moves the remaining ones around, which must not disturb the iteration. */
+    FILL_MANY_RANDOMLY(btree);
+    index = 0;
+    btree_for_each_safe(n, backup, &btree) {
+        assert(key_of_(n) == (int) index);
+
+        if (index % 2 == 0) {
+            btree_remove(&btree, n);
+        }
+
+        ++index;
+    }
+    assert(index == NUM_MANY);
+    ASSERT_BTREE(btree, NUM_MANY / 2);
+    ASSERT_PROPERTIES(btree);
+}
+
+TestFunc test_funcs[] = {
+    test_btree_init,
+    test_btree_set_key_prefix,
+    test_btree_first,
+    test_btree_last,
+    test_btree_prev,
+    test_btree_next,
+    test_btree_size,
+    test_btree_empty,
+    test_btree_contains_key,
+    test_btree_num_free_pages,
+    test_btree_index_of,
+    test_btree_at,
+    test_btree_insert,
+    test_btree_lookup_key,
+    test_btree_lower_bound,
+    test_btree_upper_bound,
+    test_btree_remove,
+    test_btree_remove_key,
+    test_btree_remove_first,
+    test_btree_remove_last,
+    test_btree_remove_all,
+    test_btree_entry,
+    test_btree_for_each,
+    test_btree_for_each_reverse,
+    test_btree_for_each_safe
+};
+
+int main(int argc, char *argv[]) {
+    char msg[100] = "BTree ";
+    assert(argc == 2);
+    strcat(msg, argv[1]);
+
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 25);
+    run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
+
+    return 0;
+}
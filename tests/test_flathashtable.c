@@ -0,0 +1,595 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+
+#include "testing_framework.h"
+
+/* Test header guard. */
+#include "../src/flathashtable.h"
+#include "../src/flathashtable.h"
+
+/* ========================================================================================================
+ *
+ *                                             TESTING UTILITIES
+ *
+ * ======================================================================================================== */
+
+#define NUM_GROUPS 3
+#define NUM_MANY (NUM_GROUPS * FLATHASHTABLE_GROUP_SIZE)
+
+typedef struct TestStruct {
+    int key;
+    int num_similar_keys;
+    FlatHashTableNode node;
+} TestStruct;
+
+TestStruct var1, var2, var3, var4, var5, var6;
+TestStruct many[NUM_MANY];
+FlatHashTable flathashtable;
+FlatHashTableGroup grp_arr[NUM_GROUPS];
+size_t counter;
+void *aux_ptr;
+
+#define ASSERT_FLATHASHTABLE(flathashtable, size_of_flathashtable) \
+    do { \
+        size_t i, num_occupied = 0; \
+        \
+        assert(flathashtable.size == size_of_flathashtable); \
+        \
+        for (i = 0; i < NUM_GROUPS * FLATHASHTABLE_GROUP_SIZE; ++i) { \
+            if (flathashtable_slot(&flathashtable, i)) { \
+                ++num_occupied; \
+            } \
+        } \
+        \
+        assert(num_occupied == size_of_flathashtable); \
+    } while (0)
+
+#define ASSERT_GROUP_ARRAY_CLEARED() \
+    do { \
+        size_t i, j; \
+        for (i = 0; i < NUM_GROUPS; ++i) { \
+            for (j = 0; j < FLATHASHTABLE_GROUP_SIZE; ++j) { \
+                assert(grp_arr[i].tags[j] == 0); \
+            } \
+            assert(grp_arr[i].overflow == 0); \
+        } \
+    } while (0)
+
+#define FLATHASHTABLE_REMOVE_KEY_BY_NODE(flathashtable_ptr, node_ptr) \
+    flathashtable_remove_key(flathashtable_ptr, &flathashtable_entry(node_ptr, TestStruct, node)->key)
+
+#define POISON_GROUP_ARRAY() \
+    memset(grp_arr, 0xAB, sizeof(grp_arr))
+
+#define CLEAR_GROUP_ARRAY() \
+    memset(grp_arr, 0, sizeof(grp_arr))
+
+#define FILL(flathashtable) \
+    do { \
+        flathashtable_insert(&flathashtable, &var2.key, &var2.node); \
+        flathashtable_insert(&flathashtable, &var1.key, &var1.node); \
+        flathashtable_insert(&flathashtable, &var4.key, &var4.node); \
+        flathashtable_insert(&flathashtable, &var3.key, &var3.node); \
+        flathashtable_insert(&flathashtable, &var6.key, &var6.node); \
+        flathashtable_insert(&flathashtable, &var5.key, &var5.node); \
+    } while (0)
+
+#define FILL_RANDOMLY(flathashtable) \
+    { \
+        int vars_used[6] = { 0, 0, 0, 0, 0, 0 }; \
+        \
+        while ( \
+            !vars_used[0] || \
+            !vars_used[1] || \
+            !vars_used[2] || \
+            !vars_used[3] || \
+            !vars_used[4] || \
+            !vars_used[5] \
+        ) { \
+            int x = rand() % 6; \
+            \
+            while (vars_used[x]) { \
+                x = rand() % 6; \
+            } \
+            \
+            vars_used[x] = 1; \
+            \
+            switch (x + 1) { \
+                case 1: \
+                    flathashtable_insert(&flathashtable, &var1.key, &var1.node); \
+                    break; \
+                case 2: \
+                    flathashtable_insert(&flathashtable, &var2.key, &var2.node); \
+                    break; \
+                case 3: \
+                    flathashtable_insert(&flathashtable, &var3.key, &var3.node); \
+                    break; \
+                case 4: \
+                    flathashtable_insert(&flathashtable, &var4.key, &var4.node); \
+                    break; \
+                case 5: \
+                    flathashtable_insert(&flathashtable, &var5.key, &var5.node); \
+                    break; \
+                case 6: \
+                    flathashtable_insert(&flathashtable, &var6.key, &var6.node); \
+                    break; \
+                default: \
+                    assert(0); \
+            } \
+        } \
+    }
+
+#define DRAIN_RANDOMLY(flathashtable) \
+    { \
+        int vars_used[6] = { 0, 0, 0, 0, 0, 0 }; \
+        \
+        while ( \
+            !vars_used[0] || \
+            !vars_used[1] || \
+            !vars_used[2] || \
+            !vars_used[3] || \
+            !vars_used[4] || \
+            !vars_used[5] \
+        ) { \
+            int x = rand() % 6; \
+            \
+            while (vars_used[x]) { \
+                x = rand() % 6; \
+            } \
+            \
+            vars_used[x] = 1; \
+            \
+            switch (x + 1) { \
+                case 1: \
+                    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var1.node); \
+                    break; \
+                case 2: \
+                    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var2.node); \
+                    break; \
+                case 3: \
+                    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var3.node); \
+                    break; \
+                case 4: \
+                    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var4.node); \
+                    break; \
+                case 5: \
+                    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var5.node); \
+                    break; \
+                case 6: \
+                    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var6.node); \
+                    break; \
+                default: \
+                    assert(0); \
+            } \
+        } \
+    }
+
+#define loop \
+    for (counter = 0; counter < 700; ++counter)
+
+/* Every key hashes to the first group, so that groups overflow quickly. */
+static size_t hash_func(const void *key) {
+    return (size_t) *(const int*) key * NUM_GROUPS;
+}
+
+/* Every key hashes to the last group, so that probing wraps around. */
+static size_t last_group_hash_func(const void *key) {
+    return (size_t) *(const int*) key * NUM_GROUPS + NUM_GROUPS - 1;
+}
+
+static int equal_func(const void *key, const FlatHashTableNode *node) {
+    return *(const int*)key == flathashtable_entry(node, TestStruct, node)->key;
+}
+
+static void collide_func(const FlatHashTableNode *old_node, const FlatHashTableNode *new_node, void *auxiliary_data) {
+    assert((void**) auxiliary_data == &aux_ptr);
+
+    flathashtable_entry(new_node, TestStruct, node)->num_similar_keys +=
+        1 + flathashtable_entry(old_node, TestStruct, node)->num_similar_keys;
+}
+
+static void reset_globals(void) {
+    size_t i;
+
+    flathashtable_init(&flathashtable, grp_arr, NUM_GROUPS, hash_func, equal_func, collide_func, &aux_ptr);
+
+    var1.key = 1;
+    var1.num_similar_keys = 0;
+
+    var2.key = 2;
+    var2.num_similar_keys = 0;
+
+    var3.key = 3;
+    var3.num_similar_keys = 0;
+
+    var4.key = 4;
+    var4.num_similar_keys = 0;
+
+    var5.key = 5;
+    var5.num_similar_keys = 0;
+
+    var6.key = 6;
+    var6.num_similar_keys = 0;
+
+    for (i = 0; i < NUM_MANY; ++i) {
+        many[i].key = (int) i + 100;
+        many[i].num_similar_keys = 0;
+    }
+}
+
+/* ========================================================================================================
+ *
+ *                                             TESTING FUNCTIONS
+ *
+ * ======================================================================================================== */
+
+void test_flathashtable_init(void) {
+    FlatHashTableNode node_init_with_macro = FLATHASHTABLE_NODE_INIT;
+    assert(node_init_with_macro.hash == 0);
+
+    POISON_GROUP_ARRAY();
+    flathashtable_init(&flathashtable, grp_arr, NUM_GROUPS, hash_func, equal_func, collide_func, &aux_ptr);
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+    ASSERT_GROUP_ARRAY_CLEARED();
+    assert(flathashtable.group_array == grp_arr);
+    assert(flathashtable.num_groups == NUM_GROUPS);
+    assert(flathashtable.hash == hash_func);
+    assert(flathashtable.equal == equal_func);
+    assert(flathashtable.collide == collide_func);
+    assert((void**) flathashtable.auxiliary_data == &aux_ptr);
+    POISON_GROUP_ARRAY();
+    flathashtable_init(&flathashtable, grp_arr, NUM_GROUPS, hash_func, equal_func, NULL, NULL);
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+    ASSERT_GROUP_ARRAY_CLEARED();
+    assert(flathashtable.collide == NULL);
+    assert(flathashtable.auxiliary_data == NULL);
+}
+
+void test_flathashtable_fast_init(void) {
+    CLEAR_GROUP_ARRAY();
+    flathashtable_fast_init(&flathashtable, grp_arr, NUM_GROUPS, hash_func, equal_func, collide_func, &aux_ptr);
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+    ASSERT_GROUP_ARRAY_CLEARED();
+    assert(flathashtable.group_array == grp_arr);
+    assert(flathashtable.num_groups == NUM_GROUPS);
+    assert(flathashtable.hash == hash_func);
+    assert(flathashtable.equal == equal_func);
+    assert(flathashtable.collide == collide_func);
+    assert((void**) flathashtable.auxiliary_data == &aux_ptr);
+    CLEAR_GROUP_ARRAY();
+    flathashtable_fast_init(&flathashtable, grp_arr, NUM_GROUPS, hash_func, equal_func, NULL, NULL);
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+    assert(flathashtable.collide == NULL);
+    assert(flathashtable.auxiliary_data == NULL);
+}
+
+void test_flathashtable_group_array(void) {
+    assert(flathashtable_group_array(&flathashtable) == grp_arr);
+}
+
+void test_flathashtable_num_groups(void) {
+    assert(flathashtable_num_groups(&flathashtable) == NUM_GROUPS);
+    flathashtable_init(&flathashtable, grp_arr, 1, hash_func, equal_func, NULL, NULL);
+    assert(flathashtable_num_groups(&flathashtable) == 1);
+}
+
+void test_flathashtable_capacity(void) {
+    assert(flathashtable_capacity(&flathashtable) == NUM_MANY);
+    flathashtable_init(&flathashtable, grp_arr, 1, hash_func, equal_func, NULL, NULL);
+    assert(flathashtable_capacity(&flathashtable) == FLATHASHTABLE_GROUP_SIZE);
+}
+
+void test_flathashtable_size(void) {
+    assert(flathashtable_size(&flathashtable) == 0);
+    flathashtable_insert(&flathashtable, &var1.key, &var1.node);
+    assert(flathashtable_size(&flathashtable) == 1);
+    flathashtable_insert(&flathashtable, &var2.key, &var2.node);
+    assert(flathashtable_size(&flathashtable) == 2);
+    flathashtable_insert(&flathashtable, &var2.key, &var2.node);
+    assert(flathashtable_size(&flathashtable) == 2);
+    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var1.node);
+    assert(flathashtable_size(&flathashtable) == 1);
+    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var1.node);
+    assert(flathashtable_size(&flathashtable) == 1);
+    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var2.node);
+    assert(flathashtable_size(&flathashtable) == 0);
+}
+
+void test_flathashtable_empty(void) {
+    assert(flathashtable_empty(&flathashtable));
+    flathashtable_insert(&flathashtable, &var1.key, &var1.node);
+    assert(!flathashtable_empty(&flathashtable));
+    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var1.node);
+    assert(flathashtable_empty(&flathashtable));
+}
+
+void test_flathashtable_contains_key(void) {
+    int key = 7;
+
+    assert(!flathashtable_contains_key(&flathashtable, &var1.key));
+    FILL(flathashtable);
+    assert(flathashtable_contains_key(&flathashtable, &var1.key));
+    assert(flathashtable_contains_key(&flathashtable, &var2.key));
+    assert(flathashtable_contains_key(&flathashtable, &var3.key));
+    assert(flathashtable_contains_key(&flathashtable, &var4.key));
+    assert(flathashtable_contains_key(&flathashtable, &var5.key));
+    assert(flathashtable_contains_key(&flathashtable, &var6.key));
+    assert(!flathashtable_contains_key(&flathashtable, &key));
+    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var3.node);
+    assert(!flathashtable_contains_key(&flathashtable, &var3.key));
+}
+
+void test_flathashtable_insert(void) {
+    TestStruct other;
+
+    /* Into an empty table. */
+    flathashtable_insert(&flathashtable, &var1.key, &var1.node);
+    ASSERT_FLATHASHTABLE(flathashtable, 1);
+    assert(var1.node.hash == hash_func(&var1.key));
+    assert(grp_arr[0].slots[0] == &var1.node);
+    assert(grp_arr[0].tags[0] & 0x80);
+    reset_globals();
+
+    /* Key collisions replace the old node in its slot. */
+    FILL(flathashtable);
+    other.key = 4;
+    other.num_similar_keys = 0;
+    flathashtable_insert(&flathashtable, &other.key, &other.node);
+    ASSERT_FLATHASHTABLE(flathashtable, 6);
+    assert(flathashtable_lookup_key(&flathashtable, &other.key) == &other.node);
+    assert(other.num_similar_keys == 1);
+    flathashtable_insert(&flathashtable, &var4.key, &var4.node);
+    ASSERT_FLATHASHTABLE(flathashtable, 6);
+    assert(flathashtable_lookup_key(&flathashtable, &var4.key) == &var4.node);
+    assert(var4.num_similar_keys == 2);
+    reset_globals();
+
+    /* Without a collide function. */
+    flathashtable_init(&flathashtable, grp_arr, NUM_GROUPS, hash_func, equal_func, NULL, NULL);
+    FILL(flathashtable);
+    other.key = 4;
+    other.num_similar_keys = 0;
+    flathashtable_insert(&flathashtable, &other.key, &other.node);
+    ASSERT_FLATHASHTABLE(flathashtable, 6);
+    assert(flathashtable_lookup_key(&flathashtable, &other.key) == &other.node);
+    assert(other.num_similar_keys == 0);
+    reset_globals();
+
+    /* Random order. */
+    loop {
+        FILL_RANDOMLY(flathashtable);
+        ASSERT_FLATHASHTABLE(flathashtable, 6);
+        assert(flathashtable_lookup_key(&flathashtable, &var1.key) == &var1.node);
+        assert(flathashtable_lookup_key(&flathashtable, &var6.key) == &var6.node);
+        reset_globals();
+    }
+}
+
+void test_flathashtable_lookup_key(void) {
+    int key = 0;
+
+    assert(flathashtable_lookup_key(&flathashtable, &var1.key) == NULL);
+    FILL(flathashtable);
+    assert(flathashtable_lookup_key(&flathashtable, &var1.key) == &var1.node);
+    assert(flathashtable_lookup_key(&flathashtable, &var2.key) == &var2.node);
+    assert(flathashtable_lookup_key(&flathashtable, &var3.key) == &var3.node);
+    assert(flathashtable_lookup_key(&flathashtable, &var4.key) == &var4.node);
+    assert(flathashtable_lookup_key(&flathashtable, &var5.key) == &var5.node);
+    assert(flathashtable_lookup_key(&flathashtable, &var6.key) == &var6.node);
+    assert(flathashtable_lookup_key(&flathashtable, &key) == NULL);
+}
+
+void test_flathashtable_remove_key(void) {
+    int key = 0;
+
+    flathashtable_remove_key(&flathashtable, &key);
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+
+    FILL(flathashtable);
+    flathashtable_remove_key(&flathashtable, &key);
+    ASSERT_FLATHASHTABLE(flathashtable, 6);
+    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var3.node);
+    ASSERT_FLATHASHTABLE(flathashtable, 5);
+    assert(flathashtable_lookup_key(&flathashtable, &var3.key) == NULL);
+    assert(flathashtable_lookup_key(&flathashtable, &var4.key) == &var4.node);
+
+    /* The freed slot is reused. */
+    flathashtable_insert(&flathashtable, &var3.key, &var3.node);
+    ASSERT_FLATHASHTABLE(flathashtable, 6);
+    assert(flathashtable_lookup_key(&flathashtable, &var3.key) == &var3.node);
+    reset_globals();
+
+    loop {
+        FILL_RANDOMLY(flathashtable);
+        DRAIN_RANDOMLY(flathashtable);
+        ASSERT_FLATHASHTABLE(flathashtable, 0);
+        ASSERT_GROUP_ARRAY_CLEARED();
+        reset_globals();
+    }
+}
+
+void test_flathashtable_remove_all(void) {
+    flathashtable_remove_all(&flathashtable);
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+
+    FILL(flathashtable);
+    flathashtable_remove_all(&flathashtable);
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+    ASSERT_GROUP_ARRAY_CLEARED();
+    assert(flathashtable_lookup_key(&flathashtable, &var1.key) == NULL);
+}
+
+void test_flathashtable_overflow(void) {
+    size_t i;
+
+    /* Every key hashes to the first group, so the later nodes overflow into the following groups. */
+    for (i = 0; i < NUM_MANY; ++i) {
+        flathashtable_insert(&flathashtable, &many[i].key, &many[i].node);
+    }
+    ASSERT_FLATHASHTABLE(flathashtable, NUM_MANY);
+    assert(grp_arr[0].overflow == 2 * FLATHASHTABLE_GROUP_SIZE);
+    assert(grp_arr[1].overflow == FLATHASHTABLE_GROUP_SIZE);
+    assert(grp_arr[2].overflow == 0);
+    for (i = 0; i < NUM_MANY; ++i) {
+        assert(flathashtable_lookup_key(&flathashtable, &many[i].key) == &many[i].node);
+    }
+    assert(!flathashtable_contains_key(&flathashtable, &var1.key));
+
+    /* Replacing a node in a later group does not change the overflow counters. */
+    flathashtable_insert(&flathashtable, &many[NUM_MANY - 1].key, &many[NUM_MANY - 1].node);
+    ASSERT_FLATHASHTABLE(flathashtable, NUM_MANY);
+    assert(grp_arr[0].overflow == 2 * FLATHASHTABLE_GROUP_SIZE);
+    assert(many[NUM_MANY - 1].num_similar_keys == 1);
+
+    /* Removing nodes from the first group keeps the other nodes reachable. */
+    for (i = 0; i < FLATHASHTABLE_GROUP_SIZE; ++i) {
+        FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &many[i].node);
+    }
+    ASSERT_FLATHASHTABLE(flathashtable, NUM_MANY - FLATHASHTABLE_GROUP_SIZE);
+    assert(grp_arr[0].overflow == 2 * FLATHASHTABLE_GROUP_SIZE);
+    for (i = FLATHASHTABLE_GROUP_SIZE; i < NUM_MANY; ++i) {
+        assert(flathashtable_lookup_key(&flathashtable, &many[i].key) == &many[i].node);
+    }
+
+    /* Removing the overflowed nodes undoes the overflow counters. */
+    for (i = FLATHASHTABLE_GROUP_SIZE; i < NUM_MANY; ++i) {
+        FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &many[i].node);
+    }
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+    ASSERT_GROUP_ARRAY_CLEARED();
+    reset_globals();
+
+    /* Probing wraps around to the first group. */
+    flathashtable.hash = last_group_hash_func;
+    for (i = 0; i < FLATHASHTABLE_GROUP_SIZE + 1; ++i) {
+        flathashtable_insert(&flathashtable, &many[i].key, &many[i].node);
+    }
+    ASSERT_FLATHASHTABLE(flathashtable, FLATHASHTABLE_GROUP_SIZE + 1);
+    assert(grp_arr[NUM_GROUPS - 1].overflow == 1);
+    assert(grp_arr[0].overflow == 0);
+    assert(grp_arr[0].slots[0] == &many[FLATHASHTABLE_GROUP_SIZE].node);
+    for (i = 0; i < FLATHASHTABLE_GROUP_SIZE + 1; ++i) {
+        assert(flathashtable_lookup_key(&flathashtable, &many[i].key) == &many[i].node);
+    }
+    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &many[FLATHASHTABLE_GROUP_SIZE].node);
+    assert(grp_arr[NUM_GROUPS - 1].overflow == 0);
+    assert(flathashtable_lookup_key(&flathashtable, &many[FLATHASHTABLE_GROUP_SIZE].key) == NULL);
+    reset_globals();
+
+    /* A completely full table still finds every key and rejects missing keys. */
+    flathashtable_init(&flathashtable, grp_arr, 1, hash_func, equal_func, NULL, NULL);
+    for (i = 0; i < FLATHASHTABLE_GROUP_SIZE; ++i) {
+        flathashtable_insert(&flathashtable, &many[i].key, &many[i].node);
+    }
+    assert(flathashtable_size(&flathashtable) == flathashtable_capacity(&flathashtable));
+    assert(grp_arr[0].overflow == 0);
+    for (i = 0; i < FLATHASHTABLE_GROUP_SIZE; ++i) {
+        assert(flathashtable_lookup_key(&flathashtable, &many[i].key) == &many[i].node);
+    }
+    assert(flathashtable_lookup_key(&flathashtable, &var1.key) == NULL);
+}
+
+void test_flathashtable_entry(void) {
+    assert(flathashtable_entry(&var1.node, TestStruct, node) == &var1);
+}
+
+void test_flathashtable_slot(void) {
+    size_t i;
+
+    for (i = 0; i < NUM_MANY; ++i) {
+        assert(flathashtable_slot(&flathashtable, i) == NULL);
+    }
+    flathashtable_insert(&flathashtable, &var1.key, &var1.node);
+    flathashtable_insert(&flathashtable, &var2.key, &var2.node);
+    assert(flathashtable_slot(&flathashtable, 0) == &var1.node);
+    assert(flathashtable_slot(&flathashtable, 1) == &var2.node);
+    assert(flathashtable_slot(&flathashtable, 2) == NULL);
+    FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, &var1.node);
+    assert(flathashtable_slot(&flathashtable, 0) == NULL);
+    assert(flathashtable_slot(&flathashtable, 1) == &var2.node);
+}
+
+void test_flathashtable_for_each(void) {
+    FlatHashTableNode *n;
+    size_t i, slot;
+    int sum;
+
+    i = 0;
+    flathashtable_for_each(n, slot, &flathashtable) {
+        ++i;
+    }
+    assert(i == 0);
+
+    FILL(flathashtable);
+    i = 0;
+    sum = 0;
+    flathashtable_for_each(n, slot, &flathashtable) {
+        assert(n == flathashtable_slot(&flathashtable, slot));
+        sum += flathashtable_entry(n, TestStruct, node)->key;
+        ++i;
+    }
+    assert(i == 6);
+    assert(sum == 1 + 2 + 3 + 4 + 5 + 6);
+
+    /* Removing the cursor is safe. */
+    i = 0;
+    flathashtable_for_each(n, slot, &flathashtable) {
+        FLATHASHTABLE_REMOVE_KEY_BY_NODE(&flathashtable, n);
+        ++i;
+    }
+    assert(i == 6);
+    ASSERT_FLATHASHTABLE(flathashtable, 0);
+    ASSERT_GROUP_ARRAY_CLEARED();
+}
+
+TestFunc test_funcs[] = {
+    test_flathashtable_init,
+    test_flathashtable_fast_init,
+    test_flathashtable_group_array,
+    test_flathashtable_num_groups,
+    test_flathashtable_capacity,
+    test_flathashtable_size,
+    test_flathashtable_empty,
+    test_flathashtable_contains_key,
+    test_flathashtable_insert,
+    test_flathashtable_lookup_key,
+    test_flathashtable_remove_key,
+    test_flathashtable_remove_all,
+    test_flathashtable_overflow,
+    test_flathashtable_entry,
+    test_flathashtable_slot,
+    test_flathashtable_for_each
+};
+
+int main(int argc, char *argv[]) {
+    char msg[100] = "FlatHashTable ";
+    assert(argc == 2);
+    strcat(msg, argv[1]);
+
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 16);
+    run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
+
+    return 0;
+}
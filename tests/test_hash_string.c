@@ -16,6 +16,7 @@ NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
 CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stddef.h>
@@ -39,6 +40,15 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define ASSERT_HASH_STRING(string, hashcode) \
     assert(hash_string(string) == hashcode##ul)
 
+#define ASSERT_HASH_BYTES(string, hashcode, seeded_hashcode) \
+    do { \
+        assert(hash_bytes(string, strlen(string)) == hashcode##ul); \
+        assert(hash_bytes_seeded(string, strlen(string), 12345) == seeded_hashcode##ul); \
+    } while (0)
+
+#define RANDOM_CHARACTER() \
+    ("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz;:[]{}-=_+!@#$^&*()~`"[rand() % 73])
+
 
 static size_t mirror_hash_string(const char *str) {
     size_t hash = 5381;
@@ -97,9 +107,103 @@ void test_hash_string(void) {
     }
 }
 
+void test_hash_string_fast(void) {
+    HashTable hashtable;
+    HashTableNode *bkt_arr[1];
+    size_t counter;
+
+    hashtable_init(&hashtable, bkt_arr, 1, hash_string_fast, dummy_equal_func, NULL, NULL);
+
+    assert(hash_string_fast("") == hash_bytes("", 0));
+    assert(hash_string_fast("abcde") == hash_bytes("abcde", 5));
+    assert(hash_string_fast("abcde") != hash_string_fast("abcdf"));
+
+    for (counter = 0; counter < 5000; ++counter) {
+        char str[100];
+        size_t i, length = (size_t) rand() % 100;
+
+        for (i = 0; i < length; ++i) {
+            str[i] = RANDOM_CHARACTER();
+        }
+        str[length] = '\0';
+
+        assert(hash_string_fast(str) == hash_bytes(str, length));
+    }
+}
+
+void test_hash_bytes(void) {
+    unsigned char buffer[300], copy[300 + 8];
+    size_t length, offset, i;
+
+    assert(hash_bytes(NULL, 0) == hash_bytes("abc", 0));
+    assert(hash_bytes("abc", 3) == hash_bytes_seeded("abc", 3, 0));
+
+    /* Known answers guard against the native and the portable wide multiplications diverging. */
+    #if ULONG_MAX > 4294967295UL
+    ASSERT_HASH_BYTES("", 10602188539874428322, 4084291375391591528);
+    ASSERT_HASH_BYTES("a", 12460635889546412024, 7936995791486648847);
+    ASSERT_HASH_BYTES("abc", 10996464419072905673, 7282968708728567579);
+    ASSERT_HASH_BYTES("abcd", 7897792245711245547, 8536280521918660167);
+    ASSERT_HASH_BYTES("abcdefgh", 13376985359312249180, 6647891084424656813);
+    ASSERT_HASH_BYTES("0123456789abcdef", 9862382195424689045, 10778504369840406337);
+    ASSERT_HASH_BYTES("0123456789abcdefg", 1509676231324862266, 1649184256596851664);
+    ASSERT_HASH_BYTES("The quick brown fox jumps over the lazy dog", 640713871350019463, 16071528856866139369);
+    ASSERT_HASH_BYTES(
+        "The quick brown fox jumps over the lazy dog, then naps under the old oak tree!",
+        13831280986292524049,
+        15346402067569560862
+    );
+    #endif
+
+    for (i = 0; i < sizeof(buffer); ++i) {
+        buffer[i] = (unsigned char) rand();
+    }
+
+    for (length = 0; length <= sizeof(buffer); ++length) {
+        size_t hash = hash_bytes(buffer, length);
+
+        /* Only the first length bytes matter, and their alignment does not. */
+        for (offset = 0; offset < 8; ++offset) {
+            memcpy(copy + offset, buffer, length);
+            if (length < sizeof(buffer)) {
+                copy[offset + length] = (unsigned char) ~buffer[length];
+            }
+            assert(hash_bytes(copy + offset, length) == hash);
+        }
+
+        /* Every length hashes differently, and so does every single bit flip. */
+        if (length > 0) {
+            assert(hash != hash_bytes(buffer, length - 1));
+
+            for (i = 0; i < length * 8; i += 5) {
+                buffer[i / 8] ^= (unsigned char) (1 << (i % 8));
+                assert(hash_bytes(buffer, length) != hash);
+                buffer[i / 8] ^= (unsigned char) (1 << (i % 8));
+            }
+        }
+    }
+}
+
+void test_hash_bytes_seeded(void) {
+    const char *str = "send_help college_debt_high btc_addr_below:";
+    size_t length = strlen(str), seed;
+
+    assert(hash_bytes_seeded(str, length, 1) == hash_bytes_seeded(str, length, 1));
+    assert(hash_bytes_seeded(NULL, 0, 1) == hash_bytes_seeded(str, 0, 1));
+
+    for (seed = 1; seed < 1000; ++seed) {
+        assert(hash_bytes_seeded(str, length, seed) != hash_bytes_seeded(str, length, seed - 1));
+        assert(hash_bytes_seeded("", 0, seed) != hash_bytes_seeded("", 0, seed - 1));
+        assert(hash_bytes_seeded("ab", 2, seed) != hash_bytes_seeded("ab", 2, seed - 1));
+    }
+}
+
 TestFunc test_funcs[] = {
     test_hashtable_compatibility,
-    test_hash_string
+    test_hash_string,
+    test_hash_string_fast,
+    test_hash_bytes,
+    test_hash_bytes_seeded
 };
 
 int main(int argc, char *argv[]) {
@@ -107,7 +211,7 @@ int main(int argc, char *argv[]) {
     assert(argc == 2);
     strcat(msg, argv[1]);
 
-    assert(sizeof(test_funcs) / sizeof(TestFunc) == 2);
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 5);
     run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, NULL);
 
     return 0;
@@ -22,6 +22,7 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <string.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "testing_framework.h"
 
@@ -44,9 +45,27 @@ typedef struct TestStruct {
 TestStruct var1, var2, var3, var4, var5, var6;
 HashTable hashtable;
 HashTableNode *bkt_arr[3];
+HashTableNode *bkt_arr2[5];
+HashTableNode *sparse_bkt_arr[200];
+unsigned long occupancy_arr[HASHTABLE_OCCUPANCY_WORDS(200)];
+unsigned long occupancy_arr2[HASHTABLE_OCCUPANCY_WORDS(5)];
 size_t counter;
+size_t num_equal_calls;
 void *aux_ptr;
 
+ConcurrentHashTable concurrenthashtable;
+ConcurrentHashTableLock lock_arr[2];
+ConcurrentHashTableReader reader_arr[4];
+
+#define NUM_WRITERS 2
+#define NUM_READERS 2
+#define KEYS_PER_WRITER 64
+#define NUM_ROUNDS 200
+
+TestStruct stress_vars[NUM_WRITERS][KEYS_PER_WRITER];
+HashTableNode *stress_bkt_arr[7];
+int stress_done;
+
 #define ASSERT_HASHTABLE(hashtable, size_of_hashtable) \
     do { \
         size_t i; \
@@ -236,10 +255,23 @@ static size_t hash_func(const void *key) {
     return 81 + k;
 }
 
+static size_t spread_hash_func(const void *key) {
+    return ((size_t) -1 / 6 + 1) * (size_t) (*(const int*) key - 1);
+}
+
+static size_t sparse_hash_func(const void *key) {
+    return (size_t) (*(const int*) key) * 37;
+}
+
 static int equal_func(const void *key, const HashTableNode *node) {
+    ++num_equal_calls;
     return *(const int*)key == hashtable_entry(node, TestStruct, node)->key;
 }
 
+static const void* key_func(const HashTableNode *node) {
+    return &hashtable_entry(node, TestStruct, node)->key;
+}
+
 static void collide_func(const HashTableNode *old_node, const HashTableNode *new_node, void *auxiliary_data) {
     ASSERT_NODE(*old_node, HASHTABLE_POISON_NEXT);
     assert((void**) auxiliary_data == &aux_ptr);
@@ -247,8 +279,93 @@ static void collide_func(const HashTableNode *old_node, const HashTableNode *new
     hashtable_entry(new_node, TestStruct, node)->num_similar_keys += 1 + hashtable_entry(old_node, TestStruct, node)->num_similar_keys;
 }
 
+static void concurrent_collide_func(const HashTableNode *old_node, const HashTableNode *new_node, void *auxiliary_data) {
+    assert((void**) auxiliary_data == &aux_ptr);
+
+    hashtable_entry(new_node, TestStruct, node)->num_similar_keys += 1 + hashtable_entry(old_node, TestStruct, node)->num_similar_keys;
+}
+
+static size_t stress_hash_func(const void *key) {
+    return (size_t) *(const int*) key;
+}
+
+static int stress_equal_func(const void *key, const HashTableNode *node) {
+    return *(const int*) key == hashtable_entry(node, TestStruct, node)->key;
+}
+
+static void* stress_writer(void *arg) {
+    TestStruct *vars = (TestStruct*) arg;
+    int base = vars[0].key;
+    size_t round, i;
+
+    for (round = 0; round < NUM_ROUNDS; ++round) {
+        for (i = 0; i < KEYS_PER_WRITER; ++i) {
+            vars[i].key = base + (int) i;
+            concurrenthashtable_insert(&concurrenthashtable, &vars[i].key, &vars[i].node);
+        }
+
+        for (i = 0; i < KEYS_PER_WRITER; ++i) {
+            int key = base + (int) i;
+            assert(concurrenthashtable_remove_key(&concurrenthashtable, &key) == &vars[i].node);
+        }
+
+        /* After the grace period no reader can see the nodes, so scribbling over them must go unnoticed. */
+        concurrenthashtable_synchronize(&concurrenthashtable);
+
+        for (i = 0; i < KEYS_PER_WRITER; ++i) {
+            vars[i].key = -1;
+            vars[i].node.next = HASHTABLE_POISON_NEXT;
+        }
+    }
+
+    return NULL;
+}
+
+static void* stress_reader(void *arg) {
+    size_t reader_index = *(size_t*) arg;
+    int key = 0;
+
+    while (!__atomic_load_n(&stress_done, __ATOMIC_ACQUIRE)) {
+        HashTableNode *n;
+
+        concurrenthashtable_read_lock(&concurrenthashtable, reader_index);
+
+        n = concurrenthashtable_lookup_key(&concurrenthashtable, &key);
+        if (n) {
+            assert(hashtable_entry(n, TestStruct, node)->key == key);
+        }
+
+        concurrenthashtable_read_unlock(&concurrenthashtable, reader_index);
+
+        key = (key + 1) % (NUM_WRITERS * KEYS_PER_WRITER);
+    }
+
+    return NULL;
+}
+
 static void reset_globals(void) {
+    size_t i;
+
     hashtable_init(&hashtable, bkt_arr, 3, hash_func, equal_func, collide_func, &aux_ptr);
+    concurrenthashtable_init(
+        &concurrenthashtable,
+        bkt_arr2,
+        5,
+        lock_arr,
+        2,
+        reader_arr,
+        4,
+        hash_func,
+        equal_func,
+        concurrent_collide_func,
+        &aux_ptr
+    );
+
+    for (i = 0; i < 5; ++i) {
+        bkt_arr2[i] = NULL;
+    }
+
+    stress_done = 0;
 
     var1.key = 1;
     var1.num_similar_keys = 0;
@@ -598,6 +715,56 @@ void test_hashtable_lookup_key(void) {
     }
 }
 
+void test_hashtable_lookup_keys_batch(void) {
+    const void *keys[40];
+    HashTableNode *results[40];
+    int missing_key = 7;
+    size_t i;
+
+    hashtable_lookup_keys_batch(&hashtable, NULL, 0, NULL);
+
+    /* More keys than HASHTABLE_BATCH_SIZE, including missing and repeated keys. */
+    for (i = 0; i < 40; ++i) {
+        switch (i % 7) {
+            case 0: keys[i] = &var1.key; break;
+            case 1: keys[i] = &var2.key; break;
+            case 2: keys[i] = &var3.key; break;
+            case 3: keys[i] = &var4.key; break;
+            case 4: keys[i] = &var5.key; break;
+            case 5: keys[i] = &var6.key; break;
+            default: keys[i] = &missing_key; break;
+        }
+    }
+
+    hashtable_lookup_keys_batch(&hashtable, keys, 40, results);
+    for (i = 0; i < 40; ++i) {
+        assert(results[i] == NULL);
+    }
+
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    HASHTABLE_REMOVE_KEY_BY_NODE(&hashtable, &var4.node);
+    hashtable_lookup_keys_batch(&hashtable, keys, 40, results);
+    for (i = 0; i < 40; ++i) {
+        assert(results[i] == hashtable_lookup_key(&hashtable, keys[i]));
+    }
+    assert(results[0] == &var1.node && results[3] == NULL && results[6] == NULL && results[39] == &var5.node);
+
+    /* A partial chunk only writes the results of its keys. */
+    results[5] = &var1.node;
+    hashtable_lookup_keys_batch(&hashtable, keys, 5, results);
+    assert(results[4] == &var5.node && results[5] == &var1.node);
+
+    /* Both bucket arrays are consulted while rehashing. */
+    hashtable_insert(&hashtable, &var4.key, &var4.node);
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    assert(hashtable_rehash_step(&hashtable, 1) == 1);
+    hashtable_lookup_keys_batch(&hashtable, keys, 40, results);
+    for (i = 0; i < 40; ++i) {
+        assert(results[i] == hashtable_lookup_key(&hashtable, keys[i]));
+        assert((results[i] == NULL) == (i % 7 == 6));
+    }
+}
+
 void test_hashtable_remove_key(void) {
     hashtable_remove_key(&hashtable, &var1.key);
 
@@ -789,6 +956,824 @@ void test_hashtable_for_each_possible_safe(void) {
     assert(i == 6);
 }
 
+void test_hashtable_rehashing(void) {
+    assert(hashtable_rehashing(&hashtable) == 0);
+
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    assert(hashtable_rehashing(&hashtable) == 1);
+    hashtable_rehash_step(&hashtable, 1);
+    assert(hashtable_rehashing(&hashtable) == 1);
+    hashtable_rehash_step(&hashtable, 2);
+    assert(hashtable_rehashing(&hashtable) == 0);
+    reset_globals();
+
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    hashtable_finish_rehash(&hashtable);
+    assert(hashtable_rehashing(&hashtable) == 0);
+    reset_globals();
+
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    hashtable_remove_all(&hashtable);
+    assert(hashtable_rehashing(&hashtable) == 0);
+}
+
+void test_hashtable_begin_rehash(void) {
+    HashTableNode *bkt_arr3[3] = { NULL, NULL, NULL };
+    HashTableNode *n;
+    size_t i, bkt;
+
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    ASSERT_HASHTABLE(hashtable, 0);
+    assert(hashtable.bucket_array == bkt_arr2);
+    assert(hashtable.num_buckets == 5);
+    assert(hashtable.old_bucket_array == bkt_arr);
+    assert(hashtable.old_num_buckets == 3);
+    assert(hashtable.rehash_index == 0);
+    assert(hashtable.key == key_func);
+    assert(hashtable_bucket_array(&hashtable) == bkt_arr2);
+    assert(hashtable_num_buckets(&hashtable) == 5);
+    reset_globals();
+
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    ASSERT_HASHTABLE(hashtable, 6);
+    assert(bkt_arr2[0] == NULL && bkt_arr2[1] == NULL && bkt_arr2[2] == NULL);
+    assert(bkt_arr2[3] == NULL && bkt_arr2[4] == NULL);
+    assert(hashtable_lookup_key(&hashtable, &var1.key) == &var1.node);
+    assert(hashtable_lookup_key(&hashtable, &var4.key) == &var4.node);
+    assert(hashtable_lookup_key(&hashtable, &var6.key) == &var6.node);
+
+    i = 0;
+    hashtable_for_each(n, bkt, &hashtable) {
+        assert(bkt >= 5);
+        ASSERT_FOR_EACH(n, i);
+        ++i;
+    }
+    assert(i == 6);
+
+    /* Inserting migrates the bucket of the key along with HASHTABLE_REHASH_STEP other buckets. */
+    HASHTABLE_REMOVE_KEY_BY_NODE(&hashtable, &var3.node);
+    ASSERT_HASHTABLE(hashtable, 5);
+    assert(hashtable_rehashing(&hashtable) == 1);
+    hashtable_insert(&hashtable, &var3.key, &var3.node);
+    assert(hashtable_rehashing(&hashtable) == 0);
+    ASSERT_HASHTABLE(hashtable, 6);
+    assert(bkt_arr[0] == NULL && bkt_arr[1] == NULL && bkt_arr[2] == NULL);
+    assert(hashtable_lookup_key(&hashtable, &var1.key) == &var1.node);
+    assert(hashtable_lookup_key(&hashtable, &var2.key) == &var2.node);
+    assert(hashtable_lookup_key(&hashtable, &var3.key) == &var3.node);
+    assert(hashtable_lookup_key(&hashtable, &var4.key) == &var4.node);
+    assert(hashtable_lookup_key(&hashtable, &var5.key) == &var5.node);
+    assert(hashtable_lookup_key(&hashtable, &var6.key) == &var6.node);
+    reset_globals();
+
+    /* Beginning a rehash while rehashing finishes the rehash in progress. */
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    hashtable_begin_rehash(&hashtable, bkt_arr3, 3, key_func);
+    ASSERT_BUCKET_ARRAY_NULLIFIED();
+    assert(hashtable.bucket_array == bkt_arr3);
+    assert(hashtable.old_bucket_array == bkt_arr2);
+    hashtable_finish_rehash(&hashtable);
+    ASSERT_HASHTABLE(hashtable, 6);
+    assert(bkt_arr2[2] == NULL && bkt_arr2[3] == NULL && bkt_arr2[4] == NULL);
+    i = 0;
+    hashtable_for_each(n, bkt, &hashtable) {
+        ++i;
+    }
+    assert(i == 6);
+    assert(hashtable_lookup_key(&hashtable, &var1.key) == &var1.node);
+    assert(hashtable_lookup_key(&hashtable, &var4.key) == &var4.node);
+    assert(hashtable_lookup_key(&hashtable, &var6.key) == &var6.node);
+    reset_globals();
+
+    loop {
+        FILL_RANDOMLY(hashtable);
+        hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+        assert(hashtable_contains_key(&hashtable, &var1.key) == 1);
+        assert(hashtable_contains_key(&hashtable, &var2.key) == 1);
+        assert(hashtable_contains_key(&hashtable, &var3.key) == 1);
+        assert(hashtable_contains_key(&hashtable, &var4.key) == 1);
+        assert(hashtable_contains_key(&hashtable, &var5.key) == 1);
+        assert(hashtable_contains_key(&hashtable, &var6.key) == 1);
+        DRAIN_RANDOMLY(hashtable);
+        ASSERT_HASHTABLE(hashtable, 0);
+        assert(hashtable_rehashing(&hashtable) == 1);
+        reset_globals();
+    }
+}
+
+void test_hashtable_rehash_step(void) {
+    HashTableNode *n, *backup;
+    size_t i, bkt;
+
+    assert(hashtable_rehash_step(&hashtable, 1) == 0);
+
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    assert(hashtable_rehash_step(&hashtable, 1) == 1);
+    assert(hashtable.rehash_index == 1);
+    assert(bkt_arr[0] == NULL);
+    assert(bkt_arr2[4] == &var1.node || bkt_arr2[4] == &var2.node);
+    assert(hashtable_lookup_key(&hashtable, &var1.key) == &var1.node);
+    assert(hashtable_lookup_key(&hashtable, &var2.key) == &var2.node);
+    assert(hashtable_lookup_key(&hashtable, &var3.key) == &var3.node);
+
+    i = 0;
+    hashtable_for_each(n, bkt, &hashtable) {
+        ++i;
+    }
+    assert(i == 6);
+
+    i = 0;
+    hashtable_for_each_safe(n, backup, bkt, &hashtable) {
+        HASHTABLE_REMOVE_KEY_BY_NODE(&hashtable, n);
+        n = NULL;
+        ++i;
+    }
+    assert(i == 6);
+    ASSERT_HASHTABLE(hashtable, 0);
+    assert(hashtable_rehash_step(&hashtable, 1) == 1);
+    assert(hashtable_rehash_step(&hashtable, 1) == 0);
+    assert(hashtable.old_bucket_array == NULL);
+    assert(hashtable.old_num_buckets == 0);
+    reset_globals();
+
+    loop {
+        FILL_RANDOMLY(hashtable);
+        hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+        hashtable_rehash_step(&hashtable, (size_t) (rand() % 3));
+        assert(hashtable_lookup_key(&hashtable, &var1.key) == &var1.node);
+        assert(hashtable_lookup_key(&hashtable, &var2.key) == &var2.node);
+        assert(hashtable_lookup_key(&hashtable, &var3.key) == &var3.node);
+        assert(hashtable_lookup_key(&hashtable, &var4.key) == &var4.node);
+        assert(hashtable_lookup_key(&hashtable, &var5.key) == &var5.node);
+        assert(hashtable_lookup_key(&hashtable, &var6.key) == &var6.node);
+        reset_globals();
+    }
+}
+
+void test_hashtable_finish_rehash(void) {
+    hashtable_finish_rehash(&hashtable);
+    ASSERT_HASHTABLE(hashtable, 0);
+
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    hashtable_rehash_step(&hashtable, 1);
+    hashtable_finish_rehash(&hashtable);
+    assert(hashtable_rehashing(&hashtable) == 0);
+    ASSERT_BUCKET_ARRAY_NULLIFIED();
+    assert(bkt_arr2[0] == NULL && bkt_arr2[1] == NULL);
+    assert(bkt_arr2[2] == &var3.node || bkt_arr2[2] == &var4.node);
+    assert(bkt_arr2[3] == &var5.node || bkt_arr2[3] == &var6.node);
+    assert(bkt_arr2[4] == &var1.node || bkt_arr2[4] == &var2.node);
+    assert(bkt_arr2[2]->next->next == NULL);
+    assert(bkt_arr2[3]->next->next == NULL);
+    assert(bkt_arr2[4]->next->next == NULL);
+    ASSERT_HASHTABLE(hashtable, 6);
+}
+
+void test_hashtable_possible_first(void) {
+    assert(hashtable_possible_first(&hashtable, &var1.key) == NULL);
+
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    assert(hashtable_possible_first(&hashtable, &var1.key) == &var1.node);
+    assert(hashtable_possible_first(&hashtable, &var4.key) == &var3.node);
+    assert(hashtable_possible_first(&hashtable, &var5.key) == &var5.node);
+
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    assert(hashtable_possible_first(&hashtable, &var1.key) == &var1.node);
+    hashtable_rehash_step(&hashtable, 1);
+    assert(hashtable_possible_first(&hashtable, &var1.key) == bkt_arr2[4]);
+}
+
+void test_hashtable_possible_next(void) {
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    assert(hashtable_possible_next(&hashtable, &var1.key, &var1.node) == &var2.node);
+    assert(hashtable_possible_next(&hashtable, &var1.key, &var2.node) == NULL);
+
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    assert(hashtable_possible_next(&hashtable, &var1.key, &var2.node) == NULL);
+
+    /* Move var1 into the new bucket array, leaving var2 behind in the old bucket array. */
+    HASHTABLE_REMOVE_KEY_BY_NODE(&hashtable, &var1.node);
+    bkt_arr2[4] = &var1.node;
+    var1.node.next = NULL;
+    ++hashtable.size;
+    assert(hashtable_possible_first(&hashtable, &var1.key) == &var2.node);
+    assert(hashtable_possible_next(&hashtable, &var1.key, &var2.node) == &var1.node);
+    assert(hashtable_possible_next(&hashtable, &var1.key, &var1.node) == NULL);
+}
+
+void test_hashtable_store_hash(void) {
+    int key = 7;
+
+    hashtable_init(&hashtable, bkt_arr2, 1, hash_func, equal_func, collide_func, &aux_ptr);
+    hashtable_insert(&hashtable, &var1.key, &var1.node);
+    hashtable_insert(&hashtable, &var3.key, &var3.node);
+    hashtable_insert(&hashtable, &var5.key, &var5.node);
+
+    num_equal_calls = 0;
+    assert(hashtable_lookup_key(&hashtable, &var3.key) == &var3.node);
+    #ifdef HASHTABLE_STORE_HASH
+    assert(num_equal_calls == 1);
+    #else
+    assert(num_equal_calls == 2);
+    #endif /* HASHTABLE_STORE_HASH */
+
+    num_equal_calls = 0;
+    assert(hashtable_lookup_key(&hashtable, &key) == NULL);
+    #ifdef HASHTABLE_STORE_HASH
+    assert(num_equal_calls == 0);
+    #else
+    assert(num_equal_calls == 3);
+    #endif /* HASHTABLE_STORE_HASH */
+
+    #ifdef HASHTABLE_STORE_HASH
+    assert(var1.node.hash == hash_func(&var1.key));
+    assert(var3.node.hash == hash_func(&var3.key));
+    assert(var5.node.hash == hash_func(&var5.key));
+
+    /* The stored hashcodes make the key function unnecessary. */
+    NULLIFY_BUCKET_ARRAY();
+    hashtable_begin_rehash(&hashtable, bkt_arr, 3, NULL);
+    hashtable_finish_rehash(&hashtable);
+    assert(hashtable_lookup_key(&hashtable, &var1.key) == &var1.node);
+    assert(hashtable_lookup_key(&hashtable, &var3.key) == &var3.node);
+    assert(hashtable_lookup_key(&hashtable, &var5.key) == &var5.node);
+    ASSERT_NODE(var1.node, NULL);
+    ASSERT_NODE(var3.node, NULL);
+    ASSERT_NODE(var5.node, NULL);
+    #endif /* HASHTABLE_STORE_HASH */
+}
+
+void test_hashtable_set_reduction(void) {
+    HashTableNode *bkt_arr3[4] = { NULL, NULL, NULL, NULL };
+    HashTableNode *n;
+    size_t i, bkt;
+
+    /* Masking with 4 buckets selects the same buckets as the modulo. */
+    hashtable_fast_init(&hashtable, bkt_arr3, 4, hash_func, equal_func, collide_func, &aux_ptr);
+    hashtable_set_reduction(&hashtable, HASHTABLE_REDUCTION_MASK);
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    assert(hashtable_size(&hashtable) == 6);
+    assert(bkt_arr3[0] == &var1.node && bkt_arr3[1] == NULL);
+    assert(bkt_arr3[2] == &var3.node && bkt_arr3[3] == &var5.node);
+    i = 0;
+    hashtable_for_each(n, bkt, &hashtable) {
+        ASSERT_FOR_EACH(n, i);
+        ++i;
+    }
+    assert(i == 6);
+    assert(hashtable_lookup_key(&hashtable, &var4.key) == &var4.node);
+    DRAIN_RANDOMLY(hashtable);
+    assert(hashtable_empty(&hashtable));
+    reset_globals();
+
+    /* Multiply-shift uses the high bits of the hashcode. */
+    hashtable_set_reduction(&hashtable, HASHTABLE_REDUCTION_MULTIPLY_SHIFT);
+    hashtable.hash = spread_hash_func;
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    assert(hashtable_size(&hashtable) == 6);
+    assert(bkt_arr[0] == &var1.node && bkt_arr[1] == &var3.node && bkt_arr[2] == &var5.node);
+    i = 0;
+    hashtable_for_each(n, bkt, &hashtable) {
+        ASSERT_FOR_EACH(n, i);
+        ++i;
+    }
+    assert(i == 6);
+    assert(hashtable_lookup_key(&hashtable, &var6.key) == &var6.node);
+    DRAIN_RANDOMLY(hashtable);
+    assert(hashtable_empty(&hashtable));
+    reset_globals();
+
+    /* Hashcodes smaller than the number of buckets all map to the first bucket. */
+    hashtable_set_reduction(&hashtable, HASHTABLE_REDUCTION_MULTIPLY_SHIFT);
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    assert(bkt_arr[0] && !bkt_arr[1] && !bkt_arr[2]);
+    assert(hashtable_lookup_key(&hashtable, &var3.key) == &var3.node);
+    reset_globals();
+
+    /* Rehashing keeps the reduction. */
+    hashtable_fast_init(&hashtable, bkt_arr3, 4, hash_func, equal_func, collide_func, &aux_ptr);
+    hashtable_set_reduction(&hashtable, HASHTABLE_REDUCTION_MASK);
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 1, key_func);
+    hashtable_finish_rehash(&hashtable);
+    assert(hashtable_reduction(&hashtable) == HASHTABLE_REDUCTION_MASK);
+    assert(hashtable_size(&hashtable) == 6);
+    for (i = 0; i < 4; ++i) {
+        assert(bkt_arr3[i] == NULL);
+    }
+    for (n = bkt_arr2[0], i = 0; n; n = n->next) {
+        ++i;
+    }
+    assert(i == 6);
+    assert(hashtable_lookup_key(&hashtable, &var2.key) == &var2.node);
+}
+
+void test_hashtable_reduction(void) {
+    assert(hashtable_reduction(&hashtable) == HASHTABLE_REDUCTION_MODULO);
+
+    hashtable_set_reduction(&hashtable, HASHTABLE_REDUCTION_MULTIPLY_SHIFT);
+    assert(hashtable_reduction(&hashtable) == HASHTABLE_REDUCTION_MULTIPLY_SHIFT);
+
+    hashtable_set_reduction(&hashtable, HASHTABLE_REDUCTION_MODULO);
+    assert(hashtable_reduction(&hashtable) == HASHTABLE_REDUCTION_MODULO);
+
+    hashtable_set_reduction(&hashtable, HASHTABLE_REDUCTION_MULTIPLY_SHIFT);
+    reset_globals();
+    assert(hashtable_reduction(&hashtable) == HASHTABLE_REDUCTION_MODULO);
+}
+
+#ifdef CDSA_STATS
+/* Asserts that the histogram of the @ref stats holds exactly the @ref num_walks @ref probe_lengths. */
+static void assert_histogram_(const HashTableStats *stats, const size_t *probe_lengths, size_t num_walks) {
+    size_t expected[HASHTABLE_STATS_HISTOGRAM_SIZE];
+    size_t i;
+
+    for (i = 0; i < HASHTABLE_STATS_HISTOGRAM_SIZE; ++i) {
+        expected[i] = 0;
+    }
+
+    for (i = 0; i < num_walks; ++i) {
+        if (probe_lengths[i] < HASHTABLE_STATS_HISTOGRAM_SIZE) {
+            ++expected[probe_lengths[i]];
+        } else {
+            ++expected[HASHTABLE_STATS_HISTOGRAM_SIZE - 1];
+        }
+    }
+
+    assert(stats->num_chain_walks == num_walks);
+    for (i = 0; i < HASHTABLE_STATS_HISTOGRAM_SIZE; ++i) {
+        assert(stats->probe_length_histogram[i] == expected[i]);
+    }
+}
+#endif /* CDSA_STATS */
+
+void test_hashtable_stats(void) {
+    #ifdef CDSA_STATS
+    const size_t insert_lengths[] = { 0, 1, 2 };
+    const size_t lookup_lengths[] = { 2, 3, 2, 3 };
+    HashTableStats stats;
+    int key = 7;
+
+    /* All keys share the only bucket, so every chain walk is as long as the position of the key. */
+    hashtable_init(&hashtable, bkt_arr2, 1, hash_func, equal_func, collide_func, &aux_ptr);
+    hashtable_stats(&hashtable, &stats);
+    assert_histogram_(&stats, NULL, 0);
+    assert(stats.num_equal_calls == 0);
+    assert(stats.num_collisions == 0);
+    assert(stats.max_probe_length == 0);
+
+    num_equal_calls = 0;
+    hashtable_insert(&hashtable, &var1.key, &var1.node);
+    hashtable_insert(&hashtable, &var3.key, &var3.node);
+    hashtable_insert(&hashtable, &var5.key, &var5.node);
+    hashtable_stats(&hashtable, &stats);
+    assert_histogram_(&stats, insert_lengths, 3);
+    assert(stats.num_equal_calls == num_equal_calls);
+    assert(stats.num_collisions == 0);
+    assert(stats.max_probe_length == 2);
+
+    /* The chain is var5 -> var3 -> var1. */
+    hashtable_reset_stats(&hashtable);
+    num_equal_calls = 0;
+    assert(hashtable_lookup_key(&hashtable, &var3.key) == &var3.node);
+    assert(hashtable_lookup_key(&hashtable, &key) == NULL);
+    var2.key = 3;
+    hashtable_insert(&hashtable, &var2.key, &var2.node);
+    hashtable_remove_key(&hashtable, &var1.key);
+    hashtable_stats(&hashtable, &stats);
+    assert_histogram_(&stats, lookup_lengths, 4);
+    assert(stats.num_equal_calls == num_equal_calls);
+    assert(stats.num_collisions == 1);
+    assert(stats.max_probe_length == 3);
+    assert(var2.num_similar_keys == 1);
+
+    hashtable_init(&hashtable, bkt_arr, 3, hash_func, equal_func, collide_func, &aux_ptr);
+    hashtable_stats(&hashtable, &stats);
+    assert_histogram_(&stats, NULL, 0);
+    assert(stats.num_collisions == 0);
+    #endif /* CDSA_STATS */
+}
+
+void test_hashtable_occupancy(void) {
+    const size_t buckets[] = { 22, 37, 74, 111, 148, 185 };
+    TestStruct extra;
+    HashTableNode *n, *backup;
+    size_t i, bkt;
+
+    /* With 200 buckets, the keys 1 to 6 land in the buckets 37, 74, 111, 148, 185 and 22. */
+    hashtable_init(&hashtable, sparse_bkt_arr, 200, sparse_hash_func, equal_func, collide_func, &aux_ptr);
+    assert(hashtable_next_occupied(&hashtable, 5) == 5);
+
+    /* Installing the bitmap picks up what is already there. */
+    hashtable_insert(&hashtable, &var1.key, &var1.node);
+    hashtable_set_occupancy(&hashtable, occupancy_arr);
+    assert(hashtable_next_occupied(&hashtable, 0) == 37);
+    assert(hashtable_next_occupied(&hashtable, 37) == 37);
+    assert(hashtable_next_occupied(&hashtable, 38) == 200);
+    hashtable_remove_key(&hashtable, &var1.key);
+    assert(hashtable_next_occupied(&hashtable, 0) == 200);
+
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    assert(hashtable_next_occupied(&hashtable, 0) == 22);
+    assert(hashtable_next_occupied(&hashtable, 38) == 74);
+    assert(hashtable_next_occupied(&hashtable, 186) == 200);
+    assert(hashtable_next_occupied(&hashtable, 500) == 200);
+
+    i = 0;
+    hashtable_for_each(n, bkt, &hashtable) {
+        assert(i < 6 && bkt == buckets[i]);
+        assert(sparse_bkt_arr[bkt] == n);
+        ++i;
+    }
+    assert(i == 6);
+
+    /* A bucket stays occupied until its last HashTableNode is removed. */
+    extra.key = 201;
+    hashtable_insert(&hashtable, &extra.key, &extra.node);
+    hashtable_remove_key(&hashtable, &var1.key);
+    assert(hashtable_next_occupied(&hashtable, 23) == 37);
+    hashtable_remove_key(&hashtable, &extra.key);
+    assert(hashtable_next_occupied(&hashtable, 23) == 74);
+
+    i = 0;
+    hashtable_for_each_safe(n, backup, bkt, &hashtable) {
+        HASHTABLE_REMOVE_KEY_BY_NODE(&hashtable, n);
+        n = NULL;
+        ++i;
+    }
+    assert(i == 5);
+    assert(hashtable_next_occupied(&hashtable, 0) == 200);
+    for (i = 0; i < HASHTABLE_OCCUPANCY_WORDS(200); ++i) {
+        assert(occupancy_arr[i] == 0);
+    }
+
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    hashtable_remove_all(&hashtable);
+    assert(hashtable_empty(&hashtable));
+    for (i = 0; i < 200; ++i) {
+        assert(sparse_bkt_arr[i] == NULL);
+    }
+    for (i = 0; i < HASHTABLE_OCCUPANCY_WORDS(200); ++i) {
+        assert(occupancy_arr[i] == 0);
+    }
+
+    /*
+     * The old bucket array keeps its bitmap while rehashing. With 5 buckets, the keys 1 to 6 land in the
+     * buckets 2, 4, 1, 3, 0 and 2.
+     */
+    FILL_FOR_TESTING_FOR_EACH(hashtable);
+    hashtable_begin_rehash(&hashtable, bkt_arr2, 5, key_func);
+    assert(hashtable.occupancy == NULL && hashtable.old_occupancy == occupancy_arr);
+    assert(hashtable_next_occupied(&hashtable, 0) == 0);
+    assert(hashtable_next_occupied(&hashtable, 5) == 5 + 22);
+
+    hashtable_set_occupancy(&hashtable, occupancy_arr2);
+    assert(hashtable_next_occupied(&hashtable, 0) == 5 + 22);
+
+    assert(hashtable_rehash_step(&hashtable, 23) == 1);
+    assert(hashtable_next_occupied(&hashtable, 0) == 2);
+    assert(hashtable_next_occupied(&hashtable, 3) == 5 + 37);
+
+    i = 0;
+    hashtable_for_each(n, bkt, &hashtable) {
+        ++i;
+    }
+    assert(i == 6);
+
+    hashtable_finish_rehash(&hashtable);
+    assert(hashtable.old_occupancy == NULL);
+    assert(occupancy_arr2[0] == 0x1FUL);
+    hashtable_remove_key(&hashtable, &var1.key);
+    assert(occupancy_arr2[0] == 0x1FUL);
+    hashtable_remove_key(&hashtable, &var6.key);
+    assert(occupancy_arr2[0] == 0x1BUL);
+
+    hashtable_remove_all(&hashtable);
+    assert(occupancy_arr2[0] == 0);
+    for (i = 0; i < 5; ++i) {
+        assert(bkt_arr2[i] == NULL);
+    }
+
+    hashtable_init(&hashtable, bkt_arr, 3, hash_func, equal_func, collide_func, &aux_ptr);
+    assert(hashtable.occupancy == NULL);
+}
+
+void test_hashtable_snapshot(void) {
+    TestStruct arena[6];
+    HashTableImage image, untouched;
+    const HashTableNode *n;
+    char *memory, *copy_memory, *buffer, *copy;
+    size_t size, i;
+    int key;
+
+    for (i = 0; i < 6; ++i) {
+        arena[i].key = (int) i + 1;
+        arena[i].num_similar_keys = (int) i * 10;
+        hashtable_insert(&hashtable, &arena[i].key, &arena[i].node);
+    }
+
+    size = hashtable_serialize(&hashtable, arena, sizeof(arena), NULL);
+    assert(size > sizeof(arena));
+
+    /* Over-allocate, so both buffers can be aligned. */
+    memory = (char*) malloc(size + HASHTABLE_SNAPSHOT_ALIGNMENT);
+    copy_memory = (char*) malloc(size + HASHTABLE_SNAPSHOT_ALIGNMENT);
+    assert(memory && copy_memory);
+    buffer = memory + (HASHTABLE_SNAPSHOT_ALIGNMENT - (size_t) memory % HASHTABLE_SNAPSHOT_ALIGNMENT) %
+        HASHTABLE_SNAPSHOT_ALIGNMENT;
+    copy = copy_memory + (HASHTABLE_SNAPSHOT_ALIGNMENT - (size_t) copy_memory % HASHTABLE_SNAPSHOT_ALIGNMENT) %
+        HASHTABLE_SNAPSHOT_ALIGNMENT;
+
+    assert(hashtable_serialize(&hashtable, arena, sizeof(arena), buffer) == size);
+    assert(hashtable_size(&hashtable) == 6);
+    assert(hashtable_lookup_key(&hashtable, &arena[2].key) == &arena[2].node);
+
+    /* Move the image and destroy the original, so nothing can point back into either. */
+    memcpy(copy, buffer, size);
+    memset(buffer, 0, size);
+    hashtable_remove_all(&hashtable);
+    memset(arena, 0, sizeof(arena));
+
+    assert(hashtable_attach(&image, copy, size, hash_func, equal_func));
+    assert(hashtable_image_size(&image) == 6);
+
+    for (i = 0; i < 6; ++i) {
+        key = (int) i + 1;
+        n = hashtable_image_lookup_key(&image, &key);
+        assert(n && (const char*) n > copy && (const char*) n < copy + size);
+        assert(hashtable_entry(n, TestStruct, node)->key == key);
+        assert(hashtable_entry(n, TestStruct, node)->num_similar_keys == (int) i * 10);
+    }
+
+    key = 7;
+    assert(hashtable_image_lookup_key(&image, &key) == NULL);
+
+    /* Truncated and foreign images are rejected, and leave the image as it was. */
+    untouched = image;
+    assert(!hashtable_attach(&image, copy, size - 1, hash_func, equal_func));
+    assert(!hashtable_attach(&image, copy, sizeof(size_t), hash_func, equal_func));
+    copy[0] ^= 1;
+    assert(!hashtable_attach(&image, copy, size, hash_func, equal_func));
+    copy[0] ^= 1;
+    assert(image.bucket_array == untouched.bucket_array);
+    assert(image.arena == untouched.arena);
+    assert(image.num_buckets == untouched.num_buckets);
+    assert(image.size == untouched.size);
+
+    /* An empty HashTable needs no arena. */
+    size = hashtable_serialize(&hashtable, NULL, 0, NULL);
+    assert(hashtable_serialize(&hashtable, NULL, 0, buffer) == size);
+    assert(hashtable_attach(&image, buffer, size, hash_func, equal_func));
+    assert(hashtable_image_size(&image) == 0);
+    key = 1;
+    assert(hashtable_image_lookup_key(&image, &key) == NULL);
+
+    free(memory);
+    free(copy_memory);
+}
+
+void test_concurrenthashtable_init(void) {
+    size_t i;
+
+    loop {
+        for (i = 0; i < 5; ++i) {
+            bkt_arr2[i] = (HashTableNode*) &aux_ptr;
+        }
+        lock_arr[1].locked = 1;
+        reader_arr[3].sequence = 1;
+
+        concurrenthashtable_init(
+            &concurrenthashtable,
+            bkt_arr2,
+            5,
+            lock_arr,
+            2,
+            reader_arr,
+            4,
+            hash_func,
+            equal_func,
+            concurrent_collide_func,
+            &aux_ptr
+        );
+
+        for (i = 0; i < 5; ++i) {
+            assert(bkt_arr2[i] == NULL);
+        }
+        assert(lock_arr[0].locked == 0 && lock_arr[1].locked == 0);
+        for (i = 0; i < 4; ++i) {
+            assert(reader_arr[i].sequence == 0);
+        }
+        assert(concurrenthashtable.bucket_array == bkt_arr2);
+        assert(concurrenthashtable.num_buckets == 5);
+        assert(concurrenthashtable.reduction == HASHTABLE_REDUCTION_MODULO);
+        assert(concurrenthashtable.lock_array == lock_arr);
+        assert(concurrenthashtable.num_locks == 2);
+        assert(concurrenthashtable.reader_array == reader_arr);
+        assert(concurrenthashtable.num_readers == 4);
+        assert(concurrenthashtable.hash == hash_func);
+        assert(concurrenthashtable.equal == equal_func);
+        assert(concurrenthashtable.collide == concurrent_collide_func);
+        assert(concurrenthashtable.auxiliary_data == &aux_ptr);
+        assert(concurrenthashtable_size(&concurrenthashtable) == 0);
+    }
+}
+
+void test_concurrenthashtable_set_reduction(void) {
+    HashTableNode *bkt_arr3[4];
+
+    /* Multiply-shift uses the high bits of the hashcode. */
+    concurrenthashtable_set_reduction(&concurrenthashtable, HASHTABLE_REDUCTION_MULTIPLY_SHIFT);
+    assert(concurrenthashtable.reduction == HASHTABLE_REDUCTION_MULTIPLY_SHIFT);
+    concurrenthashtable.hash = spread_hash_func;
+    concurrenthashtable_insert(&concurrenthashtable, &var1.key, &var1.node);
+    concurrenthashtable_insert(&concurrenthashtable, &var2.key, &var2.node);
+    concurrenthashtable_insert(&concurrenthashtable, &var4.key, &var4.node);
+    concurrenthashtable_insert(&concurrenthashtable, &var6.key, &var6.node);
+    assert(bkt_arr2[0] == &var2.node && bkt_arr2[1] == NULL && bkt_arr2[2] == &var4.node);
+    assert(bkt_arr2[3] == NULL && bkt_arr2[4] == &var6.node);
+    assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var4.key) == &var4.node);
+    assert(concurrenthashtable_remove_key(&concurrenthashtable, &var1.key) == &var1.node);
+    assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var1.key) == NULL);
+    assert(concurrenthashtable_size(&concurrenthashtable) == 3);
+    reset_globals();
+
+    /* Masking with 4 buckets selects the same buckets as the modulo. */
+    concurrenthashtable_init(
+        &concurrenthashtable,
+        bkt_arr3,
+        4,
+        lock_arr,
+        2,
+        reader_arr,
+        4,
+        stress_hash_func,
+        equal_func,
+        concurrent_collide_func,
+        &aux_ptr
+    );
+    concurrenthashtable_set_reduction(&concurrenthashtable, HASHTABLE_REDUCTION_MASK);
+    concurrenthashtable_insert(&concurrenthashtable, &var5.key, &var5.node);
+    concurrenthashtable_insert(&concurrenthashtable, &var6.key, &var6.node);
+    assert(bkt_arr3[0] == NULL && bkt_arr3[1] == &var5.node && bkt_arr3[2] == &var6.node && bkt_arr3[3] == NULL);
+    assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var6.key) == &var6.node);
+    assert(concurrenthashtable_remove_key(&concurrenthashtable, &var5.key) == &var5.node);
+    assert(concurrenthashtable_size(&concurrenthashtable) == 1);
+}
+
+void test_concurrenthashtable_insert(void) {
+    loop {
+        TestStruct dup;
+
+        concurrenthashtable_insert(&concurrenthashtable, &var1.key, &var1.node);
+        concurrenthashtable_insert(&concurrenthashtable, &var2.key, &var2.node);
+        concurrenthashtable_insert(&concurrenthashtable, &var3.key, &var3.node);
+        assert(concurrenthashtable_size(&concurrenthashtable) == 3);
+
+        /* Keys 1 and 2 share a bucket, most recently inserted first. */
+        assert(bkt_arr2[hash_func(&var1.key) % 5] == &var2.node);
+        assert(bkt_arr2[hash_func(&var3.key) % 5] == &var3.node);
+        ASSERT_NODE(var2.node, &var1.node);
+        ASSERT_NODE(var1.node, NULL);
+        ASSERT_NODE(var3.node, NULL);
+
+        dup.key = 2;
+        dup.num_similar_keys = 0;
+        concurrenthashtable_insert(&concurrenthashtable, &dup.key, &dup.node);
+        assert(concurrenthashtable_size(&concurrenthashtable) == 3);
+        assert(dup.num_similar_keys == 1);
+        assert(bkt_arr2[hash_func(&var1.key) % 5] == &dup.node);
+        ASSERT_NODE(dup.node, &var1.node);
+
+        /* The replaced node still leads to the rest of the chain. */
+        ASSERT_NODE(var2.node, &var1.node);
+        assert(lock_arr[0].locked == 0 && lock_arr[1].locked == 0);
+
+        reset_globals();
+    }
+}
+
+void test_concurrenthashtable_lookup_key(void) {
+    loop {
+        int key = 7;
+
+        assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var1.key) == NULL);
+
+        concurrenthashtable_insert(&concurrenthashtable, &var1.key, &var1.node);
+        concurrenthashtable_insert(&concurrenthashtable, &var4.key, &var4.node);
+        concurrenthashtable_insert(&concurrenthashtable, &var6.key, &var6.node);
+
+        assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var1.key) == &var1.node);
+        assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var4.key) == &var4.node);
+        assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var6.key) == &var6.node);
+        assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var2.key) == NULL);
+        assert(concurrenthashtable_lookup_key(&concurrenthashtable, &key) == NULL);
+
+        reset_globals();
+    }
+}
+
+void test_concurrenthashtable_remove_key(void) {
+    loop {
+        int key = 7;
+
+        concurrenthashtable_insert(&concurrenthashtable, &var1.key, &var1.node);
+        concurrenthashtable_insert(&concurrenthashtable, &var2.key, &var2.node);
+        concurrenthashtable_insert(&concurrenthashtable, &var3.key, &var3.node);
+
+        assert(concurrenthashtable_remove_key(&concurrenthashtable, &key) == NULL);
+        assert(concurrenthashtable_size(&concurrenthashtable) == 3);
+
+        assert(concurrenthashtable_remove_key(&concurrenthashtable, &var2.key) == &var2.node);
+        assert(concurrenthashtable_size(&concurrenthashtable) == 2);
+        assert(bkt_arr2[hash_func(&var1.key) % 5] == &var1.node);
+
+        /* The removed node is not poisoned, since readers may still be standing on it. */
+        ASSERT_NODE(var2.node, &var1.node);
+        assert(concurrenthashtable_lookup_key(&concurrenthashtable, &var2.key) == NULL);
+
+        assert(concurrenthashtable_remove_key(&concurrenthashtable, &var3.key) == &var3.node);
+        assert(concurrenthashtable_remove_key(&concurrenthashtable, &var1.key) == &var1.node);
+        assert(concurrenthashtable_remove_key(&concurrenthashtable, &var1.key) == NULL);
+        assert(concurrenthashtable_size(&concurrenthashtable) == 0);
+        assert(bkt_arr2[hash_func(&var1.key) % 5] == NULL);
+        assert(lock_arr[0].locked == 0 && lock_arr[1].locked == 0);
+
+        reset_globals();
+    }
+}
+
+void test_concurrenthashtable_read_lock(void) {
+    loop {
+        concurrenthashtable_read_lock(&concurrenthashtable, 1);
+        assert(reader_arr[1].sequence == 1);
+        assert(reader_arr[0].sequence == 0);
+
+        concurrenthashtable_read_unlock(&concurrenthashtable, 1);
+        assert(reader_arr[1].sequence == 2);
+
+        concurrenthashtable_read_lock(&concurrenthashtable, 1);
+        concurrenthashtable_read_unlock(&concurrenthashtable, 1);
+        assert(reader_arr[1].sequence == 4);
+
+        /* No reader is inside a critical section, so this returns right away. */
+        concurrenthashtable_synchronize(&concurrenthashtable);
+
+        reset_globals();
+    }
+}
+
+void test_concurrenthashtable_threads(void) {
+    pthread_t writers[NUM_WRITERS], readers[NUM_READERS];
+    size_t reader_indices[NUM_READERS];
+    size_t i;
+
+    concurrenthashtable_init(
+        &concurrenthashtable,
+        stress_bkt_arr,
+        7,
+        lock_arr,
+        2,
+        reader_arr,
+        NUM_READERS,
+        stress_hash_func,
+        stress_equal_func,
+        NULL,
+        NULL
+    );
+
+    for (i = 0; i < NUM_WRITERS; ++i) {
+        stress_vars[i][0].key = (int) (i * KEYS_PER_WRITER);
+    }
+
+    for (i = 0; i < NUM_READERS; ++i) {
+        reader_indices[i] = i;
+        assert(pthread_create(readers + i, NULL, stress_reader, reader_indices + i) == 0);
+    }
+
+    for (i = 0; i < NUM_WRITERS; ++i) {
+        assert(pthread_create(writers + i, NULL, stress_writer, stress_vars[i]) == 0);
+    }
+
+    for (i = 0; i < NUM_WRITERS; ++i) {
+        assert(pthread_join(writers[i], NULL) == 0);
+    }
+
+    __atomic_store_n(&stress_done, 1, __ATOMIC_RELEASE);
+
+    for (i = 0; i < NUM_READERS; ++i) {
+        assert(pthread_join(readers[i], NULL) == 0);
+    }
+
+    assert(concurrenthashtable_size(&concurrenthashtable) == 0);
+    for (i = 0; i < 7; ++i) {
+        assert(stress_bkt_arr[i] == NULL);
+    }
+}
+
 TestFunc test_funcs[] = {
     test_hashtable_init,
     test_hashtable_fast_init,
@@ -799,13 +1784,33 @@ TestFunc test_funcs[] = {
     test_hashtable_contains_key,
     test_hashtable_insert,
     test_hashtable_lookup_key,
+    test_hashtable_lookup_keys_batch,
     test_hashtable_remove_key,
     test_hashtable_remove_all,
     test_hashtable_entry,
     test_hashtable_for_each,
     test_hashtable_for_each_safe,
     test_hashtable_for_each_possible,
-    test_hashtable_for_each_possible_safe
+    test_hashtable_for_each_possible_safe,
+    test_hashtable_rehashing,
+    test_hashtable_begin_rehash,
+    test_hashtable_rehash_step,
+    test_hashtable_finish_rehash,
+    test_hashtable_possible_first,
+    test_hashtable_possible_next,
+    test_hashtable_store_hash,
+    test_hashtable_set_reduction,
+    test_hashtable_reduction,
+    test_hashtable_stats,
+    test_hashtable_occupancy,
+    test_hashtable_snapshot,
+    test_concurrenthashtable_init,
+    test_concurrenthashtable_set_reduction,
+    test_concurrenthashtable_insert,
+    test_concurrenthashtable_lookup_key,
+    test_concurrenthashtable_remove_key,
+    test_concurrenthashtable_read_lock,
+    test_concurrenthashtable_threads
 };
 
 int main(int argc, char *argv[]) {
@@ -813,7 +1818,7 @@ int main(int argc, char *argv[]) {
     assert(argc == 2);
     strcat(msg, argv[1]);
 
-    assert(sizeof(test_funcs) / sizeof(TestFunc) == 16);
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 36);
     run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
 
     return 0;
@@ -41,6 +41,7 @@ typedef struct TestStruct {
 } TestStruct;
 
 TestStruct var1, var2, var3, var4, var5;
+TestStruct many[1000];
 List list, other_list;
 
 #define ASSERT_LIST(list, head_ptr, tail_ptr, size_of_list) \
@@ -398,6 +399,63 @@ static int cmp(const ListNode *a, const ListNode *b) {
     return list_entry(a, TestStruct, node)->val - list_entry(b, TestStruct, node)->val;
 }
 
+/*
+ * Checks every lookup of the @ref index against the actual order of the @ref list.
+ */
+static void assert_index_(ListIndex *index, const List *list) {
+    ListNode *n;
+    size_t i = 0;
+
+    list_for_each(n, list) {
+        assert(list_index_at(index, i) == n);
+        assert(list_index_position_of(index, n) == i);
+        ++i;
+    }
+}
+
+void test_list_index(void) {
+    ListIndexEntry entries[300];
+    ListIndex index;
+    size_t num_entries, i;
+
+    list_index_init(&index, &list, entries, 3);
+    list_index_rebuild(&index);
+    list_insert_back(&list, &var1.node);
+    assert(list_index_at(&index, 0) == &var1.node);
+    assert(list_index_position_of(&index, &var1.node) == 0);
+    list_insert_back(&list, &var2.node);
+    list_insert_back(&list, &var3.node);
+    list_insert_back(&list, &var4.node);
+    list_insert_back(&list, &var5.node);
+    assert_index_(&index, &list);
+    reset_globals();
+
+    for (num_entries = 3; num_entries <= 300; num_entries = num_entries * 2 + 1) {
+        list_init(&list);
+        for (i = 0; i < 1000; ++i) {
+            many[i].val = (int) i;
+            list_insert_back(&list, &many[i].node);
+        }
+        list_index_init(&index, &list, entries, num_entries);
+        assert_index_(&index, &list);
+
+        /* Every kind of change makes the index rebuild itself. */
+        list_remove(&list, &many[500].node);
+        assert(list_index_at(&index, 500) == &many[501].node);
+        assert_index_(&index, &list);
+        list_insert_front(&list, &many[500].node);
+        assert(list_index_position_of(&index, &many[0].node) == 1);
+        assert_index_(&index, &list);
+        list_sort(&list, cmp);
+        assert(list_index_at(&index, 0) == &many[0].node);
+        assert_index_(&index, &list);
+        list_cut(&list, &many[10].node, &many[19].node, 10);
+        list_paste(&list, NULL, &many[10].node, &many[19].node, list.head, 10);
+        assert(list_index_position_of(&index, &many[19].node) == 9);
+        assert_index_(&index, &list);
+    }
+}
+
 void test_list_sort(void) {
     TestStruct var4cpy = var4;
 
@@ -425,6 +483,310 @@ void test_list_sort(void) {
     ASSERT_NODE(var5.node, &var4cpy.node, NULL);
 }
 
+static int cmp_quarters(const ListNode *a, const ListNode *b) {
+    return list_entry(a, TestStruct, node)->val / 4 - list_entry(b, TestStruct, node)->val / 4;
+}
+
+size_t num_comparisons;
+
+static int cmp_counted(const ListNode *a, const ListNode *b) {
+    ++num_comparisons;
+
+    return cmp(a, b);
+}
+
+/*
+ * Fills the @ref list with the first @ref num_nodes elements of "many" in array order, using the @ref pattern
+ * to choose their values.
+ */
+static void fill_many_(List *list, size_t num_nodes, int pattern) {
+    size_t i;
+
+    list_init(list);
+
+    for (i = 0; i < num_nodes; ++i) {
+        switch (pattern) {
+            case 0:
+                many[i].val = (int) i;
+                break;
+            case 1:
+                many[i].val = (int) (num_nodes - i);
+                break;
+            case 2:
+                many[i].val = (int) (i % 37);
+                break;
+            case 3:
+                many[i].val = rand() % 20 == 0 ? rand() % 1000 : (int) i;
+                break;
+            default:
+                many[i].val = rand() % 1000;
+                break;
+        }
+
+        list_insert_back(list, &many[i].node);
+    }
+}
+
+/*
+ * Checks that the @ref list is sorted by @ref cmp_quarters, and that ties kept their array order.
+ */
+static void assert_sorted_many_(const List *list, size_t num_nodes) {
+    ListNode *n, *prev = NULL;
+    size_t i = 0;
+
+    assert(list->size == num_nodes);
+
+    list_for_each(n, list) {
+        assert(n->prev == prev);
+
+        if (prev) {
+            int result = cmp_quarters(prev, n);
+
+            assert(result < 0 || (result == 0 && prev < n));
+        }
+
+        prev = n;
+        ++i;
+    }
+
+    assert(i == num_nodes);
+    assert(list->tail == prev);
+}
+
+void test_list_sort_adaptive(void) {
+    TestStruct var4cpy = var4;
+    size_t num_nodes;
+    int pattern;
+
+    list_sort_adaptive(&list, cmp);
+    ASSERT_LIST(list, NULL, NULL, 0);
+    list_insert_back(&list, &var1.node);
+    list_sort_adaptive(&list, cmp);
+    ASSERT_LIST(list, &var1.node, &var1.node, 1);
+    ASSERT_NODE(var1.node, NULL, NULL);
+    reset_globals();
+
+    list_insert_back(&list, &var2.node);
+    list_insert_back(&list, &var1.node);
+    list_insert_back(&list, &var5.node);
+    list_insert_back(&list, &var4.node);
+    list_insert_back(&list, &var4cpy.node);
+    list_insert_back(&list, &var3.node);
+    list_sort_adaptive(&list, cmp);
+    ASSERT_LIST(list, &var1.node, &var5.node, 6);
+    ASSERT_NODE(var1.node, NULL, &var2.node);
+    ASSERT_NODE(var2.node, &var1.node, &var3.node);
+    ASSERT_NODE(var3.node, &var2.node, &var4.node);
+    ASSERT_NODE(var4.node, &var3.node, &var4cpy.node);
+    ASSERT_NODE(var4cpy.node, &var4.node, &var5.node);
+    ASSERT_NODE(var5.node, &var4cpy.node, NULL);
+    list_sort_adaptive(&list, cmp);
+    ASSERT_LIST(list, &var1.node, &var5.node, 6);
+    ASSERT_NODE(var1.node, NULL, &var2.node);
+    ASSERT_NODE(var4.node, &var3.node, &var4cpy.node);
+    ASSERT_NODE(var5.node, &var4cpy.node, NULL);
+    reset_globals();
+
+    /* Sorted and strictly reverse sorted Lists are a single run. */
+    fill_many_(&list, 1000, 0);
+    num_comparisons = 0;
+    list_sort_adaptive(&list, cmp_counted);
+    assert(num_comparisons == 999);
+    fill_many_(&list, 1000, 1);
+    num_comparisons = 0;
+    list_sort_adaptive(&list, cmp_counted);
+    assert(num_comparisons == 999);
+    assert(list.head == &many[999].node && list.tail == &many[0].node);
+    reset_globals();
+
+    /* Sorted, reversed, sawtooth, nearly sorted and random inputs, all with plenty of ties. */
+    for (pattern = 0; pattern < 5; ++pattern) {
+        for (num_nodes = 0; num_nodes <= 1000; num_nodes += 77) {
+            fill_many_(&list, num_nodes, pattern);
+            list_sort_adaptive(&list, cmp_quarters);
+            assert_sorted_many_(&list, num_nodes);
+        }
+    }
+}
+
+static unsigned long key_of_(const ListNode *node) {
+    return (unsigned long) list_entry(node, TestStruct, node)->val / 4;
+}
+
+size_t num_key_calls;
+
+static unsigned long key_counted(const ListNode *node) {
+    ++num_key_calls;
+
+    return key_of_(node);
+}
+
+void test_list_sort_buffered(void) {
+    ListNode *scratch[2000];
+    TestStruct var4cpy = var4;
+    size_t num_nodes;
+    int pattern;
+
+    list_sort_buffered(&list, cmp, NULL, 0);
+    ASSERT_LIST(list, NULL, NULL, 0);
+    list_insert_back(&list, &var1.node);
+    list_sort_buffered(&list, cmp, NULL, 0);
+    ASSERT_LIST(list, &var1.node, &var1.node, 1);
+    ASSERT_NODE(var1.node, NULL, NULL);
+    reset_globals();
+
+    list_insert_back(&list, &var2.node);
+    list_insert_back(&list, &var1.node);
+    list_insert_back(&list, &var5.node);
+    list_insert_back(&list, &var4.node);
+    list_insert_back(&list, &var4cpy.node);
+    list_insert_back(&list, &var3.node);
+    list_sort_buffered(&list, cmp, scratch, 12);
+    ASSERT_LIST(list, &var1.node, &var5.node, 6);
+    ASSERT_NODE(var1.node, NULL, &var2.node);
+    ASSERT_NODE(var2.node, &var1.node, &var3.node);
+    ASSERT_NODE(var3.node, &var2.node, &var4.node);
+    ASSERT_NODE(var4.node, &var3.node, &var4cpy.node);
+    ASSERT_NODE(var4cpy.node, &var4.node, &var5.node);
+    ASSERT_NODE(var5.node, &var4cpy.node, NULL);
+    reset_globals();
+
+    for (pattern = 0; pattern < 5; ++pattern) {
+        for (num_nodes = 0; num_nodes <= 1000; num_nodes += 53) {
+            fill_many_(&list, num_nodes, pattern);
+            list_sort_buffered(&list, cmp_quarters, scratch, 2 * num_nodes);
+            assert_sorted_many_(&list, num_nodes);
+        }
+    }
+}
+
+void test_list_sort_radix(void) {
+    ListRadixEntry scratch[2000];
+    TestStruct var4cpy = var4;
+    size_t num_nodes;
+    int pattern;
+
+    list_sort_radix(&list, key_of_, NULL, 0);
+    ASSERT_LIST(list, NULL, NULL, 0);
+    reset_globals();
+
+    /* The key is the value divided by 4, so the first three TestStruct's tie. */
+    list_insert_back(&list, &var5.node);
+    list_insert_back(&list, &var2.node);
+    list_insert_back(&list, &var4.node);
+    list_insert_back(&list, &var1.node);
+    list_insert_back(&list, &var4cpy.node);
+    list_insert_back(&list, &var3.node);
+    list_sort_radix(&list, key_of_, scratch, 12);
+    ASSERT_LIST(list, &var2.node, &var4cpy.node, 6);
+    ASSERT_NODE(var2.node, NULL, &var1.node);
+    ASSERT_NODE(var1.node, &var2.node, &var3.node);
+    ASSERT_NODE(var3.node, &var1.node, &var5.node);
+    ASSERT_NODE(var5.node, &var3.node, &var4.node);
+    ASSERT_NODE(var4.node, &var5.node, &var4cpy.node);
+    ASSERT_NODE(var4cpy.node, &var4.node, NULL);
+    reset_globals();
+
+    for (pattern = 0; pattern < 5; ++pattern) {
+        for (num_nodes = 0; num_nodes <= 1000; num_nodes += 53) {
+            fill_many_(&list, num_nodes, pattern);
+            list_sort_radix(&list, key_of_, scratch, 2 * num_nodes);
+            assert_sorted_many_(&list, num_nodes);
+        }
+    }
+
+    /* Keys wider than a byte need several passes. */
+    for (num_nodes = 0; num_nodes < 1000; ++num_nodes) {
+        many[num_nodes].val = (rand() % 30000) * 4;
+    }
+    list_init(&list);
+    for (num_nodes = 0; num_nodes < 1000; ++num_nodes) {
+        list_insert_back(&list, &many[num_nodes].node);
+    }
+    num_key_calls = 0;
+    list_sort_radix(&list, key_counted, scratch, 2000);
+    assert(num_key_calls == 1000);
+    assert_sorted_many_(&list, 1000);
+}
+
+void test_list_merge(void) {
+    List pieces[4];
+    size_t num_nodes, i;
+    int pattern;
+
+    list_merge(&list, &other_list, cmp);
+    ASSERT_LIST(list, NULL, NULL, 0);
+    ASSERT_LIST(other_list, NULL, NULL, 0);
+
+    list_insert_back(&other_list, &var2.node);
+    list_merge(&list, &other_list, cmp);
+    ASSERT_LIST(list, &var2.node, &var2.node, 1);
+    ASSERT_LIST(other_list, NULL, NULL, 0);
+    list_merge(&list, &other_list, cmp);
+    ASSERT_LIST(list, &var2.node, &var2.node, 1);
+
+    /* Overlapping Lists are interleaved. */
+    list_insert_back(&list, &var4.node);
+    list_insert_back(&other_list, &var1.node);
+    list_insert_back(&other_list, &var3.node);
+    list_insert_back(&other_list, &var5.node);
+    list_merge(&list, &other_list, cmp);
+    ASSERT_LIST(list, &var1.node, &var5.node, 5);
+    ASSERT_LIST(other_list, NULL, NULL, 0);
+    ASSERT_NODE(var1.node, NULL, &var2.node);
+    ASSERT_NODE(var2.node, &var1.node, &var3.node);
+    ASSERT_NODE(var3.node, &var2.node, &var4.node);
+    ASSERT_NODE(var4.node, &var3.node, &var5.node);
+    ASSERT_NODE(var5.node, &var4.node, NULL);
+    reset_globals();
+
+    /* Disjoint Lists are spliced, and ties favor the destination List. */
+    list_insert_back(&list, &var1.node);
+    list_insert_back(&list, &var2.node);
+    var3.val = 2;
+    list_insert_back(&other_list, &var3.node);
+    list_insert_back(&other_list, &var4.node);
+    list_merge(&list, &other_list, cmp);
+    ASSERT_LIST(list, &var1.node, &var4.node, 4);
+    ASSERT_NODE(var2.node, &var1.node, &var3.node);
+    ASSERT_NODE(var3.node, &var2.node, &var4.node);
+    var5.val = 1;
+    list_insert_back(&other_list, &var5.node);
+    list_merge(&list, &other_list, cmp);
+    ASSERT_LIST(list, &var1.node, &var4.node, 5);
+    ASSERT_NODE(var1.node, NULL, &var5.node);
+    ASSERT_NODE(var5.node, &var1.node, &var2.node);
+    reset_globals();
+
+    /* Sort the pieces of a List separately (as separate threads would), then merge them pairwise. */
+    for (pattern = 0; pattern < 5; ++pattern) {
+        for (num_nodes = 0; num_nodes <= 1000; num_nodes += 91) {
+            fill_many_(&list, num_nodes, pattern);
+
+            for (i = 0; i < 4; ++i) {
+                size_t piece_size = i < 3 ? num_nodes / 4 : list.size;
+
+                list_init(&pieces[i]);
+
+                if (piece_size > 0) {
+                    ListNode *from = list.head, *to = list_at(&list, piece_size - 1);
+
+                    list_cut(&list, from, to, piece_size);
+                    list_paste(&pieces[i], NULL, from, to, NULL, piece_size);
+                }
+
+                list_sort_adaptive(&pieces[i], cmp_quarters);
+            }
+
+            ASSERT_LIST(list, NULL, NULL, 0);
+            list_merge(&pieces[0], &pieces[1], cmp_quarters);
+            list_merge(&pieces[2], &pieces[3], cmp_quarters);
+            list_merge(&pieces[0], &pieces[2], cmp_quarters);
+            assert_sorted_many_(&pieces[0], num_nodes);
+        }
+    }
+}
+
 void test_list_entry(void) {
     assert(list_entry(&var1.node, TestStruct, node)->val == 1);
     assert(list_entry(&var1.node, TestStruct, node)->node.prev == LIST_POISON_PREV);
@@ -713,6 +1075,7 @@ TestFunc test_funcs[] = {
     test_list_empty,
     test_list_index_of,
     test_list_at,
+    test_list_index,
     test_list_insert_left,
     test_list_insert_right,
     test_list_insert_front,
@@ -728,6 +1091,10 @@ TestFunc test_funcs[] = {
     test_list_cut,
     test_list_paste,
     test_list_sort,
+    test_list_sort_adaptive,
+    test_list_sort_buffered,
+    test_list_sort_radix,
+    test_list_merge,
     test_list_entry,
     test_list_for_each,
     test_list_for_each_reverse,
@@ -748,7 +1115,7 @@ int main(int argc, char *argv[]) {
     assert(argc == 2);
     strcat(msg, argv[1]);
 
-    assert(sizeof(test_funcs) / sizeof(TestFunc) == 37);
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 42);
     run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
 
     return 0;
@@ -0,0 +1,421 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+
+#include "testing_framework.h"
+
+/* Test header guard. */
+#include "../src/lrucache.h"
+#include "../src/lrucache.h"
+
+/* ========================================================================================================
+ *
+ *                                             TESTING UTILITIES
+ *
+ * ======================================================================================================== */
+
+#define CAPACITY 3
+
+typedef struct TestStruct {
+    int key;
+    LRUCacheNode node;
+} TestStruct;
+
+TestStruct var1, var2, var3, var4, var5, var6;
+LRUCache lrucache;
+HashTableNode *bkt_arr[4];
+TestStruct *evicted[8];
+size_t num_evicted;
+void *aux_ptr;
+
+#define ASSERT_LRUCACHE(lrucache, size_of_lrucache) \
+    do { \
+        assert(lrucache.hashtable.size == size_of_lrucache); \
+        assert(lrucache.list.size == size_of_lrucache); \
+    } while (0)
+
+#define PUT(lrucache, var) \
+    lrucache_put(&lrucache, &(var).key, &(var).node)
+
+static size_t hash_func(const void *key) {
+    return (size_t) *(const int*) key;
+}
+
+static int equal_func(const void *key, const HashTableNode *node) {
+    return *(const int*)key == lrucache_hash_entry(node, TestStruct, node)->key;
+}
+
+static const void* key_func(const HashTableNode *node) {
+    return &lrucache_hash_entry(node, TestStruct, node)->key;
+}
+
+static void evict_func(LRUCacheNode *node, void *auxiliary_data) {
+    assert((void**) auxiliary_data == &aux_ptr);
+    assert(!lrucache_peek(&lrucache, &lrucache_entry(node, TestStruct, node)->key) ||
+           lrucache_peek(&lrucache, &lrucache_entry(node, TestStruct, node)->key) != node);
+
+    evicted[num_evicted++] = lrucache_entry(node, TestStruct, node);
+}
+
+/* Asserts that the List of the cache holds exactly the @ref num_vars TestStruct's passed, front to back. */
+static void assert_order_(size_t num_vars, ...) {
+    ListNode *n;
+    va_list args;
+    size_t i = 0;
+
+    va_start(args, num_vars);
+    list_for_each(n, &lrucache.list) {
+        assert(i < num_vars);
+        assert(&va_arg(args, TestStruct*)->node == list_entry(n, LRUCacheNode, list_node));
+        ++i;
+    }
+    va_end(args);
+
+    assert(i == num_vars);
+}
+
+static void reset_globals(void) {
+    lrucache_init(
+        &lrucache,
+        bkt_arr,
+        4,
+        CAPACITY,
+        LRUCACHE_POLICY_LRU,
+        hash_func,
+        equal_func,
+        key_func,
+        evict_func,
+        &aux_ptr
+    );
+
+    num_evicted = 0;
+
+    var1.key = 1;
+    var2.key = 2;
+    var3.key = 3;
+    var4.key = 4;
+    var5.key = 5;
+    var6.key = 6;
+}
+
+/* ========================================================================================================
+ *
+ *                                             TESTING FUNCTIONS
+ *
+ * ======================================================================================================== */
+
+void test_lrucache_init(void) {
+    LRUCacheNode node_init_with_macro = LRUCACHE_NODE_INIT;
+    assert(node_init_with_macro.hash_node.next == HASHTABLE_POISON_NEXT);
+    assert(node_init_with_macro.list_node.prev == LIST_POISON_PREV);
+    assert(node_init_with_macro.list_node.next == LIST_POISON_NEXT);
+    assert(node_init_with_macro.referenced == 0);
+
+    ASSERT_LRUCACHE(lrucache, 0);
+    assert(lrucache.hand == NULL);
+    assert(lrucache.capacity == CAPACITY);
+    assert(lrucache.policy == LRUCACHE_POLICY_LRU);
+    assert(lrucache.key == key_func);
+    assert(lrucache.evict == evict_func);
+    assert(lrucache.auxiliary_data == &aux_ptr);
+
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    lrucache_init(&lrucache, bkt_arr, 4, 1, LRUCACHE_POLICY_CLOCK, hash_func, equal_func, key_func, NULL, NULL);
+    ASSERT_LRUCACHE(lrucache, 0);
+    assert(bkt_arr[1] == NULL && bkt_arr[2] == NULL);
+    assert(lrucache.capacity == 1);
+    assert(lrucache.policy == LRUCACHE_POLICY_CLOCK);
+    assert(lrucache.evict == NULL);
+    assert(num_evicted == 0);
+}
+
+void test_lrucache_capacity(void) {
+    assert(lrucache_capacity(&lrucache) == CAPACITY);
+
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    PUT(lrucache, var3);
+    PUT(lrucache, var4);
+    assert(lrucache_capacity(&lrucache) == CAPACITY);
+    assert(lrucache_size(&lrucache) == CAPACITY);
+}
+
+void test_lrucache_size(void) {
+    assert(lrucache_size(&lrucache) == 0);
+
+    PUT(lrucache, var1);
+    assert(lrucache_size(&lrucache) == 1);
+
+    PUT(lrucache, var2);
+    PUT(lrucache, var3);
+    PUT(lrucache, var4);
+    assert(lrucache_size(&lrucache) == 3);
+
+    lrucache_remove_key(&lrucache, &var4.key);
+    assert(lrucache_size(&lrucache) == 2);
+}
+
+void test_lrucache_empty(void) {
+    assert(lrucache_empty(&lrucache));
+
+    PUT(lrucache, var1);
+    assert(!lrucache_empty(&lrucache));
+
+    lrucache_remove_key(&lrucache, &var1.key);
+    assert(lrucache_empty(&lrucache));
+}
+
+void test_lrucache_contains_key(void) {
+    assert(!lrucache_contains_key(&lrucache, &var1.key));
+
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    assert(lrucache_contains_key(&lrucache, &var1.key));
+    assert(lrucache_contains_key(&lrucache, &var2.key));
+    assert(!lrucache_contains_key(&lrucache, &var3.key));
+
+    /* Contains does not count as a use, so 1 is still the least recently used key. */
+    PUT(lrucache, var3);
+    PUT(lrucache, var4);
+    assert(!lrucache_contains_key(&lrucache, &var1.key));
+}
+
+void test_lrucache_put(void) {
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    PUT(lrucache, var3);
+    ASSERT_LRUCACHE(lrucache, 3);
+    assert_order_(3, &var3, &var2, &var1);
+    assert(num_evicted == 0);
+
+    /* A full cache evicts its least recently used key first. */
+    PUT(lrucache, var4);
+    ASSERT_LRUCACHE(lrucache, 3);
+    assert_order_(3, &var4, &var3, &var2);
+    assert(num_evicted == 1 && evicted[0] == &var1);
+    assert(!lrucache_contains_key(&lrucache, &var1.key));
+
+    /* Putting an existing key replaces its LRUCacheNode and makes it the most recently used. */
+    var5.key = 2;
+    PUT(lrucache, var5);
+    ASSERT_LRUCACHE(lrucache, 3);
+    assert_order_(3, &var5, &var4, &var3);
+    assert(num_evicted == 2 && evicted[1] == &var2);
+    assert(lrucache_peek(&lrucache, &var5.key) == &var5.node);
+
+    PUT(lrucache, var6);
+    assert_order_(3, &var6, &var5, &var4);
+    assert(num_evicted == 3 && evicted[2] == &var3);
+
+    /* The evict callback function is optional. */
+    lrucache_init(&lrucache, bkt_arr, 4, 1, LRUCACHE_POLICY_LRU, hash_func, equal_func, key_func, NULL, NULL);
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    ASSERT_LRUCACHE(lrucache, 1);
+    assert_order_(1, &var2);
+    assert(num_evicted == 3);
+}
+
+void test_lrucache_get(void) {
+    assert(lrucache_get(&lrucache, &var1.key) == NULL);
+
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    PUT(lrucache, var3);
+
+    assert(lrucache_get(&lrucache, &var1.key) == &var1.node);
+    assert_order_(3, &var1, &var3, &var2);
+
+    assert(lrucache_get(&lrucache, &var1.key) == &var1.node);
+    assert_order_(3, &var1, &var3, &var2);
+
+    assert(lrucache_get(&lrucache, &var2.key) == &var2.node);
+    assert_order_(3, &var2, &var1, &var3);
+
+    PUT(lrucache, var4);
+    assert(num_evicted == 1 && evicted[0] == &var3);
+    assert(lrucache_get(&lrucache, &var3.key) == NULL);
+    assert_order_(3, &var4, &var2, &var1);
+}
+
+void test_lrucache_peek(void) {
+    assert(lrucache_peek(&lrucache, &var1.key) == NULL);
+
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    PUT(lrucache, var3);
+
+    assert(lrucache_peek(&lrucache, &var1.key) == &var1.node);
+    assert(lrucache_peek(&lrucache, &var4.key) == NULL);
+    assert_order_(3, &var3, &var2, &var1);
+
+    PUT(lrucache, var4);
+    assert(num_evicted == 1 && evicted[0] == &var1);
+}
+
+void test_lrucache_remove_key(void) {
+    lrucache_remove_key(&lrucache, &var1.key);
+    ASSERT_LRUCACHE(lrucache, 0);
+
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    PUT(lrucache, var3);
+
+    lrucache_remove_key(&lrucache, &var2.key);
+    ASSERT_LRUCACHE(lrucache, 2);
+    assert_order_(2, &var3, &var1);
+    assert(!lrucache_contains_key(&lrucache, &var2.key));
+    assert(var2.node.hash_node.next == HASHTABLE_POISON_NEXT);
+    assert(var2.node.list_node.prev == LIST_POISON_PREV);
+    assert(var2.node.list_node.next == LIST_POISON_NEXT);
+
+    /* Removal does not call the evict callback function, and frees up room. */
+    PUT(lrucache, var4);
+    ASSERT_LRUCACHE(lrucache, 3);
+    assert(num_evicted == 0);
+
+    lrucache_remove_key(&lrucache, &var5.key);
+    ASSERT_LRUCACHE(lrucache, 3);
+}
+
+void test_lrucache_remove_all(void) {
+    lrucache_remove_all(&lrucache);
+    ASSERT_LRUCACHE(lrucache, 0);
+
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    PUT(lrucache, var3);
+
+    lrucache_remove_all(&lrucache);
+    ASSERT_LRUCACHE(lrucache, 0);
+    assert(lrucache.hand == NULL);
+    assert(bkt_arr[0] == NULL && bkt_arr[1] == NULL && bkt_arr[2] == NULL && bkt_arr[3] == NULL);
+    assert(num_evicted == 0);
+
+    PUT(lrucache, var4);
+    ASSERT_LRUCACHE(lrucache, 1);
+}
+
+void test_lrucache_clock(void) {
+    lrucache_init(
+        &lrucache,
+        bkt_arr,
+        4,
+        CAPACITY,
+        LRUCACHE_POLICY_CLOCK,
+        hash_func,
+        equal_func,
+        key_func,
+        evict_func,
+        &aux_ptr
+    );
+
+    PUT(lrucache, var1);
+    PUT(lrucache, var2);
+    PUT(lrucache, var3);
+    assert_order_(3, &var3, &var2, &var1);
+
+    /* A hit only sets the referenced flag. */
+    assert(lrucache_get(&lrucache, &var1.key) == &var1.node);
+    assert(var1.node.referenced == 1);
+    assert_order_(3, &var3, &var2, &var1);
+
+    /* The sweep starts at the back, gives 1 a second chance, and takes the place of 2. */
+    PUT(lrucache, var4);
+    assert(num_evicted == 1 && evicted[0] == &var2);
+    assert(var1.node.referenced == 0);
+    assert_order_(3, &var3, &var4, &var1);
+    assert(lrucache.hand == &var3.node.list_node);
+
+    PUT(lrucache, var5);
+    assert(num_evicted == 2 && evicted[1] == &var3);
+    assert_order_(3, &var5, &var4, &var1);
+    assert(lrucache.hand == NULL);
+
+    /* The sweep wraps around to the back. */
+    PUT(lrucache, var6);
+    assert(num_evicted == 3 && evicted[2] == &var1);
+    assert_order_(3, &var5, &var4, &var6);
+    assert(lrucache.hand == &var4.node.list_node);
+
+    /* A replacement takes the place of the old LRUCacheNode, including the hand. */
+    var1.key = 4;
+    PUT(lrucache, var1);
+    assert(num_evicted == 4 && evicted[3] == &var4);
+    assert_order_(3, &var5, &var1, &var6);
+    assert(lrucache.hand == &var1.node.list_node);
+    assert(var1.node.referenced == 1);
+
+    /* Every referenced flag is cleared within one circle. */
+    assert(lrucache_get(&lrucache, &var5.key) == &var5.node);
+    assert(lrucache_get(&lrucache, &var6.key) == &var6.node);
+    var2.key = 2;
+    PUT(lrucache, var2);
+    assert(num_evicted == 5 && evicted[4] == &var1);
+    assert(var5.node.referenced == 0 && var6.node.referenced == 0);
+    assert_order_(3, &var5, &var2, &var6);
+
+    /* Removing the LRUCacheNode at the hand moves the hand on. */
+    lrucache_remove_key(&lrucache, &var5.key);
+    assert(lrucache.hand == NULL);
+    assert_order_(2, &var2, &var6);
+}
+
+void test_lrucache_entry(void) {
+    assert(lrucache_entry(&var1.node, TestStruct, node) == &var1);
+    assert(lrucache_entry(&var2.node, TestStruct, node)->key == 2);
+}
+
+void test_lrucache_hash_entry(void) {
+    assert(lrucache_hash_entry(&var1.node.hash_node, TestStruct, node) == &var1);
+    assert(lrucache_hash_entry(&var2.node.hash_node, TestStruct, node)->key == 2);
+}
+
+TestFunc test_funcs[] = {
+    test_lrucache_init,
+    test_lrucache_capacity,
+    test_lrucache_size,
+    test_lrucache_empty,
+    test_lrucache_contains_key,
+    test_lrucache_put,
+    test_lrucache_get,
+    test_lrucache_peek,
+    test_lrucache_remove_key,
+    test_lrucache_remove_all,
+    test_lrucache_clock,
+    test_lrucache_entry,
+    test_lrucache_hash_entry
+};
+
+int main(int argc, char *argv[]) {
+    char msg[100] = "LRUCache ";
+    assert(argc == 2);
+    strcat(msg, argv[1]);
+
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 13);
+    run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
+
+    return 0;
+}
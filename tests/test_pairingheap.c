@@ -0,0 +1,362 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+
+#include "testing_framework.h"
+
+/* Test header guard. */
+#include "../src/pairingheap.h"
+#include "../src/pairingheap.h"
+
+/* ========================================================================================================
+ *
+ *                                             TESTING UTILITIES
+ *
+ * ======================================================================================================== */
+
+typedef struct TestStruct {
+    int val;
+    PairingHeapNode node;
+} TestStruct;
+
+#define NUM_RANDOM_VARS 1000
+
+TestStruct var1, var2, var3;
+TestStruct random_vars[NUM_RANDOM_VARS];
+PairingHeap pairingheap, src_pairingheap;
+
+#define ASSERT_PAIRINGHEAP(pairingheap, root_ptr, size_of_pairingheap) \
+    do { \
+        assert(pairingheap.root == (PairingHeapNode*) (root_ptr)); \
+        assert(pairingheap.size == size_of_pairingheap); \
+    } while (0)
+
+#define ASSERT_NODE(node, child_ptr, next_ptr, prev_ptr) \
+    do { \
+        assert(node.child == (PairingHeapNode*) (child_ptr)); \
+        assert(node.next == (PairingHeapNode*) (next_ptr)); \
+        assert(node.prev == (PairingHeapNode*) (prev_ptr)); \
+    } while (0)
+
+#define ASSERT_POISONED(node) \
+    ASSERT_NODE(node, PAIRINGHEAP_POISON_CHILD, PAIRINGHEAP_POISON_NEXT, PAIRINGHEAP_POISON_PREV)
+
+static int compare(const PairingHeapNode *a, const PairingHeapNode *b) {
+    return pairingheap_entry(a, TestStruct, node)->val - pairingheap_entry(b, TestStruct, node)->val;
+}
+
+static void reset_globals(void) {
+    pairingheap_init(&pairingheap, compare);
+    pairingheap_init(&src_pairingheap, compare);
+
+    var1.val = 1;
+    var1.node.child = PAIRINGHEAP_POISON_CHILD;
+    var1.node.next = PAIRINGHEAP_POISON_NEXT;
+    var1.node.prev = PAIRINGHEAP_POISON_PREV;
+
+    var2.val = 2;
+    var2.node.child = PAIRINGHEAP_POISON_CHILD;
+    var2.node.next = PAIRINGHEAP_POISON_NEXT;
+    var2.node.prev = PAIRINGHEAP_POISON_PREV;
+
+    var3.val = 3;
+    var3.node.child = PAIRINGHEAP_POISON_CHILD;
+    var3.node.next = PAIRINGHEAP_POISON_NEXT;
+    var3.node.prev = PAIRINGHEAP_POISON_PREV;
+}
+
+/*
+ * Pops every PairingHeapNode of the pairingheap, checking that they come out in order and that there are
+ * size_of_pairingheap of them.
+ */
+static void assert_pop_order_(size_t size_of_pairingheap) {
+    PairingHeapNode *n;
+    int last_val = -1;
+    size_t i = 0;
+
+    while ((n = pairingheap_pop(&pairingheap)) != NULL) {
+        assert(pairingheap_entry(n, TestStruct, node)->val >= last_val);
+        last_val = pairingheap_entry(n, TestStruct, node)->val;
+        ASSERT_POISONED((*n));
+        ++i;
+    }
+
+    assert(i == size_of_pairingheap);
+    ASSERT_PAIRINGHEAP(pairingheap, NULL, 0);
+}
+
+/* ========================================================================================================
+ *
+ *                                             TESTING FUNCTIONS
+ *
+ * ======================================================================================================== */
+
+void test_pairingheap_init(void) {
+    PairingHeapNode node_init_with_macro = PAIRINGHEAP_NODE_INIT;
+    ASSERT_POISONED(node_init_with_macro);
+
+    pairingheap_init(&pairingheap, compare);
+    assert(pairingheap.compare == compare);
+    ASSERT_PAIRINGHEAP(pairingheap, NULL, 0);
+}
+
+void test_pairingheap_peek(void) {
+    assert(pairingheap_peek(&pairingheap) == NULL);
+
+    pairingheap_push(&pairingheap, &var2.node);
+    assert(pairingheap_peek(&pairingheap) == &var2.node);
+    pairingheap_push(&pairingheap, &var3.node);
+    assert(pairingheap_peek(&pairingheap) == &var2.node);
+    pairingheap_push(&pairingheap, &var1.node);
+    assert(pairingheap_peek(&pairingheap) == &var1.node);
+}
+
+void test_pairingheap_size(void) {
+    assert(pairingheap_size(&pairingheap) == 0);
+
+    pairingheap_push(&pairingheap, &var1.node);
+    assert(pairingheap_size(&pairingheap) == 1);
+    pairingheap_push(&pairingheap, &var2.node);
+    assert(pairingheap_size(&pairingheap) == 2);
+    pairingheap_pop(&pairingheap);
+    assert(pairingheap_size(&pairingheap) == 1);
+}
+
+void test_pairingheap_empty(void) {
+    assert(pairingheap_empty(&pairingheap) == 1);
+
+    pairingheap_push(&pairingheap, &var1.node);
+    assert(pairingheap_empty(&pairingheap) == 0);
+    pairingheap_pop(&pairingheap);
+    assert(pairingheap_empty(&pairingheap) == 1);
+}
+
+void test_pairingheap_push(void) {
+    pairingheap_push(&pairingheap, &var2.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var2.node, 1);
+    ASSERT_NODE(var2.node, NULL, NULL, NULL);
+
+    /* A lower priority node becomes the first child of the root. */
+    pairingheap_push(&pairingheap, &var3.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var2.node, 2);
+    ASSERT_NODE(var2.node, &var3.node, NULL, NULL);
+    ASSERT_NODE(var3.node, NULL, NULL, &var2.node);
+
+    /* A higher priority node becomes the root. */
+    pairingheap_push(&pairingheap, &var1.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var1.node, 3);
+    ASSERT_NODE(var1.node, &var2.node, NULL, NULL);
+    ASSERT_NODE(var2.node, &var3.node, NULL, &var1.node);
+    ASSERT_NODE(var3.node, NULL, NULL, &var2.node);
+}
+
+void test_pairingheap_merge(void) {
+    /* Merging an empty heap does nothing. */
+    pairingheap_push(&pairingheap, &var2.node);
+    pairingheap_merge(&pairingheap, &src_pairingheap);
+    ASSERT_PAIRINGHEAP(pairingheap, &var2.node, 1);
+    ASSERT_PAIRINGHEAP(src_pairingheap, NULL, 0);
+
+    /* Merging into an empty heap moves the tree. */
+    pairingheap_merge(&src_pairingheap, &pairingheap);
+    ASSERT_PAIRINGHEAP(src_pairingheap, &var2.node, 1);
+    ASSERT_PAIRINGHEAP(pairingheap, NULL, 0);
+
+    pairingheap_push(&pairingheap, &var3.node);
+    pairingheap_push(&src_pairingheap, &var1.node);
+    pairingheap_merge(&pairingheap, &src_pairingheap);
+    ASSERT_PAIRINGHEAP(pairingheap, &var1.node, 3);
+    ASSERT_PAIRINGHEAP(src_pairingheap, NULL, 0);
+    ASSERT_NODE(var1.node, &var3.node, NULL, NULL);
+    ASSERT_NODE(var3.node, NULL, &var2.node, &var1.node);
+    ASSERT_NODE(var2.node, NULL, NULL, &var3.node);
+
+    assert_pop_order_(3);
+}
+
+void test_pairingheap_decrease_key(void) {
+    pairingheap_push(&pairingheap, &var1.node);
+    pairingheap_push(&pairingheap, &var2.node);
+    pairingheap_push(&pairingheap, &var3.node);
+
+    /* The root stays in place. */
+    var1.val = 0;
+    pairingheap_decrease_key(&pairingheap, &var1.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var1.node, 3);
+
+    /* A node that still has a lower priority than the root becomes its first child. */
+    var2.val = 1;
+    pairingheap_decrease_key(&pairingheap, &var2.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var1.node, 3);
+    ASSERT_NODE(var1.node, &var2.node, NULL, NULL);
+    ASSERT_NODE(var2.node, NULL, &var3.node, &var1.node);
+    ASSERT_NODE(var3.node, NULL, NULL, &var2.node);
+
+    var3.val = -1;
+    pairingheap_decrease_key(&pairingheap, &var3.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var3.node, 3);
+    ASSERT_NODE(var3.node, &var1.node, NULL, NULL);
+    ASSERT_NODE(var1.node, &var2.node, NULL, &var3.node);
+    ASSERT_NODE(var2.node, NULL, NULL, &var1.node);
+
+    assert(pairingheap_pop(&pairingheap) == &var3.node);
+    assert(pairingheap_pop(&pairingheap) == &var1.node);
+    assert(pairingheap_pop(&pairingheap) == &var2.node);
+}
+
+void test_pairingheap_pop(void) {
+    assert(pairingheap_pop(&pairingheap) == NULL);
+
+    pairingheap_push(&pairingheap, &var3.node);
+    pairingheap_push(&pairingheap, &var1.node);
+    pairingheap_push(&pairingheap, &var2.node);
+
+    assert(pairingheap_pop(&pairingheap) == &var1.node);
+    ASSERT_POISONED(var1.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var2.node, 2);
+    ASSERT_NODE(var2.node, &var3.node, NULL, NULL);
+    ASSERT_NODE(var3.node, NULL, NULL, &var2.node);
+
+    assert(pairingheap_pop(&pairingheap) == &var2.node);
+    ASSERT_POISONED(var2.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var3.node, 1);
+    ASSERT_NODE(var3.node, NULL, NULL, NULL);
+
+    assert(pairingheap_pop(&pairingheap) == &var3.node);
+    ASSERT_POISONED(var3.node);
+    ASSERT_PAIRINGHEAP(pairingheap, NULL, 0);
+
+    assert(pairingheap_pop(&pairingheap) == NULL);
+}
+
+void test_pairingheap_remove(void) {
+    pairingheap_push(&pairingheap, &var1.node);
+    pairingheap_push(&pairingheap, &var3.node);
+    pairingheap_push(&pairingheap, &var2.node);
+
+    /* A first child. */
+    pairingheap_remove(&pairingheap, &var2.node);
+    ASSERT_POISONED(var2.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var1.node, 2);
+    ASSERT_NODE(var1.node, &var3.node, NULL, NULL);
+    ASSERT_NODE(var3.node, NULL, NULL, &var1.node);
+
+    /* A later sibling. */
+    pairingheap_push(&pairingheap, &var2.node);
+    pairingheap_remove(&pairingheap, &var3.node);
+    ASSERT_POISONED(var3.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var1.node, 2);
+    ASSERT_NODE(var1.node, &var2.node, NULL, NULL);
+    ASSERT_NODE(var2.node, NULL, NULL, &var1.node);
+
+    /* A node with children. */
+    pairingheap_push(&pairingheap, &var3.node);
+    pairingheap_decrease_key(&pairingheap, &var2.node);
+    pairingheap_remove(&pairingheap, &var1.node);
+    ASSERT_POISONED(var1.node);
+    ASSERT_PAIRINGHEAP(pairingheap, &var2.node, 2);
+
+    /* A root without children. */
+    pairingheap_remove(&pairingheap, &var2.node);
+    pairingheap_remove(&pairingheap, &var3.node);
+    ASSERT_POISONED(var3.node);
+    ASSERT_PAIRINGHEAP(pairingheap, NULL, 0);
+}
+
+void test_pairingheap_remove_all(void) {
+    pairingheap_remove_all(&pairingheap);
+    ASSERT_PAIRINGHEAP(pairingheap, NULL, 0);
+
+    pairingheap_push(&pairingheap, &var1.node);
+    pairingheap_push(&pairingheap, &var2.node);
+    pairingheap_push(&pairingheap, &var3.node);
+
+    pairingheap_remove_all(&pairingheap);
+    ASSERT_PAIRINGHEAP(pairingheap, NULL, 0);
+    ASSERT_POISONED(var1.node);
+}
+
+void test_pairingheap_entry(void) {
+    assert(pairingheap_entry(&var1.node, TestStruct, node) == &var1);
+    assert(pairingheap_entry(&var2.node, TestStruct, node)->val == 2);
+}
+
+void test_pairingheap_random(void) {
+    size_t i, size = NUM_RANDOM_VARS;
+
+    srand(0);
+
+    for (i = 0; i < NUM_RANDOM_VARS; ++i) {
+        random_vars[i].val = 1 + rand() % (NUM_RANDOM_VARS / 2);
+        pairingheap_push(i % 2 ? &pairingheap : &src_pairingheap, &random_vars[i].node);
+    }
+
+    pairingheap_merge(&pairingheap, &src_pairingheap);
+    ASSERT_PAIRINGHEAP(pairingheap, pairingheap.root, NUM_RANDOM_VARS);
+
+    /* Restructure the tree, then raise priorities all over it and remove nodes from wherever they are. */
+    for (i = 0; i < NUM_RANDOM_VARS / 10; ++i) {
+        pairingheap_push(&pairingheap, pairingheap_pop(&pairingheap));
+    }
+
+    for (i = 0; i < NUM_RANDOM_VARS; i += 3) {
+        random_vars[i].val -= rand() % (random_vars[i].val + 1);
+        pairingheap_decrease_key(&pairingheap, &random_vars[i].node);
+    }
+
+    for (i = 1; i < NUM_RANDOM_VARS; i += 7) {
+        pairingheap_remove(&pairingheap, &random_vars[i].node);
+        ASSERT_POISONED(random_vars[i].node);
+        --size;
+    }
+
+    assert(pairingheap_size(&pairingheap) == size);
+    assert_pop_order_(size);
+}
+
+TestFunc test_funcs[] = {
+    test_pairingheap_init,
+    test_pairingheap_peek,
+    test_pairingheap_size,
+    test_pairingheap_empty,
+    test_pairingheap_push,
+    test_pairingheap_merge,
+    test_pairingheap_decrease_key,
+    test_pairingheap_pop,
+    test_pairingheap_remove,
+    test_pairingheap_remove_all,
+    test_pairingheap_entry,
+    test_pairingheap_random
+};
+
+int main(int argc, char *argv[]) {
+    char msg[100] = "PairingHeap ";
+    assert(argc == 2);
+    strcat(msg, argv[1]);
+
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 12);
+    run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
+
+    return 0;
+}
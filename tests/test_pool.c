@@ -0,0 +1,431 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "testing_framework.h"
+
+/* Test header guard. */
+#include "../src/pool.h"
+#include "../src/pool.h"
+
+/* ========================================================================================================
+ *
+ *                                             TESTING UTILITIES
+ *
+ * ======================================================================================================== */
+
+typedef struct TestStruct {
+    int val;
+    double weight;
+} TestStruct;
+
+#define NUM_OBJECTS 100
+#define NUM_THREADS 4
+#define NUM_ROUNDS 2000
+#define OBJECTS_PER_ROUND 20
+
+/* Rounds @ref x up to a multiple of POOL_ALIGNMENT. */
+#define ALIGN_UP(x) (((x) + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT * POOL_ALIGNMENT)
+
+/* The memory of the Pool, with room for NUM_OBJECTS objects of any POOL_ALIGNMENT. */
+TestStruct memory[NUM_OBJECTS * ALIGN_UP(sizeof(TestStruct)) / sizeof(TestStruct) + POOL_ALIGNMENT];
+TestStruct *objects[NUM_OBJECTS];
+Pool pool;
+PoolCache poolcache, poolcache2;
+
+/* The Pool, initialized to hold exactly NUM_OBJECTS objects. */
+static void init_pool(void) {
+    size_t offset = (POOL_ALIGNMENT - (size_t) memory % POOL_ALIGNMENT) % POOL_ALIGNMENT;
+
+    pool_init(&pool, memory, offset + NUM_OBJECTS * ALIGN_UP(sizeof(TestStruct)), sizeof(TestStruct));
+    assert(pool_capacity(&pool) == NUM_OBJECTS);
+}
+
+static void reset_globals(void) {
+    size_t i;
+
+    init_pool();
+
+    for (i = 0; i < NUM_OBJECTS; ++i) {
+        objects[i] = NULL;
+    }
+
+    poolcache_init(&poolcache, &pool, 4);
+    poolcache_init(&poolcache2, &pool, 4);
+}
+
+/* Allocates @ref n objects from the pool into the objects array, and checks that they are distinct slots. */
+static void alloc_objects(size_t n) {
+    size_t i, j;
+
+    for (i = 0; i < n; ++i) {
+        objects[i] = (TestStruct*) pool_alloc(&pool);
+        assert(objects[i]);
+        assert(pool_contains(&pool, objects[i]));
+        assert((size_t) objects[i] % POOL_ALIGNMENT == 0);
+
+        for (j = 0; j < i; ++j) {
+            assert(objects[j] != objects[i]);
+        }
+
+        objects[i]->val = (int) i;
+    }
+}
+
+/* Allocates and frees objects through its own PoolCache, checking that no other thread holds them meanwhile. */
+static void* cache_worker(void *arg) {
+    TestStruct *held[OBJECTS_PER_ROUND];
+    PoolCache cache;
+    int id = *(int*) arg;
+    size_t round, i;
+
+    poolcache_init(&cache, &pool, 3);
+
+    for (round = 0; round < NUM_ROUNDS; ++round) {
+        for (i = 0; i < OBJECTS_PER_ROUND; ++i) {
+            held[i] = (TestStruct*) poolcache_alloc(&cache);
+            assert(held[i]);
+            held[i]->val = id;
+        }
+
+        for (i = 0; i < OBJECTS_PER_ROUND; ++i) {
+            assert(held[i]->val == id);
+            held[i]->val = -1;
+            poolcache_free(&cache, held[i]);
+        }
+    }
+
+    poolcache_flush(&cache);
+    assert(poolcache_size(&cache) == 0);
+
+    return NULL;
+}
+
+/* ========================================================================================================
+ *
+ *                                             TESTING FUNCTIONS
+ *
+ * ======================================================================================================== */
+
+void test_pool_init(void) {
+    char *bytes = (char*) memory;
+    size_t offset;
+
+    pool_init(&pool, memory, sizeof(memory), sizeof(TestStruct));
+    assert((size_t) pool.memory % POOL_ALIGNMENT == 0);
+    assert(pool.fresh == pool.memory);
+    assert(pool.free_list == NULL);
+    assert(pool.object_size == ALIGN_UP(sizeof(TestStruct)));
+    assert(pool.size == 0);
+    assert(pool.locked == 0);
+
+    /* Misaligned memory has its first bytes skipped. */
+    offset = (POOL_ALIGNMENT - (size_t) (bytes + 1) % POOL_ALIGNMENT) % POOL_ALIGNMENT;
+    pool_init(&pool, bytes + 1, 10 * POOL_ALIGNMENT, 1);
+    assert(pool.memory == bytes + 1 + offset);
+    assert(pool.object_size == POOL_ALIGNMENT);
+    assert(pool_capacity(&pool) == (10 * POOL_ALIGNMENT - offset) / POOL_ALIGNMENT);
+
+    /* Memory too small for a single object. */
+    pool_init(&pool, bytes, POOL_ALIGNMENT - 1, 1);
+    assert(pool_capacity(&pool) == 0);
+    assert(pool_alloc(&pool) == NULL);
+
+    pool_init(&pool, bytes + 1, 0, sizeof(TestStruct));
+    assert(pool_capacity(&pool) == 0);
+    assert(pool_alloc(&pool) == NULL);
+}
+
+void test_pool_object_size(void) {
+    assert(pool_object_size(&pool) == ALIGN_UP(sizeof(TestStruct)));
+    assert(pool_object_size(&pool) % POOL_ALIGNMENT == 0);
+    assert(pool_object_size(&pool) >= sizeof(TestStruct));
+
+    pool_init(&pool, memory, sizeof(memory), 1);
+    assert(pool_object_size(&pool) == POOL_ALIGNMENT);
+    assert(pool_object_size(&pool) >= sizeof(void*));
+
+    pool_init(&pool, memory, sizeof(memory), POOL_ALIGNMENT + 1);
+    assert(pool_object_size(&pool) == 2 * POOL_ALIGNMENT);
+}
+
+void test_pool_capacity(void) {
+    assert(pool_capacity(&pool) == NUM_OBJECTS);
+
+    alloc_objects(10);
+    assert(pool_capacity(&pool) == NUM_OBJECTS);
+
+    pool_reset(&pool);
+    assert(pool_capacity(&pool) == NUM_OBJECTS);
+}
+
+void test_pool_size(void) {
+    assert(pool_size(&pool) == 0);
+
+    alloc_objects(3);
+    assert(pool_size(&pool) == 3);
+
+    pool_free(&pool, objects[1]);
+    assert(pool_size(&pool) == 2);
+
+    assert(poolcache_alloc(&poolcache));
+    assert(pool_size(&pool) == 6);
+}
+
+void test_pool_contains(void) {
+    alloc_objects(2);
+
+    assert(pool_contains(&pool, objects[0]));
+    assert(pool_contains(&pool, objects[1]));
+    assert(!pool_contains(&pool, (char*) objects[0] + 1));
+    assert(!pool_contains(&pool, (char*) objects[1] - 1));
+    assert(!pool_contains(&pool, &pool));
+    assert(!pool_contains(&pool, NULL));
+
+    /* Every slot counts, allocated or not, but not the one past the end. */
+    assert(pool_contains(&pool, pool.memory + (NUM_OBJECTS - 1) * pool.object_size));
+    assert(!pool_contains(&pool, pool.memory + NUM_OBJECTS * pool.object_size));
+}
+
+void test_pool_alloc(void) {
+    size_t i;
+
+    alloc_objects(NUM_OBJECTS);
+    assert(pool_size(&pool) == NUM_OBJECTS);
+
+    /* Fresh slots are handed out in order of address. */
+    for (i = 0; i < NUM_OBJECTS; ++i) {
+        assert((char*) objects[i] == pool.memory + i * pool.object_size);
+        assert(objects[i]->val == (int) i);
+    }
+
+    assert(pool_alloc(&pool) == NULL);
+    assert(pool_size(&pool) == NUM_OBJECTS);
+
+    /* Freed objects are reused before fresh slots, most recently freed first. */
+    pool_reset(&pool);
+    alloc_objects(5);
+
+    pool_free(&pool, objects[1]);
+    pool_free(&pool, objects[3]);
+    assert(pool_alloc(&pool) == objects[3]);
+    assert(pool_alloc(&pool) == objects[1]);
+    assert((char*) pool_alloc(&pool) == pool.memory + 5 * pool.object_size);
+    assert(pool_size(&pool) == 6);
+}
+
+void test_pool_free(void) {
+    size_t i;
+
+    alloc_objects(NUM_OBJECTS);
+
+    for (i = 0; i < NUM_OBJECTS; ++i) {
+        pool_free(&pool, objects[i]);
+        assert(pool_size(&pool) == NUM_OBJECTS - 1 - i);
+    }
+
+    assert(pool.free_list == objects[NUM_OBJECTS - 1]);
+
+    /* Every object can be allocated again, in reverse order of being freed. */
+    for (i = NUM_OBJECTS; i-- > 0;) {
+        assert(pool_alloc(&pool) == objects[i]);
+    }
+
+    assert(pool_alloc(&pool) == NULL);
+    assert(pool_size(&pool) == NUM_OBJECTS);
+}
+
+void test_pool_reset(void) {
+    alloc_objects(NUM_OBJECTS);
+    pool_free(&pool, objects[7]);
+
+    pool_reset(&pool);
+    assert(pool_size(&pool) == 0);
+    assert(pool.free_list == NULL);
+    assert(pool.fresh == pool.memory);
+
+    alloc_objects(NUM_OBJECTS);
+    assert(objects[0] == (TestStruct*) pool.memory);
+    assert(pool_alloc(&pool) == NULL);
+
+    pool_reset(&pool);
+    pool_reset(&pool);
+    assert(pool_size(&pool) == 0);
+}
+
+void test_poolcache_init(void) {
+    poolcache_init(&poolcache, &pool, 7);
+    assert(poolcache.pool == &pool);
+    assert(poolcache.free_list == NULL);
+    assert(poolcache.size == 0);
+    assert(poolcache.batch_size == 7);
+    assert(poolcache_batch_size(&poolcache) == 7);
+    assert(poolcache_size(&poolcache) == 0);
+    assert(pool_size(&pool) == 0);
+}
+
+void test_poolcache_alloc(void) {
+    void *a, *b;
+    size_t i;
+
+    /* The first allocation takes a whole batch from the Pool. */
+    a = poolcache_alloc(&poolcache);
+    assert(pool_contains(&pool, a));
+    assert(poolcache_size(&poolcache) == 3);
+    assert(pool_size(&pool) == 4);
+
+    for (i = 0; i < 3; ++i) {
+        b = poolcache_alloc(&poolcache);
+        assert(b && b != a);
+    }
+
+    assert(poolcache_size(&poolcache) == 0);
+    assert(pool_size(&pool) == 4);
+
+    b = poolcache_alloc(&poolcache);
+    assert(pool_contains(&pool, b));
+    assert(poolcache_size(&poolcache) == 3);
+    assert(pool_size(&pool) == 8);
+
+    /* Drain the Pool through both caches, the last batch being partial. */
+    for (i = 8; i < NUM_OBJECTS; ++i) {
+        assert(poolcache_alloc(&poolcache2));
+    }
+
+    assert(pool_size(&pool) == NUM_OBJECTS);
+    assert(poolcache_size(&poolcache2) == 0);
+    assert(poolcache_alloc(&poolcache2) == NULL);
+
+    for (i = 0; i < 3; ++i) {
+        assert(poolcache_alloc(&poolcache));
+    }
+
+    assert(poolcache_alloc(&poolcache) == NULL);
+    assert(pool_alloc(&pool) == NULL);
+}
+
+void test_poolcache_free(void) {
+    size_t i;
+
+    alloc_objects(10);
+
+    for (i = 0; i < 7; ++i) {
+        poolcache_free(&poolcache, objects[i]);
+        assert(poolcache_size(&poolcache) == i + 1);
+        assert(pool_size(&pool) == 10);
+    }
+
+    /* Reaching twice the batch size returns the least recently freed batch. */
+    poolcache_free(&poolcache, objects[7]);
+    assert(poolcache_size(&poolcache) == 4);
+    assert(pool_size(&pool) == 6);
+
+    for (i = 8; i-- > 4;) {
+        assert(poolcache_alloc(&poolcache) == objects[i]);
+    }
+
+    /* The returned batch keeps its order on the free list of the Pool. */
+    assert(pool_alloc(&pool) == objects[3]);
+    assert(pool_alloc(&pool) == objects[2]);
+
+    /* Objects may be freed into another PoolCache than the one they came from. */
+    poolcache_free(&poolcache2, objects[9]);
+    assert(poolcache_alloc(&poolcache2) == objects[9]);
+    assert(poolcache_size(&poolcache2) == 0);
+}
+
+void test_poolcache_flush(void) {
+    size_t i;
+
+    poolcache_flush(&poolcache);
+    assert(poolcache_size(&poolcache) == 0);
+
+    alloc_objects(5);
+
+    for (i = 0; i < 5; ++i) {
+        poolcache_free(&poolcache, objects[i]);
+    }
+
+    assert(poolcache_size(&poolcache) == 5);
+
+    poolcache_flush(&poolcache);
+    assert(poolcache_size(&poolcache) == 0);
+    assert(poolcache.free_list == NULL);
+    assert(pool_size(&pool) == 0);
+
+    /* The flushed objects keep their order on the free list of the Pool. */
+    for (i = 5; i-- > 0;) {
+        assert(pool_alloc(&pool) == objects[i]);
+    }
+}
+
+void test_poolcache_threads(void) {
+    pthread_t threads[NUM_THREADS];
+    int ids[NUM_THREADS];
+    size_t i;
+
+    for (i = 0; i < NUM_THREADS; ++i) {
+        ids[i] = (int) i;
+        assert(pthread_create(threads + i, NULL, cache_worker, ids + i) == 0);
+    }
+
+    for (i = 0; i < NUM_THREADS; ++i) {
+        assert(pthread_join(threads[i], NULL) == 0);
+    }
+
+    assert(pool_size(&pool) == 0);
+    assert(pool.locked == 0);
+
+    /* Nothing was lost or duplicated: every object can still be allocated exactly once. */
+    alloc_objects(NUM_OBJECTS);
+    assert(pool_alloc(&pool) == NULL);
+}
+
+TestFunc test_funcs[] = {
+    test_pool_init,
+    test_pool_object_size,
+    test_pool_capacity,
+    test_pool_size,
+    test_pool_contains,
+    test_pool_alloc,
+    test_pool_free,
+    test_pool_reset,
+    test_poolcache_init,
+    test_poolcache_alloc,
+    test_poolcache_free,
+    test_poolcache_flush,
+    test_poolcache_threads
+};
+
+int main(int argc, char *argv[]) {
+    char msg[100] = "Pool ";
+    assert(argc == 2);
+    strcat(msg, argv[1]);
+
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 13);
+    run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
+
+    return 0;
+}
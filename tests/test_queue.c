@@ -22,6 +22,7 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <string.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "testing_framework.h"
 
@@ -41,7 +42,23 @@ typedef struct TestStruct {
 } TestStruct;
 
 TestStruct var1, var2, var3;
-Queue queue;
+Queue queue, src_queue;
+
+MPSCQueue mpscqueue;
+MPMCQueue mpmcqueue;
+MPMCQueueCell cell_arr[4];
+MPMCQueueCell stress_cell_arr[64];
+SPSCQueue spscqueue;
+QueueNode *node_arr[4];
+QueueNode *stress_node_arr[64];
+
+#define NUM_PRODUCERS 4
+#define NUM_CONSUMERS 4
+#define NODES_PER_PRODUCER 2000
+
+TestStruct stress_vars[NUM_PRODUCERS][NODES_PER_PRODUCER];
+unsigned char stress_popped[NUM_PRODUCERS][NODES_PER_PRODUCER];
+size_t stress_num_popped;
 
 #define ASSERT_QUEUE(queue, head_ptr, tail_ptr, size_of_queue) \
     do { \
@@ -74,6 +91,7 @@ Queue queue;
 
 static void reset_globals(void) {
     queue_init(&queue);
+    queue_init(&src_queue);
 
     var1.val = 1;
     var1.node.next = QUEUE_POISON_NEXT;
@@ -85,6 +103,92 @@ static void reset_globals(void) {
     var3.node.next = QUEUE_POISON_NEXT;
 }
 
+static void* mpsc_producer(void *arg) {
+    TestStruct *vars = (TestStruct*) arg;
+    size_t i;
+
+    for (i = 0; i < NODES_PER_PRODUCER; ++i) {
+        mpscqueue_push(&mpscqueue, &vars[i].node);
+    }
+
+    return NULL;
+}
+
+static void* mpmc_producer(void *arg) {
+    TestStruct *vars = (TestStruct*) arg;
+    size_t i;
+
+    for (i = 0; i < NODES_PER_PRODUCER; ++i) {
+        while (!mpmcqueue_push(&mpmcqueue, &vars[i].node)) {
+        }
+    }
+
+    return NULL;
+}
+
+static void* mpmc_consumer(void *arg) {
+    (void) arg;
+
+    while (__atomic_load_n(&stress_num_popped, __ATOMIC_RELAXED) < NUM_PRODUCERS * NODES_PER_PRODUCER) {
+        QueueNode *n = mpmcqueue_pop(&mpmcqueue);
+
+        if (n) {
+            int val = queue_entry(n, TestStruct, node)->val;
+
+            assert(!stress_popped[val / NODES_PER_PRODUCER][val % NODES_PER_PRODUCER]);
+            stress_popped[val / NODES_PER_PRODUCER][val % NODES_PER_PRODUCER] = 1;
+            __atomic_add_fetch(&stress_num_popped, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+/* Pushes every stress node in order, in batches of varying size. */
+static void* spsc_producer(void *arg) {
+    QueueNode *batch[7];
+    size_t i = 0, num_batch = 0, num_pushed;
+
+    (void) arg;
+
+    while (i < NUM_PRODUCERS * NODES_PER_PRODUCER) {
+        if (num_batch == 0) {
+            for (; num_batch < 1 + i % 7 && i + num_batch < NUM_PRODUCERS * NODES_PER_PRODUCER; ++num_batch) {
+                size_t val = i + num_batch;
+
+                batch[num_batch] = &stress_vars[val / NODES_PER_PRODUCER][val % NODES_PER_PRODUCER].node;
+            }
+        }
+
+        /* Whatever did not fit is pushed again, node by node every other time. */
+        if (i % 2) {
+            num_pushed = spscqueue_push(&spscqueue, batch[0]) ? 1 : 0;
+        } else {
+            num_pushed = spscqueue_push_batch(&spscqueue, batch, num_batch);
+        }
+
+        memmove(batch, batch + num_pushed, (num_batch - num_pushed) * sizeof(QueueNode*));
+        num_batch -= num_pushed;
+        i += num_pushed;
+    }
+
+    return NULL;
+}
+
+static void reset_stress_globals(void) {
+    size_t i, j;
+
+    for (i = 0; i < NUM_PRODUCERS; ++i) {
+        for (j = 0; j < NODES_PER_PRODUCER; ++j) {
+            stress_vars[i][j].val = (int) (i * NODES_PER_PRODUCER + j);
+            stress_vars[i][j].node.next = QUEUE_POISON_NEXT;
+            stress_popped[i][j] = 0;
+        }
+    }
+
+    stress_num_popped = 0;
+}
+
 /* ========================================================================================================
  *
  *                                             TESTING FUNCTIONS
@@ -147,6 +251,33 @@ void test_queue_push(void) {
     ASSERT_NODE(var3.node, NULL);
 }
 
+void test_queue_splice_back(void) {
+    /* Splicing an empty queue does nothing. */
+    queue_push(&queue, &var1.node);
+    queue_splice_back(&queue, &src_queue);
+    ASSERT_QUEUE(queue, &var1.node, &var1.node, 1);
+    ASSERT_QUEUE(src_queue, NULL, NULL, 0);
+
+    /* Splicing into an empty queue moves the chain. */
+    queue_splice_back(&src_queue, &queue);
+    ASSERT_QUEUE(src_queue, &var1.node, &var1.node, 1);
+    ASSERT_QUEUE(queue, NULL, NULL, 0);
+
+    queue_push(&src_queue, &var2.node);
+    queue_push(&queue, &var3.node);
+    queue_splice_back(&queue, &src_queue);
+    ASSERT_QUEUE(queue, &var3.node, &var2.node, 3);
+    ASSERT_QUEUE(src_queue, NULL, NULL, 0);
+    ASSERT_NODE(var3.node, &var1.node);
+    ASSERT_NODE(var1.node, &var2.node);
+    ASSERT_NODE(var2.node, NULL);
+
+    assert(queue_pop(&queue) == &var3.node);
+    assert(queue_pop(&queue) == &var1.node);
+    assert(queue_pop(&queue) == &var2.node);
+    ASSERT_QUEUE(queue, NULL, NULL, 0);
+}
+
 void test_queue_pop(void) {
     queue_push(&queue, &var1.node);
     queue_push(&queue, &var2.node);
@@ -167,6 +298,23 @@ void test_queue_pop(void) {
     ASSERT_QUEUE(queue, NULL, NULL, 0);
 }
 
+void test_queue_pop_all(void) {
+    assert(queue_pop_all(&queue) == NULL);
+    ASSERT_QUEUE(queue, NULL, NULL, 0);
+
+    queue_push(&queue, &var1.node);
+    queue_push(&queue, &var2.node);
+    queue_push(&queue, &var3.node);
+    assert(queue_pop_all(&queue) == &var1.node);
+    ASSERT_QUEUE(queue, NULL, NULL, 0);
+    ASSERT_NODE(var1.node, &var2.node);
+    ASSERT_NODE(var2.node, &var3.node);
+    ASSERT_NODE(var3.node, NULL);
+
+    queue_push(&queue, &var2.node);
+    ASSERT_QUEUE(queue, &var2.node, &var2.node, 1);
+}
+
 void test_queue_remove_all(void) {
     queue_push(&queue, &var1.node);
     queue_push(&queue, &var2.node);
@@ -224,17 +372,217 @@ void test_queue_for_each_safe(void) {
     assert(i == 3);
 }
 
+void test_mpscqueue(void) {
+    mpscqueue_init(&mpscqueue);
+    assert(mpscqueue_pop(&mpscqueue) == NULL);
+
+    mpscqueue_push(&mpscqueue, &var1.node);
+    assert(mpscqueue_pop(&mpscqueue) == &var1.node);
+    ASSERT_NODE(var1.node, QUEUE_POISON_NEXT);
+    assert(mpscqueue_pop(&mpscqueue) == NULL);
+
+    mpscqueue_push(&mpscqueue, &var1.node);
+    mpscqueue_push(&mpscqueue, &var2.node);
+    assert(mpscqueue_pop(&mpscqueue) == &var1.node);
+    mpscqueue_push(&mpscqueue, &var3.node);
+    assert(mpscqueue_pop(&mpscqueue) == &var2.node);
+    ASSERT_NODE(var2.node, QUEUE_POISON_NEXT);
+    assert(mpscqueue_pop(&mpscqueue) == &var3.node);
+    assert(mpscqueue_pop(&mpscqueue) == NULL);
+    assert(mpscqueue_pop(&mpscqueue) == NULL);
+
+    mpscqueue_push(&mpscqueue, &var2.node);
+    assert(mpscqueue_pop(&mpscqueue) == &var2.node);
+    assert(mpscqueue_pop(&mpscqueue) == NULL);
+}
+
+void test_mpscqueue_threads(void) {
+    pthread_t producers[NUM_PRODUCERS];
+    size_t next_val[NUM_PRODUCERS] = { 0 };
+    size_t i, num_popped = 0;
+
+    reset_stress_globals();
+    mpscqueue_init(&mpscqueue);
+
+    for (i = 0; i < NUM_PRODUCERS; ++i) {
+        assert(pthread_create(producers + i, NULL, mpsc_producer, stress_vars[i]) == 0);
+    }
+
+    /* The nodes of every producer must come out in the order that producer pushed them. */
+    while (num_popped < NUM_PRODUCERS * NODES_PER_PRODUCER) {
+        QueueNode *n = mpscqueue_pop(&mpscqueue);
+
+        if (n) {
+            int val = queue_entry(n, TestStruct, node)->val;
+
+            assert((size_t) val % NODES_PER_PRODUCER == next_val[val / NODES_PER_PRODUCER]);
+            ++next_val[val / NODES_PER_PRODUCER];
+            ++num_popped;
+        }
+    }
+
+    for (i = 0; i < NUM_PRODUCERS; ++i) {
+        assert(pthread_join(producers[i], NULL) == 0);
+    }
+
+    assert(mpscqueue_pop(&mpscqueue) == NULL);
+}
+
+void test_mpmcqueue(void) {
+    TestStruct var4, var5;
+
+    mpmcqueue_init(&mpmcqueue, cell_arr, 4);
+    assert(mpmcqueue_pop(&mpmcqueue) == NULL);
+
+    assert(mpmcqueue_push(&mpmcqueue, &var1.node));
+    assert(mpmcqueue_push(&mpmcqueue, &var2.node));
+    assert(mpmcqueue_push(&mpmcqueue, &var3.node));
+    assert(mpmcqueue_push(&mpmcqueue, &var4.node));
+    assert(!mpmcqueue_push(&mpmcqueue, &var5.node));
+    assert(mpmcqueue_pop(&mpmcqueue) == &var1.node);
+    assert(mpmcqueue_push(&mpmcqueue, &var5.node));
+    assert(!mpmcqueue_push(&mpmcqueue, &var1.node));
+
+    assert(mpmcqueue_pop(&mpmcqueue) == &var2.node);
+    assert(mpmcqueue_pop(&mpmcqueue) == &var3.node);
+    assert(mpmcqueue_pop(&mpmcqueue) == &var4.node);
+    assert(mpmcqueue_pop(&mpmcqueue) == &var5.node);
+    assert(mpmcqueue_pop(&mpmcqueue) == NULL);
+
+    /* Wrap around the cells a few times. */
+    {
+        size_t i;
+
+        for (i = 0; i < 10; ++i) {
+            assert(mpmcqueue_push(&mpmcqueue, &var1.node));
+            assert(mpmcqueue_push(&mpmcqueue, &var2.node));
+            assert(mpmcqueue_pop(&mpmcqueue) == &var1.node);
+            assert(mpmcqueue_pop(&mpmcqueue) == &var2.node);
+            assert(mpmcqueue_pop(&mpmcqueue) == NULL);
+        }
+    }
+}
+
+void test_mpmcqueue_threads(void) {
+    pthread_t producers[NUM_PRODUCERS], consumers[NUM_CONSUMERS];
+    size_t i, j;
+
+    reset_stress_globals();
+    mpmcqueue_init(&mpmcqueue, stress_cell_arr, 64);
+
+    for (i = 0; i < NUM_CONSUMERS; ++i) {
+        assert(pthread_create(consumers + i, NULL, mpmc_consumer, NULL) == 0);
+    }
+
+    for (i = 0; i < NUM_PRODUCERS; ++i) {
+        assert(pthread_create(producers + i, NULL, mpmc_producer, stress_vars[i]) == 0);
+    }
+
+    for (i = 0; i < NUM_PRODUCERS; ++i) {
+        assert(pthread_join(producers[i], NULL) == 0);
+    }
+
+    for (i = 0; i < NUM_CONSUMERS; ++i) {
+        assert(pthread_join(consumers[i], NULL) == 0);
+    }
+
+    for (i = 0; i < NUM_PRODUCERS; ++i) {
+        for (j = 0; j < NODES_PER_PRODUCER; ++j) {
+            assert(stress_popped[i][j]);
+        }
+    }
+
+    assert(mpmcqueue_pop(&mpmcqueue) == NULL);
+}
+
+void test_spscqueue(void) {
+    QueueNode *nodes[5] = { &var1.node, &var2.node, &var3.node, &var1.node, &var2.node };
+    QueueNode *popped[5];
+    size_t i;
+
+    spscqueue_init(&spscqueue, node_arr, 4);
+    assert(spscqueue_pop(&spscqueue) == NULL);
+    assert(spscqueue_pop_batch(&spscqueue, popped, 5) == 0);
+
+    /* A batch that does not fit is pushed in part. */
+    assert(spscqueue_push(&spscqueue, &var3.node));
+    assert(spscqueue_push_batch(&spscqueue, nodes, 5) == 3);
+    assert(!spscqueue_push(&spscqueue, &var1.node));
+    assert(spscqueue_push_batch(&spscqueue, nodes, 5) == 0);
+    assert(spscqueue_push_batch(&spscqueue, nodes, 0) == 0);
+
+    assert(spscqueue_pop(&spscqueue) == &var3.node);
+    assert(spscqueue_pop_batch(&spscqueue, popped, 2) == 2);
+    assert(popped[0] == &var1.node && popped[1] == &var2.node);
+
+    /* Wrap around the end of the array, in batches. */
+    assert(spscqueue_push_batch(&spscqueue, nodes + 1, 3) == 3);
+    assert(spscqueue_pop_batch(&spscqueue, popped, 5) == 4);
+    assert(popped[0] == &var3.node);
+    assert(popped[1] == &var2.node && popped[2] == &var3.node && popped[3] == &var1.node);
+    assert(spscqueue_pop(&spscqueue) == NULL);
+
+    /* A ring holding a single node. */
+    spscqueue_init(&spscqueue, node_arr, 1);
+    for (i = 0; i < 3; ++i) {
+        assert(spscqueue_push(&spscqueue, &var1.node));
+        assert(!spscqueue_push(&spscqueue, &var2.node));
+        assert(spscqueue_pop(&spscqueue) == &var1.node);
+        assert(spscqueue_pop(&spscqueue) == NULL);
+    }
+
+    /* The "next" member of a node is not used. */
+    assert(var1.node.next == QUEUE_POISON_NEXT);
+}
+
+void test_spscqueue_threads(void) {
+    pthread_t producer;
+    QueueNode *popped[5];
+    size_t i, j, expected = 0, num_popped;
+
+    reset_stress_globals();
+    spscqueue_init(&spscqueue, stress_node_arr, 64);
+
+    assert(pthread_create(&producer, NULL, spsc_producer, NULL) == 0);
+
+    /* The nodes must come out exactly in the order they went in. */
+    for (i = 0; expected < NUM_PRODUCERS * NODES_PER_PRODUCER; ++i) {
+        if (i % 3 == 0) {
+            popped[0] = spscqueue_pop(&spscqueue);
+            num_popped = popped[0] ? 1 : 0;
+        } else {
+            num_popped = spscqueue_pop_batch(&spscqueue, popped, 1 + i % 5);
+        }
+
+        for (j = 0; j < num_popped; ++j) {
+            assert(queue_entry(popped[j], TestStruct, node)->val == (int) expected);
+            ++expected;
+        }
+    }
+
+    assert(pthread_join(producer, NULL) == 0);
+    assert(spscqueue_pop(&spscqueue) == NULL);
+}
+
 TestFunc test_funcs[] = {
     test_queue_init,
     test_queue_peek,
     test_queue_size,
     test_queue_empty,
     test_queue_push,
+    test_queue_splice_back,
     test_queue_pop,
+    test_queue_pop_all,
     test_queue_remove_all,
     test_queue_entry,
     test_queue_for_each,
-    test_queue_for_each_safe
+    test_queue_for_each_safe,
+    test_mpscqueue,
+    test_mpscqueue_threads,
+    test_mpmcqueue,
+    test_mpmcqueue_threads,
+    test_spscqueue,
+    test_spscqueue_threads
 };
 
 int main(int argc, char *argv[]) {
@@ -242,7 +590,7 @@ int main(int argc, char *argv[]) {
     assert(argc == 2);
     strcat(msg, argv[1]);
 
-    assert(sizeof(test_funcs) / sizeof(TestFunc) == 10);
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 18);
     run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
 
     return 0;
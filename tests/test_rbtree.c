@@ -38,10 +38,14 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 typedef struct TestStruct {
     int key;
     int num_similar_keys;
+    int value;
+    int subtree_sum;
     RBTreeNode node;
 } TestStruct;
 
 TestStruct var1, var2, var3, var4, var5, var6, var7;
+TestStruct many[1000];
+RBTreeNode *many_nodes[1000];
 RBTree rbtree;
 size_t counter;
 void *aux_ptr;
@@ -54,10 +58,16 @@ void *aux_ptr;
 
 #define ASSERT_NODE(node, parent_ptr, left_child_ptr, right_child_ptr, node_color) \
     do { \
-        assert((node).parent == (RBTreeNode*) (parent_ptr)); \
+        assert(rbtree_parent(&(node)) == (RBTreeNode*) (parent_ptr)); \
         assert((node).left_child == (RBTreeNode*) (left_child_ptr)); \
         assert((node).right_child == (RBTreeNode*) (right_child_ptr)); \
-        assert((node).color == node_color); \
+        assert(rbtree_color(&(node)) == node_color); \
+    } while (0)
+
+#define POISON_NODE(node) \
+    do { \
+        RBTreeNode poisoned_node_ = RBTREE_NODE_INIT; \
+        (node) = poisoned_node_; \
     } while (0)
 
 #define ASSERT_INORDERNESS(rbtree) \
@@ -84,16 +94,29 @@ void *aux_ptr;
     } while (0)
 
 static RBTreeNodeColor color_(RBTreeNode *node) {
-    return node ? node->color : RBTREE_NODE_BLACK;
+    return node ? rbtree_color(node) : RBTREE_NODE_BLACK;
 }
 
 static void p1_(RBTree *rbtree) {
+    RBTreeNode *first = rbtree->root, *last = rbtree->root;
+
     assert(color_(rbtree->root) == RBTREE_NODE_BLACK);
+
+    while (first && first->left_child) {
+        first = first->left_child;
+    }
+
+    while (last && last->right_child) {
+        last = last->right_child;
+    }
+
+    assert(rbtree->first == first);
+    assert(rbtree->last == last);
 }
 
 static void p2_(RBTreeNode *node) {
     if (color_(node) == RBTREE_NODE_RED) {
-        assert(color_(node->parent) == RBTREE_NODE_BLACK);
+        assert(color_(rbtree_parent(node)) == RBTREE_NODE_BLACK);
         assert(color_(node->left_child) == RBTREE_NODE_BLACK);
         assert(color_(node->right_child) == RBTREE_NODE_BLACK);
     }
@@ -131,12 +154,56 @@ static void p3_(RBTreeNode *node) {
     p3_helper_(node, 0, &black_count_path);
 }
 
-#define ASSERT_PROPERTIES(rbtree) \
-    do { \
-        p1_(&rbtree); \
-        p2_(rbtree.root); \
-        p3_(rbtree.root); \
-    } while (0)
+static int p5_(RBTreeNode *node) {
+    int sum;
+
+    if (!node) {
+        return 0;
+    }
+
+    sum = rbtree_entry(node, TestStruct, node)->value + p5_(node->left_child) + p5_(node->right_child);
+    assert(rbtree_entry(node, TestStruct, node)->subtree_sum == sum);
+
+    return sum;
+}
+
+#ifdef RBTREE_ORDER_STATISTICS
+static size_t p4_(RBTreeNode *node) {
+    size_t num_nodes;
+
+    if (!node) {
+        return 0;
+    }
+
+    num_nodes = 1 + p4_(node->left_child) + p4_(node->right_child);
+    assert(node->count == num_nodes);
+
+    return num_nodes;
+}
+#endif /* RBTREE_ORDER_STATISTICS */
+
+#ifdef RBTREE_ORDER_STATISTICS
+    #define ASSERT_PROPERTIES(rbtree) \
+        do { \
+            p1_(&rbtree); \
+            p2_(rbtree.root); \
+            p3_(rbtree.root); \
+            if (rbtree.augment) { \
+                p5_(rbtree.root); \
+            } \
+            assert(p4_(rbtree.root) == rbtree.size); \
+        } while (0)
+#else
+    #define ASSERT_PROPERTIES(rbtree) \
+        do { \
+            p1_(&rbtree); \
+            p2_(rbtree.root); \
+            p3_(rbtree.root); \
+            if (rbtree.augment) { \
+                p5_(rbtree.root); \
+            } \
+        } while (0)
+#endif /* RBTREE_ORDER_STATISTICS */
 
 #define ASSERT_FOR_EACH(node_ptr, index) \
     do { \
@@ -349,56 +416,100 @@ static int compare_func(const void *key, const RBTreeNode *node) {
 }
 
 static void collide_func(const RBTreeNode *old_node, const RBTreeNode *new_node, void *auxiliary_data) {
-    ASSERT_NODE(*old_node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, old_node->color);
+    ASSERT_NODE(*old_node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(old_node));
     assert((void**) auxiliary_data == &aux_ptr);
 
     rbtree_entry(new_node, TestStruct, node)->num_similar_keys += 1 + rbtree_entry(old_node, TestStruct, node)->num_similar_keys;
 }
 
+static int subtree_sum_(const RBTreeNode *node) {
+    return node ? rbtree_entry(node, TestStruct, node)->subtree_sum : 0;
+}
+
+static void compute_sum_(RBTreeNode *node) {
+    TestStruct *t = rbtree_entry(node, TestStruct, node);
+    t->subtree_sum = t->value + subtree_sum_(node->left_child) + subtree_sum_(node->right_child);
+}
+
+static void propagate_func(RBTreeNode *node, RBTreeNode *stop) {
+    for ( ; node != stop; node = rbtree_parent(node)) {
+        compute_sum_(node);
+    }
+}
+
+static void copy_func(RBTreeNode *old_node, RBTreeNode *new_node) {
+    rbtree_entry(new_node, TestStruct, node)->subtree_sum = rbtree_entry(old_node, TestStruct, node)->subtree_sum;
+}
+
+static void rotate_func(RBTreeNode *old_node, RBTreeNode *new_node) {
+    copy_func(old_node, new_node);
+    compute_sum_(old_node);
+}
+
+const RBTreeAugment augment = { propagate_func, copy_func, rotate_func };
+
+static RBTreeNode* next_func(void *context) {
+    TestStruct **cursor = (TestStruct**) context;
+
+    return &(*cursor)++->node;
+}
+
+static void visit_postorder_(RBTreeNode *node, int *visited) {
+    TestStruct *t = rbtree_entry(node, TestStruct, node);
+
+    assert(!visited[t->key]);
+    assert(!node->left_child || visited[rbtree_entry(node->left_child, TestStruct, node)->key]);
+    assert(!node->right_child || visited[rbtree_entry(node->right_child, TestStruct, node)->key]);
+
+    visited[t->key] = 1;
+}
+
+static void destroy_func(RBTreeNode *node, void *auxiliary_data) {
+    assert((void**) auxiliary_data == &aux_ptr);
+
+    ++counter;
+
+    /* Scribble over the node, as freeing it would. */
+    POISON_NODE(*node);
+}
+
 static void reset_globals(void) {
     rbtree_init(&rbtree, compare_func, collide_func, &aux_ptr);
 
     var1.key = 1;
     var1.num_similar_keys = 0;
-    var1.node.parent = RBTREE_POISON_PARENT;
-    var1.node.left_child = RBTREE_POISON_LEFT_CHILD;
-    var1.node.right_child = RBTREE_POISON_RIGHT_CHILD;
+    var1.value = 1;
+    POISON_NODE(var1.node);
 
     var2.key = 2;
     var2.num_similar_keys = 0;
-    var2.node.parent = RBTREE_POISON_PARENT;
-    var2.node.left_child = RBTREE_POISON_LEFT_CHILD;
-    var2.node.right_child = RBTREE_POISON_RIGHT_CHILD;
+    var2.value = 2;
+    POISON_NODE(var2.node);
 
     var3.key = 3;
     var3.num_similar_keys = 0;
-    var3.node.parent = RBTREE_POISON_PARENT;
-    var3.node.left_child = RBTREE_POISON_LEFT_CHILD;
-    var3.node.right_child = RBTREE_POISON_RIGHT_CHILD;
+    var3.value = 3;
+    POISON_NODE(var3.node);
 
     var4.key = 4;
     var4.num_similar_keys = 0;
-    var4.node.parent = RBTREE_POISON_PARENT;
-    var4.node.left_child = RBTREE_POISON_LEFT_CHILD;
-    var4.node.right_child = RBTREE_POISON_RIGHT_CHILD;
+    var4.value = 4;
+    POISON_NODE(var4.node);
 
     var5.key = 5;
     var5.num_similar_keys = 0;
-    var5.node.parent = RBTREE_POISON_PARENT;
-    var5.node.left_child = RBTREE_POISON_LEFT_CHILD;
-    var5.node.right_child = RBTREE_POISON_RIGHT_CHILD;
+    var5.value = 5;
+    POISON_NODE(var5.node);
 
     var6.key = 6;
     var6.num_similar_keys = 0;
-    var6.node.parent = RBTREE_POISON_PARENT;
-    var6.node.left_child = RBTREE_POISON_LEFT_CHILD;
-    var6.node.right_child = RBTREE_POISON_RIGHT_CHILD;
+    var6.value = 6;
+    POISON_NODE(var6.node);
 
     var7.key = 7;
     var7.num_similar_keys = 0;
-    var7.node.parent = RBTREE_POISON_PARENT;
-    var7.node.left_child = RBTREE_POISON_LEFT_CHILD;
-    var7.node.right_child = RBTREE_POISON_RIGHT_CHILD;
+    var7.value = 7;
+    POISON_NODE(var7.node);
 }
 
 /* ========================================================================================================
@@ -411,8 +522,13 @@ void test_rbtree_init(void) {
     RBTreeNode node_init_with_macro = RBTREE_NODE_INIT;
     ASSERT_NODE(node_init_with_macro, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, RBTREE_NODE_RED);
 
+    #if defined(RBTREE_COMPACT) && !defined(RBTREE_ORDER_STATISTICS)
+    assert(sizeof(RBTreeNode) == 3 * sizeof(RBTreeNode*));
+    #endif
+
     rbtree_init(&rbtree, compare_func, collide_func, &aux_ptr);
     ASSERT_RBTREE(rbtree, NULL, 0);
+    assert(rbtree.first == NULL && rbtree.last == NULL);
     assert(rbtree.compare == compare_func);
     assert(rbtree.collide == collide_func);
     assert((void**) rbtree.auxiliary_data == &aux_ptr);
@@ -421,6 +537,49 @@ void test_rbtree_init(void) {
     assert(rbtree.compare == compare_func);
     assert(rbtree.collide == NULL);
     assert(rbtree.auxiliary_data == NULL);
+    assert(rbtree.augment == NULL);
+    rbtree_set_augment(&rbtree, &augment);
+    rbtree_init(&rbtree, compare_func, NULL, NULL);
+    assert(rbtree.augment == NULL);
+}
+
+void test_rbtree_set_augment(void) {
+    TestStruct dup;
+
+    rbtree_set_augment(&rbtree, &augment);
+    assert(rbtree.augment == &augment);
+
+    FILL_SEQUENTIALLY(rbtree);
+    assert(subtree_sum_(rbtree.root) == 28);
+
+    dup.key = 4;
+    dup.num_similar_keys = 0;
+    dup.value = 100;
+    rbtree_insert(&rbtree, &dup.key, &dup.node);
+    ASSERT_PROPERTIES(rbtree);
+    assert(subtree_sum_(rbtree.root) == 124);
+    rbtree_remove(&rbtree, &dup.node);
+    ASSERT_PROPERTIES(rbtree);
+    assert(subtree_sum_(rbtree.root) == 24);
+    rbtree_remove_all(&rbtree);
+
+    rbtree_set_augment(&rbtree, NULL);
+    assert(rbtree.augment == NULL);
+    reset_globals();
+
+    loop {
+        rbtree_set_augment(&rbtree, &augment);
+        FILL_RANDOMLY(rbtree);
+        assert(subtree_sum_(rbtree.root) == 28);
+        DRAIN_RANDOMLY(rbtree);
+        reset_globals();
+    }
+}
+
+void test_rbtree_augment(void) {
+    assert(rbtree_augment(&rbtree) == NULL);
+    rbtree_set_augment(&rbtree, &augment);
+    assert(rbtree_augment(&rbtree) == &augment);
 }
 
 void test_rbtree_first(void) {
@@ -571,6 +730,34 @@ void test_rbtree_next(void) {
     }
 }
 
+void test_rbtree_postorder_first(void) {
+    assert(rbtree_postorder_first(&rbtree) == NULL);
+
+    rbtree_insert(&rbtree, &var1.key, &var1.node);
+    assert(rbtree_postorder_first(&rbtree) == &var1.node);
+    reset_globals();
+
+    FILL_SEQUENTIALLY(rbtree);
+    assert(rbtree_postorder_first(&rbtree) == &var1.node);
+    rbtree_remove(&rbtree, &var1.node);
+    assert(rbtree_postorder_first(&rbtree) == &var3.node);
+    reset_globals();
+}
+
+void test_rbtree_postorder_next(void) {
+    assert(rbtree_postorder_next(NULL) == NULL);
+
+    FILL_SEQUENTIALLY(rbtree);
+    assert(rbtree_postorder_next(&var1.node) == &var3.node);
+    assert(rbtree_postorder_next(&var3.node) == &var5.node);
+    assert(rbtree_postorder_next(&var5.node) == &var7.node);
+    assert(rbtree_postorder_next(&var7.node) == &var6.node);
+    assert(rbtree_postorder_next(&var6.node) == &var4.node);
+    assert(rbtree_postorder_next(&var4.node) == &var2.node);
+    assert(rbtree_postorder_next(&var2.node) == NULL);
+    reset_globals();
+}
+
 void test_rbtree_size(void) {
     assert(rbtree_size(&rbtree) == 0);
 
@@ -757,6 +944,38 @@ void test_rbtree_at(void) {
     }
 }
 
+void test_rbtree_rank_of_key(void) {
+    int key = 0;
+
+    assert(rbtree_rank_of_key(&rbtree, &var1.key) == 0);
+
+    FILL_SEQUENTIALLY(rbtree);
+    assert(rbtree_rank_of_key(&rbtree, &key) == 0);
+    assert(rbtree_rank_of_key(&rbtree, &var1.key) == 0);
+    assert(rbtree_rank_of_key(&rbtree, &var4.key) == 3);
+    assert(rbtree_rank_of_key(&rbtree, &var7.key) == 6);
+    key = 8;
+    assert(rbtree_rank_of_key(&rbtree, &key) == 7);
+    reset_globals();
+
+    loop {
+        FILL_RANDOMLY(rbtree);
+        rbtree_remove(&rbtree, &var3.node);
+        rbtree_remove(&rbtree, &var6.node);
+        ASSERT_PROPERTIES(rbtree);
+        assert(rbtree_rank_of_key(&rbtree, &var1.key) == 0);
+        assert(rbtree_rank_of_key(&rbtree, &var2.key) == 1);
+        assert(rbtree_rank_of_key(&rbtree, &var3.key) == 2);
+        assert(rbtree_rank_of_key(&rbtree, &var4.key) == 2);
+        assert(rbtree_rank_of_key(&rbtree, &var5.key) == 3);
+        assert(rbtree_rank_of_key(&rbtree, &var6.key) == 4);
+        assert(rbtree_rank_of_key(&rbtree, &var7.key) == 4);
+        assert(rbtree_index_of(&rbtree, &var5.node) == 3);
+        assert(rbtree_at(&rbtree, 4) == &var7.node);
+        reset_globals();
+    }
+}
+
 void test_rbtree_insert(void) {
     rbtree.collide = NULL;
     rbtree_insert(&rbtree, &var1.key, &var1.node);
@@ -771,7 +990,7 @@ void test_rbtree_insert(void) {
     var3.key = var1.key;
     rbtree_insert(&rbtree, &var3.key, &var3.node);
     ASSERT_RBTREE(rbtree, &var3.node, 2);
-    ASSERT_NODE(var1.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var1.node.color);
+    ASSERT_NODE(var1.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var1.node));
     ASSERT_NODE(var2.node, &var3.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var3.node, NULL, NULL, &var2.node, RBTREE_NODE_BLACK);
     ASSERT_PROPERTIES(rbtree);
@@ -779,7 +998,7 @@ void test_rbtree_insert(void) {
     ASSERT_RBTREE(rbtree, &var1.node, 2);
     ASSERT_NODE(var1.node, NULL, NULL, &var2.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var2.node, &var1.node, NULL, NULL, RBTREE_NODE_RED);
-    ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var3.node.color);
+    ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var3.node));
     ASSERT_PROPERTIES(rbtree);
     var3.key = 3;
     rbtree_insert(&rbtree, &var3.key, &var3.node);
@@ -838,7 +1057,7 @@ void test_rbtree_insert(void) {
     rbtree_insert(&rbtree, &var5.key, &var5.node);
     assert(var5.num_similar_keys == 1);
     ASSERT_RBTREE(rbtree, &var5.node, 2);
-    ASSERT_NODE(var7.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var7.node.color);
+    ASSERT_NODE(var7.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var7.node));
     ASSERT_NODE(var6.node, &var5.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var5.node, NULL, &var6.node, NULL, RBTREE_NODE_BLACK);
     ASSERT_PROPERTIES(rbtree);
@@ -847,7 +1066,7 @@ void test_rbtree_insert(void) {
     ASSERT_RBTREE(rbtree, &var7.node, 2);
     ASSERT_NODE(var7.node, NULL, &var6.node, NULL, RBTREE_NODE_BLACK);
     ASSERT_NODE(var6.node, &var7.node, NULL, NULL, RBTREE_NODE_RED);
-    ASSERT_NODE(var5.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var5.node.color);
+    ASSERT_NODE(var5.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var5.node));
     ASSERT_PROPERTIES(rbtree);
     var5.key = 5;
     rbtree_insert(&rbtree, &var5.key, &var5.node);
@@ -924,6 +1143,239 @@ void test_rbtree_insert(void) {
     }
 }
 
+void test_rbtree_insert_hint(void) {
+    size_t i;
+
+    rbtree_insert_hint(&rbtree, &var4.key, &var4.node, NULL);
+    ASSERT_RBTREE(rbtree, &var4.node, 1);
+    ASSERT_PROPERTIES(rbtree);
+    rbtree_insert_hint(&rbtree, &var2.key, &var2.node, &var4.node);
+    ASSERT_NODE(var2.node, &var4.node, NULL, NULL, RBTREE_NODE_RED);
+    ASSERT_PROPERTIES(rbtree);
+    rbtree_insert_hint(&rbtree, &var3.key, &var3.node, &var2.node);
+    ASSERT_PROPERTIES(rbtree);
+    rbtree_insert_hint(&rbtree, &var6.key, &var6.node, NULL);
+    rbtree_insert_hint(&rbtree, &var7.key, &var7.node, &var6.node);
+    rbtree_insert_hint(&rbtree, &var5.key, &var5.node, &var6.node);
+    ASSERT_PROPERTIES(rbtree);
+
+    /* Wrong hints fall back to a full search. */
+    rbtree_insert_hint(&rbtree, &var1.key, &var1.node, &var7.node);
+    ASSERT_RBTREE(rbtree, rbtree.root, 7);
+    ASSERT_INORDERNESS(rbtree);
+    ASSERT_PROPERTIES(rbtree);
+    reset_globals();
+
+    /* Key collisions are found through the hint itself, either of its neighbors, or a full search. */
+    FILL_SEQUENTIALLY(rbtree);
+    for (i = 0; i < 4; ++i) {
+        many[i].key = 4;
+        many[i].num_similar_keys = 0;
+    }
+    rbtree_insert_hint(&rbtree, &many[0].key, &many[0].node, &var4.node);
+    assert(rbtree_lookup_key(&rbtree, &var4.key) == &many[0].node && many[0].num_similar_keys == 1);
+    rbtree_insert_hint(&rbtree, &many[1].key, &many[1].node, &var3.node);
+    assert(rbtree_lookup_key(&rbtree, &var4.key) == &many[1].node && many[1].num_similar_keys == 2);
+    rbtree_insert_hint(&rbtree, &many[2].key, &many[2].node, &var5.node);
+    assert(rbtree_lookup_key(&rbtree, &var4.key) == &many[2].node && many[2].num_similar_keys == 3);
+    rbtree_insert_hint(&rbtree, &many[3].key, &many[3].node, &var7.node);
+    assert(rbtree_lookup_key(&rbtree, &var4.key) == &many[3].node && many[3].num_similar_keys == 4);
+    ASSERT_RBTREE(rbtree, rbtree.root, 7);
+    ASSERT_PROPERTIES(rbtree);
+    reset_globals();
+
+    /* Random hints, right or wrong, must always produce the same tree contents as plain insertion. */
+    rbtree_set_augment(&rbtree, &augment);
+    for (i = 0; i < 1000; ++i) {
+        many[i].key = (int) i;
+        many[i].value = (int) i;
+    }
+    for (i = 0; i < 1000; ++i) {
+        size_t j = (size_t) rand() % (i + 1);
+        TestStruct tmp = many[i];
+
+        many[i] = many[j];
+        many[j] = tmp;
+    }
+    for (i = 0; i < 1000; ++i) {
+        RBTreeNode *hint = i > 0 && rand() % 4 ? &many[(size_t) rand() % i].node : NULL;
+
+        rbtree_insert_hint(&rbtree, &many[i].key, &many[i].node, hint);
+    }
+    ASSERT_RBTREE(rbtree, rbtree.root, 1000);
+    ASSERT_PROPERTIES(rbtree);
+    for (i = 0; i < 1000; ++i) {
+        assert(rbtree_entry(rbtree_at(&rbtree, i), TestStruct, node)->key == (int) i);
+    }
+    reset_globals();
+
+    /* Inserting in order with the previous RBTreeNode as the hint never searches. */
+    for (i = 0; i < 1000; ++i) {
+        many[i].key = (int) i;
+    }
+    for (i = 0; i < 1000; ++i) {
+        rbtree_insert_hint(&rbtree, &many[i].key, &many[i].node, i > 0 ? &many[i - 1].node : NULL);
+    }
+    ASSERT_RBTREE(rbtree, rbtree.root, 1000);
+    ASSERT_PROPERTIES(rbtree);
+    for (i = 1000; i > 0; --i) {
+        rbtree_remove(&rbtree, &many[i - 1].node);
+    }
+    for (i = 1000; i > 0; --i) {
+        rbtree_insert_hint(&rbtree, &many[i - 1].key, &many[i - 1].node, i < 1000 ? &many[i].node : NULL);
+    }
+    ASSERT_RBTREE(rbtree, rbtree.root, 1000);
+    ASSERT_PROPERTIES(rbtree);
+    for (i = 0; i < 1000; ++i) {
+        assert(rbtree_at(&rbtree, i) == &many[i].node);
+    }
+}
+
+void test_rbtree_insert_last(void) {
+    size_t i;
+
+    rbtree_insert_last(&rbtree, &var1.key, &var1.node);
+    ASSERT_RBTREE(rbtree, &var1.node, 1);
+    rbtree_insert_last(&rbtree, &var2.key, &var2.node);
+    rbtree_insert_last(&rbtree, &var3.key, &var3.node);
+    rbtree_insert_last(&rbtree, &var4.key, &var4.node);
+    rbtree_insert_last(&rbtree, &var6.key, &var6.node);
+    rbtree_insert_last(&rbtree, &var7.key, &var7.node);
+    ASSERT_PROPERTIES(rbtree);
+
+    /* A key that is not the greatest falls back to a full search. */
+    rbtree_insert_last(&rbtree, &var5.key, &var5.node);
+    ASSERT_RBTREE(rbtree, rbtree.root, 7);
+    ASSERT_INORDERNESS(rbtree);
+    ASSERT_PROPERTIES(rbtree);
+
+    many[0].key = 7;
+    many[0].num_similar_keys = 0;
+    rbtree_insert_last(&rbtree, &many[0].key, &many[0].node);
+    assert(rbtree_last(&rbtree) == &many[0].node && many[0].num_similar_keys == 1);
+    ASSERT_RBTREE(rbtree, rbtree.root, 7);
+    ASSERT_PROPERTIES(rbtree);
+    reset_globals();
+
+    /* The greatest key is linked below the cached last RBTreeNode after a single comparison. */
+    for (i = 0; i < 1000; ++i) {
+        many[i].key = (int) i;
+
+        #ifdef CDSA_STATS
+        rbtree_reset_stats(&rbtree);
+        #endif /* CDSA_STATS */
+
+        rbtree_insert_last(&rbtree, &many[i].key, &many[i].node);
+        assert(rbtree_last(&rbtree) == &many[i].node);
+
+        #ifdef CDSA_STATS
+        assert(rbtree.stats.num_compare_calls == (i == 0 ? 0 : 1));
+        #endif /* CDSA_STATS */
+    }
+    ASSERT_RBTREE(rbtree, rbtree.root, 1000);
+    ASSERT_PROPERTIES(rbtree);
+    reset_globals();
+
+    rbtree_set_augment(&rbtree, &augment);
+    for (i = 0; i < 1000; ++i) {
+        many[i].key = (int) i;
+        many[i].value = (int) i;
+        rbtree_insert_last(&rbtree, &many[i].key, &many[i].node);
+    }
+    ASSERT_RBTREE(rbtree, rbtree.root, 1000);
+    ASSERT_PROPERTIES(rbtree);
+    for (i = 0; i < 1000; ++i) {
+        assert(rbtree_at(&rbtree, i) == &many[i].node);
+    }
+}
+
+void test_rbtree_build_sorted(void) {
+    RBTreeNode *nodes[7];
+    size_t num_nodes, i;
+
+    nodes[0] = &var1.node;
+    nodes[1] = &var2.node;
+    nodes[2] = &var3.node;
+    nodes[3] = &var4.node;
+    nodes[4] = &var5.node;
+    nodes[5] = &var6.node;
+    nodes[6] = &var7.node;
+
+    rbtree_build_sorted(&rbtree, NULL, 0);
+    ASSERT_RBTREE(rbtree, NULL, 0);
+
+    for (num_nodes = 1; num_nodes <= 7; ++num_nodes) {
+        reset_globals();
+        rbtree_build_sorted(&rbtree, nodes, num_nodes);
+        assert(rbtree_size(&rbtree) == num_nodes);
+        ASSERT_PROPERTIES(rbtree);
+
+        for (i = 0; i < num_nodes; ++i) {
+            assert(rbtree_at(&rbtree, i) == nodes[i]);
+            assert(rbtree_lookup_key(&rbtree, &rbtree_entry(nodes[i], TestStruct, node)->key) == nodes[i]);
+        }
+    }
+
+    ASSERT_INORDERNESS(rbtree);
+    ASSERT_RBTREE(rbtree, &var4.node, 7);
+    DRAIN_RANDOMLY(rbtree);
+    reset_globals();
+
+    for (num_nodes = 0; num_nodes <= 1000; num_nodes += 37) {
+        for (i = 0; i < num_nodes; ++i) {
+            many[i].key = (int) (2 * i);
+            many[i].value = (int) i;
+            many_nodes[i] = &many[i].node;
+        }
+
+        rbtree_set_augment(&rbtree, &augment);
+        rbtree_build_sorted(&rbtree, many_nodes, num_nodes);
+        assert(rbtree_size(&rbtree) == num_nodes);
+        ASSERT_PROPERTIES(rbtree);
+        assert(subtree_sum_(rbtree.root) == (int) (num_nodes * (num_nodes - 1) / 2));
+
+        /* The built tree must behave like any other tree. */
+        for (i = 0; i < num_nodes; i += 3) {
+            rbtree_remove(&rbtree, &many[i].node);
+        }
+        ASSERT_PROPERTIES(rbtree);
+        for (i = 0; i < num_nodes; i += 3) {
+            rbtree_insert(&rbtree, &many[i].key, &many[i].node);
+        }
+        ASSERT_PROPERTIES(rbtree);
+        for (i = 0; i < num_nodes; ++i) {
+            assert(rbtree_at(&rbtree, i) == &many[i].node);
+        }
+
+        reset_globals();
+    }
+}
+
+void test_rbtree_build_sorted_sequence(void) {
+    TestStruct *cursor = many;
+    size_t num_nodes, i;
+
+    rbtree_build_sorted_sequence(&rbtree, 0, NULL, NULL);
+    ASSERT_RBTREE(rbtree, NULL, 0);
+
+    for (num_nodes = 1; num_nodes <= 1000; num_nodes += 111) {
+        for (i = 0; i < num_nodes; ++i) {
+            many[i].key = (int) i;
+        }
+
+        cursor = many;
+        rbtree_build_sorted_sequence(&rbtree, num_nodes, next_func, &cursor);
+        assert(cursor == many + num_nodes);
+        assert(rbtree_size(&rbtree) == num_nodes);
+        ASSERT_PROPERTIES(rbtree);
+        for (i = 0; i < num_nodes; ++i) {
+            assert(rbtree_at(&rbtree, i) == &many[i].node);
+        }
+
+        reset_globals();
+    }
+}
+
 void test_rbtree_lookup_key(void) {
     assert(rbtree_lookup_key(&rbtree, &var1.key) == NULL);
 
@@ -970,6 +1422,49 @@ void test_rbtree_lookup_key(void) {
     }
 }
 
+void test_rbtree_lower_bound(void) {
+    int key = 0;
+
+    assert(rbtree_lower_bound(&rbtree, &key) == NULL);
+
+    loop {
+        FILL_RANDOMLY(rbtree);
+        rbtree_remove(&rbtree, &var4.node);
+
+        key = 0;
+        assert(rbtree_lower_bound(&rbtree, &key) == &var1.node);
+        assert(rbtree_lower_bound(&rbtree, &var1.key) == &var1.node);
+        assert(rbtree_lower_bound(&rbtree, &var3.key) == &var3.node);
+        assert(rbtree_lower_bound(&rbtree, &var4.key) == &var5.node);
+        assert(rbtree_lower_bound(&rbtree, &var7.key) == &var7.node);
+        key = 8;
+        assert(rbtree_lower_bound(&rbtree, &key) == NULL);
+
+        reset_globals();
+    }
+}
+
+void test_rbtree_upper_bound(void) {
+    int key = 0;
+
+    assert(rbtree_upper_bound(&rbtree, &key) == NULL);
+
+    loop {
+        FILL_RANDOMLY(rbtree);
+        rbtree_remove(&rbtree, &var4.node);
+
+        key = 0;
+        assert(rbtree_upper_bound(&rbtree, &key) == &var1.node);
+        assert(rbtree_upper_bound(&rbtree, &var1.key) == &var2.node);
+        assert(rbtree_upper_bound(&rbtree, &var3.key) == &var5.node);
+        assert(rbtree_upper_bound(&rbtree, &var4.key) == &var5.node);
+        assert(rbtree_upper_bound(&rbtree, &var6.key) == &var7.node);
+        assert(rbtree_upper_bound(&rbtree, &var7.key) == NULL);
+
+        reset_globals();
+    }
+}
+
 void test_rbtree_remove(void) {
     rbtree_remove(&rbtree, NULL);
     ASSERT_RBTREE(rbtree, NULL, 0);
@@ -977,7 +1472,7 @@ void test_rbtree_remove(void) {
     FILL_SEQUENTIALLY(rbtree);
     rbtree_remove(&rbtree, &var1.node);
     ASSERT_RBTREE(rbtree, &var4.node, 6);
-    ASSERT_NODE(var1.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var1.node.color);
+    ASSERT_NODE(var1.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var1.node));
     ASSERT_NODE(var2.node, &var4.node, NULL, &var3.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var3.node, &var2.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var4.node, NULL, &var2.node, &var6.node, RBTREE_NODE_BLACK);
@@ -987,7 +1482,7 @@ void test_rbtree_remove(void) {
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var2.node);
     ASSERT_RBTREE(rbtree, &var6.node, 5);
-    ASSERT_NODE(var2.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var2.node.color);
+    ASSERT_NODE(var2.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var2.node));
     ASSERT_NODE(var3.node, &var4.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var4.node, &var6.node, &var3.node, &var5.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var5.node, &var4.node, NULL, NULL, RBTREE_NODE_RED);
@@ -996,7 +1491,7 @@ void test_rbtree_remove(void) {
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var3.node);
     ASSERT_RBTREE(rbtree, &var6.node, 4);
-    ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var3.node.color);
+    ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var3.node));
     ASSERT_NODE(var4.node, &var6.node, NULL, &var5.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var5.node, &var4.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var6.node, NULL, &var4.node, &var7.node, RBTREE_NODE_BLACK);
@@ -1004,25 +1499,25 @@ void test_rbtree_remove(void) {
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var4.node);
     ASSERT_RBTREE(rbtree, &var6.node, 3);
-    ASSERT_NODE(var4.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var4.node.color);
+    ASSERT_NODE(var4.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var4.node));
     ASSERT_NODE(var5.node, &var6.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var6.node, NULL, &var5.node, &var7.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var7.node, &var6.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var5.node);
     ASSERT_RBTREE(rbtree, &var6.node, 2);
-    ASSERT_NODE(var5.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var5.node.color);
+    ASSERT_NODE(var5.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var5.node));
     ASSERT_NODE(var6.node, NULL, NULL, &var7.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var7.node, &var6.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var6.node);
     ASSERT_RBTREE(rbtree, &var7.node, 1);
-    ASSERT_NODE(var6.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var6.node.color);
+    ASSERT_NODE(var6.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var6.node));
     ASSERT_NODE(var7.node, NULL, NULL, NULL, RBTREE_NODE_BLACK);
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var7.node);
     ASSERT_RBTREE(rbtree, NULL, 0);
-    ASSERT_NODE(var7.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var7.node.color);
+    ASSERT_NODE(var7.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var7.node));
     ASSERT_PROPERTIES(rbtree);
     reset_globals();
 
@@ -1035,7 +1530,7 @@ void test_rbtree_remove(void) {
     ASSERT_NODE(var4.node, &var2.node, &var3.node, &var6.node, RBTREE_NODE_RED);
     ASSERT_NODE(var5.node, &var6.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var6.node, &var4.node, &var5.node, NULL, RBTREE_NODE_BLACK);
-    ASSERT_NODE(var7.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var7.node.color);
+    ASSERT_NODE(var7.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var7.node));
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var6.node);
     ASSERT_RBTREE(rbtree, &var2.node, 5);
@@ -1044,7 +1539,7 @@ void test_rbtree_remove(void) {
     ASSERT_NODE(var3.node, &var4.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var4.node, &var2.node, &var3.node, &var5.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var5.node, &var4.node, NULL, NULL, RBTREE_NODE_RED);
-    ASSERT_NODE(var6.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var6.node.color);
+    ASSERT_NODE(var6.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var6.node));
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var5.node);
     ASSERT_RBTREE(rbtree, &var2.node, 4);
@@ -1052,29 +1547,29 @@ void test_rbtree_remove(void) {
     ASSERT_NODE(var2.node, NULL, &var1.node, &var4.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var3.node, &var4.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var4.node, &var2.node, &var3.node, NULL, RBTREE_NODE_BLACK);
-    ASSERT_NODE(var5.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var5.node.color);
+    ASSERT_NODE(var5.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var5.node));
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var4.node);
     ASSERT_RBTREE(rbtree, &var2.node, 3);
     ASSERT_NODE(var1.node, &var2.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var2.node, NULL, &var1.node, &var3.node, RBTREE_NODE_BLACK);
     ASSERT_NODE(var3.node, &var2.node, NULL, NULL, RBTREE_NODE_RED);
-    ASSERT_NODE(var4.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var4.node.color);
+    ASSERT_NODE(var4.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var4.node));
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var3.node);
     ASSERT_RBTREE(rbtree, &var2.node, 2);
     ASSERT_NODE(var1.node, &var2.node, NULL, NULL, RBTREE_NODE_RED);
     ASSERT_NODE(var2.node, NULL, &var1.node, NULL, RBTREE_NODE_BLACK);
-    ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var3.node.color);
+    ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var3.node));
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var2.node);
     ASSERT_RBTREE(rbtree, &var1.node, 1);
     ASSERT_NODE(var1.node, NULL, NULL, NULL, RBTREE_NODE_BLACK);
-    ASSERT_NODE(var2.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var2.node.color);
+    ASSERT_NODE(var2.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var2.node));
     ASSERT_PROPERTIES(rbtree);
     rbtree_remove(&rbtree, &var1.node);
     ASSERT_RBTREE(rbtree, NULL, 0);
-    ASSERT_NODE(var1.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var1.node.color);
+    ASSERT_NODE(var1.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var1.node));
     ASSERT_PROPERTIES(rbtree);
     reset_globals();
 
@@ -1366,6 +1861,64 @@ void test_rbtree_remove_last(void) {
     }
 }
 
+void test_rbtree_remove_range(void) {
+    int low = 0, high = 8;
+
+    rbtree_remove_range(&rbtree, &low, &high);
+    ASSERT_RBTREE(rbtree, NULL, 0);
+
+    loop {
+        FILL_RANDOMLY(rbtree);
+
+        rbtree_remove_range(&rbtree, &var5.key, &var3.key);
+        assert(rbtree_size(&rbtree) == 7);
+
+        low = 3;
+        high = 5;
+        rbtree_remove_range(&rbtree, &low, &high);
+        assert(rbtree_size(&rbtree) == 4);
+        ASSERT_PROPERTIES(rbtree);
+        ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var3.node));
+        ASSERT_NODE(var4.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var4.node));
+        ASSERT_NODE(var5.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var5.node));
+        assert(rbtree_at(&rbtree, 1) == &var2.node);
+        assert(rbtree_at(&rbtree, 2) == &var6.node);
+
+        low = 6;
+        high = 100;
+        rbtree_remove_range(&rbtree, &low, &high);
+        assert(rbtree_size(&rbtree) == 2);
+        assert(rbtree_last(&rbtree) == &var2.node);
+
+        low = -100;
+        rbtree_remove_range(&rbtree, &low, &high);
+        ASSERT_RBTREE(rbtree, NULL, 0);
+
+        reset_globals();
+    }
+}
+
+void test_rbtree_destroy(void) {
+    size_t num_destroyed;
+
+    counter = 0;
+    rbtree_destroy(&rbtree, destroy_func, &aux_ptr);
+    assert(counter == 0);
+    ASSERT_RBTREE(rbtree, NULL, 0);
+
+    FILL_RANDOMLY(rbtree);
+    rbtree_destroy(&rbtree, destroy_func, &aux_ptr);
+    num_destroyed = counter;
+    assert(num_destroyed == 7);
+    ASSERT_RBTREE(rbtree, NULL, 0);
+    ASSERT_NODE(var4.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var4.node));
+
+    /* The destroyed tree can be used right away. */
+    reset_globals();
+    FILL_RANDOMLY(rbtree);
+    ASSERT_INORDERNESS(rbtree);
+}
+
 void test_rbtree_remove_all(void) {
     rbtree_remove_all(&rbtree);
     ASSERT_RBTREE(rbtree, NULL, 0);
@@ -1376,21 +1929,21 @@ void test_rbtree_remove_all(void) {
     rbtree_insert(&rbtree, &var3.key, &var3.node);
     rbtree_remove_all(&rbtree);
     ASSERT_RBTREE(rbtree, NULL, 0);
-    ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var3.node.color);
+    ASSERT_NODE(var3.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var3.node));
     ASSERT_PROPERTIES(rbtree);
     reset_globals();
 
     FILL_SEQUENTIALLY(rbtree);
     rbtree_remove_all(&rbtree);
     ASSERT_RBTREE(rbtree, NULL, 0);
-    ASSERT_NODE(var2.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var2.node.color);
+    ASSERT_NODE(var2.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var2.node));
     ASSERT_PROPERTIES(rbtree);
     reset_globals();
 
     FILL_SEQUENTIALLY_REVERSE(rbtree);
     rbtree_remove_all(&rbtree);
     ASSERT_RBTREE(rbtree, NULL, 0);
-    ASSERT_NODE(var6.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, var6.node.color);
+    ASSERT_NODE(var6.node, RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(&var6.node));
     ASSERT_PROPERTIES(rbtree);
     reset_globals();
 
@@ -1400,15 +1953,289 @@ void test_rbtree_remove_all(void) {
         root = rbtree.root;
         rbtree_remove_all(&rbtree);
         ASSERT_RBTREE(rbtree, NULL, 0);
-        ASSERT_NODE((*root), RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, root->color);
+        ASSERT_NODE((*root), RBTREE_POISON_PARENT, RBTREE_POISON_LEFT_CHILD, RBTREE_POISON_RIGHT_CHILD, rbtree_color(root));
         ASSERT_PROPERTIES(rbtree);
         reset_globals();
     }
 }
 
+void test_rbtree_stats(void) {
+    #ifdef CDSA_STATS
+    RBTreeStats stats;
+    int i;
+
+    rbtree_stats(&rbtree, &stats);
+    assert(stats.num_compare_calls == 0);
+    assert(stats.num_collisions == 0);
+    assert(stats.num_rotations == 0);
+    assert(stats.num_recolorings == 0);
+    assert(stats.max_depth == 0);
+
+    /* The root turns black, and the third insertion recolors twice and rotates once. */
+    rbtree_insert(&rbtree, &var1.key, &var1.node);
+    rbtree_insert(&rbtree, &var2.key, &var2.node);
+    rbtree_insert(&rbtree, &var3.key, &var3.node);
+    rbtree_stats(&rbtree, &stats);
+    assert(stats.num_compare_calls == 3);
+    assert(stats.num_collisions == 0);
+    assert(stats.num_rotations == 1);
+    assert(stats.num_recolorings == 3);
+    assert(stats.max_depth == 2);
+
+    var4.key = 2;
+    rbtree_insert(&rbtree, &var4.key, &var4.node);
+    assert(rbtree_lookup_key(&rbtree, &var3.key) == &var3.node);
+    rbtree_stats(&rbtree, &stats);
+    assert(stats.num_compare_calls == 6);
+    assert(stats.num_collisions == 1);
+    assert(stats.num_rotations == 1);
+    assert(var4.num_similar_keys == 1);
+
+    rbtree_reset_stats(&rbtree);
+    rbtree_stats(&rbtree, &stats);
+    assert(stats.num_compare_calls == 0);
+    assert(stats.num_collisions == 0);
+    assert(stats.num_rotations == 0);
+    assert(stats.num_recolorings == 0);
+    assert(stats.max_depth == 0);
+
+    /* Ascending insertions keep rebalancing, but the depth stays logarithmic. */
+    rbtree_init(&rbtree, compare_func, collide_func, &aux_ptr);
+    for (i = 0; i < 1000; ++i) {
+        many[i].key = i;
+        rbtree_insert(&rbtree, &many[i].key, &many[i].node);
+    }
+    rbtree_stats(&rbtree, &stats);
+    assert(stats.num_rotations > 0 && stats.num_rotations < 1000);
+    assert(stats.num_recolorings > 0);
+    assert(stats.max_depth >= 9 && stats.max_depth <= 20);
+    ASSERT_PROPERTIES(rbtree);
+    #endif /* CDSA_STATS */
+}
+
+/* Asserts that the keys of the @ref tree are exactly @ref low, @ref low + 1, ..., @ref high - 1 in order. */
+static void assert_key_range_(const RBTree *tree, int low, int high) {
+    RBTreeNode *n;
+    int key = low;
+
+    for (n = rbtree_first(tree); n; n = rbtree_next(n)) {
+        assert(rbtree_entry(n, TestStruct, node)->key == key++);
+    }
+
+    assert(key == high);
+    assert(rbtree_size(tree) == (size_t) (high - low));
+}
+
+/* Fills the @ref rbtree with the keys 0 to 999 of the many array, out of order. */
+static void fill_many_(void) {
+    int i;
+
+    for (i = 0; i < 1000; ++i) {
+        many[(i * 7) % 1000].key = (i * 7) % 1000;
+        many[(i * 7) % 1000].value = (i * 7) % 1000;
+        rbtree_insert(&rbtree, &many[(i * 7) % 1000].key, &many[(i * 7) % 1000].node);
+    }
+}
+
+void test_rbtree_split(void) {
+    const int split_keys[] = { -5, 0, 1, 2, 333, 500, 998, 999, 1000, 2000 };
+    RBTree left, right;
+    size_t i;
+    int key;
+
+    /* An empty RBTree splits into two empty ones. */
+    key = 0;
+    rbtree_split(&rbtree, &key, &left, &right);
+    ASSERT_RBTREE(left, NULL, 0);
+    ASSERT_RBTREE(right, NULL, 0);
+
+    for (i = 0; i < sizeof(split_keys) / sizeof(split_keys[0]); ++i) {
+        int low = split_keys[i] < 0 ? 0 : split_keys[i] > 1000 ? 1000 : split_keys[i];
+
+        reset_globals();
+        rbtree_set_augment(&rbtree, &augment);
+        fill_many_();
+
+        rbtree_split(&rbtree, &split_keys[i], &left, &right);
+        ASSERT_RBTREE(rbtree, NULL, 0);
+        ASSERT_PROPERTIES(left);
+        ASSERT_PROPERTIES(right);
+        assert_key_range_(&left, 0, low);
+        assert_key_range_(&right, low, 1000);
+        assert(left.compare == compare_func && right.augment == &augment);
+
+        /* The halves are ordinary trees. */
+        var1.key = 5000;
+        rbtree_remove(&left, rbtree_first(&left));
+        rbtree_insert(&right, &var1.key, &var1.node);
+        ASSERT_PROPERTIES(left);
+        ASSERT_PROPERTIES(right);
+        assert(rbtree_last(&right) == &var1.node);
+    }
+
+    /* Splitting into the RBTree itself keeps the upper half in place. */
+    reset_globals();
+    fill_many_();
+    key = 250;
+    rbtree_split(&rbtree, &key, &left, &rbtree);
+    ASSERT_PROPERTIES(left);
+    ASSERT_PROPERTIES(rbtree);
+    assert_key_range_(&left, 0, 250);
+    assert_key_range_(&rbtree, 250, 1000);
+    assert(rbtree_contains_key(&rbtree, &key));
+
+    #ifdef CDSA_STATS
+    {
+        RBTreeStats stats, left_stats, right_stats;
+
+        /* Only the left half keeps the counters. */
+        reset_globals();
+        fill_many_();
+        key = 500;
+        rbtree_stats(&rbtree, &stats);
+        rbtree_split(&rbtree, &key, &left, &right);
+        rbtree_stats(&left, &left_stats);
+        rbtree_stats(&right, &right_stats);
+        assert(left_stats.num_compare_calls >= stats.num_compare_calls);
+        assert(left_stats.num_rotations >= stats.num_rotations);
+        assert(right_stats.num_compare_calls == 0 && right_stats.num_collisions == 0);
+        assert(right_stats.num_rotations == 0 && right_stats.num_recolorings == 0 && right_stats.max_depth == 0);
+        rbtree_stats(&rbtree, &stats);
+        assert(stats.num_compare_calls == 0 && stats.num_rotations == 0);
+    }
+    #endif /* CDSA_STATS */
+}
+
+void test_rbtree_join(void) {
+    const int split_keys[] = { 0, 1, 2, 17, 500, 998, 999, 1000 };
+    RBTree left, right;
+    size_t i;
+
+    for (i = 0; i < sizeof(split_keys) / sizeof(split_keys[0]); ++i) {
+        reset_globals();
+        rbtree_set_augment(&rbtree, &augment);
+        fill_many_();
+
+        rbtree_split(&rbtree, &split_keys[i], &left, &right);
+        rbtree_join(&left, &right);
+        ASSERT_RBTREE(right, NULL, 0);
+        ASSERT_PROPERTIES(left);
+        assert_key_range_(&left, 0, 1000);
+    }
+
+    /* Trees of very different heights, built independently. */
+    reset_globals();
+    left = rbtree;
+    right = rbtree;
+    rbtree_insert(&left, &var1.key, &var1.node);
+    for (i = 0; i < 1000; ++i) {
+        many[i].key = (int) i + 10;
+        rbtree_insert(&right, &many[i].key, &many[i].node);
+    }
+    rbtree_join(&left, &right);
+    ASSERT_RBTREE(right, NULL, 0);
+    ASSERT_PROPERTIES(left);
+    assert(rbtree_size(&left) == 1001);
+    assert(rbtree_first(&left) == &var1.node && rbtree_last(&left) == &many[999].node);
+
+    right = rbtree;
+    var2.key = 5000;
+    rbtree_insert(&right, &var2.key, &var2.node);
+    rbtree_join(&left, &right);
+    ASSERT_PROPERTIES(left);
+    assert(rbtree_size(&left) == 1002 && rbtree_last(&left) == &var2.node);
+
+    /* Joining with an empty RBTree on either side moves everything. */
+    right = rbtree;
+    rbtree_join(&left, &right);
+    assert(rbtree_size(&left) == 1002);
+    rbtree_join(&right, &left);
+    ASSERT_RBTREE(left, NULL, 0);
+    ASSERT_PROPERTIES(right);
+    assert(rbtree_size(&right) == 1002);
+}
+
+void test_rbtree_snapshot(void) {
+    RBTreeImage image;
+    const RBTreeNode *n;
+    char *memory, *copy_memory, *buffer, *copy;
+    size_t size;
+    int i, key;
+
+    /* Insert the even keys out of order, so the tree is not laid out like the arena. */
+    for (i = 0; i < 1000; ++i) {
+        many[(i * 7) % 1000].key = 2 * ((i * 7) % 1000);
+        many[(i * 7) % 1000].value = (i * 7) % 1000;
+        rbtree_insert(&rbtree, &many[(i * 7) % 1000].key, &many[(i * 7) % 1000].node);
+    }
+
+    size = rbtree_serialize(&rbtree, many, sizeof(many), NULL);
+    assert(size > sizeof(many));
+
+    /* Over-allocate, so both buffers can be aligned. */
+    memory = (char*) malloc(size + RBTREE_SNAPSHOT_ALIGNMENT);
+    copy_memory = (char*) malloc(size + RBTREE_SNAPSHOT_ALIGNMENT);
+    assert(memory && copy_memory);
+    buffer = memory + (RBTREE_SNAPSHOT_ALIGNMENT - (size_t) memory % RBTREE_SNAPSHOT_ALIGNMENT) %
+        RBTREE_SNAPSHOT_ALIGNMENT;
+    copy = copy_memory + (RBTREE_SNAPSHOT_ALIGNMENT - (size_t) copy_memory % RBTREE_SNAPSHOT_ALIGNMENT) %
+        RBTREE_SNAPSHOT_ALIGNMENT;
+
+    assert(rbtree_serialize(&rbtree, many, sizeof(many), buffer) == size);
+    assert(rbtree_size(&rbtree) == 1000);
+
+    /* Move the image and destroy the original, so nothing can point back into either. */
+    memcpy(copy, buffer, size);
+    memset(buffer, 0, size);
+    rbtree_init(&rbtree, compare_func, collide_func, &aux_ptr);
+    memset(many, 0, sizeof(many));
+
+    assert(rbtree_attach(&image, copy, size, compare_func));
+    assert(rbtree_image_size(&image) == 1000);
+
+    for (i = 0, n = rbtree_image_first(&image); n; ++i, n = rbtree_image_next(n)) {
+        assert((const char*) n > copy && (const char*) n < copy + size);
+        assert(rbtree_entry(n, TestStruct, node)->key == 2 * i);
+        assert(rbtree_entry(n, TestStruct, node)->value == i);
+    }
+    assert(i == 1000);
+
+    key = 1998;
+    n = rbtree_image_lookup_key(&image, &key);
+    assert(n && rbtree_entry(n, TestStruct, node)->value == 999);
+    assert(rbtree_image_next(n) == NULL);
+    key = 501;
+    assert(rbtree_image_lookup_key(&image, &key) == NULL);
+    n = rbtree_image_lower_bound(&image, &key);
+    assert(n && rbtree_entry(n, TestStruct, node)->key == 502);
+    key = -1;
+    assert(rbtree_image_lower_bound(&image, &key) == rbtree_image_first(&image));
+    key = 1999;
+    assert(rbtree_image_lower_bound(&image, &key) == NULL);
+
+    /* Truncated and foreign images are rejected. */
+    assert(!rbtree_attach(&image, copy, size - 1, compare_func));
+    assert(!rbtree_attach(&image, copy, sizeof(size_t), compare_func));
+    copy[0] ^= 1;
+    assert(!rbtree_attach(&image, copy, size, compare_func));
+    copy[0] ^= 1;
+    assert(rbtree_image_size(&image) == 1000);
+
+    /* An empty RBTree needs no arena. */
+    size = rbtree_serialize(&rbtree, NULL, 0, NULL);
+    assert(rbtree_serialize(&rbtree, NULL, 0, buffer) == size);
+    assert(rbtree_attach(&image, buffer, size, compare_func));
+    assert(rbtree_image_size(&image) == 0);
+    assert(rbtree_image_first(&image) == NULL);
+    assert(rbtree_image_lookup_key(&image, &key) == NULL);
+
+    free(memory);
+    free(copy_memory);
+}
+
 void test_rbtree_entry(void) {
     assert(rbtree_entry(&var1.node, TestStruct, node)->key == 1);
-    assert(rbtree_entry(&var1.node, TestStruct, node)->node.parent == RBTREE_POISON_PARENT);
+    assert(rbtree_parent(&rbtree_entry(&var1.node, TestStruct, node)->node) == RBTREE_POISON_PARENT);
     assert(rbtree_entry(&var1.node, TestStruct, node)->node.left_child == RBTREE_POISON_LEFT_CHILD);
     assert(rbtree_entry(&var1.node, TestStruct, node)->node.right_child == RBTREE_POISON_RIGHT_CHILD);
 }
@@ -1697,24 +2524,129 @@ void test_rbtree_for_each_safe_from_reverse(void) {
     }
 }
 
+void test_rbtree_for_each_in_range(void) {
+    RBTreeNode *n;
+    int low = 0, high = 8;
+
+    rbtree_for_each_in_range(n, &low, &high, &rbtree) {
+        assert(0);
+    }
+
+    loop {
+        size_t i;
+
+        FILL_RANDOMLY(rbtree);
+
+        i = 0;
+        rbtree_for_each_in_range(n, &low, &high, &rbtree) {
+            ASSERT_FOR_EACH(n, i);
+            ++i;
+        }
+        assert(i == 7);
+
+        i = 2;
+        rbtree_for_each_in_range(n, &var3.key, &var5.key, &rbtree) {
+            ASSERT_FOR_EACH(n, i);
+            ++i;
+        }
+        assert(i == 5);
+
+        i = 0;
+        rbtree_for_each_in_range(n, &var5.key, &var3.key, &rbtree) {
+            ++i;
+        }
+        assert(i == 0);
+
+        reset_globals();
+    }
+}
+
+void test_rbtree_for_each_postorder(void) {
+    RBTreeNode *n;
+
+    rbtree_for_each_postorder(n, &rbtree) {
+        assert(0);
+    }
+
+    loop {
+        int visited[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        size_t i = 0;
+
+        FILL_RANDOMLY(rbtree);
+
+        rbtree_for_each_postorder(n, &rbtree) {
+            visit_postorder_(n, visited);
+            ++i;
+        }
+        assert(i == 7);
+        assert(n == NULL);
+
+        reset_globals();
+    }
+}
+
+void test_rbtree_for_each_postorder_safe(void) {
+    RBTreeNode *n, *backup;
+
+    rbtree_for_each_postorder_safe(n, backup, &rbtree) {
+        assert(0);
+    }
+
+    loop {
+        int visited[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        size_t i = 0;
+
+        FILL_RANDOMLY(rbtree);
+
+        rbtree_for_each_postorder_safe(n, backup, &rbtree) {
+            visit_postorder_(n, visited);
+            ++i;
+
+            /* Scribble over the node, as freeing it would. */
+            POISON_NODE(*n);
+            n = NULL;
+        }
+        assert(i == 7);
+
+        reset_globals();
+    }
+}
+
 TestFunc test_funcs[] = {
     test_rbtree_init,
+    test_rbtree_set_augment,
     test_rbtree_first,
     test_rbtree_last,
     test_rbtree_prev,
     test_rbtree_next,
+    test_rbtree_postorder_first,
+    test_rbtree_postorder_next,
     test_rbtree_size,
     test_rbtree_empty,
     test_rbtree_contains_key,
+    test_rbtree_augment,
     test_rbtree_index_of,
     test_rbtree_at,
+    test_rbtree_rank_of_key,
     test_rbtree_insert,
+    test_rbtree_insert_hint,
+    test_rbtree_insert_last,
+    test_rbtree_build_sorted,
+    test_rbtree_build_sorted_sequence,
     test_rbtree_lookup_key,
+    test_rbtree_lower_bound,
+    test_rbtree_upper_bound,
     test_rbtree_remove,
     test_rbtree_remove_key,
     test_rbtree_remove_first,
     test_rbtree_remove_last,
+    test_rbtree_remove_range,
     test_rbtree_remove_all,
+    test_rbtree_destroy,
+    test_rbtree_stats,
+    test_rbtree_split,
+    test_rbtree_join,
+    test_rbtree_snapshot,
     test_rbtree_entry,
     test_rbtree_for_each,
     test_rbtree_for_each_reverse,
@@ -1727,7 +2659,10 @@ TestFunc test_funcs[] = {
     test_rbtree_for_each_from,
     test_rbtree_for_each_from_reverse,
     test_rbtree_for_each_safe_from,
-    test_rbtree_for_each_safe_from_reverse
+    test_rbtree_for_each_safe_from_reverse,
+    test_rbtree_for_each_in_range,
+    test_rbtree_for_each_postorder,
+    test_rbtree_for_each_postorder_safe
 };
 
 int main(int argc, char *argv[]) {
@@ -1735,7 +2670,7 @@ int main(int argc, char *argv[]) {
     assert(argc == 2);
     strcat(msg, argv[1]);
 
-    assert(sizeof(test_funcs) / sizeof(TestFunc) == 30);
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 50);
     run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
 
     return 0;
@@ -23,6 +23,10 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <stdarg.h>
 #include <assert.h>
 
+#ifdef STACK_ATOMICS
+    #include <pthread.h>
+#endif /* STACK_ATOMICS */
+
 #include "testing_framework.h"
 
 /* Test header guard. */
@@ -41,7 +45,19 @@ typedef struct TestStruct {
 } TestStruct;
 
 TestStruct var1, var2, var3;
-Stack stack;
+Stack stack, src_stack;
+
+#ifdef STACK_ATOMICS
+
+ConcurrentStack concurrentstack;
+
+#define NUM_THREADS 4
+#define NUM_STRESS_NODES 64
+#define NUM_ROUNDS 5000
+
+TestStruct stress_vars[NUM_STRESS_NODES];
+
+#endif /* STACK_ATOMICS */
 
 #define ASSERT_STACK(stack, tail_ptr, size_of_stack) \
     do { \
@@ -73,6 +89,7 @@ Stack stack;
 
 static void reset_globals(void) {
     stack_init(&stack);
+    stack_init(&src_stack);
 
     var1.val = 1;
     var1.node.prev = STACK_POISON_PREV;
@@ -84,6 +101,56 @@ static void reset_globals(void) {
     var3.node.prev = STACK_POISON_PREV;
 }
 
+#ifdef STACK_ATOMICS
+
+/*
+ * Marks the node as owned by the calling thread, checking that no other thread owns it, i.e. that no node was
+ * popped twice.
+ */
+static void claim_(StackNode *n) {
+    assert(__atomic_exchange_n(&stack_entry(n, TestStruct, node)->val, 1, __ATOMIC_RELAXED) == 0);
+    __atomic_store_n(&stack_entry(n, TestStruct, node)->val, 0, __ATOMIC_RELAXED);
+}
+
+static void* stress_thread(void *arg) {
+    size_t i;
+
+    (void) arg;
+
+    for (i = 0; i < NUM_ROUNDS; ++i) {
+        if (i % 128 == 0) {
+            StackNode *n = concurrentstack_pop_all(&concurrentstack);
+
+            while (n) {
+                StackNode *prev = n->prev;
+
+                claim_(n);
+                concurrentstack_push(&concurrentstack, n);
+                n = prev;
+            }
+        } else {
+            StackNode *a = concurrentstack_pop(&concurrentstack);
+            StackNode *b = concurrentstack_pop(&concurrentstack);
+
+            /* Pushing back in a different order makes ABA situations likely. */
+            if (a) {
+                claim_(a);
+            }
+            if (b) {
+                claim_(b);
+                concurrentstack_push(&concurrentstack, b);
+            }
+            if (a) {
+                concurrentstack_push(&concurrentstack, a);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+#endif /* STACK_ATOMICS */
+
 /* ========================================================================================================
  *
  *                                             TESTING FUNCTIONS
@@ -146,6 +213,37 @@ void test_stack_push(void) {
     ASSERT_NODE(var3.node, &var2.node);
 }
 
+void test_stack_splice(void) {
+    /* Splicing an empty stack does nothing. */
+    stack_push(&stack, &var1.node);
+    stack_splice(&stack, &src_stack);
+    ASSERT_STACK(stack, &var1.node, 1);
+    ASSERT_STACK(src_stack, NULL, 0);
+
+    /* Splicing onto an empty stack moves the chain. */
+    stack_splice(&src_stack, &stack);
+    ASSERT_STACK(src_stack, &var1.node, 1);
+    assert(src_stack.head == &var1.node);
+    ASSERT_STACK(stack, NULL, 0);
+    assert(stack.head == NULL);
+
+    stack_push(&src_stack, &var2.node);
+    stack_push(&stack, &var3.node);
+    stack_splice(&stack, &src_stack);
+    ASSERT_STACK(stack, &var2.node, 3);
+    assert(stack.head == &var3.node);
+    ASSERT_STACK(src_stack, NULL, 0);
+    assert(src_stack.head == NULL);
+    ASSERT_NODE(var2.node, &var1.node);
+    ASSERT_NODE(var1.node, &var3.node);
+    ASSERT_NODE(var3.node, NULL);
+
+    assert(stack_pop(&stack) == &var2.node);
+    assert(stack_pop(&stack) == &var1.node);
+    assert(stack_pop(&stack) == &var3.node);
+    assert(stack.head == NULL);
+}
+
 void test_stack_pop(void) {
     stack_push(&stack, &var1.node);
     stack_push(&stack, &var2.node);
@@ -166,6 +264,36 @@ void test_stack_pop(void) {
     ASSERT_STACK(stack, NULL, 0);
 }
 
+void test_stack_pop_n(void) {
+    assert(stack_pop_n(&stack, 2) == NULL);
+
+    stack_push(&stack, &var1.node);
+    stack_push(&stack, &var2.node);
+    stack_push(&stack, &var3.node);
+    assert(stack_pop_n(&stack, 0) == NULL);
+    ASSERT_STACK(stack, &var3.node, 3);
+
+    /* Part of the stack. */
+    assert(stack_pop_n(&stack, 2) == &var3.node);
+    ASSERT_STACK(stack, &var1.node, 1);
+    assert(stack.head == &var1.node);
+    ASSERT_NODE(var3.node, &var2.node);
+    ASSERT_NODE(var2.node, NULL);
+    ASSERT_NODE(var1.node, NULL);
+
+    /* More than the whole stack. */
+    stack_push(&stack, &var2.node);
+    assert(stack_pop_n(&stack, 5) == &var2.node);
+    ASSERT_STACK(stack, NULL, 0);
+    assert(stack.head == NULL);
+    ASSERT_NODE(var2.node, &var1.node);
+    ASSERT_NODE(var1.node, NULL);
+
+    /* The head is still right after emptying the stack. */
+    stack_push(&stack, &var3.node);
+    assert(stack.head == &var3.node);
+}
+
 void test_stack_remove_all(void) {
     stack_push(&stack, &var1.node);
     stack_push(&stack, &var2.node);
@@ -222,17 +350,79 @@ void test_stack_for_each_safe(void) {
     assert(i == 3);
 }
 
+void test_concurrentstack(void) {
+    #ifdef STACK_ATOMICS
+    StackNode *n;
+
+    concurrentstack_init(&concurrentstack);
+    assert(concurrentstack_pop(&concurrentstack) == NULL);
+    assert(concurrentstack_pop_all(&concurrentstack) == NULL);
+
+    concurrentstack_push(&concurrentstack, &var1.node);
+    concurrentstack_push(&concurrentstack, &var2.node);
+    concurrentstack_push(&concurrentstack, &var3.node);
+    assert(concurrentstack_pop(&concurrentstack) == &var3.node);
+    ASSERT_NODE(var3.node, STACK_POISON_PREV);
+    assert(concurrentstack_pop(&concurrentstack) == &var2.node);
+    concurrentstack_push(&concurrentstack, &var3.node);
+
+    n = concurrentstack_pop_all(&concurrentstack);
+    assert(n == &var3.node);
+    ASSERT_NODE(var3.node, &var1.node);
+    ASSERT_NODE(var1.node, NULL);
+    assert(concurrentstack_pop(&concurrentstack) == NULL);
+    assert(concurrentstack_pop_all(&concurrentstack) == NULL);
+
+    concurrentstack_push(&concurrentstack, &var2.node);
+    assert(concurrentstack_pop(&concurrentstack) == &var2.node);
+    assert(concurrentstack_pop(&concurrentstack) == NULL);
+    #endif /* STACK_ATOMICS */
+}
+
+void test_concurrentstack_threads(void) {
+    #ifdef STACK_ATOMICS
+    pthread_t threads[NUM_THREADS];
+    StackNode *n;
+    size_t i;
+
+    concurrentstack_init(&concurrentstack);
+
+    for (i = 0; i < NUM_STRESS_NODES; ++i) {
+        stress_vars[i].val = 0;
+        concurrentstack_push(&concurrentstack, &stress_vars[i].node);
+    }
+
+    for (i = 0; i < NUM_THREADS; ++i) {
+        assert(pthread_create(threads + i, NULL, stress_thread, NULL) == 0);
+    }
+
+    for (i = 0; i < NUM_THREADS; ++i) {
+        assert(pthread_join(threads[i], NULL) == 0);
+    }
+
+    /* No node may have been lost or duplicated. */
+    for (i = 0, n = concurrentstack_pop_all(&concurrentstack); n; n = n->prev, ++i) {
+        assert(n >= &stress_vars[0].node && n <= &stress_vars[NUM_STRESS_NODES - 1].node);
+    }
+    assert(i == NUM_STRESS_NODES);
+    #endif /* STACK_ATOMICS */
+}
+
 TestFunc test_funcs[] = {
     test_stack_init,
     test_stack_peek,
     test_stack_size,
     test_stack_empty,
     test_stack_push,
+    test_stack_splice,
     test_stack_pop,
+    test_stack_pop_n,
     test_stack_remove_all,
     test_stack_entry,
     test_stack_for_each,
-    test_stack_for_each_safe
+    test_stack_for_each_safe,
+    test_concurrentstack,
+    test_concurrentstack_threads
 };
 
 int main(int argc, char *argv[]) {
@@ -240,7 +430,7 @@ int main(int argc, char *argv[]) {
     assert(argc == 2);
     strcat(msg, argv[1]);
 
-    assert(sizeof(test_funcs) / sizeof(TestFunc) == 10);
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 14);
     run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
 
     return 0;
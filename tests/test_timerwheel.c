@@ -0,0 +1,329 @@
+/*
+Copyright (c) 2017, Michael J Welsh
+
+Permission to use, copy, modify, and/or distribute this software
+for any purpose with or without fee is hereby granted, provided
+that the above copyright notice and this permission notice appear
+in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+
+#include "testing_framework.h"
+
+/* Test header guard. */
+#include "../src/timerwheel.h"
+#include "../src/timerwheel.h"
+
+/* ========================================================================================================
+ *
+ *                                             TESTING UTILITIES
+ *
+ * ======================================================================================================== */
+
+typedef struct TestStruct {
+    int val;
+    unsigned long fired_at;
+    TimerWheelNode node;
+} TestStruct;
+
+#define NUM_RANDOM_VARS 1000
+
+/* Ticks of the next level up, and the ticks the whole TimerWheel tells apart. */
+#define LEVEL_1_TICKS (1UL << TIMERWHEEL_LEVEL_BITS)
+#define RANGE_TICKS (1UL << (TIMERWHEEL_LEVEL_BITS * TIMERWHEEL_NUM_LEVELS))
+
+TestStruct var1, var2, var3;
+TestStruct random_vars[NUM_RANDOM_VARS];
+TimerWheel timerwheel;
+
+/* Every expired node in the order in which it expired. */
+TimerWheelNode *expired[NUM_RANDOM_VARS];
+size_t num_expired;
+
+#define ASSERT_NODE_POISONED(node) \
+    do { \
+        assert(node.next == TIMERWHEEL_POISON_NEXT); \
+        assert(node.pprev == TIMERWHEEL_POISON_PPREV); \
+    } while (0)
+
+static void reset_globals(void) {
+    timerwheel_init(&timerwheel, 0);
+
+    var1.val = 1;
+    var1.fired_at = 0;
+    var1.node.next = TIMERWHEEL_POISON_NEXT;
+    var1.node.pprev = TIMERWHEEL_POISON_PPREV;
+
+    var2.val = 2;
+    var2.fired_at = 0;
+    var2.node.next = TIMERWHEEL_POISON_NEXT;
+    var2.node.pprev = TIMERWHEEL_POISON_PPREV;
+
+    var3.val = 3;
+    var3.fired_at = 0;
+    var3.node.next = TIMERWHEEL_POISON_NEXT;
+    var3.node.pprev = TIMERWHEEL_POISON_PPREV;
+
+    num_expired = 0;
+}
+
+static void expire(TimerWheelNode *node, void *auxiliary_data) {
+    assert(auxiliary_data == &timerwheel);
+    ASSERT_NODE_POISONED((*node));
+
+    timerwheel_entry(node, TestStruct, node)->fired_at = timerwheel_now(&timerwheel);
+    expired[num_expired++] = node;
+}
+
+/* Cancels var2 whenever var1 expires, and schedules var3 again whenever var3 expires. */
+static void expire_and_meddle(TimerWheelNode *node, void *auxiliary_data) {
+    expire(node, auxiliary_data);
+
+    if (node == &var1.node && var2.node.pprev != TIMERWHEEL_POISON_PPREV) {
+        timerwheel_cancel(&timerwheel, &var2.node);
+    } else if (node == &var3.node && num_expired < 3) {
+        timerwheel_schedule(&timerwheel, &var3.node, timerwheel_now(&timerwheel));
+    }
+}
+
+/* ========================================================================================================
+ *
+ *                                             TESTING FUNCTIONS
+ *
+ * ======================================================================================================== */
+
+void test_timerwheel_init(void) {
+    TimerWheelNode node_init_with_macro = TIMERWHEEL_NODE_INIT;
+    int level, i;
+
+    ASSERT_NODE_POISONED(node_init_with_macro);
+
+    timerwheel_init(&timerwheel, 42);
+    assert(timerwheel.now == 42);
+    assert(timerwheel.size == 0);
+
+    for (level = 0; level < TIMERWHEEL_NUM_LEVELS; ++level) {
+        for (i = 0; i < TIMERWHEEL_NUM_SLOTS; ++i) {
+            assert(timerwheel.slots[level][i] == NULL);
+        }
+    }
+}
+
+void test_timerwheel_now(void) {
+    assert(timerwheel_now(&timerwheel) == 0);
+
+    timerwheel_advance(&timerwheel, 10, expire, &timerwheel);
+    assert(timerwheel_now(&timerwheel) == 10);
+
+    timerwheel_schedule(&timerwheel, &var1.node, 20);
+    timerwheel_advance(&timerwheel, 15, expire, &timerwheel);
+    assert(timerwheel_now(&timerwheel) == 15);
+}
+
+void test_timerwheel_size(void) {
+    assert(timerwheel_size(&timerwheel) == 0);
+
+    timerwheel_schedule(&timerwheel, &var1.node, 1);
+    assert(timerwheel_size(&timerwheel) == 1);
+    timerwheel_schedule(&timerwheel, &var2.node, 2);
+    assert(timerwheel_size(&timerwheel) == 2);
+    timerwheel_advance(&timerwheel, 1, expire, &timerwheel);
+    assert(timerwheel_size(&timerwheel) == 1);
+    timerwheel_cancel(&timerwheel, &var2.node);
+    assert(timerwheel_size(&timerwheel) == 0);
+}
+
+void test_timerwheel_empty(void) {
+    assert(timerwheel_empty(&timerwheel) == 1);
+
+    timerwheel_schedule(&timerwheel, &var1.node, 1);
+    assert(timerwheel_empty(&timerwheel) == 0);
+    timerwheel_cancel(&timerwheel, &var1.node);
+    assert(timerwheel_empty(&timerwheel) == 1);
+}
+
+void test_timerwheel_schedule(void) {
+    timerwheel_schedule(&timerwheel, &var1.node, 3);
+    assert(var1.node.expiry == 3);
+    assert(timerwheel.slots[0][3] == &var1.node);
+    assert(var1.node.pprev == &timerwheel.slots[0][3]);
+    assert(var1.node.next == NULL);
+
+    /* Nodes of the same slot are chained, the last one first. */
+    timerwheel_schedule(&timerwheel, &var2.node, 3);
+    assert(timerwheel.slots[0][3] == &var2.node);
+    assert(var2.node.next == &var1.node);
+    assert(var1.node.pprev == &var2.node.next);
+
+    /* Nodes further away go into a higher level. */
+    timerwheel_schedule(&timerwheel, &var3.node, 3 * LEVEL_1_TICKS + 1);
+    assert(timerwheel.slots[1][3] == &var3.node);
+    assert(timerwheel_size(&timerwheel) == 3);
+
+    timerwheel_advance(&timerwheel, 2, expire, &timerwheel);
+    assert(num_expired == 0);
+    timerwheel_advance(&timerwheel, 3, expire, &timerwheel);
+    assert(num_expired == 2);
+    assert(var1.fired_at == 3 && var2.fired_at == 3);
+
+    /* A node that is not due after the current tick expires at the next tick. */
+    timerwheel_schedule(&timerwheel, &var1.node, 0);
+    assert(var1.node.expiry == 0);
+    timerwheel_schedule(&timerwheel, &var2.node, 3);
+    timerwheel_advance(&timerwheel, 4, expire, &timerwheel);
+    assert(num_expired == 4);
+    assert(var1.fired_at == 4 && var2.fired_at == 4);
+
+    timerwheel_advance(&timerwheel, 3 * LEVEL_1_TICKS, expire, &timerwheel);
+    assert(num_expired == 4);
+    timerwheel_advance(&timerwheel, 3 * LEVEL_1_TICKS + 1, expire, &timerwheel);
+    assert(num_expired == 5);
+    assert(var3.fired_at == 3 * LEVEL_1_TICKS + 1);
+    assert(timerwheel_empty(&timerwheel));
+}
+
+void test_timerwheel_cancel(void) {
+    timerwheel_schedule(&timerwheel, &var1.node, 3);
+    timerwheel_schedule(&timerwheel, &var2.node, 3);
+    timerwheel_schedule(&timerwheel, &var3.node, 3);
+
+    /* From the middle of a chain. */
+    timerwheel_cancel(&timerwheel, &var2.node);
+    ASSERT_NODE_POISONED(var2.node);
+    assert(var3.node.next == &var1.node);
+    assert(var1.node.pprev == &var3.node.next);
+
+    /* From the front of a chain. */
+    timerwheel_cancel(&timerwheel, &var3.node);
+    ASSERT_NODE_POISONED(var3.node);
+    assert(timerwheel.slots[0][3] == &var1.node);
+    assert(var1.node.pprev == &timerwheel.slots[0][3]);
+
+    timerwheel_cancel(&timerwheel, &var1.node);
+    ASSERT_NODE_POISONED(var1.node);
+    assert(timerwheel.slots[0][3] == NULL);
+    assert(timerwheel_empty(&timerwheel));
+
+    /* From a higher level, after which nothing expires. */
+    timerwheel_schedule(&timerwheel, &var1.node, RANGE_TICKS / 2);
+    timerwheel_cancel(&timerwheel, &var1.node);
+    timerwheel_schedule(&timerwheel, &var2.node, RANGE_TICKS / 2 + 1);
+    timerwheel_advance(&timerwheel, RANGE_TICKS, expire, &timerwheel);
+    assert(num_expired == 1);
+    assert(expired[0] == &var2.node);
+}
+
+void test_timerwheel_advance(void) {
+    /* Nodes cascade down through every level, expiring exactly on their ticks. */
+    timerwheel_schedule(&timerwheel, &var1.node, LEVEL_1_TICKS - 1);
+    timerwheel_schedule(&timerwheel, &var2.node, LEVEL_1_TICKS * LEVEL_1_TICKS + 7);
+    timerwheel_schedule(&timerwheel, &var3.node, RANGE_TICKS - 1);
+
+    timerwheel_advance(&timerwheel, RANGE_TICKS, expire, &timerwheel);
+    assert(num_expired == 3);
+    assert(expired[0] == &var1.node && var1.fired_at == LEVEL_1_TICKS - 1);
+    assert(expired[1] == &var2.node && var2.fired_at == LEVEL_1_TICKS * LEVEL_1_TICKS + 7);
+    assert(expired[2] == &var3.node && var3.fired_at == RANGE_TICKS - 1);
+    assert(timerwheel_now(&timerwheel) == RANGE_TICKS);
+
+    /* Nodes too far away to be told apart still expire on their ticks. */
+    timerwheel_schedule(&timerwheel, &var1.node, 3 * RANGE_TICKS + 5);
+    timerwheel_advance(&timerwheel, 3 * RANGE_TICKS + 4, expire, &timerwheel);
+    assert(num_expired == 3);
+    timerwheel_advance(&timerwheel, 4 * RANGE_TICKS, expire, &timerwheel);
+    assert(num_expired == 4);
+    assert(var1.fired_at == 3 * RANGE_TICKS + 5);
+
+    /* The expire callback function may cancel and schedule nodes, even in the chain being expired. */
+    num_expired = 0;
+    timerwheel_schedule(&timerwheel, &var2.node, 4 * RANGE_TICKS + 1);
+    timerwheel_schedule(&timerwheel, &var1.node, 4 * RANGE_TICKS + 1);
+    timerwheel_schedule(&timerwheel, &var3.node, 4 * RANGE_TICKS + 1);
+    timerwheel_advance(&timerwheel, 4 * RANGE_TICKS + 10, expire_and_meddle, &timerwheel);
+    assert(num_expired == 3);
+    assert(expired[0] == &var3.node && expired[1] == &var1.node && expired[2] == &var3.node);
+    assert(var3.fired_at == 4 * RANGE_TICKS + 2);
+    ASSERT_NODE_POISONED(var2.node);
+    assert(timerwheel_empty(&timerwheel));
+}
+
+void test_timerwheel_entry(void) {
+    assert(timerwheel_entry(&var1.node, TestStruct, node) == &var1);
+    assert(timerwheel_entry(&var2.node, TestStruct, node)->val == 2);
+}
+
+void test_timerwheel_random(void) {
+    size_t i, num_cancelled = 0;
+    unsigned long now;
+
+    srand(0);
+    timerwheel_init(&timerwheel, 12345);
+
+    for (i = 0; i < NUM_RANDOM_VARS; ++i) {
+        random_vars[i].val = 0;
+        timerwheel_schedule(
+            &timerwheel,
+            &random_vars[i].node,
+            12345 + (unsigned long) rand() % (i % 2 ? 2 * LEVEL_1_TICKS : 2 * RANGE_TICKS)
+        );
+    }
+
+    for (i = 0; i < NUM_RANDOM_VARS; i += 3) {
+        timerwheel_cancel(&timerwheel, &random_vars[i].node);
+        random_vars[i].val = 1;
+        ++num_cancelled;
+    }
+
+    for (now = timerwheel_now(&timerwheel); !timerwheel_empty(&timerwheel); ) {
+        now += 1 + (unsigned long) rand() % LEVEL_1_TICKS;
+        timerwheel_advance(&timerwheel, now, expire, &timerwheel);
+    }
+
+    assert(num_expired == NUM_RANDOM_VARS - num_cancelled);
+
+    for (i = 0; i < num_expired; ++i) {
+        TestStruct *entry = timerwheel_entry(expired[i], TestStruct, node);
+
+        assert(entry->val == 0);
+        assert(entry->fired_at == (entry->node.expiry > 12345 ? entry->node.expiry : 12346));
+        assert(i == 0 || timerwheel_entry(expired[i - 1], TestStruct, node)->fired_at <= entry->fired_at);
+    }
+}
+
+TestFunc test_funcs[] = {
+    test_timerwheel_init,
+    test_timerwheel_now,
+    test_timerwheel_size,
+    test_timerwheel_empty,
+    test_timerwheel_schedule,
+    test_timerwheel_cancel,
+    test_timerwheel_advance,
+    test_timerwheel_entry,
+    test_timerwheel_random
+};
+
+int main(int argc, char *argv[]) {
+    char msg[100] = "TimerWheel ";
+    assert(argc == 2);
+    strcat(msg, argv[1]);
+
+    assert(sizeof(test_funcs) / sizeof(TestFunc) == 9);
+    run_tests(test_funcs, sizeof(test_funcs) / sizeof(TestFunc), msg, reset_globals);
+
+    return 0;
+}